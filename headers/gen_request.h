@@ -0,0 +1,54 @@
+#ifndef GEN_REQUEST_H
+#define GEN_REQUEST_H
+
+/**
+ * @file gen_request.h
+ * @brief Generated by tools/json_schemagen.c from schemas/request.json. Do not edit.
+ */
+
+#include "json_gen.h"
+
+/// Presence Bits:
+
+#define REQUEST_HAS_ID (1u << 0)
+#define REQUEST_HAS_USER (1u << 1)
+#define REQUEST_HAS_PATH (1u << 2)
+#define REQUEST_HAS_MS (1u << 3)
+#define REQUEST_HAS_CACHED (1u << 4)
+
+typedef struct gen_request
+{
+    int id;
+    char *user;
+    char *path;
+    float ms;
+    int cached;
+    unsigned int present; // REQUEST_HAS_... bits of the fields seen with non-null values
+} Request;
+
+/**
+ * @brief Parses one Request Object starting at tokens[*pos]. Unknown keys are skipped and duplicate keys replace earlier values.
+ *
+ * @param self Cleared first, then filled. On error it is left destroyed.
+ * @param src
+ * @param tokens
+ * @param pos Index of the opening '{', advanced past the closing '}' on success.
+ * @param allocator Allocates the string fields (NULL for libc).
+ * @return int ParserErr
+ */
+int Request_Parse(Request *self, const char *src, const TokenVec *tokens, size_t *pos, const JsonAllocator *allocator);
+
+/**
+ * @brief Lexes a whole document into a scratch tape and parses it as one Request.
+ *
+ * @param self
+ * @param src
+ * @param len
+ * @param scratch Token tape reused between documents.
+ * @param allocator
+ * @return int ParserErr
+ */
+int Request_Parse_Text(Request *self, char *src, size_t len, TokenVec *scratch, const JsonAllocator *allocator);
+void Request_Destroy(Request *self, const JsonAllocator *allocator);
+
+#endif
@@ -0,0 +1,463 @@
+#ifndef JSON_HPP
+#define JSON_HPP
+
+/**
+ * @file json.hpp
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares a header-only C++17 wrapper over the C API: a move-only Document that owns a JsonThing, and non-owning Value / ObjectView / ArrayView views over its nodes. Typed reads compile down to direct loads of the node fields, so they cost no more than the C accessors.
+ * @note 1: Views borrow from their Document (or any other JsonThing), so they must not outlive it.
+ * @note 2: Value::as<T> does not check the type. Use Value::is<T> or Value::get<T> when the type is not known.
+ * @date 2026-10-19
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+extern "C" {
+#include "json_parser.h"
+}
+
+namespace myjson
+{
+    class Value;
+    class ObjectView;
+    class ArrayView;
+
+    namespace detail
+    {
+        template <typename T>
+        inline constexpr bool unsupported_type = false;
+
+        /// Maps a C++ read type to the DataType its node must have.
+        template <typename T>
+        constexpr DataType data_type_of()
+        {
+            if constexpr (std::is_same_v<T, bool>)
+                return BOOL;
+            else if constexpr (std::is_same_v<T, int>)
+                return INT;
+            else if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>)
+                return FLT;
+            else if constexpr (std::is_same_v<T, std::string_view> || std::is_same_v<T, const char*>)
+                return STR;
+            else if constexpr (std::is_same_v<T, std::nullptr_t>)
+                return NUL;
+            else if constexpr (std::is_same_v<T, ObjectView>)
+                return OBJ;
+            else if constexpr (std::is_same_v<T, ArrayView>)
+                return ARR;
+            else
+                static_assert(unsupported_type<T>, "myjson: read type must be bool, int, float, double, std::string_view, const char*, std::nullptr_t, ObjectView or ArrayView");
+        }
+    }
+
+    /// Read-only view of an Object.
+    class ObjectView
+    {
+    public:
+        struct Member;
+        class Iterator;
+
+        /// @param object Must not be NULL.
+        constexpr explicit ObjectView(const Object *object) noexcept : object_ {object} {}
+
+        std::size_t size() const noexcept { return object_->count; }
+        bool empty() const noexcept { return size() == 0; }
+
+        /**
+         * @brief Looks up a member by key without copying the key.
+         *
+         * @param key
+         * @return Value An invalid Value if the key is not bound.
+         */
+        Value find(std::string_view key) const noexcept;
+        Value operator[](std::string_view key) const noexcept;
+        bool contains(std::string_view key) const noexcept;
+
+        Iterator begin() const noexcept;
+        Iterator end() const noexcept;
+
+        const Object *get() const noexcept { return object_; }
+
+    private:
+        const Object *object_;
+    };
+
+    /// Read-only view of an Array. Indexing walks the item list, so iterate when visiting many items.
+    class ArrayView
+    {
+    public:
+        class Iterator;
+
+        /// @param array Must not be NULL.
+        constexpr explicit ArrayView(const Array *array) noexcept : array_ {array} {}
+
+        std::size_t size() const noexcept { return array_->length; }
+        bool empty() const noexcept { return size() == 0; }
+
+        /**
+         * @brief Gets the item at index in O(index).
+         *
+         * @param index
+         * @return Value An invalid Value if index is out of range.
+         */
+        Value operator[](std::size_t index) const noexcept;
+        Value front() const noexcept;
+
+        Iterator begin() const noexcept;
+        Iterator end() const noexcept;
+
+        const Array *get() const noexcept { return array_; }
+
+    private:
+        const Array *array_;
+    };
+
+    /// Read-only view of one value: a Property, an ArrayItem or a document root.
+    class Value
+    {
+    public:
+        constexpr Value() noexcept = default;
+        explicit Value(const Property &prop) noexcept : type_ {prop.type}, data_ {&prop.data} {}
+        explicit Value(const ArrayItem &item) noexcept : type_ {item.type}, data_ {&item.data} {}
+
+        /// The pointer forms take NULL (e.g. a failed lookup) as an invalid Value.
+        explicit Value(const Property *prop) noexcept : type_ {prop != nullptr ? prop->type : UNSUPPORTED}, data_ {prop != nullptr ? &prop->data : nullptr} {}
+        explicit Value(const ArrayItem *item) noexcept : type_ {item != nullptr ? item->type : UNSUPPORTED}, data_ {item != nullptr ? &item->data : nullptr} {}
+
+        /**
+         * @brief Views the root of a document, which may be owned elsewhere (e.g. by a ParseContext).
+         *
+         * @param thing
+         * @return Value
+         */
+        static Value of(const JsonThing *thing) noexcept { return Value {thing != nullptr ? thing->root : nullptr}; }
+
+        DataType type() const noexcept { return type_; }
+
+        /// False for a missing member, an out of range item or a lookup on a non-container.
+        explicit operator bool() const noexcept { return data_ != nullptr; }
+
+        template <typename T>
+        bool is() const noexcept { return data_ != nullptr && type_ == detail::data_type_of<T>(); }
+
+        /**
+         * @brief Reads the value as T without checking its type.
+         *
+         * @tparam T bool, int, float, double, std::string_view, const char*, std::nullptr_t, ObjectView or ArrayView.
+         * @return T
+         */
+        template <typename T>
+        T as() const noexcept
+        {
+            constexpr DataType expected = detail::data_type_of<T>();
+
+            if constexpr (expected == BOOL)
+                return *static_cast<const int*>(data_) != 0;
+            else if constexpr (expected == INT)
+                return *static_cast<const int*>(data_);
+            else if constexpr (expected == FLT)
+                return static_cast<T>(*static_cast<const float*>(data_));
+            else if constexpr (expected == STR)
+                return T {*static_cast<char *const *>(data_)};
+            else if constexpr (expected == NUL)
+                return nullptr;
+            else if constexpr (expected == OBJ)
+                return ObjectView {static_cast<const Object*>(*static_cast<void *const *>(data_))};
+            else
+                return ArrayView {static_cast<const Array*>(*static_cast<void *const *>(data_))};
+        }
+
+        /**
+         * @brief Reads the value as T if it has the matching type.
+         *
+         * @tparam T See as<T>.
+         * @return std::optional<T> Empty on a type mismatch or an invalid Value.
+         */
+        template <typename T>
+        std::optional<T> get() const noexcept
+        {
+            if (!is<T>())
+                return std::nullopt;
+
+            return as<T>();
+        }
+
+        /// Member lookup that chains: an invalid Value comes back for non-Objects.
+        Value operator[](std::string_view key) const noexcept { return is<ObjectView>() ? as<ObjectView>().find(key) : Value {}; }
+
+        /// Item lookup in O(index) that chains: an invalid Value comes back for non-Arrays.
+        Value operator[](std::size_t index) const noexcept { return is<ArrayView>() ? as<ArrayView>()[index] : Value {}; }
+
+    private:
+        DataType type_ = UNSUPPORTED;
+        const void *data_ = nullptr; // the node's value union
+    };
+
+    struct ObjectView::Member
+    {
+        std::string_view key;
+        Value value;
+    };
+
+    /// Visits the filled buckets of the Object's table, in no particular order.
+    class ObjectView::Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Member;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Member;
+
+        Iterator() noexcept = default;
+        Iterator(void *const *bucket, void *const *end) noexcept : bucket_ {bucket}, end_ {end} { skip_empty(); }
+
+        Member operator*() const noexcept
+        {
+            const Property *prop = static_cast<const Property*>(*bucket_);
+            return Member {prop->name, Value {*prop}};
+        }
+
+        Iterator &operator++() noexcept
+        {
+            ++bucket_;
+            skip_empty();
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept
+        {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const Iterator &other) const noexcept { return bucket_ == other.bucket_; }
+        bool operator!=(const Iterator &other) const noexcept { return bucket_ != other.bucket_; }
+
+    private:
+        void skip_empty() noexcept
+        {
+            while (bucket_ != end_ && *bucket_ == nullptr)
+                ++bucket_;
+        }
+
+        void *const *bucket_ = nullptr;
+        void *const *end_ = nullptr;
+    };
+
+    class ArrayView::Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Value;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Value;
+
+        Iterator() noexcept = default;
+        explicit Iterator(const ArrayItem *item) noexcept : item_ {item} {}
+
+        Value operator*() const noexcept { return Value {*item_}; }
+
+        Iterator &operator++() noexcept
+        {
+            item_ = item_->next;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept
+        {
+            Iterator old = *this;
+            item_ = item_->next;
+            return old;
+        }
+
+        bool operator==(const Iterator &other) const noexcept { return item_ == other.item_; }
+        bool operator!=(const Iterator &other) const noexcept { return item_ != other.item_; }
+
+    private:
+        const ArrayItem *item_ = nullptr;
+    };
+
+    /// ObjectView:
+
+    inline Value ObjectView::find(std::string_view key) const noexcept
+    {
+        return Value {Object_GetItemN(object_, key.data(), key.size())};
+    }
+
+    inline Value ObjectView::operator[](std::string_view key) const noexcept { return find(key); }
+
+    inline bool ObjectView::contains(std::string_view key) const noexcept { return static_cast<bool>(find(key)); }
+
+    inline ObjectView::Iterator ObjectView::begin() const noexcept
+    {
+        return Iterator {object_->buckets, object_->buckets + object_->bucket_count};
+    }
+
+    inline ObjectView::Iterator ObjectView::end() const noexcept
+    {
+        return Iterator {object_->buckets + object_->bucket_count, object_->buckets + object_->bucket_count};
+    }
+
+    /// ArrayView:
+
+    inline Value ArrayView::operator[](std::size_t index) const noexcept
+    {
+        const ArrayItem *item = array_->head;
+
+        for (; item != nullptr && index > 0; --index)
+            item = item->next;
+
+        return Value {item};
+    }
+
+    inline Value ArrayView::front() const noexcept { return Value {array_->head}; }
+
+    inline ArrayView::Iterator ArrayView::begin() const noexcept { return Iterator {array_->head}; }
+
+    inline ArrayView::Iterator ArrayView::end() const noexcept { return Iterator {}; }
+
+    /// Owner of one parsed JsonThing. Destroying, resetting or assigning over it frees the document with the allocator that made it.
+    class Document
+    {
+    public:
+        Document() noexcept = default;
+
+        /**
+         * @brief Adopts a heap document, e.g. one from Parser_Start_Parse or PushParser_Take. Never adopt a document living in a ParseContext arena.
+         *
+         * @param thing
+         */
+        explicit Document(JsonThing *thing) noexcept : thing_ {thing} {}
+
+        Document(const Document &other) = delete;
+        Document &operator=(const Document &other) = delete;
+
+        Document(Document &&other) noexcept : thing_ {std::exchange(other.thing_, nullptr)}, err_code_ {std::exchange(other.err_code_, NO_ERR)} {}
+
+        Document &operator=(Document &&other) noexcept
+        {
+            if (this != &other)
+            {
+                reset(std::exchange(other.thing_, nullptr));
+                err_code_ = std::exchange(other.err_code_, NO_ERR);
+            }
+
+            return *this;
+        }
+
+        ~Document() { reset(); }
+
+        /**
+         * @brief Parses text, which is only borrowed while parsing.
+         *
+         * @param text
+         * @param allocator Allocator for the tape and the document (NULL for libc).
+         * @return Document Empty on failure, see error().
+         */
+        static Document parse(std::string_view text, const JsonAllocator *allocator = nullptr) noexcept
+        {
+            Document result;
+            TokenVec tokens;
+            Lexer lexer;
+            Parser parser;
+
+            if (!TokenVec_Init(&tokens, 16, allocator))
+            {
+                result.err_code_ = OUT_OF_MEMORY_ERR;
+                return result;
+            }
+
+            // lexing and parsing only read the text
+            char *src = const_cast<char*>(text.data());
+
+            Lexer_Init(&lexer, src, text.size(), allocator);
+            Lexer_Lex_Into(&lexer, &tokens);
+
+            // a cut short tape could still parse as a shorter document
+            if (lexer.out_of_memory)
+            {
+                TokenVec_Destroy(&tokens);
+                result.err_code_ = OUT_OF_MEMORY_ERR;
+                return result;
+            }
+
+            Parser_Init(&parser, src, &tokens, allocator);
+
+            result.thing_ = Parser_Start_Parse(&parser);
+            result.err_code_ = static_cast<ParserErr>(Parser_Get_ErrCode(&parser));
+
+            Parser_Destroy(&parser);
+            TokenVec_Destroy(&tokens);
+
+            return result;
+        }
+
+        /**
+         * @brief Reads and parses a file, which may be compressed (see json_input.h).
+         *
+         * @param path
+         * @param allocator
+         * @return Document Empty on failure, see error().
+         */
+        static Document parse_file(const char *path, const JsonAllocator *allocator = nullptr) noexcept
+        {
+            std::size_t len = 0;
+            char *src = read_file(path, &len, allocator);
+
+            if (src == nullptr)
+            {
+                Document result;
+                result.err_code_ = INPUT_ERR;
+                return result;
+            }
+
+            Document result = parse(std::string_view {src, len}, allocator);
+            json_free(allocator, src);
+
+            return result;
+        }
+
+        explicit operator bool() const noexcept { return thing_ != nullptr; }
+        ParserErr error() const noexcept { return err_code_; }
+
+        Value root() const noexcept { return Value::of(thing_); }
+        Value operator[](std::string_view key) const noexcept { return root()[key]; }
+        Value operator[](std::size_t index) const noexcept { return root()[index]; }
+
+        JsonThing *get() const noexcept { return thing_; }
+
+        /// Clones in O(1) by sharing every container (see JsonThing_Clone). Empty if this is empty or memory ran out.
+        Document clone() const noexcept { return Document(thing_ != nullptr ? JsonThing_Clone(thing_) : nullptr); }
+
+        /// Gives up ownership, so the caller destroys and frees the document.
+        JsonThing *release() noexcept { return std::exchange(thing_, nullptr); }
+
+        void reset(JsonThing *thing = nullptr) noexcept
+        {
+            JsonThing *old = std::exchange(thing_, thing);
+
+            if (old != nullptr)
+            {
+                const JsonAllocator *allocator = old->allocator;
+
+                JsonThing_Destroy(old);
+                json_free(allocator, old);
+            }
+        }
+
+    private:
+        JsonThing *thing_ = nullptr;
+        ParserErr err_code_ = NO_ERR;
+    };
+}
+
+#endif
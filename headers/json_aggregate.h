@@ -0,0 +1,168 @@
+#ifndef JSON_AGGREGATE_H
+#define JSON_AGGREGATE_H
+
+/**
+ * @file json_aggregate.h
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares an aggregation engine over NDJSON: count, sum, min, max and mean of fields across records, optionally grouped by another field, without building a DOM. Each line is lexed into a reused tape and walked once. Only the keys along the requested paths are compared, every other value is stepped over, and numbers are read in place into running totals.
+ * @note 1: Field paths are dotted keys relative to each record, e.g. "latency.ms". Arrays are not descended into, so values inside them cannot be aggregated.
+ * @note 2: Values that are stepped over are only checked for balanced brackets. Records that are not Objects or whose walked parts are malformed are counted in bad_records and otherwise ignored.
+ * @note 3: Aggregator_Run splits a buffer at line boundaries across threads, each with its own tape and totals, then merges them. Groups keep the order in which the input first shows them either way.
+ * @date 2026-10-19
+ */
+
+#include "json_parser.h"
+
+#define AGG_NONE ((size_t)-1)
+#define AGG_BLOCK_SIZE (4 << 20) // bytes Aggregator_RunFile reads per thread before running them
+
+typedef enum json_agg_func {
+    AGG_COUNT,  // records with a non-null value at the path, or every record when the path is NULL
+    AGG_SUM,
+    AGG_MIN,
+    AGG_MAX,
+    AGG_MEAN    // sum over count of numeric values
+} AggFunc;
+
+typedef struct json_agg_spec
+{
+    const char *path;
+    AggFunc func;
+} AggSpec;
+
+/// Trie node for one key of a field path. Children are linked as siblings so the trie is one flat array.
+typedef struct json_agg_node
+{
+    char *key;
+    size_t key_len;
+    size_t first_child;  // AGG_NONE when there is none
+    size_t next_sibling; // AGG_NONE when there is none
+    size_t field;        // field whose path ends here, or AGG_NONE
+} AggNode;
+
+/// Running totals of one field in one group, which every aggregate over that field reads from.
+typedef struct json_agg_accum
+{
+    size_t present; // non-null values
+    size_t count;   // numeric values, which the other totals cover
+    double sum;
+    double min;
+    double max;
+} AggAccum;
+
+typedef struct json_agg_group
+{
+    char *key;          // group field's text: decoded for strings, as written for numbers and booleans
+    size_t key_len;
+    DataType key_type;  // NUL when the field is null or missing, UNSUPPORTED without group-by
+    uint64_t hash;
+    size_t records;
+} AggGroup;
+
+typedef struct json_aggregator
+{
+    /* Job, shared read-only with the workers of Aggregator_Run */
+
+    AggNode *nodes;         // nodes[0] is the record itself
+    size_t node_count;
+    size_t node_capacity;
+    size_t field_count;     // distinct paths
+    size_t *spec_fields;    // field of each aggregate, AGG_NONE to count records
+    AggFunc *spec_funcs;
+    size_t spec_count;
+    size_t group_field;     // AGG_NONE without group-by
+    int owns_job;
+
+    /* Scratch for the current record */
+
+    TokenVec tokens;
+    const Token **values;   // token of each field's value, NULL when missing
+    char *key_buf;          // decoded escaped keys and group values
+    size_t key_buf_cap;
+
+    /* Results */
+
+    AggGroup *groups;
+    AggAccum *accums;       // field_count per group, in group order
+    size_t group_count;
+    size_t group_capacity;
+    size_t *slots;          // open addressing by group hash, holding group indices
+    size_t slot_count;
+    size_t records;
+    size_t bad_records;
+
+    const JsonAllocator *allocator;
+} Aggregator;
+
+/**
+ * @brief Creates an aggregator for a set of aggregates.
+ *
+ * @param group_path Field to group records by, or NULL for one group of all records.
+ * @param specs Copied, so they need not outlive the call.
+ * @param spec_count
+ * @param allocator Allocator for the aggregator and its tables (NULL for libc). Aggregator_Run uses it from several threads, so it must allow that. The caller frees the aggregator with it too.
+ * @return Aggregator* NULL if a path has an empty key or memory ran out.
+ */
+Aggregator *Aggregator_Create(const char *group_path, const AggSpec *specs, size_t spec_count, const JsonAllocator *allocator);
+
+/**
+ * @brief Frees the tables and results, but not the aggregator itself.
+ *
+ * @param self
+ */
+void Aggregator_Destroy(Aggregator *self);
+
+/**
+ * @brief Aggregates every line of an NDJSON buffer on the calling thread. Blank lines are skipped.
+ *
+ * @param self
+ * @param src Whole lines only, as a record is never split across calls.
+ * @param len
+ * @return int NO_ERR or OUT_OF_MEMORY_ERR.
+ */
+int Aggregator_Feed(Aggregator *self, char *src, size_t len);
+
+/**
+ * @brief Splits a buffer at line boundaries into up to thread_count parts, aggregates each on its own thread and merges the results.
+ *
+ * @param self
+ * @param src
+ * @param len
+ * @param thread_count 0 or 1 feeds the buffer on the calling thread.
+ * @return int NO_ERR or OUT_OF_MEMORY_ERR.
+ */
+int Aggregator_Run(Aggregator *self, char *src, size_t len, size_t thread_count);
+
+/**
+ * @brief Aggregates a whole NDJSON file, which may be gzip or zstd compressed, reading AGG_BLOCK_SIZE bytes per thread at a time.
+ *
+ * @param self
+ * @param path
+ * @param thread_count
+ * @return int NO_ERR, INPUT_ERR if the file could not be opened or read, or OUT_OF_MEMORY_ERR.
+ */
+int Aggregator_RunFile(Aggregator *self, const char *path, size_t thread_count);
+
+/**
+ * @brief Adds another aggregator's results into this one. Both must have been made for the same job.
+ *
+ * @param self
+ * @param other
+ * @return int NO_ERR or OUT_OF_MEMORY_ERR.
+ */
+int Aggregator_Merge(Aggregator *self, const Aggregator *other);
+
+size_t Aggregator_GroupCount(const Aggregator *self);
+const AggGroup *Aggregator_Group(const Aggregator *self, size_t group);
+
+/**
+ * @brief Gives one aggregate's value for one group.
+ *
+ * @param self
+ * @param group
+ * @param spec Index into the specs given to Aggregator_Create.
+ * @return double NAN for the min, max or mean of a group without numeric values.
+ */
+double Aggregator_Result(const Aggregator *self, size_t group, size_t spec);
+
+#endif
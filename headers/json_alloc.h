@@ -0,0 +1,33 @@
+#ifndef JSON_ALLOC_H
+#define JSON_ALLOC_H
+
+/**
+ * @file json_alloc.h
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares the pluggable allocator used by the Lexer, Parser and every DOM node.
+ * @note Passing a NULL allocator anywhere means the default libc malloc / realloc / free.
+ * @date 2026-10-19
+ */
+
+#include <stddef.h>
+
+typedef struct json_allocator
+{
+    void *(*alloc)(void *ctx, size_t size);
+    void *(*realloc)(void *ctx, void *ptr, size_t size);
+    void (*free)(void *ctx, void *ptr);
+    void *ctx; // pool, arena, etc. given back to each call
+} JsonAllocator;
+
+/**
+ * @brief Gets the shared libc-backed allocator.
+ *
+ * @return const JsonAllocator*
+ */
+const JsonAllocator *JsonAllocator_Default();
+
+void *json_alloc(const JsonAllocator *allocator, size_t size);
+void *json_realloc(const JsonAllocator *allocator, void *ptr, size_t size);
+void json_free(const JsonAllocator *allocator, void *ptr);
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+/**
+ * @file json_arena.h
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares a bump allocating arena usable as a JsonAllocator. Freeing single allocations is a no-op, and a reset rewinds every block in O(1) while keeping them for reuse.
+ * @date 2026-10-19
+ */
+
+#include "json_alloc.h"
+
+#define ARENA_BLOCK_SIZE 16384
+
+typedef struct json_arena_block
+{
+    struct json_arena_block *next;
+    size_t capacity;
+    size_t used;
+    unsigned char data[];
+} ArenaBlock;
+
+typedef struct json_arena
+{
+    JsonAllocator allocator;   // vtable with ctx = this arena, so the arena must not be moved after init
+    const JsonAllocator *base; // allocates the blocks themselves
+    ArenaBlock *head;
+    ArenaBlock *current;
+    size_t block_size;
+    void *last_ptr;            // most recent allocation, which realloc can grow in place
+} JsonArena;
+
+void JsonArena_Init(JsonArena *self, size_t block_size, const JsonAllocator *base);
+
+/**
+ * @brief Rewinds the arena to its first block in O(1). Every earlier allocation becomes invalid but the blocks are kept.
+ *
+ * @param self
+ */
+void JsonArena_Reset(JsonArena *self);
+
+/**
+ * @brief Frees all blocks back to the base allocator.
+ *
+ * @param self
+ */
+void JsonArena_Destroy(JsonArena *self);
+const JsonAllocator *JsonArena_Allocator(JsonArena *self);
+
+#endif
@@ -10,7 +10,7 @@ typedef struct json_array_item
     union
     {
         /* data */
-        int i;
+        int i;      // also holds BOOL values as 0 or 1
         float f;
         char *str;
         void *chunk; // non-primitive (Array or Object)
@@ -19,38 +19,70 @@ typedef struct json_array_item
     struct json_array_item *next;
 } ArrayItem;
 
-ArrayItem *ArrayItem_Int(int value);
-ArrayItem *ArrayItem_Float(float value);
+ArrayItem *ArrayItem_Int(int value, const JsonAllocator *allocator);
+ArrayItem *ArrayItem_Float(float value, const JsonAllocator *allocator);
+ArrayItem *ArrayItem_Bool(int value, const JsonAllocator *allocator);
 
 /**
  * @brief Initialize a JSON array slot for a string.
  * 
  * @param str The C-String to be moved to the internal "str" pointer.
+ * @param allocator Allocator for the slot itself (NULL for libc).
  * @return ArrayItem*
  */
-ArrayItem *ArrayItem_String(char *str);
+ArrayItem *ArrayItem_String(char *str, const JsonAllocator *allocator);
 
-// TODO: implement this missing function...
-ArrayItem *ArrayItem_Chunk(void *chunk, DataType type);
+ArrayItem *ArrayItem_Chunk(void *chunk, DataType type, const JsonAllocator *allocator);
 
 /**
  * @brief Frees any dynamic memory within an ArrayItem (mostly C-Strings).
  * 
  * @param self 
+ * @param allocator The allocator which made the item's strings and chunk.
  */
-void ArrayItem_Destroy(ArrayItem *self);
+void ArrayItem_Destroy(ArrayItem *self, const JsonAllocator *allocator);
 
 typedef struct json_array
 {
     /* data */
     size_t length;
     ArrayItem *head;
+    ArrayItem *tail;    // for O(1) pushes
+    size_t refs;        // owners sharing this Array, which is read-only while over 1 (see JsonThing_Clone)
+    uint64_t hash;      // Merkle hash of the subtree, a mutable cache (see json_merkle.h) that is 0 until JsonThing_Hash fills it in and again after any change to the elements
+    const JsonAllocator *allocator; // inherited by the items
 } Array;
 
-Array *Array_Create();
+Array *Array_Create(const JsonAllocator *allocator);
 void Array_Destroy(Array *self);
+
+/**
+ * @brief Copies an Array's items for copy-on-write. Strings are duplicated, but nested Arrays and Objects are shared by taking a reference on each.
+ *
+ * @param self
+ * @return Array* NULL if memory ran out.
+ */
+Array *Array_Copy(const Array *self);
 size_t Array_Length(const Array *self);
 const ArrayItem *Array_Get(const Array *self, size_t pos);
 void Array_Push(Array *self, ArrayItem *item);
 
+/**
+ * @brief Links an item in before position pos in O(pos), or at the end if pos is the length or past it.
+ *
+ * @param self
+ * @param pos
+ * @param item Must be allocated already, and is owned by the Array from here.
+ */
+void Array_Insert(Array *self, size_t pos, ArrayItem *item);
+
+/**
+ * @brief Unlinks the item at position pos in O(pos) without destroying it.
+ *
+ * @param self
+ * @param pos
+ * @return ArrayItem* The unlinked item, which the caller destroys and frees, or NULL if pos is out of range.
+ */
+ArrayItem *Array_Take(Array *self, size_t pos);
+
 #endif
\ No newline at end of file
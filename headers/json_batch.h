@@ -0,0 +1,108 @@
+#ifndef JSON_BATCH_H
+#define JSON_BATCH_H
+
+/**
+ * @file json_batch.h
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares a batch loader for parsing many small files. On Linux it keeps a bounded number of opens and reads in flight through io_uring, with each read going straight into a registered per-slot buffer. Each file is parsed as soon as its read completes, so disk waits overlap with parsing instead of adding to it.
+ * @note 1: The ring is set up with raw syscalls, so no liburing is needed. Where io_uring is missing or blocked (e.g. by a seccomp filter), files are read one at a time with blocking reads instead, with the same results.
+ * @note 2: Files are read as plain JSON up to the slot buffer size. Larger files and gzip / zstd files fail with INPUT_ERR (read_file and PushParser_Parse_Input handle those).
+ * @date 2026-10-19
+ */
+
+#include "json_context.h"
+
+#define BATCH_QUEUE_DEPTH 32      // default number of files in flight
+#define BATCH_BUFFER_SIZE 65536   // default slot buffer size, which caps the file size
+#define BATCH_NO_FILE ((size_t)-1)
+
+/**
+ * @brief Receives each parsed file, in completion order.
+ *
+ * @param user
+ * @param index Position of the file in the path list.
+ * @param path
+ * @param doc The document, which lives in the batch's ParseContext: it is only valid until the callback returns and must not be destroyed. NULL on failure.
+ * @param err_code A ParserErr, INPUT_ERR if the file could not be opened or read.
+ */
+typedef void (*BatchCallback)(void *user, size_t index, const char *path, const JsonThing *doc, int err_code);
+
+/// One file in flight and the buffer its read lands in.
+typedef struct json_batch_slot
+{
+    char *buf;
+    size_t index;   // path index, BATCH_NO_FILE while idle
+    int fd;
+} BatchSlot;
+
+typedef struct json_batch
+{
+    BatchSlot *slots;
+    char *buffers;          // one block split into the slot buffers
+    size_t depth;
+    size_t buffer_size;
+    ParseContext *context;  // parses every file, so steady-state parsing does not allocate
+
+    /* io_uring state, unused when ring_fd is -1 */
+
+    int ring_fd;
+    int fixed_buffers;      // the slot buffers are registered, so reads skip page pinning
+    unsigned sq_entries;    // at least 2 * depth: one open or read per slot plus one close per slot
+    unsigned sq_pending;    // filled entries past the published tail
+    size_t closing;         // async closes without a completion yet
+    void *sq_map;
+    size_t sq_map_len;
+    void *cq_map;
+    size_t cq_map_len;
+    void *sqes;             // struct io_uring_sqe array
+    size_t sqes_len;
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    void *cqes;             // struct io_uring_cqe array
+
+    const JsonAllocator *allocator;
+} JsonBatch;
+
+/**
+ * @brief Creates a batch loader with its slot buffers, parse context and, where available, its ring.
+ *
+ * @param depth Files kept in flight, or 0 for BATCH_QUEUE_DEPTH.
+ * @param buffer_size Largest file size accepted, or 0 for BATCH_BUFFER_SIZE.
+ * @param allocator Allocator for the loader, its buffers and its parse context (NULL for libc). The caller frees the loader with it too.
+ * @return JsonBatch*
+ */
+JsonBatch *JsonBatch_Create(size_t depth, size_t buffer_size, const JsonAllocator *allocator);
+
+/**
+ * @brief Closes the ring and frees the buffers and parse context, but not the loader itself.
+ *
+ * @param self
+ */
+void JsonBatch_Destroy(JsonBatch *self);
+
+/**
+ * @brief Reads and parses every file in paths, handing each result to on_doc as it completes.
+ *
+ * @param self
+ * @param paths
+ * @param count
+ * @param on_doc
+ * @param user Passed through to on_doc.
+ * @return size_t How many files parsed without error.
+ */
+size_t JsonBatch_Run(JsonBatch *self, const char *const *paths, size_t count, BatchCallback on_doc, void *user);
+
+/**
+ * @brief Tells whether reads go through io_uring or the blocking fallback.
+ *
+ * @param self
+ * @return int
+ */
+int JsonBatch_Uses_Uring(const JsonBatch *self);
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef JSON_COMPACT_H
+#define JSON_COMPACT_H
+
+/**
+ * @file json_compact.h
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares a compact read-only document for large in-memory datasets. Every value is one 16-byte CompactNode in a single document-wide pool, nodes refer to each other by 32-bit index instead of by pointer, and numbers, booleans and strings of up to 8 chars live inside their node. Member names are interned, so a key repeated across a million records is stored once.
+ * @note 1: Nodes sit in document order, so the elements of a container follow it directly and a container records the index past its subtree. Traversal walks the pool front to back instead of chasing pointers.
+ * @note 2: Object lookups scan the members with integer key compares, so they are O(member count). Prefer the DOM for very wide Objects with random key access.
+ * @note 3: Indices, string lengths and pool offsets are 32-bit, which caps a document at 2^32 nodes, 4 GiB of strings and strings of 256 MiB.
+ * @date 2026-10-19
+ */
+
+#include <stdint.h>
+#include "json_parser.h"
+
+#define COMPACT_ROOT 0               // the root value is always the first node
+#define COMPACT_NONE 0xffffffffu     // no such node, or no key for Array items and the root
+#define COMPACT_INLINE_STR 0x8u      // STR: the text sits in the node itself
+#define COMPACT_TAG_BITS 4
+#define COMPACT_TAG_MASK 0x7u        // the DataType in the low bits of meta
+#define COMPACT_INLINE_LEN 8
+#define COMPACT_MAX_LEN 0x0fffffffu  // longest string or largest element count
+
+typedef struct json_compact_node
+{
+    uint32_t meta;  // DataType and COMPACT_INLINE_STR in the low 4 bits, the string length or element count above them
+    uint32_t key;   // member name in the key pool, COMPACT_NONE for Array items and the root
+    union
+    {
+        int32_t i;  // also holds BOOL values as 0 or 1
+        float f;
+        uint32_t str; // STR over 8 chars: offset in the string pool
+        uint32_t end; // ARR / OBJ: index past the subtree
+        char inline_str[COMPACT_INLINE_LEN]; // STR up to 8 chars, not null terminated
+    } data;
+} CompactNode;
+
+typedef struct json_compact_doc
+{
+    CompactNode *nodes;
+    uint32_t node_count;
+    char *strs;             // strings over 8 chars, each null terminated
+    uint32_t strs_len;
+    char *keys;             // interned member names, each null terminated
+    uint32_t keys_len;
+    uint32_t *key_slots;    // open addressing table of key pool offsets, COMPACT_NONE when empty
+    uint32_t key_slot_count;
+    uint32_t key_count;
+    const JsonAllocator *allocator;
+} CompactDoc;
+
+/**
+ * @brief Parses text straight into a compact document, with the same error codes as a DOM parse. The pools are trimmed to size at the end.
+ *
+ * @param src The JSON text, which is borrowed.
+ * @param len
+ * @param allocator Allocator for the document and its pools (NULL for libc). The caller frees the document with it too.
+ * @param err_code Receives the ParserErr, or OUT_OF_MEMORY_ERR past the 32-bit limits.
+ * @return CompactDoc* NULL on failure.
+ */
+CompactDoc *CompactDoc_Parse(char *src, size_t len, const JsonAllocator *allocator, int *err_code);
+
+/**
+ * @brief Frees the pools, but not the document itself.
+ *
+ * @param self
+ */
+void CompactDoc_Destroy(CompactDoc *self);
+
+/**
+ * @brief Gives the heap bytes held by the document's pools, excluding the CompactDoc itself.
+ *
+ * @param self
+ * @return size_t
+ */
+size_t CompactDoc_Bytes(const CompactDoc *self);
+
+/// Node Readers: node is an index from CompactDoc_Get, CompactDoc_At, CompactDoc_First / Next or COMPACT_ROOT, and is not range checked.
+
+DataType CompactDoc_Type(const CompactDoc *self, uint32_t node);
+int CompactDoc_Int(const CompactDoc *self, uint32_t node);
+float CompactDoc_Float(const CompactDoc *self, uint32_t node);
+int CompactDoc_Bool(const CompactDoc *self, uint32_t node);
+
+/**
+ * @brief Gets a string value. Text of up to 8 chars points into the node and is not null terminated, so always use len.
+ *
+ * @param self
+ * @param node
+ * @param len Receives the length.
+ * @return const char*
+ */
+const char *CompactDoc_Str(const CompactDoc *self, uint32_t node, size_t *len);
+
+/**
+ * @brief Gets the member name of an Object member.
+ *
+ * @param self
+ * @param node
+ * @return const char* NULL for Array items and the root.
+ */
+const char *CompactDoc_Key(const CompactDoc *self, uint32_t node);
+
+/**
+ * @brief Gets the element count of an Array or Object.
+ *
+ * @param self
+ * @param node
+ * @return uint32_t 0 for other values.
+ */
+uint32_t CompactDoc_Count(const CompactDoc *self, uint32_t node);
+
+/**
+ * @brief Looks up an Object member. A key that was never interned fails without scanning, and a later duplicate key shadows an earlier one like in the DOM.
+ *
+ * @param self
+ * @param object
+ * @param key
+ * @return uint32_t COMPACT_NONE if the key is not bound or object is not an Object.
+ */
+uint32_t CompactDoc_Get(const CompactDoc *self, uint32_t object, const char *key);
+
+/**
+ * @brief Gets an Array item in O(index), jumping over nested values.
+ *
+ * @param self
+ * @param array
+ * @param index
+ * @return uint32_t COMPACT_NONE if out of range or array is not an Array.
+ */
+uint32_t CompactDoc_At(const CompactDoc *self, uint32_t array, size_t index);
+
+/**
+ * @brief Gets the first element of an Array or Object. Visit the rest with CompactDoc_Next, CompactDoc_Count times in all.
+ *
+ * @param self
+ * @param container
+ * @return uint32_t COMPACT_NONE if the container is empty or not a container.
+ */
+uint32_t CompactDoc_First(const CompactDoc *self, uint32_t container);
+
+/**
+ * @brief Gets the index past a node's subtree, which is its next sibling unless it was the last element.
+ *
+ * @param self
+ * @param node
+ * @return uint32_t
+ */
+uint32_t CompactDoc_Next(const CompactDoc *self, uint32_t node);
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef JSON_CONTEXT_H
+#define JSON_CONTEXT_H
+
+/**
+ * @file json_context.h
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares a long-lived parse context for parsing many documents in a row. It keeps its token tape and arena blocks between documents, so steady-state parsing of similar documents does no heap allocation.
+ * @date 2026-10-19
+ */
+
+#include "json_parser.h"
+#include "json_arena.h"
+
+typedef struct json_parse_context
+{
+    JsonArena arena;           // DOM nodes, strings and the JsonThing of the current document
+    TokenVec tokens;           // token tape, capacity kept across documents
+    Lexer lexer;
+    Parser parser;             // keeps its parse stack across documents
+    const JsonAllocator *base; // backs the arena blocks and the tape
+} ParseContext;
+
+/**
+ * @brief Creates a reusable parse context.
+ *
+ * @param arena_block_size Size of each arena block, or 0 for ARENA_BLOCK_SIZE.
+ * @param base Allocator for the context, its arena blocks and its token tape (NULL for libc). The caller frees the context with it too.
+ * @return ParseContext*
+ */
+ParseContext *ParseContext_Create(size_t arena_block_size, const JsonAllocator *base);
+
+/**
+ * @brief Frees the kept tape, parse stack and arena blocks, but not the context itself.
+ *
+ * @param self
+ */
+void ParseContext_Destroy(ParseContext *self);
+
+/**
+ * @brief Resets the context in O(1), which invalidates the last parsed document.
+ *
+ * @param self
+ */
+void ParseContext_Reset(ParseContext *self);
+
+/**
+ * @brief Parses a document after resetting the context. The result lives in the context's arena, so it stays valid only until the next parse or reset and must not be passed to JsonThing_Destroy.
+ *
+ * @param self
+ * @param src The JSON text, which is borrowed.
+ * @param len Length of src in chars.
+ * @return JsonThing*
+ */
+JsonThing *ParseContext_Parse(ParseContext *self, char *src, size_t len);
+int ParseContext_Get_ErrCode(const ParseContext *self);
+
+#endif
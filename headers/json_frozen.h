@@ -0,0 +1,54 @@
+#ifndef JSON_FROZEN_H
+#define JSON_FROZEN_H
+
+/**
+ * @file json_frozen.h
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares frozen documents, which any number of threads may read at once without locks. Freezing gives the document private copies of any containers it shares with clones and fills in every Merkle hash, so no accessor writes to it afterwards. Readers then share it through a handle with an atomic reference count, and whichever reader lets go last frees it.
+ * @note 1: Read a frozen document through the const accessors only: Object_GetItem, Object_GetItemN, Array_Get, Array_Length, Property_As*, JsonThing_Hash, JsonThing_Same, JsonThing_Diff, plain walks over items and buckets, and the C++ views. Do not clone, edit or patch it, as clones and edits change counts that are not atomic.
+ * @note 2: The last FrozenThing_Release frees the document with its own allocator, on whichever thread that is, so the allocator must allow frees from any thread (libc's does, an arena does not).
+ * @date 2026-10-19
+ */
+
+#include <stdatomic.h>
+#include "json_thing.h"
+
+typedef struct json_frozen
+{
+    const JsonThing *doc;
+    atomic_size_t refs; // handles held, starting at 1 for the freezing thread
+} FrozenThing;
+
+/**
+ * @brief Readies doc for lock-free reads from several threads: gives it private copies of any containers it shares with clones and fills in every Merkle hash, so no accessor writes to it afterwards. JsonThing_Freeze and JsonReload_Publish call it, and it may be called again on a sealed document at little cost.
+ *
+ * @param doc
+ * @return int 0 if memory ran out, in which case doc is unchanged in content but may still share some containers.
+ */
+int JsonThing_Seal(JsonThing *doc);
+
+/**
+ * @brief Makes doc read-only and hands it to a shareable handle. Only the containers doc shares with clones are copied, the rest are just walked once.
+ *
+ * @param doc Owned by the handle on success. On failure the caller keeps it, unchanged in content.
+ * @return FrozenThing* NULL if memory ran out.
+ */
+FrozenThing *JsonThing_Freeze(JsonThing *doc);
+
+/**
+ * @brief Takes another reference, typically before handing the document to another thread.
+ *
+ * @param self
+ * @return FrozenThing* self
+ */
+FrozenThing *FrozenThing_Acquire(FrozenThing *self);
+
+/**
+ * @brief Drops a reference, freeing the document and the handle when it was the last.
+ *
+ * @param self
+ * @return int 1 if this call freed the document.
+ */
+int FrozenThing_Release(FrozenThing *self);
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef JSON_GEN_H
+#define JSON_GEN_H
+
+/**
+ * @file json_gen.h
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares the small runtime that parsers emitted by tools/json_schemagen.c call into. Each helper reads one value token from the tape straight into a typed C field, without building DOM nodes.
+ * @date 2026-10-19
+ */
+
+#include "json_parser.h"
+
+/// Value Readers: each returns a ParserErr code, and UNEXPECTED_TOKEN_ERR when the token does not fit the field type.
+
+int JsonGen_Int(int *out, const char *src, const Token *value);
+
+/**
+ * @brief Reads an integer or floating literal into a float field, converting the whole literal like the parser does (see Token_ToNum).
+ *
+ * @param out
+ * @param src
+ * @param value
+ * @param allocator Copies a literal of MAX_NUM_TXT_LEN chars or more.
+ * @return int ParserErr
+ */
+int JsonGen_Float(float *out, const char *src, const Token *value, const JsonAllocator *allocator);
+int JsonGen_Bool(int *out, const Token *value);
+
+/**
+ * @brief Copies a string token into a string field, freeing the field's old string first so duplicate keys replace the earlier value.
+ *
+ * @param out
+ * @param src
+ * @param value
+ * @param allocator Allocates the copied string.
+ * @return int ParserErr
+ */
+int JsonGen_String(char **out, const char *src, const Token *value, const JsonAllocator *allocator);
+
+/**
+ * @brief Steps *pos past one whole value of an unknown key, in O(1) for a container indexed by the lexer and else by counting brackets. Nested content is only checked for balance, not grammar.
+ *
+ * @param tokens
+ * @param pos Index of the value's first token, which is advanced past its last token.
+ * @return int ParserErr
+ */
+int JsonGen_Skip(const TokenVec *tokens, size_t *pos);
+
+/**
+ * @brief Matches an escaped key by decoding it first, so e.g. "\u0069d" still finds the field "id".
+ *
+ * @param src
+ * @param key
+ * @param match Generated key matcher.
+ * @param allocator Scratch allocator for the decoded key.
+ * @return int Field index, or -1 for an unknown key.
+ */
+int JsonGen_Match_Escaped(const char *src, const Token *key, int (*match)(const char *, size_t), const JsonAllocator *allocator);
+
+/**
+ * @brief Lexes a whole document into a cleared scratch tape, so generated Parse_Text functions share one lexing path.
+ *
+ * @param scratch Token tape reused between documents.
+ * @param src
+ * @param len
+ * @return int ParserErr
+ */
+int JsonGen_Lex(TokenVec *scratch, char *src, size_t len);
+
+#endif
@@ -8,4 +8,13 @@
 
 size_t hash_object_key(const char *key_str);
 
+/**
+ * @brief Hashes a key that need not be null terminated, matching hash_object_key for the same text.
+ *
+ * @param key_str
+ * @param len
+ * @return size_t
+ */
+size_t hash_object_keyn(const char *key_str, size_t len);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef JSON_INCR_H
+#define JSON_INCR_H
+
+/**
+ * @file json_incr.h
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares an incrementally reparsed document. A text edit relexes only the tokens it touches, splices them into the kept token tape, and rebuilds the smallest enclosing value of the DOM instead of the whole document.
+ * @date 2026-10-19
+ */
+
+#include "json_parser.h"
+
+/// Path entry for one Array / Object open around an edit, found by walking the token tape.
+typedef struct json_incr_frame
+{
+    size_t opener;     // tape index of the '[' or '{'
+    size_t item_index; // Arrays: index of the current item
+    size_t key_idx;    // Objects: tape index of the current member's key
+    DataType type;
+} IncrFrame;
+
+typedef struct json_incr_doc
+{
+    /* Document */
+
+    char *src;                      // owned copy of the text
+    size_t len;
+    size_t cap;
+    TokenVec tokens;                // tape kept in step with src
+    JsonThing *doc;                 // NULL while the text is not valid JSON
+    Parser parser;                  // rebuilds subtrees, keeping its parse stack
+    const JsonAllocator *allocator;
+
+    /* Scratch kept between edits */
+
+    TokenVec relexed;
+    IncrFrame *path;
+    size_t path_cap;
+
+    /* Last Edit */
+
+    size_t relexed_count;  // tokens lexed again
+    size_t reparsed_count; // tokens parsed again
+    int full_reparse;      // 1 if the edit fell back to reparsing everything
+} IncrDoc;
+
+/**
+ * @brief Copies and parses a document for later edits. The result is NULL only if memory ran out; invalid JSON gives a NULL document and an error code.
+ *
+ * @param src
+ * @param len
+ * @param allocator Allocates the copy, tapes and DOM (NULL for libc). The caller frees the IncrDoc with it too.
+ * @return IncrDoc*
+ */
+IncrDoc *IncrDoc_Create(const char *src, size_t len, const JsonAllocator *allocator);
+
+/**
+ * @brief Frees the text, tapes, scratch and DOM, but not the IncrDoc itself.
+ *
+ * @param self
+ */
+void IncrDoc_Destroy(IncrDoc *self);
+
+/**
+ * @brief Replaces the text in [begin, end) with text, then updates the DOM. An edit inside one primitive value rebuilds only that value, other edits rebuild the innermost Array / Object around them, and an edit that breaks or reaches the root reparses everything.
+ *
+ * @param self
+ * @param begin Offsets into the current text, clamped to its length.
+ * @param end
+ * @param text Replacement text, which may be empty to delete.
+ * @param text_len
+ * @return int The ParserErr of the edited document.
+ */
+int IncrDoc_Edit(IncrDoc *self, size_t begin, size_t end, const char *text, size_t text_len);
+
+/**
+ * @brief Gives the current DOM, which stays owned by the IncrDoc and changes in place on each edit.
+ *
+ * @param self
+ * @return const JsonThing*
+ */
+const JsonThing *IncrDoc_Get(const IncrDoc *self);
+int IncrDoc_Get_ErrCode(const IncrDoc *self);
+
+#endif
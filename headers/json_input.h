@@ -0,0 +1,80 @@
+#ifndef JSON_INPUT_H
+#define JSON_INPUT_H
+
+/**
+ * @file json_input.h
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares the file input layer, which recognizes gzip and zstd streams by their magic bytes and decompresses them block by block into the reader's own buffer, so compressed JSON needs no temporary file.
+ * @note 1: Decompression is opt-in: "make ZLIB=1" links the system zlib and "make ZSTD=1" links libzstd. Without them, a compressed stream is still recognized but fails with INPUT_ERR.
+ * @date 2026-10-19
+ */
+
+#include <stdio.h>
+#include "json_parser.h"
+
+#define INPUT_CHUNK_SIZE 65536 // compressed bytes read per refill
+
+typedef enum json_input_codec {
+    INPUT_PLAIN,
+    INPUT_GZIP, // 1f 8b
+    INPUT_ZSTD  // 28 b5 2f fd
+} InputCodec;
+
+typedef struct json_input
+{
+    FILE *file;
+    int owns_file;        // opened by JsonInput_Open, so closed on destroy
+    InputCodec codec;
+
+    /* Compressed bytes read ahead (or the sniffed prefix of a plain file) */
+
+    unsigned char *raw;
+    size_t raw_len;
+    size_t raw_pos;
+
+    void *decoder;        // z_stream or ZSTD_DStream
+    int frame_done;       // the last compressed frame ended cleanly, so end of file is not a truncation
+    int file_done;        // no compressed bytes are left to read
+    int at_end;
+    ParserErr err_code;
+    const JsonAllocator *allocator;
+} JsonInput;
+
+/**
+ * @brief Opens a possibly compressed file for reading.
+ *
+ * @param path
+ * @param allocator Allocator for the input and its buffers (NULL for libc). The caller frees the input with it too.
+ * @return JsonInput* NULL if the file cannot be opened or memory ran out.
+ */
+JsonInput *JsonInput_Open(const char *path, const JsonAllocator *allocator);
+
+/**
+ * @brief Initializes an embedded JsonInput over an already open file, which is borrowed. Reads the first bytes to pick the codec.
+ *
+ * @param self
+ * @param file
+ * @param allocator
+ * @return int 0 if memory ran out or the codec could not start.
+ */
+int JsonInput_Init(JsonInput *self, FILE *file, const JsonAllocator *allocator);
+
+/**
+ * @brief Frees the decoder and read-ahead buffer, and closes the file if the input opened it, but does not free the input itself.
+ *
+ * @param self
+ */
+void JsonInput_Destroy(JsonInput *self);
+
+/**
+ * @brief Reads up to len decompressed bytes into buf.
+ *
+ * @param self
+ * @param buf
+ * @param len
+ * @return size_t Bytes produced, 0 only at the end of input or on error (see JsonInput_Get_ErrCode).
+ */
+size_t JsonInput_Read(JsonInput *self, char *buf, size_t len);
+int JsonInput_Get_ErrCode(const JsonInput *self);
+
+#endif
@@ -8,36 +8,69 @@
 
 #define MAX_JSON_LEN 10000
 
+/// Character Classes:
+
+/// Every byte maps to one class through a 256-entry table, so the lexer dispatches on one lookup instead of comparison chains.
+typedef enum json_char_class {
+    CC_OTHER,     // no token starts here
+    CC_WSPACE,
+    CC_LBRACKET,
+    CC_RBRACKET,
+    CC_LCURLY,
+    CC_RCURLY,
+    CC_COLON,
+    CC_COMMA,
+    CC_QUOTE,
+    CC_NUMBER,    // [0-9] or '-'
+    CC_LITERAL    // 'n', 't' or 'f' starting null / true / false
+} CharClass;
+
+extern const unsigned char JSON_CHAR_CLASS[256];
+
 /// Helpers:
 
 int is_wspace(char c);
 int is_digit(char c);
 
 /**
- * @brief Reads an entire file (json) into a dynamic char buffer. Returns NULL on failure. Either failed allocation or a size too large (over MAX_JSON_LEN) will cause failure.
+ * @brief Reads an entire file (json) into a dynamic char buffer, decompressing gzip or zstd files on the way (see json_input.h). Returns NULL on failure. Either failed allocation, unreadable input or a size too large (over MAX_JSON_LEN) will cause failure.
  * 
  * @param file_path The file path.
+ * @param allocator Allocator for the buffer (NULL for libc).
  * @return char*
  */
-char *read_file(const char *file_path, size_t *external_len);
+char *read_file(const char *file_path, size_t *external_len, const JsonAllocator *allocator);
 
 /// Lexer:
 
 typedef struct json_lex
 {
-    char special_null[5]; // cached "null" name for lexing
     char *doc_buf;
     size_t doc_pos;
     size_t doc_end;
+    int out_of_memory; // set when Lexer_Lex_Into could not grow the tape, which is then cut short
+    JsonStats stats; // lex timer and token allocations (JSON_STATS builds only)
+    const JsonAllocator *allocator; // for the buffer, tokens and token vector
 } Lexer;
 
 /**
  * @brief Creates and initializes a new Lexer with an internal buffer of the small JSON file.
  * 
  * @param file_path Constant C-String naming the file.
+ * @param allocator Allocator for the Lexer, its buffer and its tokens (NULL for libc). The caller frees the Lexer with it too.
  * @return Lexer*
  */
-Lexer *Lexer_Create(const char *file_path);
+Lexer *Lexer_Create(const char *file_path, const JsonAllocator *allocator);
+
+/**
+ * @brief Initializes an embedded or reused Lexer over a caller's buffer, which is borrowed and not freed by the Lexer.
+ *
+ * @param self
+ * @param src The JSON text.
+ * @param len Length of src in chars.
+ * @param allocator Allocator for any TokenVec made by Lexer_Lex_All.
+ */
+void Lexer_Init(Lexer *self, char *src, size_t len, const JsonAllocator *allocator);
 
 /**
  * @brief Moves out the dynamic buffer (to the parser) after resetting Lexer data.
@@ -55,10 +88,42 @@ char *Lexer_CleanUp(Lexer *self);
 int Lexer_CanUse(const Lexer *self);
 
 void Lexer_Skip_WSpc(Lexer *self);
-Token *Lexer_Lex_Punct(Lexer *self, TokenType punct_kind);
-Token *Lexer_Lex_Str(Lexer *self);
-Token *Lexer_Lex_Num(Lexer *self);
-Token *Lexer_Lex_Null(Lexer *self);
+Token Lexer_Lex_Punct(Lexer *self, TokenType punct_kind);
+Token Lexer_Lex_Str(Lexer *self);
+Token Lexer_Lex_Num(Lexer *self);
+
+/**
+ * @brief Lexes null, true or false with a single 4-byte word compare (plus one byte for false). Anything else becomes an UNKNOWN token.
+ *
+ * @param self
+ * @return Token
+ */
+Token Lexer_Lex_Literal(Lexer *self);
+
+/**
+ * @brief Skips whitespace and lexes one token, so callers can pull tokens without a tape. Gives a FILE_END token at the end of the buffer. Openers come back unindexed (skip 0).
+ *
+ * @param self
+ * @return Token
+ */
+Token Lexer_Lex_Next(Lexer *self);
+
+/**
+ * @brief Lexes the whole buffer, appending to an existing token tape so its capacity can be reused. Returns the count of appended tokens. If the tape cannot grow, lexing stops and out_of_memory is set, as the tokens so far may still read as a shorter valid document.
+ * @note Each LBRACKET / LCURLY also gets the distance to its matching closer (skip) and its element count (flags), so consumers can step over or size a container in O(1). Openers still open at the end stay unindexed.
+ *
+ * @param self
+ * @param out
+ * @return size_t
+ */
+size_t Lexer_Lex_Into(Lexer *self, TokenVec *out);
+
+/**
+ * @brief Lexes the whole buffer into a new token tape.
+ *
+ * @param self
+ * @return TokenVec* NULL if memory ran out, which also sets out_of_memory.
+ */
 TokenVec *Lexer_Lex_All(Lexer *self);
 
 #endif
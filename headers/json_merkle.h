@@ -0,0 +1,99 @@
+#ifndef JSON_MERKLE_H
+#define JSON_MERKLE_H
+
+/**
+ * @file json_merkle.h
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares Merkle hashing over the DOM: every Array and Object caches a 64-bit hash of its subtree, built from its children's hashes. Object hashes ignore member order. Once hashed, two documents compare in O(1), a diff descends only into subtrees whose hashes differ, and a MerkleStore can fold equal subtrees from many documents into one shared copy.
+ * @note 1: Hashing is a separate pass, so parses that never compare pay nothing. Cached hashes are reused, so hashing again after an edit only revisits the edited path.
+ * @note 2: Edits clear the cached hashes they make stale: JsonThing_Edit and JsonPatch along their path, IncrDoc from the rebuilt value up to the root, and the Array / Object mutators on the container they change.
+ * @note 3: The hash is not cryptographic. Equal hashes mean equal documents up to 64-bit collisions, so MerkleStore confirms each match with a full compare before sharing it.
+ * @note 4: Each container's hash is a mutable cache, like a C++ mutable member: JsonThing_Hash, JsonThing_Same and JsonThing_Diff take const documents because they never change content, but they fill in missing hashes. Several threads may only call them on one document once every hash is filled in, as JsonThing_Seal does for frozen and published documents. Any other document must not be hashed by one thread while another reads it.
+ * @date 2026-10-19
+ */
+
+#include "json_thing.h"
+
+typedef enum json_diff_kind {
+    DIFF_ADDED,     // only the second document has a value at the pointer
+    DIFF_REMOVED,   // only the first document has a value at the pointer
+    DIFF_CHANGED    // both have a value, and it differs
+} DiffKind;
+
+/**
+ * @brief Receives each difference found by JsonThing_Diff.
+ *
+ * @param user
+ * @param pointer JSON Pointer to the differing value, only valid during the call.
+ * @param kind
+ */
+typedef void (*DiffCallback)(void *user, const char *pointer, DiffKind kind);
+
+typedef struct json_merkle_entry
+{
+    uint64_t hash;
+    DataType type;  // ARR or OBJ, UNSUPPORTED when the slot is empty
+    void *chunk;    // the store holds a reference
+} MerkleEntry;
+
+typedef struct json_merkle_store
+{
+    MerkleEntry *entries;   // open addressing by hash
+    size_t capacity;
+    size_t count;
+    const JsonAllocator *allocator; // interned documents must use it too, as their chunks are freed by whichever owner is last
+} MerkleStore;
+
+/**
+ * @brief Hashes every subtree without a cached hash, then gives the root's hash. Missing hashes are cached in the containers even though the document is const (see note 4).
+ *
+ * @param self
+ * @return uint64_t 0 for an empty document.
+ */
+uint64_t JsonThing_Hash(const JsonThing *self);
+
+/**
+ * @brief Tells whether two documents are equal by their root hashes, hashing them first if needed.
+ *
+ * @param a
+ * @param b
+ * @return int
+ */
+int JsonThing_Same(const JsonThing *a, const JsonThing *b);
+
+/**
+ * @brief Reports the differences between two documents, skipping every subtree whose hash matches. Object members are matched by key and Array items by position.
+ *
+ * @param a The old document.
+ * @param b The new document.
+ * @param on_diff
+ * @param user Passed through to on_diff.
+ * @return size_t How many differences were reported, or (size_t)-1 if memory ran out.
+ */
+size_t JsonThing_Diff(const JsonThing *a, const JsonThing *b, DiffCallback on_diff, void *user);
+
+/**
+ * @brief Creates an empty store of shared subtrees.
+ *
+ * @param allocator Allocator for the store and of every document interned in it (NULL for libc). The caller frees the store with it too.
+ * @return MerkleStore*
+ */
+MerkleStore *MerkleStore_Create(const JsonAllocator *allocator);
+
+/**
+ * @brief Drops the store's references, freeing subtrees no document uses anymore, but not the store itself.
+ *
+ * @param self
+ */
+void MerkleStore_Destroy(MerkleStore *self);
+
+/**
+ * @brief Swaps each subtree of doc that equals one already in the store for the stored one, and adds the rest. A matching subtree is swapped whole without visiting its children. Shared subtrees are unshared again by JsonThing_Edit when a document edits them.
+ *
+ * @param self
+ * @param doc Must use the store's allocator.
+ * @return size_t How many subtrees were swapped for stored ones, or (size_t)-1 if doc uses another allocator or memory ran out.
+ */
+size_t MerkleStore_Intern(MerkleStore *self, JsonThing *doc);
+
+#endif
@@ -7,18 +7,60 @@ typedef struct json_obj
 {
     /* data */
     size_t bucket_count;
+    size_t count;       // bound properties
     void **buckets;
+    size_t refs;        // owners sharing this Object, which is read-only while over 1 (see JsonThing_Clone)
+    uint64_t hash;      // Merkle hash of the subtree, a mutable cache (see json_merkle.h) that is 0 until JsonThing_Hash fills it in and again after any change to the members
+    const JsonAllocator *allocator; // inherited by the properties
 } Object;
 
 /**
- * @brief Creates and initializes a hashtable-based key-value object with load factor 0.5.
+ * @brief Creates and initializes a hashtable-based key-value object with load factor 1/3. The table grows to keep its load at or under 1/2.
  * 
- * @param slots Count of actual items (half the bucket count).
+ * @param slots Expected count of actual items (a third of the bucket count).
+ * @param allocator Allocator for the object and its properties (NULL for libc).
  * @return Object*
  */
-Object *Object_Create(size_t slots);
+Object *Object_Create(size_t slots, const JsonAllocator *allocator);
 void Object_Destroy(Object *self);
-void Object_SetItem(Object *self, const char *key, Property *prop_val);
-const Property *Object_GetItem(Object *self, const char *key);
+
+/**
+ * @brief Copies an Object's table and properties for copy-on-write. Names and strings are duplicated, but nested Arrays and Objects are shared by taking a reference on each.
+ *
+ * @param self
+ * @return Object* NULL if memory ran out.
+ */
+Object *Object_Copy(const Object *self);
+
+/**
+ * @brief Binds a property under its key, growing the table when needed. A property already bound under the same key is destroyed and replaced.
+ *
+ * @param self
+ * @param key Must equal prop_val's name.
+ * @param prop_val
+ * @return int 0 if the table could not grow, in which case prop_val is not bound and stays the caller's.
+ */
+int Object_SetItem(Object *self, const char *key, Property *prop_val);
+const Property *Object_GetItem(const Object *self, const char *key);
+
+/**
+ * @brief Looks up a key given by pointer and length, so a slice of a larger string needs no terminated copy.
+ *
+ * @param self
+ * @param key
+ * @param key_len
+ * @return const Property* NULL if the key is not bound.
+ */
+const Property *Object_GetItemN(const Object *self, const char *key, size_t key_len);
+/**
+ * @brief Unbinds a property without destroying it, shifting later colliding properties back so lookups need no tombstones.
+ *
+ * @param self
+ * @param key
+ * @return Property* The unbound property, which the caller destroys and frees, or NULL if the key is not bound.
+ */
+Property *Object_TakeItem(Object *self, const char *key);
+
+size_t Object_Count(const Object *self);
 
 #endif
\ No newline at end of file
@@ -3,6 +3,11 @@
 
 #include "json_thing.h"
 #include "json_lex.h"
+#include "json_projection.h"
+
+/// Limits:
+
+#define DEFAULT_MAX_DEPTH 4096 // nesting limit, see Parser_SetMaxDepth
 
 /// Enums:
 
@@ -11,10 +16,35 @@ typedef enum json_parser_error {
     EMPTY_TOKENS_ERR,
     UNEXPECTED_TOKEN_ERR, // token is incorrectly placed or typed
     UNKNOWN_TOKEN_ERR,    // token has invalid content
-    UNBALANCED_NEST       // tokens have unbalanced sequence of [], {}
+    UNBALANCED_NEST,      // tokens have unbalanced sequence of [], {}
+    DEPTH_LIMIT_ERR,      // nesting went past the parser's max depth
+    OUT_OF_MEMORY_ERR,    // a node or the parse stack could not be allocated
+    INPUT_ERR             // the input could not be read or decompressed
 } ParserErr;
 
-/// Recursive Parser:
+/// What the innermost open container accepts next.
+typedef enum json_parse_state {
+    FIRST_ITEM,   // after '[': a value or ']'
+    NEXT_ITEM,    // after ',' in an Array: a value
+    FIRST_KEY,    // after '{': a key or '}'
+    NEXT_KEY,     // after ',' in an Object: a key
+    PROP_COLON,   // after a key: ':'
+    PROP_VALUE,   // after ':': a value
+    SEPARATOR     // after a value: ',' or the closer
+} ParseState;
+
+/// Explicit stack entry for an open Array or Object.
+typedef struct json_parse_frame
+{
+    void *chunk;        // Array or Object being filled
+    char *pending_name; // parsed key still waiting for its value
+    DataType type;      // ARR or OBJ
+    ParseState state;
+    size_t proj;         // projection node filtering this container's keys, PROJ_ALL keeps them all
+    size_t pending_proj; // projection node for the pending key's value, PROJ_SKIP to step over it
+} ParseFrame;
+
+/// Iterative Parser:
 
 typedef struct json_parser
 {
@@ -25,13 +55,75 @@ typedef struct json_parser
     TokenVec *tokvec_ref;  // references json tokens
     size_t tokvec_idx;
     size_t tokvec_end;
+    size_t depth;          // current Array / Object nesting (used frames)
+    size_t max_depth;
+    const Projection *projection; // optional: only these paths are built
+    const JsonAllocator *allocator; // inherited by every DOM node
+
+    /* Parse Stack */
+
+    ParseFrame *stack;
+    size_t stack_cap;
+    const JsonAllocator *stack_allocator; // kept apart so a reused Parser keeps its stack while DOM memory is recycled
 
     /* Parsing Temps */
 
     Property *temp_root; // parent prop. of entire JSON!
+
+    JsonStats stats;     // parse timer and node counters (JSON_STATS builds only)
 } Parser;
 
-Parser *Parser_Create(char *src, TokenVec *tokens);
+/**
+ * @brief Creates a Parser over lexed text and tokens. The parse result is built with the given allocator.
+ *
+ * @param src
+ * @param tokens
+ * @param allocator Allocator for the Parser and the resulting JsonThing (NULL for libc). The caller frees the Parser with it too.
+ * @return Parser*
+ */
+Parser *Parser_Create(char *src, TokenVec *tokens, const JsonAllocator *allocator);
+
+/**
+ * @brief Initializes an embedded or reused Parser. The same as Parser_Create without allocating the Parser.
+ *
+ * @param self
+ * @param src
+ * @param tokens
+ * @param allocator
+ */
+void Parser_Init(Parser *self, char *src, TokenVec *tokens, const JsonAllocator *allocator);
+
+/**
+ * @brief Points an initialized Parser at a new document, keeping its allocators, depth limit and parse stack.
+ *
+ * @param self
+ * @param src
+ * @param tokens
+ */
+void Parser_Rebind(Parser *self, char *src, TokenVec *tokens);
+
+/**
+ * @brief Frees the parse stack, but not the Parser itself.
+ *
+ * @param self
+ */
+void Parser_Destroy(Parser *self);
+
+/**
+ * @brief Sets how deep Arrays and Objects may nest before parsing fails with DEPTH_LIMIT_ERR. The parse stack lives on the heap, so deep input never risks a C stack overflow.
+ *
+ * @param self
+ * @param max_depth
+ */
+void Parser_SetMaxDepth(Parser *self, size_t max_depth);
+
+/**
+ * @brief Restricts later parses to the paths of a projection, which is borrowed and kept across Parser_Rebind. Values of other keys are stepped over on the token tape by counting brackets, so inside them only lexing errors and bracket balance are checked.
+ *
+ * @param self
+ * @param projection NULL to build whole documents again.
+ */
+void Parser_SetProjection(Parser *self, const Projection *projection);
 void Parser_Reset(Parser *self);
 int Parser_IsReady(const Parser *self);
 int Parser_AtEnd(const Parser *self);
@@ -47,9 +139,61 @@ int Parser_AtEnd(const Parser *self);
  */
 void *Parser_Parse_Prim(Parser *self, char *optional_name, DataType prim_type, JsonProx relation);
 
+/**
+ * @brief Parses the Array or Object starting at the current token into a detached container. On failure, the partial container is freed and NULL is returned.
+ *
+ * @param self
+ * @return void*
+ */
 void *Parser_Parse_Arr(Parser *self);
 void *Parser_Parse_Obj(Parser *self);
+
+/**
+ * @brief Creates the Array or Object opened by the current token and pushes its frame without parsing its contents, so a caller can drive Parser_Run itself.
+ *
+ * @param self
+ * @param type ARR or OBJ
+ * @return void* The detached container, or NULL on error.
+ */
+void *Parser_Begin_Chunk(Parser *self, DataType type);
+
+/**
+ * @brief Runs the grammar over tokens until the frame at stop_depth closes, the tokens run out or an error happens. Each token is handled by the innermost frame's state, so nesting costs no C recursion. Running out of tokens keeps every frame, so the run resumes where it stopped once more tokens are appended and tokvec_end is raised.
+ *
+ * @param self
+ * @param stop_depth
+ * @return int 1 once the container at stop_depth has closed.
+ */
+int Parser_Run(Parser *self, size_t stop_depth);
+
+/**
+ * @brief Drops frames down to stop_depth after a failure. Their containers are already owned by a parent or the caller, so only unbound key names need freeing here.
+ *
+ * @param self
+ * @param stop_depth
+ */
+void Parser_Unwind(Parser *self, size_t stop_depth);
 int Parser_Get_ErrCode(const Parser *self);
 JsonThing *Parser_Start_Parse(Parser *self);
 
+/**
+ * @brief Checks that text holds exactly one well-formed JSON value without building a token tape or any nodes. Tokens are pulled straight from the lexer and the grammar runs on a fixed bit stack, so nothing is allocated. Errors match what a full parse of the same text reports.
+ *
+ * @param src
+ * @param len
+ * @param err_offset Set to the byte offset of the first bad token (len when valid). May be NULL.
+ * @return int NO_ERR or a ParserErr, with DEPTH_LIMIT_ERR past DEFAULT_MAX_DEPTH.
+ */
+int Parser_Validate(const char *src, size_t len, size_t *err_offset);
+
+/**
+ * @brief Converts a byte offset to a 1-based line and column by counting newlines before it. Meant to be called only once an error is reported.
+ *
+ * @param src
+ * @param offset
+ * @param line
+ * @param column Counted in bytes.
+ */
+void Parser_Locate(const char *src, size_t offset, size_t *line, size_t *column);
+
 #endif
\ No newline at end of file
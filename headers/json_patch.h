@@ -0,0 +1,43 @@
+#ifndef JSON_PATCH_H
+#define JSON_PATCH_H
+
+/**
+ * @file json_patch.h
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares JSON Patch (RFC 6902) and JSON Merge Patch (RFC 7396) applied straight to a parsed document. Each operation finds its target with a JSON Pointer walk and then relinks, unbinds or rebinds nodes in place, so a small patch costs time in proportion to the patch and the paths it names instead of a reparse.
+ * @note 1: Paths are walked with copy-on-write, so patching a JsonThing_Clone copies only the containers along the patched paths and leaves the original as it was.
+ * @note 2: Operations apply in order and a failed one stops the patch, keeping the ones before it. For all-or-nothing updates, patch a clone and keep it only on success.
+ * @note 3: Array positions cost O(index), as Arrays are linked lists.
+ * @date 2026-10-19
+ */
+
+#include "json_thing.h"
+
+typedef enum json_patch_error {
+    PATCH_OK,
+    PATCH_BAD_OP,       // not an Array of operation Objects, or an operation is missing a member or has a bad pointer
+    PATCH_NO_PATH,      // a pointer names a missing value, or an index past the end
+    PATCH_TEST_FAILED,  // a "test" operation found a different value
+    PATCH_NO_MEMORY
+} PatchErr;
+
+/**
+ * @brief Applies a JSON Patch document (an Array of "add", "remove", "replace", "move", "copy" and "test" operations) to doc.
+ *
+ * @param doc
+ * @param patch Only read. Values are copied into doc with doc's allocator.
+ * @param failed_op Receives the index of the operation that failed. May be NULL.
+ * @return int A PatchErr.
+ */
+int JsonPatch_Apply(JsonThing *doc, const JsonThing *patch, size_t *failed_op);
+
+/**
+ * @brief Applies a JSON Merge Patch: Object members are merged recursively, a null member removes its key, and any other value replaces its target whole.
+ *
+ * @param doc
+ * @param merge_patch Only read. Values are copied into doc with doc's allocator.
+ * @return int PATCH_OK or PATCH_NO_MEMORY.
+ */
+int JsonPatch_Merge(JsonThing *doc, const JsonThing *merge_patch);
+
+#endif
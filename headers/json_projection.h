@@ -0,0 +1,72 @@
+#ifndef JSON_PROJECTION_H
+#define JSON_PROJECTION_H
+
+/**
+ * @file json_projection.h
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares field projections: a trie of dotted key paths handed to the Parser so it only builds nodes along those paths. The value of any other key is stepped over on the token tape, so its key text and nodes are never allocated.
+ * @note 1: Arrays along a path are transparent, so each of their elements is projected by the same trie node. For example, "tags.k" keeps every element of "tags" but only the "k" key of each.
+ * @note 2: Keys containing a '.' cannot be named in a path.
+ * @date 2026-10-19
+ */
+
+#include "json_token.h"
+
+#define PROJ_ROOT 0            // trie node for the document's root value
+#define PROJ_ALL ((size_t)-1)  // every key below is kept
+#define PROJ_SKIP ((size_t)-2) // the key is not projected, so its value is skipped
+
+/// Trie node for one path segment. Children are linked as siblings so the trie is one flat array.
+typedef struct json_proj_node
+{
+    char *key;
+    size_t key_len;
+    size_t first_child;  // PROJ_ALL when there is none
+    size_t next_sibling; // PROJ_ALL when there is none
+    int is_leaf;         // a whole path ends here, so the value is kept whole
+} ProjNode;
+
+typedef struct json_projection
+{
+    ProjNode *nodes;     // nodes[PROJ_ROOT] is the root
+    size_t count;
+    size_t capacity;
+    const JsonAllocator *allocator;
+} Projection;
+
+/**
+ * @brief Creates an empty projection. Until paths are added it keeps nothing, so a root Object parses to an empty one.
+ *
+ * @param allocator Allocator for the projection and its keys (NULL for libc). The caller frees the projection with it too.
+ * @return Projection*
+ */
+Projection *Projection_Create(const JsonAllocator *allocator);
+
+/**
+ * @brief Frees the trie, but not the projection itself.
+ *
+ * @param self
+ */
+void Projection_Destroy(Projection *self);
+
+/**
+ * @brief Adds a dotted key path such as "limits.cpu". A path that is a prefix of another keeps its whole value, which covers the longer one.
+ *
+ * @param self
+ * @param path
+ * @return int 0 if the path has an empty segment or memory ran out.
+ */
+int Projection_Add(Projection *self, const char *path);
+
+/**
+ * @brief Looks up an Object key below a trie node.
+ *
+ * @param self
+ * @param node
+ * @param key A STRBODY token. Escaped keys are decoded as they are compared, so "\u0069d" still matches "id" without allocating.
+ * @param src
+ * @return size_t The child node, PROJ_ALL if the path ends at the key, or PROJ_SKIP if no path goes through it.
+ */
+size_t Projection_Step(const Projection *self, size_t node, const Token *key, const char *src);
+
+#endif
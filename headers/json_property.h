@@ -9,21 +9,30 @@ typedef struct json_property
     union
     {
         /* data */
-        int i;
+        int i;      // also holds BOOL values as 0 or 1
         float f;
         char *str;
         void *chunk;  // non-primitive (Array or Object)
     } data;
 } Property;
 
-Property *Property_Int(char *name, int value);
-Property *Property_Float(char *name, float value);
-Property *Property_String(char *name, char *value);
-Property *Property_Chunk(char *name, void *value, DataType type);
-void Property_Destroy(Property *self);
+Property *Property_Int(char *name, int value, const JsonAllocator *allocator);
+Property *Property_Float(char *name, float value, const JsonAllocator *allocator);
+Property *Property_String(char *name, char *value, const JsonAllocator *allocator);
+Property *Property_Bool(char *name, int value, const JsonAllocator *allocator);
+Property *Property_Chunk(char *name, void *value, DataType type, const JsonAllocator *allocator);
+
+/**
+ * @brief Frees the name, string or chunk of a Property, but not the Property itself.
+ *
+ * @param self
+ * @param allocator The allocator which made the name and value.
+ */
+void Property_Destroy(Property *self, const JsonAllocator *allocator);
 int Property_AsInt(const Property *self);
 float Property_AsFloat(const Property *self);
 const char *Property_AsStr(const Property *self);
+int Property_AsBool(const Property *self);
 
 /**
  * @brief Returns a void pointer and sets an external type code to determine whether the voidptr chunk is an array or object. 
@@ -34,4 +43,31 @@ const char *Property_AsStr(const Property *self);
  */
 const void *Property_AsChunk(const Property *self, DataType *type_flag);
 
+/**
+ * @brief Takes another reference on a shared Array or Object.
+ *
+ * @param chunk
+ * @param type ARR or OBJ.
+ */
+void Chunk_Retain(void *chunk, DataType type);
+
+/**
+ * @brief Drops a reference to an Array or Object, destroying and freeing it along with the last one.
+ *
+ * @param chunk
+ * @param type ARR or OBJ.
+ * @param allocator The allocator which made the chunk.
+ */
+void Chunk_Release(void *chunk, DataType type, const JsonAllocator *allocator);
+
+/**
+ * @brief Swaps a shared Array or Object in its parent's slot for a private copy, so it may be changed. A chunk with one owner is left as is. Either way its cached hash is cleared, as the caller is about to change it.
+ *
+ * @param slot The data.chunk field holding the chunk.
+ * @param type ARR or OBJ.
+ * @param allocator The allocator which made the chunk.
+ * @return int 0 if memory ran out.
+ */
+int Chunk_Unshare(void **slot, DataType type, const JsonAllocator *allocator);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,105 @@
+#ifndef JSON_PUSH_H
+#define JSON_PUSH_H
+
+/**
+ * @file json_push.h
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares a resumable push parser for input that arrives in pieces, e.g. from a non-blocking socket. Each feed lexes the complete tokens it can and advances the parse stack, while a token cut off at the end of a slice (a partial string, number or literal) is kept as raw bytes until the next feed completes it.
+ * @date 2026-10-19
+ */
+
+#include "json_input.h"
+
+#define PUSH_BUFFER_SIZE 4096
+
+typedef enum json_push_status {
+    PUSH_NEED_MORE, // the document is not complete yet
+    PUSH_DONE,      // a whole document was parsed, see PushParser_Take
+    PUSH_ERROR      // see PushParser_Get_ErrCode
+} PushStatus;
+
+typedef struct json_push_parser
+{
+    /* Pending input: only bytes of unfinished tokens are kept between feeds */
+
+    char *buf;
+    size_t buf_len;
+    size_t buf_cap;
+    size_t lex_pos;      // first byte not lexed yet
+    size_t str_resume;   // where to continue looking for the closing quote of a cut off string
+
+    /* Suspended state */
+
+    TokenVec tokens;     // lexed tokens the parser has not consumed yet
+    Lexer lexer;
+    Parser parser;       // its frame stack holds the open containers between feeds
+    Property *root;      // root container wrapper while it is still open
+    DataType root_type;
+
+    /* Result */
+
+    JsonThing *doc;
+    PushStatus status;
+    ParserErr err_code;
+    const JsonAllocator *allocator;
+} PushParser;
+
+/**
+ * @brief Creates a push parser waiting for the first bytes of a document.
+ *
+ * @param allocator Allocator for the parser, its buffers and the resulting JsonThing (NULL for libc). The caller frees the parser with it too.
+ * @return PushParser*
+ */
+PushParser *PushParser_Create(const JsonAllocator *allocator);
+
+/**
+ * @brief Frees the pending input, any partial document and an untaken result, but not the parser itself.
+ *
+ * @param self
+ */
+void PushParser_Destroy(PushParser *self);
+
+/**
+ * @brief Drops all state so the parser can take a new document, keeping its buffers.
+ *
+ * @param self
+ */
+void PushParser_Reset(PushParser *self);
+
+/**
+ * @brief Feeds the next slice of input, which is copied and may be reused by the caller right away. Only whitespace may follow a finished document.
+ *
+ * @param self
+ * @param bytes
+ * @param len
+ * @return PushStatus
+ */
+PushStatus PushParser_Feed(PushParser *self, const char *bytes, size_t len);
+
+/**
+ * @brief Parses a whole possibly compressed input, reading one block at a time straight into the pending buffer so decompression and parsing overlap. Includes the final PushParser_Finish.
+ *
+ * @param self
+ * @param input
+ * @return PushStatus PUSH_DONE or PUSH_ERROR (INPUT_ERR if the input failed).
+ */
+PushStatus PushParser_Parse_Input(PushParser *self, JsonInput *input);
+
+/**
+ * @brief Marks the end of input, so a number or literal cut off at the end counts as complete. A document left open fails with UNBALANCED_NEST.
+ *
+ * @param self
+ * @return PushStatus PUSH_DONE or PUSH_ERROR.
+ */
+PushStatus PushParser_Finish(PushParser *self);
+
+/**
+ * @brief Hands the finished document to the caller, who destroys and frees it with the parser's allocator.
+ *
+ * @param self
+ * @return JsonThing* NULL unless the status is PUSH_DONE.
+ */
+JsonThing *PushParser_Take(PushParser *self);
+int PushParser_Get_ErrCode(const PushParser *self);
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef JSON_RELOAD_H
+#define JSON_RELOAD_H
+
+/**
+ * @file json_reload.h
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares hot reloading of a shared document, RCU style. A background thread parses the new version and publishes it with one atomic pointer swap, so readers never take a lock: each read is a single pointer load. A replaced version is freed only once every registered reader has passed a quiescent point since the swap (quiescent-state-based reclamation).
+ * @note 1: A reader thread registers a ReloadReader once, then calls JsonReload_Quiesce between units of work (e.g. requests). A document pointer from JsonReload_Get is valid until that reader's next quiescent point, so it must not be kept across one.
+ * @note 2: A reader that goes idle for long should call JsonReload_Offline, or it holds back every free. Its next JsonReload_Quiesce brings it back online.
+ * @note 3: Published documents are read from several threads, so they are sealed like frozen documents before readers can see them, and follow the same rules (see json_frozen.h): const accessors only, no clones or edits. Replaced versions are freed on the publishing thread, with the reload's allocator.
+ * @date 2026-10-19
+ */
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "json_parser.h"
+
+/// A reader thread's record of the last epoch it saw at a quiescent point.
+typedef struct json_reload_reader
+{
+    atomic_uint_fast64_t epoch; // 0 while offline
+    struct json_reload_reader *next;
+} ReloadReader;
+
+/// A replaced document waiting for the readers to pass its epoch.
+typedef struct json_reload_retired
+{
+    JsonThing *doc;
+    uint64_t epoch;
+    struct json_reload_retired *next;
+} ReloadRetired;
+
+typedef struct json_reload
+{
+    _Atomic(JsonThing*) current;
+    atomic_uint_fast64_t epoch; // bumped after each swap, starting at 1
+    pthread_mutex_t lock;       // taken by writers, registration and the loader, never by JsonReload_Get
+    ReloadReader *readers;
+    ReloadRetired *retired;
+    pthread_t loader;
+    int loading;
+    int load_err;               // ParserErr of the last background load
+    char *load_path;
+    const JsonAllocator *allocator; // for the loader's parses, and frees every published document
+} JsonReload;
+
+/**
+ * @brief Creates a reload point serving initial until the first reload.
+ *
+ * @param initial Owned by the reload point, which seals it (see JsonThing_Seal). May be NULL, in which case JsonReload_Get gives NULL until a document is published.
+ * @param allocator Must be safe to use from several threads (NULL for libc). The caller frees the reload point with it too.
+ * @return JsonReload* NULL if memory ran out, in which case initial stays the caller's.
+ */
+JsonReload *JsonReload_Create(JsonThing *initial, const JsonAllocator *allocator);
+
+/**
+ * @brief Waits for a running load, then frees the current and every replaced document. No reader may still be using them.
+ *
+ * @param self
+ */
+void JsonReload_Destroy(JsonReload *self);
+
+/**
+ * @brief Registers a reader thread's record, online as of the current epoch.
+ *
+ * @param self
+ * @param reader Owned by the caller, and must stay valid until JsonReload_RemoveReader.
+ */
+void JsonReload_AddReader(JsonReload *self, ReloadReader *reader);
+void JsonReload_RemoveReader(JsonReload *self, ReloadReader *reader);
+
+/**
+ * @brief Gets the current document. Inlined, as it is the readers' hot path: one acquire load, a plain load on x86 and ARMv8.
+ *
+ * @param self
+ * @return const JsonThing*
+ */
+static inline const JsonThing *JsonReload_Get(JsonReload *self) { return atomic_load_explicit(&self->current, memory_order_acquire); }
+
+/**
+ * @brief Announces that the reader holds no document pointers, letting versions replaced before now be freed.
+ *
+ * @param self
+ * @param reader
+ */
+void JsonReload_Quiesce(JsonReload *self, ReloadReader *reader);
+
+/**
+ * @brief Marks an idle reader as holding nothing, so it does not hold back frees until its next JsonReload_Quiesce.
+ *
+ * @param reader
+ */
+void JsonReload_Offline(ReloadReader *reader);
+
+/**
+ * @brief Seals a new document (see JsonThing_Seal), swaps it in and retires the old one, then frees what the readers have let go of.
+ *
+ * @param self
+ * @param doc Owned by the reload point on success. Must use the reload point's allocator.
+ * @return int 0 if memory ran out, in which case doc was not published and stays the caller's.
+ */
+int JsonReload_Publish(JsonReload *self, JsonThing *doc);
+
+/**
+ * @brief Frees every replaced document that all online readers have passed.
+ *
+ * @param self
+ * @return size_t How many replaced documents are still waiting.
+ */
+size_t JsonReload_Reclaim(JsonReload *self);
+
+/**
+ * @brief Starts parsing a file on a background thread, which publishes it if the parse succeeds.
+ *
+ * @param self
+ * @param path Copied, so it need not outlive the call.
+ * @return int 0 if a load is already running or the thread could not start.
+ */
+int JsonReload_Load(JsonReload *self, const char *path);
+
+/**
+ * @brief Waits for the background load to finish.
+ *
+ * @param self
+ * @return int A ParserErr: NO_ERR if the new version was published, INPUT_ERR if the file could not be read.
+ */
+int JsonReload_Wait(JsonReload *self);
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef JSON_SCHEMA_H
+#define JSON_SCHEMA_H
+
+/**
+ * @file json_schema.h
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares a validator for a subset of JSON Schema: type, enum, required, properties, items, minimum / maximum, minLength / maxLength and minItems / maxItems. A schema is compiled once into a table of nodes whose property names are hashed up front. Validating then pulls tokens straight from the lexer like Parser_Validate, checking grammar and schema in the same pass, so no DOM or token tape is built and nothing is allocated, except a copy of any number literal of MAX_NUM_TXT_LEN chars or more.
+ * @note 1: Other validation keywords (pattern, $ref, anyOf, additionalProperties...) are rejected when compiling instead of being ignored, so a schema never passes documents it was meant to reject. Annotations such as title, description and $schema are skipped.
+ * @note 2: Enum values must be scalars, and items must be a single schema, not a list of them.
+ * @note 3: Validation stops at the first error. Members the schema does not describe are only checked for grammar.
+ * @date 2026-10-19
+ */
+
+#include "json_parser.h"
+
+/// Limits:
+
+#define SCHEMA_NONE ((size_t)-1)
+#define SCHEMA_MAX_DEPTH 64     // nesting of properties and items inside a schema
+#define SCHEMA_MAX_REQUIRED 64  // required keys of one Object, which are tracked in one bit mask
+#define SCHEMA_MAX_TEXT 256     // length of a property name or enum string
+
+/// Type bits of a schema node:
+
+#define SCHEMA_NULL 0x1
+#define SCHEMA_BOOLEAN 0x2
+#define SCHEMA_INTEGER 0x4    // numbers without a fractional part, so 2.0 counts
+#define SCHEMA_NUMBER 0x8     // any number, integers included
+#define SCHEMA_STRING 0x10
+#define SCHEMA_ARRAY 0x20
+#define SCHEMA_OBJECT 0x40
+#define SCHEMA_ANY 0x7f
+
+/// Check bits of a schema node:
+
+#define SCHEMA_HAS_MINIMUM 0x1
+#define SCHEMA_HAS_MAXIMUM 0x2
+#define SCHEMA_HAS_MIN_LENGTH 0x4
+#define SCHEMA_HAS_MAX_LENGTH 0x8
+#define SCHEMA_HAS_MIN_ITEMS 0x10
+#define SCHEMA_HAS_MAX_ITEMS 0x20
+#define SCHEMA_HAS_ENUM 0x40
+
+typedef enum json_schema_error {
+    SCHEMA_OK,
+    SCHEMA_SYNTAX_ERR,      // the document is not well-formed JSON
+    SCHEMA_TYPE_ERR,
+    SCHEMA_ENUM_ERR,
+    SCHEMA_MINIMUM_ERR,
+    SCHEMA_MAXIMUM_ERR,
+    SCHEMA_MIN_LENGTH_ERR,
+    SCHEMA_MAX_LENGTH_ERR,
+    SCHEMA_MIN_ITEMS_ERR,
+    SCHEMA_MAX_ITEMS_ERR,
+    SCHEMA_REQUIRED_ERR,
+    SCHEMA_NO_MEMORY_ERR    // a number literal past MAX_NUM_TXT_LEN chars could not be copied
+} SchemaErr;
+
+/// One compiled (sub)schema. Checks only apply to values of their kind, e.g. maxLength passes numbers.
+typedef struct json_schema_node
+{
+    unsigned int types;     // SCHEMA_* type bits the value may have
+    unsigned int checks;    // SCHEMA_HAS_* bits of the bounds below in use
+    double minimum;
+    double maximum;
+    size_t min_length;      // in code points
+    size_t max_length;
+    size_t min_items;
+    size_t max_items;
+    size_t items;           // node every Array item must match, SCHEMA_NONE for any
+    size_t first_prop;      // this Object's open addressing table in props
+    size_t prop_slots;      // a power of 2, 0 when no member is described
+    size_t required_count;
+    size_t first_enum;
+    size_t enum_count;
+} SchemaNode;
+
+/// Slot of a node's property table, for a member that has a schema, is required, or both.
+typedef struct json_schema_prop
+{
+    uint64_t hash;
+    char *key;              // NULL when the slot is empty
+    size_t key_len;
+    size_t node;            // SCHEMA_NONE for any value
+    uint64_t required_bit;  // 0 when the member is optional
+} SchemaProp;
+
+/// Scalar of an enum.
+typedef struct json_schema_const
+{
+    unsigned int type;      // SCHEMA_NULL, SCHEMA_BOOLEAN, SCHEMA_NUMBER or SCHEMA_STRING
+    double number;          // also 0 / 1 for booleans
+    char *text;             // decoded string
+    size_t text_len;
+    uint64_t hash;
+} SchemaConst;
+
+typedef struct json_schema
+{
+    SchemaNode *nodes;      // nodes[0] is the root
+    size_t node_count;
+    size_t node_capacity;
+    SchemaProp *props;
+    size_t prop_count;
+    size_t prop_capacity;
+    SchemaConst *consts;
+    size_t const_count;
+    size_t const_capacity;
+    const JsonAllocator *allocator;
+} JsonSchema;
+
+typedef struct json_schema_result
+{
+    SchemaErr err;
+    ParserErr syntax_err;   // the grammar error for SCHEMA_SYNTAX_ERR, else NO_ERR
+    size_t offset;          // byte offset of the failing value, or of the '}' missing a required member
+    const char *missing;    // SCHEMA_REQUIRED_ERR: the missing member's name, owned by the schema
+} SchemaResult;
+
+/**
+ * @brief Compiles a schema from its JSON text.
+ *
+ * @param src
+ * @param len
+ * @param allocator Allocator for the schema and its tables (NULL for libc). The caller frees the schema with it too.
+ * @param err_offset Set to the byte offset of the first malformed or unsupported part (len when compiled). May be NULL.
+ * @return JsonSchema* NULL if the text is malformed, uses an unsupported keyword, nests past SCHEMA_MAX_DEPTH or memory ran out.
+ */
+JsonSchema *JsonSchema_Compile(const char *src, size_t len, const JsonAllocator *allocator, size_t *err_offset);
+
+/**
+ * @brief Frees the schema's tables, but not the schema itself.
+ *
+ * @param self
+ */
+void JsonSchema_Destroy(JsonSchema *self);
+
+/**
+ * @brief Checks that text is one well-formed JSON value matching the schema, in one pass over its tokens. Only members and items the schema describes are looked at beyond grammar.
+ *
+ * @param self
+ * @param src
+ * @param len
+ * @param result Filled with the first error and where it is. May be NULL.
+ * @return int SCHEMA_OK or a SchemaErr.
+ */
+int JsonSchema_Validate(const JsonSchema *self, const char *src, size_t len, SchemaResult *result);
+
+#endif
@@ -0,0 +1,930 @@
+#ifndef JSON_STATIC_HPP
+#define JSON_STATIC_HPP
+
+/**
+ * @file json_static.hpp
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares a C++20 constexpr parser that turns an embedded JSON literal into a read-only StaticDocument at compile time, so embedded configs cost no parse time and no heap at startup. It accepts the same tokens as json_lex.c and runs the same state machine as Parser_Validate, so it reports the same error codes. Lookups with constant keys fold to constants.
+ * @note 1: Nodes sit in one array in document order. Each node records the index past its subtree, so the parser needs no links and lookups jump over nested values.
+ * @note 2: A malformed literal fails to compile, and the error names the ParserErr code and byte offset.
+ * @note 3: GCC stops constant evaluation of a loop after 262144 iterations, so literals larger than that need -fconstexpr-loop-limit.
+ * @date 2026-10-19
+ */
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include "json.hpp"
+
+namespace myjson
+{
+    /// A string literal passed as a template argument, e.g. parse_static<R"({"port": 80})">().
+    template <std::size_t N>
+    struct StaticText
+    {
+        char chars[N] {};
+
+        constexpr StaticText(const char (&text)[N]) noexcept
+        {
+            for (std::size_t i = 0; i < N; i++)
+                chars[i] = text[i];
+        }
+
+        constexpr std::string_view view() const noexcept { return std::string_view {chars, N - 1}; }
+    };
+
+    /// One parsed value. Member names and string values are decoded into the document's char pool, each followed by a '\0'.
+    struct StaticNode
+    {
+        DataType type = UNSUPPORTED;
+        std::uint32_t key = 0;      // member name in the char pool
+        std::uint32_t key_len = 0;  // 0 for Array items and the root
+        std::uint32_t end = 0;      // index past this node's subtree
+        std::uint32_t count = 0;    // elements of an Array or Object
+        std::uint32_t text = 0;     // STR value in the char pool
+        std::uint32_t text_len = 0;
+        int i = 0;                  // INT, also BOOL as 0 or 1
+        float f = 0.0f;             // FLT
+    };
+
+    /// Read-only view of one StaticNode. Usable in constant expressions, where reads and lookups fold away.
+    class StaticValue
+    {
+    public:
+        class Iterator;
+
+        constexpr StaticValue() noexcept = default;
+        constexpr StaticValue(const StaticNode *nodes, const char *chars, std::uint32_t index) noexcept : nodes_ {nodes}, chars_ {chars}, index_ {index} {}
+
+        constexpr DataType type() const noexcept { return nodes_ != nullptr ? node().type : UNSUPPORTED; }
+
+        /// False for a missing member, an out of range item or a lookup on a non-container.
+        constexpr explicit operator bool() const noexcept { return nodes_ != nullptr; }
+
+        /// The member name, which is empty for Array items and the root.
+        constexpr std::string_view key() const noexcept { return pool_view(node().key, node().key_len); }
+
+        template <typename T>
+        constexpr bool is() const noexcept { return nodes_ != nullptr && node().type == detail::data_type_of<T>(); }
+
+        /**
+         * @brief Reads the value as T without checking its type.
+         *
+         * @tparam T bool, int, float, double, std::string_view, const char* or std::nullptr_t. Containers are read by indexing or iterating.
+         * @return T
+         */
+        template <typename T>
+        constexpr T as() const noexcept
+        {
+            constexpr DataType expected = detail::data_type_of<T>();
+            static_assert(expected != OBJ && expected != ARR, "myjson: index or iterate a StaticValue to read its container");
+
+            if constexpr (expected == BOOL)
+                return node().i != 0;
+            else if constexpr (expected == INT)
+                return node().i;
+            else if constexpr (expected == FLT)
+                return static_cast<T>(node().f);
+            else if constexpr (expected == STR)
+            {
+                if constexpr (std::is_same_v<T, const char*>)
+                    return chars_ + node().text;
+                else
+                    return pool_view(node().text, node().text_len);
+            }
+            else
+                return nullptr;
+        }
+
+        template <typename T>
+        constexpr std::optional<T> get() const noexcept
+        {
+            if (!is<T>())
+                return std::nullopt;
+
+            return as<T>();
+        }
+
+        /// Element count of an Array or Object, 0 for anything else.
+        constexpr std::size_t size() const noexcept { return (type() == ARR || type() == OBJ) ? node().count : 0; }
+
+        /**
+         * @brief Looks up an Object member, scanning the members in O(count). Like the C Object, a later duplicate key shadows an earlier one.
+         *
+         * @param key
+         * @return StaticValue An invalid value if the key is not bound or this is not an Object.
+         */
+        constexpr StaticValue operator[](std::string_view key) const noexcept;
+
+        /// Array item in O(index), jumping over nested values. Invalid if out of range or not an Array.
+        constexpr StaticValue operator[](std::size_t index) const noexcept;
+
+        /// Visits the elements of an Array or the members of an Object (see key()), in document order.
+        constexpr Iterator begin() const noexcept;
+        constexpr Iterator end() const noexcept;
+
+    private:
+        constexpr const StaticNode &node() const noexcept { return nodes_[index_]; }
+
+        constexpr std::string_view pool_view(std::uint32_t offset, std::uint32_t len) const noexcept
+        {
+            return (len > 0) ? std::string_view {chars_ + offset, len} : std::string_view {};
+        }
+
+        const StaticNode *nodes_ = nullptr;
+        const char *chars_ = nullptr;
+        std::uint32_t index_ = 0;
+    };
+
+    class StaticValue::Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = StaticValue;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = StaticValue;
+
+        constexpr Iterator() noexcept = default;
+        constexpr Iterator(const StaticNode *nodes, const char *chars, std::uint32_t index) noexcept : nodes_ {nodes}, chars_ {chars}, index_ {index} {}
+
+        constexpr StaticValue operator*() const noexcept { return StaticValue {nodes_, chars_, index_}; }
+
+        constexpr Iterator &operator++() noexcept
+        {
+            index_ = nodes_[index_].end;
+            return *this;
+        }
+
+        constexpr Iterator operator++(int) noexcept
+        {
+            Iterator old = *this;
+            index_ = nodes_[index_].end;
+            return old;
+        }
+
+        constexpr bool operator==(const Iterator &other) const noexcept { return index_ == other.index_; }
+        constexpr bool operator!=(const Iterator &other) const noexcept { return index_ != other.index_; }
+
+    private:
+        const StaticNode *nodes_ = nullptr;
+        const char *chars_ = nullptr;
+        std::uint32_t index_ = 0;
+    };
+
+    constexpr StaticValue::Iterator StaticValue::begin() const noexcept
+    {
+        // elements start right after their container, and a non-container has none
+        return (size() > 0) ? Iterator {nodes_, chars_, index_ + 1} : end();
+    }
+
+    constexpr StaticValue::Iterator StaticValue::end() const noexcept
+    {
+        return (nodes_ != nullptr) ? Iterator {nodes_, chars_, node().end} : Iterator {};
+    }
+
+    constexpr StaticValue StaticValue::operator[](std::string_view key) const noexcept
+    {
+        StaticValue result;
+
+        if (type() != OBJ)
+            return result;
+
+        for (StaticValue member : *this)
+        {
+            if (member.key() == key)
+                result = member;
+        }
+
+        return result;
+    }
+
+    constexpr StaticValue StaticValue::operator[](std::size_t index) const noexcept
+    {
+        if (type() != ARR || index >= size())
+            return StaticValue {};
+
+        Iterator item = begin();
+
+        for (; index > 0; --index)
+            ++item;
+
+        return *item;
+    }
+
+    /// A document parsed at compile time. Declare it static constexpr so it lives in read-only data.
+    template <std::size_t NodeCount, std::size_t CharCount>
+    struct StaticDocument
+    {
+        std::array<StaticNode, NodeCount> nodes {};
+        std::array<char, CharCount> chars {};
+
+        constexpr StaticValue root() const noexcept { return StaticValue {nodes.data(), chars.data(), 0}; }
+        constexpr StaticValue operator[](std::string_view key) const noexcept { return root()[key]; }
+        constexpr StaticValue operator[](std::size_t index) const noexcept { return root()[index]; }
+    };
+
+    namespace detail
+    {
+        struct StaticResult
+        {
+            ParserErr err;
+            std::size_t offset;     // of the bad token, or the text length at an early end
+            std::size_t node_count;
+            std::size_t char_count;
+        };
+
+        /// Instantiated only for a malformed literal, so the compiler error shows Err (a ParserErr) and Offset (in bytes).
+        template <ParserErr Err, std::size_t Offset>
+        struct malformed_static_json
+        {
+            static_assert(Err == NO_ERR, "myjson: malformed JSON literal, see Err (a ParserErr code) and Offset (a byte offset) in this instantiation");
+        };
+
+        constexpr bool static_is_wspace(char c) noexcept { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+        constexpr bool static_is_digit(char c) noexcept { return c >= '0' && c <= '9'; }
+
+        constexpr long static_hex_value(char c) noexcept
+        {
+            if (c >= '0' && c <= '9')
+                return c - '0';
+            else if (c >= 'a' && c <= 'f')
+                return c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                return c - 'A' + 10;
+
+            return -1;
+        }
+
+        /**
+         * @brief Converts INT_LTRL text like atoi does: out of range values are clamped to 64 bits, then truncated to int.
+         */
+        constexpr int static_to_int(std::string_view txt) noexcept
+        {
+            bool negative = (txt[0] == '-');
+            std::uint64_t magnitude = 0;
+            constexpr std::uint64_t limit = static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max());
+
+            for (std::size_t i = negative ? 1 : 0; i < txt.size(); i++)
+            {
+                magnitude = magnitude * 10 + static_cast<std::uint64_t>(txt[i] - '0');
+
+                if (magnitude > limit)
+                {
+                    magnitude = limit + (negative ? 1 : 0);
+                    break;
+                }
+            }
+
+            std::uint64_t bits = negative ? (~magnitude + 1) : magnitude;
+
+            return static_cast<int>(static_cast<std::uint32_t>(bits));
+        }
+
+        /**
+         * @brief Converts FLT_LTRL text with up to 19 significant digits scaled by exact powers of ten, which matches atof to within one float ulp.
+         */
+        constexpr float static_to_float(std::string_view txt) noexcept
+        {
+            constexpr double exact_pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+            bool negative = (txt[0] == '-');
+            std::size_t pos = negative ? 1 : 0;
+            std::uint64_t mantissa = 0;
+            int sig_digits = 0;
+            long exp10 = 0;
+
+            for (; pos < txt.size() && static_is_digit(txt[pos]); pos++)
+            {
+                if (sig_digits < 19)
+                {
+                    mantissa = mantissa * 10 + static_cast<std::uint64_t>(txt[pos] - '0');
+                    sig_digits += (mantissa != 0);
+                }
+                else
+                    exp10++;
+            }
+
+            if (pos < txt.size() && txt[pos] == '.')
+            {
+                for (pos++; pos < txt.size() && static_is_digit(txt[pos]); pos++)
+                {
+                    if (sig_digits < 19)
+                    {
+                        mantissa = mantissa * 10 + static_cast<std::uint64_t>(txt[pos] - '0');
+                        sig_digits += (mantissa != 0);
+                        exp10--;
+                    }
+                }
+            }
+
+            if (pos < txt.size() && (txt[pos] == 'e' || txt[pos] == 'E'))
+            {
+                bool exp_negative = (txt[++pos] == '-');
+                long exp_value = 0;
+
+                if (txt[pos] == '+' || txt[pos] == '-')
+                    pos++;
+
+                for (; pos < txt.size(); pos++)
+                    exp_value = (exp_value < 100000) ? exp_value * 10 + (txt[pos] - '0') : exp_value;
+
+                exp10 += exp_negative ? -exp_value : exp_value;
+            }
+
+            float result = 0.0f;
+
+            // out of float range values are settled before scaling, as constant evaluation rejects overflow
+            if (mantissa == 0 || exp10 + sig_digits < -46)
+                result = 0.0f;
+            else if (exp10 + sig_digits > 40)
+                result = std::numeric_limits<float>::infinity();
+            else
+            {
+                double value = static_cast<double>(mantissa);
+
+                for (; exp10 < -22; exp10 += 22)
+                    value /= exact_pow10[22];
+
+                for (; exp10 > 22; exp10 -= 22)
+                    value *= exact_pow10[22];
+
+                value = (exp10 < 0) ? value / exact_pow10[-exp10] : value * exact_pow10[exp10];
+                result = (value > std::numeric_limits<float>::max()) ? std::numeric_limits<float>::infinity() : static_cast<float>(value);
+            }
+
+            return negative ? -result : result;
+        }
+
+        /**
+         * @brief Runs twice per literal: first without output to size the node array and char pool, then filling them.
+         */
+        class StaticParser
+        {
+        public:
+            constexpr StaticParser(std::string_view text, StaticNode *nodes, char *chars) noexcept : text_ {text}, nodes_ {nodes}, chars_ {chars} {}
+
+            constexpr StaticResult run() noexcept
+            {
+                // each open container is stored as its node index times 2, plus 1 for an Object
+                std::array<std::size_t, DEFAULT_MAX_DEPTH> open {};
+                std::size_t depth = 0;
+                bool in_obj = false;
+                ParseState state = NEXT_ITEM; // the root takes exactly one value, like an Array after ','
+                std::uint32_t key = 0;
+                std::uint32_t key_len = 0;
+
+                while (true)
+                {
+                    TokenType tok_type = lex_next();
+
+                    if (tok_type == FILE_END)
+                    {
+                        if (depth == 0 && state == SEPARATOR)
+                            return StaticResult {NO_ERR, text_.size(), node_count_, char_count_};
+
+                        return fail((depth == 0) ? EMPTY_TOKENS_ERR : UNBALANCED_NEST, text_.size());
+                    }
+
+                    switch (state)
+                    {
+                    case FIRST_ITEM:
+                    case NEXT_ITEM:
+                    case PROP_VALUE:
+                        if (tok_type == RBRACKET && state == FIRST_ITEM)
+                            break;
+                        else if (tok_type == UNKNOWN)
+                            return fail(UNKNOWN_TOKEN_ERR, tok_begin_);
+                        else if (tok_type != STRBODY && !(tok_type >= INT_LTRL && tok_type <= FALSE_LTRL) && tok_type != LBRACKET && tok_type != LCURLY)
+                            return fail(UNEXPECTED_TOKEN_ERR, tok_begin_);
+
+                        if (depth > 0 && nodes_ != nullptr)
+                            nodes_[open[depth - 1] >> 1].count++;
+
+                        add_node(tok_type, (state == PROP_VALUE) ? key : 0, (state == PROP_VALUE) ? key_len : 0);
+
+                        if (tok_type == LBRACKET || tok_type == LCURLY)
+                        {
+                            if (depth >= DEFAULT_MAX_DEPTH)
+                                return fail(DEPTH_LIMIT_ERR, tok_begin_);
+
+                            in_obj = (tok_type == LCURLY);
+                            open[depth++] = ((node_count_ - 1) << 1) | (in_obj ? 1 : 0);
+                            state = in_obj ? FIRST_KEY : FIRST_ITEM;
+                        }
+                        else
+                            state = SEPARATOR;
+
+                        continue;
+                    case FIRST_KEY:
+                    case NEXT_KEY:
+                        if (tok_type == RCURLY && state == FIRST_KEY)
+                            break;
+                        else if (tok_type != STRBODY)
+                            return fail((tok_type == UNKNOWN) ? UNKNOWN_TOKEN_ERR : UNEXPECTED_TOKEN_ERR, tok_begin_);
+
+                        key = static_cast<std::uint32_t>(char_count_);
+                        key_len = add_text();
+                        state = PROP_COLON;
+                        continue;
+                    case PROP_COLON:
+                        if (tok_type != COLON)
+                            return fail(UNEXPECTED_TOKEN_ERR, tok_begin_);
+
+                        state = PROP_VALUE;
+                        continue;
+                    case SEPARATOR:
+                        if (depth == 0)
+                            return fail(UNEXPECTED_TOKEN_ERR, tok_begin_); // trailing tokens after the root value
+                        else if (tok_type == COMMA)
+                        {
+                            state = in_obj ? NEXT_KEY : NEXT_ITEM;
+                            continue;
+                        }
+                        else if ((tok_type == RBRACKET && !in_obj) || (tok_type == RCURLY && in_obj))
+                            break;
+                        else if (tok_type == RBRACKET || tok_type == RCURLY)
+                            return fail(UNBALANCED_NEST, tok_begin_);
+
+                        return fail((tok_type == UNKNOWN) ? UNKNOWN_TOKEN_ERR : UNEXPECTED_TOKEN_ERR, tok_begin_);
+                    default:
+                        continue;
+                    }
+
+                    // close the innermost container: its subtree ends at the next node
+                    depth--;
+
+                    if (nodes_ != nullptr)
+                        nodes_[open[depth] >> 1].end = static_cast<std::uint32_t>(node_count_);
+
+                    in_obj = (depth > 0) && (open[depth - 1] & 1);
+                    state = SEPARATOR;
+                }
+            }
+
+        private:
+            constexpr StaticResult fail(ParserErr err, std::size_t offset) const noexcept
+            {
+                return StaticResult {err, offset, 0, 0};
+            }
+
+            constexpr char at(std::size_t pos) const noexcept { return text_[pos]; }
+
+            constexpr TokenType lex_next() noexcept
+            {
+                while (pos_ < text_.size() && static_is_wspace(at(pos_)))
+                    pos_++;
+
+                tok_begin_ = pos_;
+
+                if (pos_ >= text_.size())
+                    return FILE_END;
+
+                char c = at(pos_);
+
+                switch (c)
+                {
+                case '[':
+                    pos_++;
+                    return LBRACKET;
+                case ']':
+                    pos_++;
+                    return RBRACKET;
+                case '{':
+                    pos_++;
+                    return LCURLY;
+                case '}':
+                    pos_++;
+                    return RCURLY;
+                case ':':
+                    pos_++;
+                    return COLON;
+                case ',':
+                    pos_++;
+                    return COMMA;
+                case '\"':
+                    return lex_str();
+                case 'n':
+                case 't':
+                case 'f':
+                    return lex_literal();
+                default:
+                    break;
+                }
+
+                if (c == '-' || static_is_digit(c))
+                    return lex_num();
+
+                pos_++;
+
+                return UNKNOWN;
+            }
+
+            constexpr long u_escape_at(std::size_t pos) const noexcept
+            {
+                if (text_.size() - pos < 6 || at(pos) != '\\' || at(pos + 1) != 'u')
+                    return -1;
+
+                long code = 0;
+
+                for (std::size_t i = pos + 2; i < pos + 6; i++)
+                {
+                    long digit = static_hex_value(at(i));
+
+                    if (digit < 0)
+                        return -1;
+
+                    code = (code << 4) | digit;
+                }
+
+                return code;
+            }
+
+            /// Length of the escape at pos, or 0 if it is invalid. Surrogate pairs must be whole.
+            constexpr std::size_t escape_len(std::size_t pos) const noexcept
+            {
+                if (text_.size() - pos < 2)
+                    return 0;
+
+                switch (at(pos + 1))
+                {
+                case '\"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                    return 2;
+                case 'u':
+                {
+                    long code = u_escape_at(pos);
+
+                    if (code < 0xd800 || code > 0xdfff)
+                        return (code < 0) ? 0 : 6;
+
+                    long low = (code <= 0xdbff) ? u_escape_at(pos + 6) : -1;
+
+                    return (low >= 0xdc00 && low <= 0xdfff) ? 12 : 0;
+                }
+                default:
+                    return 0;
+                }
+            }
+
+            /// Length of the UTF-8 sequence at pos, or 0 if it is overlong, a surrogate, past U+10FFFF or cut off.
+            constexpr std::size_t utf8_len(std::size_t pos) const noexcept
+            {
+                unsigned char lead = static_cast<unsigned char>(at(pos));
+                unsigned char low = 0x80;
+                unsigned char high = 0xbf;
+                std::size_t len = 0;
+
+                if (lead >= 0xc2 && lead <= 0xdf)
+                    len = 2;
+                else if (lead >= 0xe0 && lead <= 0xef)
+                {
+                    len = 3;
+                    low = (lead == 0xe0) ? 0xa0 : 0x80;
+                    high = (lead == 0xed) ? 0x9f : 0xbf;
+                }
+                else if (lead >= 0xf0 && lead <= 0xf4)
+                {
+                    len = 4;
+                    low = (lead == 0xf0) ? 0x90 : 0x80;
+                    high = (lead == 0xf4) ? 0x8f : 0xbf;
+                }
+                else
+                    return 0;
+
+                if (text_.size() - pos < len)
+                    return 0;
+
+                for (std::size_t i = 1; i < len; i++)
+                {
+                    unsigned char next = static_cast<unsigned char>(at(pos + i));
+
+                    if (next < low || next > high)
+                        return 0;
+
+                    low = 0x80;
+                    high = 0xbf;
+                }
+
+                return len;
+            }
+
+            constexpr TokenType lex_str() noexcept
+            {
+                std::size_t scan = pos_ + 1;
+                bool invalid = false;
+
+                tok_escaped_ = false;
+
+                while (true)
+                {
+                    // reject an unterminated string after consuming the rest of the text
+                    if (scan >= text_.size())
+                    {
+                        pos_ = text_.size();
+                        return UNKNOWN;
+                    }
+
+                    unsigned char c = static_cast<unsigned char>(at(scan));
+                    std::size_t len = 1;
+
+                    if (c == '\"')
+                        break;
+
+                    if (c == '\\')
+                    {
+                        tok_escaped_ = true;
+                        len = escape_len(scan);
+
+                        if (len == 0)
+                        {
+                            // an escaped quote still must not end the string, even when the escape around it is bad
+                            len = (text_.size() - scan >= 2 && (at(scan + 1) == '\"' || at(scan + 1) == '\\')) ? 2 : 1;
+                            invalid = true;
+                        }
+                    }
+                    else if (c < 0x20)
+                        invalid = true; // raw control char
+                    else if (c >= 0x80)
+                    {
+                        len = utf8_len(scan);
+
+                        if (len == 0)
+                        {
+                            len = 1;
+                            invalid = true;
+                        }
+                    }
+
+                    scan += len;
+                }
+
+                tok_text_ = pos_ + 1;
+                tok_end_ = scan;
+                pos_ = scan + 1;
+
+                return invalid ? UNKNOWN : STRBODY;
+            }
+
+            constexpr TokenType lex_num() noexcept
+            {
+                std::size_t start = pos_;
+                std::size_t digit_count = 0;
+                bool is_float = false;
+
+                if (at(pos_) == '-')
+                    pos_++;
+
+                std::size_t int_start = pos_;
+
+                while (pos_ < text_.size() && static_is_digit(at(pos_)))
+                    pos_++;
+
+                digit_count = pos_ - start;
+                bool leading_zero = (pos_ - int_start > 1 && at(int_start) == '0'); // RFC 8259 has no 01 or -00
+
+                // fraction part
+                if (pos_ < text_.size() && at(pos_) == '.')
+                {
+                    std::size_t frac_start = ++pos_;
+
+                    while (pos_ < text_.size() && static_is_digit(at(pos_)))
+                        pos_++;
+
+                    digit_count = (pos_ > frac_start) ? digit_count : 0;
+                    is_float = true;
+                }
+
+                // exponent part
+                if (pos_ < text_.size() && (at(pos_) == 'e' || at(pos_) == 'E'))
+                {
+                    pos_++;
+
+                    if (pos_ < text_.size() && (at(pos_) == '+' || at(pos_) == '-'))
+                        pos_++;
+
+                    std::size_t exp_start = pos_;
+
+                    while (pos_ < text_.size() && static_is_digit(at(pos_)))
+                        pos_++;
+
+                    digit_count = (pos_ > exp_start) ? digit_count : 0;
+                    is_float = true;
+                }
+
+                tok_text_ = start;
+                tok_end_ = pos_;
+
+                if (digit_count == 0 || (at(start) == '-' && digit_count == 1) || leading_zero)
+                    return UNKNOWN;
+
+                return is_float ? FLT_LTRL : INT_LTRL;
+            }
+
+            constexpr TokenType lex_literal() noexcept
+            {
+                std::string_view rest = text_.substr(pos_);
+
+                if (rest.substr(0, 4) == "null")
+                {
+                    pos_ += 4;
+                    return NULL_LTRL;
+                }
+                else if (rest.substr(0, 4) == "true")
+                {
+                    pos_ += 4;
+                    return TRUE_LTRL;
+                }
+                else if (rest.substr(0, 5) == "false")
+                {
+                    pos_ += 5;
+                    return FALSE_LTRL;
+                }
+
+                pos_++;
+
+                return UNKNOWN;
+            }
+
+            constexpr void put_char(char c) noexcept
+            {
+                if (chars_ != nullptr)
+                    chars_[char_count_] = c;
+
+                char_count_++;
+            }
+
+            /// Appends a code point as UTF-8.
+            constexpr void put_code(long code) noexcept
+            {
+                if (code < 0x80)
+                    put_char(static_cast<char>(code));
+                else if (code < 0x800)
+                {
+                    put_char(static_cast<char>(0xc0 | (code >> 6)));
+                    put_char(static_cast<char>(0x80 | (code & 0x3f)));
+                }
+                else if (code < 0x10000)
+                {
+                    put_char(static_cast<char>(0xe0 | (code >> 12)));
+                    put_char(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+                    put_char(static_cast<char>(0x80 | (code & 0x3f)));
+                }
+                else
+                {
+                    put_char(static_cast<char>(0xf0 | (code >> 18)));
+                    put_char(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+                    put_char(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+                    put_char(static_cast<char>(0x80 | (code & 0x3f)));
+                }
+            }
+
+            /**
+             * @brief Decodes the last STRBODY token into the char pool, followed by a '\0'.
+             *
+             * @return std::uint32_t The decoded length.
+             */
+            constexpr std::uint32_t add_text() noexcept
+            {
+                std::size_t start = char_count_;
+
+                for (std::size_t pos = tok_text_; pos < tok_end_; )
+                {
+                    char c = at(pos);
+
+                    if (!tok_escaped_ || c != '\\')
+                    {
+                        put_char(c);
+                        pos++;
+                        continue;
+                    }
+
+                    std::size_t len = escape_len(pos);
+
+                    switch (at(pos + 1))
+                    {
+                    case 'b':
+                        put_char('\b');
+                        break;
+                    case 'f':
+                        put_char('\f');
+                        break;
+                    case 'n':
+                        put_char('\n');
+                        break;
+                    case 'r':
+                        put_char('\r');
+                        break;
+                    case 't':
+                        put_char('\t');
+                        break;
+                    case 'u':
+                    {
+                        long code = u_escape_at(pos);
+
+                        if (len == 12)
+                            code = 0x10000 + ((code - 0xd800) << 10) + (u_escape_at(pos + 6) - 0xdc00);
+
+                        put_code(code);
+                        break;
+                    }
+                    default:
+                        put_char(at(pos + 1)); // '"', '\\' and '/' stand for themselves
+                        break;
+                    }
+
+                    pos += len;
+                }
+
+                std::uint32_t len = static_cast<std::uint32_t>(char_count_ - start);
+                put_char('\0');
+
+                return len;
+            }
+
+            constexpr void add_node(TokenType tok_type, std::uint32_t key, std::uint32_t key_len) noexcept
+            {
+                StaticNode node;
+
+                node.key = key;
+                node.key_len = key_len;
+
+                switch (tok_type)
+                {
+                case LBRACKET:
+                    node.type = ARR;
+                    break;
+                case LCURLY:
+                    node.type = OBJ;
+                    break;
+                case STRBODY:
+                    node.type = STR;
+                    node.text = static_cast<std::uint32_t>(char_count_);
+                    node.text_len = add_text();
+                    break;
+                case INT_LTRL:
+                    node.type = INT;
+                    node.i = static_to_int(text_.substr(tok_text_, tok_end_ - tok_text_));
+                    break;
+                case FLT_LTRL:
+                    node.type = FLT;
+                    node.f = static_to_float(text_.substr(tok_text_, tok_end_ - tok_text_));
+                    break;
+                case TRUE_LTRL:
+                case FALSE_LTRL:
+                    node.type = BOOL;
+                    node.i = (tok_type == TRUE_LTRL);
+                    break;
+                default:
+                    node.type = NUL;
+                    break;
+                }
+
+                // a primitive's subtree is itself, a container's end is set when it closes
+                node.end = static_cast<std::uint32_t>(node_count_ + 1);
+
+                if (nodes_ != nullptr)
+                    nodes_[node_count_] = node;
+
+                node_count_++;
+            }
+
+            std::string_view text_;
+            StaticNode *nodes_;
+            char *chars_;
+            std::size_t node_count_ = 0;
+            std::size_t char_count_ = 0;
+            std::size_t pos_ = 0;
+            std::size_t tok_begin_ = 0;  // first byte of the last token, for error offsets
+            std::size_t tok_text_ = 0;   // string contents or number text of the last token
+            std::size_t tok_end_ = 0;
+            bool tok_escaped_ = false;
+        };
+    }
+
+    /**
+     * @brief Parses a JSON literal at compile time, e.g. static constexpr auto routes = myjson::parse_static<R"({"port": 8080})">();
+     *
+     * @tparam Text
+     * @return StaticDocument Sized exactly for the literal's nodes and decoded strings.
+     */
+    template <StaticText Text>
+    constexpr auto parse_static() noexcept
+    {
+        constexpr detail::StaticResult sizes = detail::StaticParser {Text.view(), nullptr, nullptr}.run();
+
+        if constexpr (sizes.err != NO_ERR)
+        {
+            [[maybe_unused]] detail::malformed_static_json<sizes.err, sizes.offset> report;
+            return StaticDocument<1, 0> {};
+        }
+        else
+        {
+            StaticDocument<sizes.node_count, sizes.char_count> result;
+
+            detail::StaticParser {Text.view(), result.nodes.data(), result.chars.data()}.run();
+
+            return result;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef JSON_STATS_H
+#define JSON_STATS_H
+
+/**
+ * @file json_stats.h
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares the opt-in parse instrumentation (phase timers and allocation counters).
+ * @note 1: Everything here compiles to nothing unless JSON_STATS is defined (see "make STATS=1").
+ * @note 2: Defining JSON_USDT as well adds static probe points for bpftrace, which needs <sys/sdt.h> (systemtap-sdt-dev).
+ * @date 2026-10-19
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+typedef struct json_stats
+{
+    /* Phase Timers (cycles, or nanoseconds on hosts without a cycle counter) */
+
+    uint64_t lex_cycles;     // Lexer_Lex_All
+    uint64_t parse_cycles;   // Parser_Start_Parse
+    uint64_t destroy_cycles; // JsonThing_Destroy
+
+    /* Counters */
+
+    size_t token_count;
+    size_t node_count;       // Properties and ArrayItems
+    size_t alloc_count;
+    size_t alloc_bytes;
+    size_t max_depth;        // deepest Array / Object nesting seen
+    size_t probe_count;      // Object lookups and inserts
+    size_t probe_total;      // buckets visited over all probes
+    size_t probe_max;        // longest single probe
+} JsonStats;
+
+void JsonStats_Clear(JsonStats *self);
+
+/**
+ * @brief Adds the counters and timers of another stats record into self. Maximums are kept as maximums.
+ *
+ * @param self
+ * @param other
+ */
+void JsonStats_Merge(JsonStats *self, const JsonStats *other);
+void JsonStats_Print(const JsonStats *self, FILE *out);
+
+/**
+ * @brief Reads the cycle counter: rdtsc on x86, cntvct on AArch64, or a monotonic nanosecond clock elsewhere.
+ *
+ * @return uint64_t
+ */
+uint64_t json_cycles_now();
+
+/**
+ * @brief Makes target the record that this thread's allocation, node, depth and probe hooks count into. Returns the previously bound record so nested phases can restore it.
+ *
+ * @param target May be NULL to stop counting.
+ * @return JsonStats*
+ */
+JsonStats *JsonStats_Bind(JsonStats *target);
+JsonStats *JsonStats_Active();
+
+/// Hooks:
+
+#ifdef JSON_STATS
+
+#define JSON_STATS_BIND(target) JsonStats *json_stats_prev_ = JsonStats_Bind(target)
+#define JSON_STATS_UNBIND() JsonStats_Bind(json_stats_prev_)
+#define JSON_STATS_ADD(field, n) do { JsonStats *s_ = JsonStats_Active(); if (s_) s_->field += (n); } while (0)
+#define JSON_STATS_ALLOC(bytes) do { JsonStats *s_ = JsonStats_Active(); if (s_) { s_->alloc_count++; s_->alloc_bytes += (bytes); } } while (0)
+#define JSON_STATS_NODE(bytes) do { JsonStats *s_ = JsonStats_Active(); if (s_) { s_->node_count++; s_->alloc_count++; s_->alloc_bytes += (bytes); } } while (0)
+#define JSON_STATS_DEPTH(depth) do { JsonStats *s_ = JsonStats_Active(); if (s_ && (size_t)(depth) > s_->max_depth) s_->max_depth = (depth); } while (0)
+#define JSON_STATS_PROBE(len) do { JsonStats *s_ = JsonStats_Active(); if (s_) { s_->probe_count++; s_->probe_total += (len); if ((size_t)(len) > s_->probe_max) s_->probe_max = (len); } } while (0)
+#define JSON_TIMER_START(name) uint64_t name = json_cycles_now()
+#define JSON_TIMER_STOP(name, target, field) ((target)->field += json_cycles_now() - (name))
+
+#else
+
+#define JSON_STATS_BIND(target)
+#define JSON_STATS_UNBIND()
+#define JSON_STATS_ADD(field, n)
+#define JSON_STATS_ALLOC(bytes)
+#define JSON_STATS_NODE(bytes)
+#define JSON_STATS_DEPTH(depth)
+#define JSON_STATS_PROBE(len)
+#define JSON_TIMER_START(name)
+#define JSON_TIMER_STOP(name, target, field)
+
+#endif
+
+/// USDT Probes: (e.g. bpftrace -e 'usdt:./bin/myjson:myjson:lex_done { @toks = hist(arg0); }')
+
+#if defined(JSON_STATS) && defined(JSON_USDT)
+
+#include <sys/sdt.h>
+#define JSON_PROBE(name) DTRACE_PROBE(myjson, name)
+#define JSON_PROBE1(name, a) DTRACE_PROBE1(myjson, name, a)
+#define JSON_PROBE2(name, a, b) DTRACE_PROBE2(myjson, name, a, b)
+
+#else
+
+#define JSON_PROBE(name)
+#define JSON_PROBE1(name, a)
+#define JSON_PROBE2(name, a, b)
+
+#endif
+
+#endif
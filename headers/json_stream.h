@@ -0,0 +1,84 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+/**
+ * @file json_stream.h
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Declares a streaming iterator over the elements of one huge top-level Array. The file is read in chunks and each element is parsed alone into a recycled ParseContext, so memory stays bounded by the largest element instead of the whole Array.
+ * @date 2026-10-19
+ */
+
+#include "json_context.h"
+#include "json_input.h"
+
+#define STREAM_CHUNK_SIZE 65536
+
+typedef enum json_stream_state {
+    STREAM_START, // before the opening '['
+    STREAM_FIRST, // after '[': an element or ']'
+    STREAM_NEXT,  // after ',': an element
+    STREAM_AFTER, // after an element: ',' or ']'
+    STREAM_END    // after the closing ']'
+} StreamState;
+
+typedef struct json_array_stream
+{
+    /* Input */
+
+    JsonInput input;      // decompresses gzip / zstd files straight into the window
+    size_t chunk_size;
+
+    /* Window over the file: only the current element and unread bytes are kept */
+
+    char *buf;
+    size_t buf_len;
+    size_t buf_cap;
+    size_t keep_pos;      // first byte still needed, everything before is dropped on refill
+    size_t scan_pos;
+
+    /* Parsing */
+
+    ParseContext *context; // arena reset for every element
+    StreamState state;
+    ParserErr err_code;
+    size_t index;          // elements yielded so far
+    const JsonAllocator *allocator;
+} ArrayStream;
+
+/**
+ * @brief Opens a file holding one top-level Array for streaming. The file may be gzip or zstd compressed.
+ *
+ * @param path
+ * @param chunk_size Bytes read per refill, or 0 for STREAM_CHUNK_SIZE.
+ * @param allocator Allocator for the stream, its window and its parse context (NULL for libc). The caller frees the stream with it too.
+ * @return ArrayStream* NULL if the file cannot be opened or memory ran out.
+ */
+ArrayStream *ArrayStream_Open(const char *path, size_t chunk_size, const JsonAllocator *allocator);
+
+/**
+ * @brief Streams from an already open file, which the stream borrows.
+ *
+ * @param file
+ * @param chunk_size
+ * @param allocator
+ * @return ArrayStream*
+ */
+ArrayStream *ArrayStream_Create(FILE *file, size_t chunk_size, const JsonAllocator *allocator);
+
+/**
+ * @brief Frees the window and parse context, and closes the file if the stream opened it, but does not free the stream itself.
+ *
+ * @param self
+ */
+void ArrayStream_Destroy(ArrayStream *self);
+
+/**
+ * @brief Parses the next element as its own document. It lives in the stream's arena, so it stays valid only until the next call and must not be passed to JsonThing_Destroy.
+ *
+ * @param self
+ * @return const JsonThing* NULL after the last element or on error (see ArrayStream_Get_ErrCode).
+ */
+const JsonThing *ArrayStream_Next(ArrayStream *self);
+int ArrayStream_Get_ErrCode(const ArrayStream *self);
+
+#endif
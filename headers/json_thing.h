@@ -6,6 +6,8 @@
 typedef struct json_thing
 {
     Property *root; // Cannot be named or a primitive!
+    JsonStats stats; // copied from the Parser, plus the destroy timer (JSON_STATS builds only)
+    const JsonAllocator *allocator; // made the root and every node under it
 } JsonThing;
 
 /**
@@ -13,8 +15,9 @@ typedef struct json_thing
  * @note The file_name param must be a statically allocated C-String!
  * @param root_type
  * @param new_root
+ * @param allocator The allocator which made new_root (NULL for libc). It also allocates the JsonThing.
  */
-JsonThing *JsonThing_Create(DataType root_type, Property *new_root);
+JsonThing *JsonThing_Create(DataType root_type, Property *new_root, const JsonAllocator *allocator);
 
 /**
  * @brief Recursively destroys properties starting from the root anonymous property (Array or Object). Fails if root property is primitive since that is invalid JSON. 
@@ -23,4 +26,24 @@ JsonThing *JsonThing_Create(DataType root_type, Property *new_root);
  */
 void JsonThing_Destroy(JsonThing *self);
 
+/// Copy-on-write: a clone shares every Array and Object with the original through reference counts, and JsonThing_Edit copies only the containers along an edited path. Variants of one base document then share all the subtrees they did not change.
+
+/**
+ * @brief Clones a document in O(1) by sharing its root container. Either document may then be destroyed first.
+ * @note Reference counts are not atomic, so a document and its clones must stay on one thread. Clones of a ParseContext document end with its next parse, like the document itself.
+ * @param self
+ * @return JsonThing* NULL if memory ran out.
+ */
+JsonThing *JsonThing_Clone(const JsonThing *self);
+
+/**
+ * @brief Makes the container at a dotted path (e.g. "routes.2.limits", or "" for the root) safe to modify, copying each shared Array or Object along the way. The returned container and the ones above it belong to this document alone, so they may be changed with Object_SetItem, Array_Push and so on.
+ * @note Containers reached any other way may be shared with clones and must be treated as read-only. That includes IncrDoc, which edits its document in place.
+ * @param self
+ * @param path Object keys and Array indices separated by '.'.
+ * @param type_flag Receives ARR or OBJ, or UNSUPPORTED on failure.
+ * @return void* The Array or Object, or NULL if a segment is missing, a value along the path is not a container, or memory ran out.
+ */
+void *JsonThing_Edit(JsonThing *self, const char *path, DataType *type_flag);
+
 #endif
\ No newline at end of file
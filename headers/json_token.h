@@ -3,6 +3,12 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include "json_alloc.h"
+#include "json_stats.h"
+
+/// Limits:
+
+#define MAX_NUM_TXT_LEN 64 // scratch buffer for numeric literal text, see Token_ToNum
 
 /// Enums:
 
@@ -16,6 +22,8 @@ typedef enum token_type {
     INT_LTRL,     // text of [0-9]+ pattern
     FLT_LTRL,     // text of [0-9]*.[0-9]+ pattern
     NULL_LTRL,    // null keyword
+    TRUE_LTRL,    // true keyword
+    FALSE_LTRL,   // false keyword
     COMMA,
     FILE_END,     // eof token
     UNKNOWN       // unsupported thing
@@ -23,27 +31,149 @@ typedef enum token_type {
 
 /// Token & TokenVec:
 
+/// Token flags:
+
+#define TOKEN_ESCAPED 0x1 // STRBODY text holds backslash escapes, so it must be decoded instead of copied
+#define TOKEN_COUNT_MASK 0x7fffffffu  // LBRACKET / LCURLY: count of elements or members inside
+#define TOKEN_HAS_UNKNOWN 0x80000000u // LBRACKET / LCURLY: an UNKNOWN token lies somewhere inside
+
 typedef struct json_token
 {
     TokenType type;
+    unsigned int flags; // fits in the padding before begin, so tokens stay 24 bytes
     size_t begin;
-    size_t span;
+    union
+    {
+        size_t span;    // length of the token text
+        size_t skip;    // LBRACKET / LCURLY: tape distance to the matching closer, 0 if not indexed (their text is always 1 char)
+    };
 } Token;
 
-Token *Token_Create(TokenType _type, size_t _begin, size_t _span); // tokens should be externally freed...
-char *Token_ToTxt(const Token *self, const char *src);
+Token Token_Create(TokenType _type, size_t _begin, size_t _span); // tokens are plain values stored inline in a TokenVec
+
+/**
+ * @brief Copies token text into a new C-String. Escaped string text is decoded on the way, turning \uXXXX escapes (and surrogate pairs) into UTF-8. Decoded text never outgrows the raw text.
+ *
+ * @param self
+ * @param src
+ * @param allocator
+ * @return char*
+ */
+char *Token_ToTxt(const Token *self, const char *src, const JsonAllocator *allocator);
+
+/**
+ * @brief Checks whether two STRBODY tokens decode to the same text. Only escaped tokens are decoded, so plain ones compare in place.
+ *
+ * @param a
+ * @param b
+ * @param src
+ * @param allocator Scratch allocator for decoding.
+ * @return int 1 if equal, 0 if not or if memory ran out.
+ */
+int Token_SameTxt(const Token *a, const Token *b, const char *src, const JsonAllocator *allocator);
+
+/**
+ * @brief Checks whether a STRBODY token decodes to the given text. Escapes are decoded one at a time as they are compared, so nothing is allocated.
+ *
+ * @param self
+ * @param src
+ * @param txt
+ * @param txt_len
+ * @return int 1 if equal.
+ */
+int Token_MatchTxt(const Token *self, const char *src, const char *txt, size_t txt_len);
+
+/**
+ * @brief Decodes STRBODY text like Token_ToTxt, but into a caller's buffer and without a null terminator.
+ *
+ * @param self
+ * @param src
+ * @param out Needs room for span chars, which decoded text never exceeds.
+ * @return size_t Decoded length.
+ */
+size_t Token_DecodeTxt(const Token *self, const char *src, char *out);
+
+/**
+ * @brief Copies token text into a caller's scratch buffer without allocating, truncating it to fit. Use Token_ToNum to read a number, which never truncates.
+ *
+ * @param self
+ * @param src
+ * @param buf
+ * @param buf_len Size of buf including the null terminator.
+ * @return size_t Count of copied chars.
+ */
+size_t Token_CopyTxt(const Token *self, const char *src, char *buf, size_t buf_len);
+
+/**
+ * @brief Reads an INT_LTRL or FLT_LTRL token the way atoi and strtod read its whole text. Literals shorter than MAX_NUM_TXT_LEN go through a stack buffer, and only longer ones are copied to the heap, so no digit is ever cut off.
+ *
+ * @param self
+ * @param src
+ * @param allocator For the copy of a long literal.
+ * @param int_out Receives the atoi value. May be NULL.
+ * @param flt_out Receives the strtod value. May be NULL.
+ * @return int 0 if memory ran out.
+ */
+int Token_ToNum(const Token *self, const char *src, const JsonAllocator *allocator, int *int_out, double *flt_out);
 
 typedef struct token_vec
 {
-    Token **data;
+    Token *data;    // contiguous token tape
     size_t count;
     size_t capacity;
+    const JsonAllocator *allocator;
 } TokenVec;
 
-TokenVec *TokenVec_Create(size_t _capacity);
+TokenVec *TokenVec_Create(size_t _capacity, const JsonAllocator *allocator);
+
+/**
+ * @brief Initializes an embedded TokenVec. Returns 0 if the tape could not be allocated.
+ *
+ * @param self
+ * @param _capacity
+ * @param allocator
+ * @return int
+ */
+int TokenVec_Init(TokenVec *self, size_t _capacity, const JsonAllocator *allocator);
 void TokenVec_Destroy(TokenVec *self);
-void TokenVec_Grow(TokenVec *self);
-void TokenVec_Set(TokenVec *self, size_t idx, Token *item);
+int TokenVec_Grow(TokenVec *self);
+
+/**
+ * @brief Appends a token, doubling the tape when it is full. Returns 0 if growing failed.
+ *
+ * @param self
+ * @param item
+ * @return int
+ */
+int TokenVec_Push(TokenVec *self, Token item);
+
+/**
+ * @brief Forgets all tokens in O(1) while keeping the tape capacity for reuse.
+ *
+ * @param self
+ */
+void TokenVec_Clear(TokenVec *self);
+
+/**
+ * @brief Replaces old_count tokens at pos with new_count tokens, moving the tail of the tape once. Returns 0 if growing failed, leaving the tape unchanged.
+ *
+ * @param self
+ * @param pos
+ * @param old_count
+ * @param items
+ * @param new_count
+ * @return int
+ */
+int TokenVec_Splice(TokenVec *self, size_t pos, size_t old_count, const Token *items, size_t new_count);
+
+/**
+ * @brief Indexes the container opened at tape index opener again, like Lexer_Lex_Into does, after a splice changed its contents. Costs one pass over the container.
+ *
+ * @param self
+ * @param opener
+ * @return int 0 if the container never closes, which leaves it unindexed.
+ */
+int TokenVec_Link(TokenVec *self, size_t opener);
 Token *TokenVec_At(TokenVec *self, size_t idx);
 
 #endif
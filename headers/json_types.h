@@ -5,6 +5,9 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
+#include "json_alloc.h"
+#include "json_stats.h"
 
 /// Enums:
 
@@ -15,6 +18,7 @@ typedef enum json_type {
     ARR,
     OBJ,
     NUL,
+    BOOL,
     UNSUPPORTED
 } DataType;
 
@@ -0,0 +1,201 @@
+/**
+ * @file gen_request.c
+ * @brief Generated by tools/json_schemagen.c from schemas/request.json. Do not edit.
+ */
+
+#include "gen_request.h"
+
+static int request_match_key(const char *key, size_t len)
+{
+    switch (len)
+    {
+    case 2:
+        switch (key[0])
+        {
+        case 'i':
+            if (memcmp(key + 1, "d", 1) == 0)
+                return 0;
+            break;
+        case 'm':
+            if (memcmp(key + 1, "s", 1) == 0)
+                return 3;
+            break;
+        default:
+            break;
+        }
+        break;
+    case 4:
+        switch (key[0])
+        {
+        case 'u':
+            if (memcmp(key + 1, "ser", 3) == 0)
+                return 1;
+            break;
+        case 'p':
+            if (memcmp(key + 1, "ath", 3) == 0)
+                return 2;
+            break;
+        default:
+            break;
+        }
+        break;
+    case 6:
+        switch (key[0])
+        {
+        case 'c':
+            if (memcmp(key + 1, "ached", 5) == 0)
+                return 4;
+            break;
+        default:
+            break;
+        }
+        break;
+    default:
+        break;
+    }
+
+    return -1;
+}
+
+static int request_set_field(Request *self, int field, const char *src, const Token *value, const JsonAllocator *allocator)
+{
+    int err = NO_ERR;
+
+    switch (field)
+    {
+    case 0:
+        err = JsonGen_Int(&self->id, src, value);
+        break;
+    case 1:
+        err = JsonGen_String(&self->user, src, value, allocator);
+        break;
+    case 2:
+        err = JsonGen_String(&self->path, src, value, allocator);
+        break;
+    case 3:
+        err = JsonGen_Float(&self->ms, src, value, allocator);
+        break;
+    case 4:
+        err = JsonGen_Bool(&self->cached, value);
+        break;
+    default:
+        break;
+    }
+
+    if (value->type == NULL_LTRL)
+        self->present &= ~(1u << field);
+    else
+        self->present |= 1u << field;
+
+    return err;
+}
+
+int Request_Parse(Request *self, const char *src, const TokenVec *tokens, size_t *pos, const JsonAllocator *allocator)
+{
+    const Token *tape = tokens->data;
+    size_t idx = *pos;
+    size_t end = tokens->count;
+    int err = NO_ERR;
+
+    memset(self, 0, sizeof(Request));
+
+    if (idx >= end || tape[idx].type != LCURLY)
+        return UNEXPECTED_TOKEN_ERR;
+
+    idx++;
+
+    if (idx < end && tape[idx].type == RCURLY)
+    {
+        *pos = idx + 1;
+        return NO_ERR;
+    }
+
+    while (1)
+    {
+        // a member needs at least key, colon and one value token
+        if (end - idx < 3)
+        {
+            err = UNBALANCED_NEST;
+            break;
+        }
+
+        if (tape[idx].type != STRBODY || tape[idx + 1].type != COLON)
+        {
+            err = UNEXPECTED_TOKEN_ERR;
+            break;
+        }
+
+        // escaped keys are rare, so only they pay for decoding
+        int field = (tape[idx].flags & TOKEN_ESCAPED) ? JsonGen_Match_Escaped(src, tape + idx, request_match_key, allocator)
+            : request_match_key(src + tape[idx].begin, tape[idx].span);
+        idx += 2;
+
+        if (field < 0)
+            err = JsonGen_Skip(tokens, &idx);
+        else
+        {
+            err = request_set_field(self, field, src, tape + idx, allocator);
+            idx++;
+        }
+
+        if (err != NO_ERR)
+            break;
+
+        if (idx >= end)
+        {
+            err = UNBALANCED_NEST;
+            break;
+        }
+
+        if (tape[idx].type == RCURLY)
+        {
+            idx++;
+            break;
+        }
+
+        if (tape[idx].type != COMMA)
+        {
+            err = UNEXPECTED_TOKEN_ERR;
+            break;
+        }
+
+        idx++;
+    }
+
+    if (err != NO_ERR)
+    {
+        Request_Destroy(self, allocator);
+        return err;
+    }
+
+    *pos = idx;
+
+    return NO_ERR;
+}
+
+int Request_Parse_Text(Request *self, char *src, size_t len, TokenVec *scratch, const JsonAllocator *allocator)
+{
+    size_t pos = 0;
+    int err = JsonGen_Lex(scratch, src, len);
+
+    memset(self, 0, sizeof(Request));
+
+    if (err == NO_ERR)
+        err = Request_Parse(self, src, scratch, &pos, allocator);
+
+    // trailing tokens after the message
+    if (err == NO_ERR && pos != scratch->count)
+    {
+        Request_Destroy(self, allocator);
+        err = UNEXPECTED_TOKEN_ERR;
+    }
+
+    return err;
+}
+
+void Request_Destroy(Request *self, const JsonAllocator *allocator)
+{
+    json_free(allocator, self->user);
+    json_free(allocator, self->path);
+    memset(self, 0, sizeof(Request));
+}
@@ -0,0 +1,813 @@
+/**
+ * @file json_aggregate.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Implements the NDJSON aggregation engine over the token tape.
+ * @date 2026-10-19
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include "json_aggregate.h"
+#include "json_gen.h"
+#include "json_input.h"
+
+#define AGG_DIGITS_EXACT 18 // integer literals this short always fit an int64_t
+
+/// One part of a buffer given to a worker thread.
+typedef struct json_agg_task
+{
+    Aggregator worker;
+    char *src;
+    size_t len;
+    int err;
+    int started;
+    pthread_t thread;
+} AggTask;
+
+/// Job:
+
+static size_t agg_find_child(const Aggregator *self, size_t node, const char *key, size_t key_len)
+{
+    size_t child = self->nodes[node].first_child;
+
+    while (child != AGG_NONE)
+    {
+        const AggNode *curr = self->nodes + child;
+
+        if (curr->key_len == key_len && memcmp(curr->key, key, key_len) == 0)
+            break;
+
+        child = curr->next_sibling;
+    }
+
+    return child;
+}
+
+static size_t agg_add_node(Aggregator *self, const char *key, size_t key_len)
+{
+    if (self->node_count == self->node_capacity)
+    {
+        size_t new_capacity = (self->node_capacity > 0) ? self->node_capacity << 1 : 8;
+        AggNode *temp = json_realloc(self->allocator, self->nodes, sizeof(AggNode) * new_capacity);
+
+        if (!temp)
+            return AGG_NONE;
+
+        self->nodes = temp;
+        self->node_capacity = new_capacity;
+    }
+
+    AggNode *node = self->nodes + self->node_count;
+
+    node->key = NULL;
+    node->key_len = key_len;
+    node->first_child = AGG_NONE;
+    node->next_sibling = AGG_NONE;
+    node->field = AGG_NONE;
+
+    if (key != NULL)
+    {
+        node->key = json_alloc(self->allocator, key_len + 1);
+
+        if (!node->key)
+            return AGG_NONE;
+
+        memcpy(node->key, key, key_len);
+        node->key[key_len] = '\0';
+    }
+
+    return self->node_count++;
+}
+
+/**
+ * @brief Adds a dotted path to the trie, sharing the field of an equal path added before.
+ *
+ * @return size_t The path's field, or AGG_NONE if a key is empty or memory ran out.
+ */
+static size_t agg_add_path(Aggregator *self, const char *path)
+{
+    size_t node = 0;
+    const char *segment = path;
+
+    while (1)
+    {
+        const char *dot = strchr(segment, '.');
+        size_t seg_len = (dot != NULL) ? (size_t)(dot - segment) : strlen(segment);
+
+        if (seg_len == 0)
+            return AGG_NONE;
+
+        size_t child = agg_find_child(self, node, segment, seg_len);
+
+        if (child == AGG_NONE)
+        {
+            child = agg_add_node(self, segment, seg_len);
+
+            if (child == AGG_NONE)
+                return AGG_NONE;
+
+            self->nodes[child].next_sibling = self->nodes[node].first_child;
+            self->nodes[node].first_child = child;
+        }
+
+        node = child;
+
+        if (!dot)
+            break;
+
+        segment = dot + 1;
+    }
+
+    if (self->nodes[node].field == AGG_NONE)
+        self->nodes[node].field = self->field_count++;
+
+    return self->nodes[node].field;
+}
+
+/**
+ * @brief Sets up the per-record scratch and empty results, which every worker has its own of.
+ *
+ * @return int 0 if memory ran out.
+ */
+static int agg_init_state(Aggregator *self)
+{
+    self->values = NULL;
+    self->key_buf = NULL;
+    self->key_buf_cap = 0;
+    self->groups = NULL;
+    self->accums = NULL;
+    self->group_count = 0;
+    self->group_capacity = 0;
+    self->slot_count = 16;
+    self->records = 0;
+    self->bad_records = 0;
+    self->slots = json_alloc(self->allocator, sizeof(size_t) * self->slot_count);
+    memset(&self->tokens, 0, sizeof(TokenVec)); // a worker's copy still points at the job owner's tape
+
+    if (!TokenVec_Init(&self->tokens, 64, self->allocator))
+    {
+        json_free(self->allocator, self->slots);
+        self->slots = NULL;
+        return 0;
+    }
+
+    if (self->field_count > 0)
+        self->values = json_alloc(self->allocator, sizeof(Token*) * self->field_count);
+
+    if (!self->slots || (self->field_count > 0 && !self->values))
+        return 0;
+
+    for (size_t i = 0; i < self->slot_count; i++)
+        self->slots[i] = AGG_NONE;
+
+    return 1;
+}
+
+/// Records:
+
+/**
+ * @brief Reads a numeric literal in place. Short integers are accumulated digit by digit, like JsonGen_Int, and only longer ones and floats go through Token_ToNum.
+ *
+ * @return int 1 for a number, 0 if the token is not one, or -1 if memory ran out copying an overlong literal.
+ */
+static int agg_number(const Token *value, const char *src, const JsonAllocator *allocator, double *out)
+{
+    if (value->type == INT_LTRL && value->span <= AGG_DIGITS_EXACT)
+    {
+        const char *digit = src + value->begin;
+        const char *end = digit + value->span;
+        int negative = (*digit == '-');
+        int64_t result = 0;
+
+        for (digit += negative; digit < end; digit++)
+            result = result * 10 + (*digit - '0');
+
+        *out = (double)(negative ? -result : result);
+
+        return 1;
+    }
+    else if (value->type == INT_LTRL || value->type == FLT_LTRL)
+        return Token_ToNum(value, src, allocator, NULL, out) ? 1 : -1;
+
+    return 0;
+}
+
+static size_t agg_step(Aggregator *self, size_t node, const Token *key, const char *src)
+{
+    if (key->flags & TOKEN_ESCAPED)
+        return agg_find_child(self, node, self->key_buf, Token_DecodeTxt(key, src, self->key_buf));
+
+    return agg_find_child(self, node, src + key->begin, key->span);
+}
+
+/**
+ * @brief Walks the value at *pos for a trie node, noting the value of each field on the way, and steps *pos past it. Only Objects with paths through them are entered, and everything else is stepped over whole.
+ *
+ * @return int 0 if the walked part is malformed.
+ */
+static int agg_walk(Aggregator *self, const char *src, size_t *pos, size_t node)
+{
+    const Token *tape = self->tokens.data;
+    size_t count = self->tokens.count;
+    size_t idx = *pos;
+
+    if (idx >= count)
+        return 0;
+
+    if (self->nodes[node].field != AGG_NONE)
+        self->values[self->nodes[node].field] = tape + idx;
+
+    if (tape[idx].type != LCURLY || self->nodes[node].first_child == AGG_NONE)
+        return JsonGen_Skip(&self->tokens, pos) == NO_ERR;
+
+    if (++idx < count && tape[idx].type == RCURLY)
+    {
+        *pos = idx + 1;
+        return 1;
+    }
+
+    while (1)
+    {
+        if (idx + 1 >= count || tape[idx].type != STRBODY || tape[idx + 1].type != COLON)
+            return 0;
+
+        size_t child = agg_step(self, node, tape + idx, src);
+
+        idx += 2;
+
+        if (child == AGG_NONE && JsonGen_Skip(&self->tokens, &idx) != NO_ERR)
+            return 0;
+        else if (child != AGG_NONE && !agg_walk(self, src, &idx, child))
+            return 0;
+
+        if (idx >= count)
+            return 0;
+        else if (tape[idx].type == RCURLY)
+            break;
+        else if (tape[idx].type != COMMA)
+            return 0;
+
+        idx++;
+    }
+
+    *pos = idx + 1;
+
+    return 1;
+}
+
+static uint64_t agg_hash_key(const char *key, size_t key_len, DataType key_type)
+{
+    uint64_t hash = 14695981039346656037ULL ^ (uint64_t)key_type;
+
+    for (size_t i = 0; i < key_len; i++)
+        hash = (hash ^ (unsigned char)key[i]) * 1099511628211ULL;
+
+    return hash;
+}
+
+static int agg_grow_slots(Aggregator *self)
+{
+    size_t new_count = self->slot_count << 1;
+    size_t *new_slots = json_alloc(self->allocator, sizeof(size_t) * new_count);
+
+    if (!new_slots)
+        return 0;
+
+    for (size_t i = 0; i < new_count; i++)
+        new_slots[i] = AGG_NONE;
+
+    for (size_t group = 0; group < self->group_count; group++)
+    {
+        size_t slot = self->groups[group].hash & (new_count - 1);
+
+        while (new_slots[slot] != AGG_NONE)
+            slot = (slot + 1) & (new_count - 1);
+
+        new_slots[slot] = group;
+    }
+
+    json_free(self->allocator, self->slots);
+    self->slots = new_slots;
+    self->slot_count = new_count;
+
+    return 1;
+}
+
+/**
+ * @brief Finds a group by key, adding it with empty totals if it is new.
+ *
+ * @return size_t The group, or AGG_NONE if memory ran out.
+ */
+static size_t agg_find_group(Aggregator *self, const char *key, size_t key_len, DataType key_type)
+{
+    uint64_t hash = agg_hash_key(key, key_len, key_type);
+    size_t mask = self->slot_count - 1;
+    size_t slot = hash & mask;
+
+    for (; self->slots[slot] != AGG_NONE; slot = (slot + 1) & mask)
+    {
+        const AggGroup *group = self->groups + self->slots[slot];
+
+        if (group->hash == hash && group->key_type == key_type && group->key_len == key_len && memcmp(group->key, key, key_len) == 0)
+            return self->slots[slot];
+    }
+
+    if (self->group_count == self->group_capacity)
+    {
+        size_t new_capacity = (self->group_capacity > 0) ? self->group_capacity << 1 : 8;
+        AggGroup *new_groups = json_realloc(self->allocator, self->groups, sizeof(AggGroup) * new_capacity);
+
+        if (!new_groups)
+            return AGG_NONE;
+
+        self->groups = new_groups;
+
+        if (self->field_count > 0)
+        {
+            AggAccum *new_accums = json_realloc(self->allocator, self->accums, sizeof(AggAccum) * self->field_count * new_capacity);
+
+            if (!new_accums)
+                return AGG_NONE;
+
+            self->accums = new_accums;
+        }
+
+        self->group_capacity = new_capacity;
+    }
+
+    AggGroup *group = self->groups + self->group_count;
+
+    group->key = json_alloc(self->allocator, key_len + 1);
+
+    if (!group->key)
+        return AGG_NONE;
+
+    memcpy(group->key, key, key_len);
+    group->key[key_len] = '\0';
+    group->key_len = key_len;
+    group->key_type = key_type;
+    group->hash = hash;
+    group->records = 0;
+
+    for (size_t field = 0; field < self->field_count; field++)
+    {
+        AggAccum *accum = self->accums + self->group_count * self->field_count + field;
+
+        accum->present = 0;
+        accum->count = 0;
+        accum->sum = 0.0;
+        accum->min = 0.0;
+        accum->max = 0.0;
+    }
+
+    self->slots[slot] = self->group_count++;
+
+    // keep the table at most half full
+    if (self->group_count * 2 > self->slot_count && !agg_grow_slots(self))
+    {
+        self->slots[slot] = AGG_NONE;
+        json_free(self->allocator, group->key);
+        self->group_count--;
+        return AGG_NONE;
+    }
+
+    return self->group_count - 1;
+}
+
+/**
+ * @brief Finds the group of the current record from its group field's value.
+ */
+static size_t agg_record_group(Aggregator *self, const char *src)
+{
+    const Token *value = (self->group_field != AGG_NONE) ? self->values[self->group_field] : NULL;
+    const char *key = "";
+    size_t key_len = 0;
+    DataType key_type = (self->group_field != AGG_NONE) ? NUL : UNSUPPORTED;
+
+    if (value != NULL)
+    {
+        switch (value->type)
+        {
+        case STRBODY:
+            key_type = STR;
+            break;
+        case INT_LTRL:
+            key_type = INT;
+            break;
+        case FLT_LTRL:
+            key_type = FLT;
+            break;
+        case TRUE_LTRL:
+        case FALSE_LTRL:
+            key_type = BOOL;
+            break;
+        case LCURLY:
+            key_type = OBJ;
+            break;
+        case LBRACKET:
+            key_type = ARR;
+            break;
+        default:
+            break;
+        }
+
+        if (key_type == STR && (value->flags & TOKEN_ESCAPED))
+        {
+            key_len = Token_DecodeTxt(value, src, self->key_buf);
+            key = self->key_buf;
+        }
+        else if (key_type == STR || key_type == INT || key_type == FLT || key_type == BOOL)
+        {
+            key = src + value->begin;
+            key_len = value->span;
+        }
+    }
+
+    return agg_find_group(self, key, key_len, key_type);
+}
+
+static void agg_accum_add(AggAccum *accum, double number)
+{
+    if (accum->count == 0 || number < accum->min)
+        accum->min = number;
+
+    if (accum->count == 0 || number > accum->max)
+        accum->max = number;
+
+    accum->sum += number;
+    accum->count++;
+}
+
+/**
+ * @brief Lexes one line into the tape, walks it once and adds its values to its group's totals.
+ *
+ * @return int NO_ERR, including for malformed records, or OUT_OF_MEMORY_ERR.
+ */
+static int agg_record(Aggregator *self, char *line, size_t len)
+{
+    Lexer lexer;
+    size_t pos = 0;
+
+    // escaped keys and values decode into key_buf, and never outgrow the line
+    if (len + 1 > self->key_buf_cap)
+    {
+        char *temp = json_realloc(self->allocator, self->key_buf, len + 1);
+
+        if (!temp)
+            return OUT_OF_MEMORY_ERR;
+
+        self->key_buf = temp;
+        self->key_buf_cap = len + 1;
+    }
+
+    TokenVec_Clear(&self->tokens);
+    Lexer_Init(&lexer, line, len, self->allocator);
+    Lexer_Lex_Into(&lexer, &self->tokens);
+
+    if (lexer.out_of_memory)
+        return OUT_OF_MEMORY_ERR;
+    else if (self->tokens.count == 0)
+        return NO_ERR; // blank line
+
+    for (size_t field = 0; field < self->field_count; field++)
+        self->values[field] = NULL;
+
+    if (self->tokens.data[0].type != LCURLY || !agg_walk(self, line, &pos, 0) || pos != self->tokens.count)
+    {
+        self->bad_records++;
+        return NO_ERR;
+    }
+
+    size_t group = agg_record_group(self, line);
+
+    if (group == AGG_NONE)
+        return OUT_OF_MEMORY_ERR;
+
+    AggAccum *accums = self->accums + group * self->field_count;
+    double number = 0.0;
+
+    self->records++;
+    self->groups[group].records++;
+
+    for (size_t field = 0; field < self->field_count; field++)
+    {
+        const Token *value = self->values[field];
+
+        if (!value || value->type == NULL_LTRL)
+            continue;
+
+        accums[field].present++;
+
+        int is_number = agg_number(value, line, self->allocator, &number);
+
+        if (is_number < 0)
+            return OUT_OF_MEMORY_ERR;
+        else if (is_number)
+            agg_accum_add(accums + field, number);
+    }
+
+    return NO_ERR;
+}
+
+static void *agg_run_task(void *arg)
+{
+    AggTask *task = (AggTask*)arg;
+
+    task->err = Aggregator_Feed(&task->worker, task->src, task->len);
+
+    return NULL;
+}
+
+/// Aggregator:
+
+Aggregator *Aggregator_Create(const char *group_path, const AggSpec *specs, size_t spec_count, const JsonAllocator *allocator)
+{
+    Aggregator *result = json_alloc(allocator, sizeof(Aggregator));
+
+    if (!result)
+        return NULL;
+
+    memset(result, 0, sizeof(Aggregator));
+    result->allocator = allocator;
+    result->owns_job = 1;
+    result->group_field = AGG_NONE;
+    result->spec_count = spec_count;
+    result->spec_fields = json_alloc(allocator, sizeof(size_t) * (spec_count + 1));
+    result->spec_funcs = json_alloc(allocator, sizeof(AggFunc) * (spec_count + 1));
+
+    if (!result->spec_fields || !result->spec_funcs || agg_add_node(result, NULL, 0) == AGG_NONE)
+        goto create_failed;
+
+    if (group_path != NULL && (result->group_field = agg_add_path(result, group_path)) == AGG_NONE)
+        goto create_failed;
+
+    for (size_t spec = 0; spec < spec_count; spec++)
+    {
+        result->spec_funcs[spec] = specs[spec].func;
+        result->spec_fields[spec] = AGG_NONE;
+
+        if (specs[spec].path != NULL && (result->spec_fields[spec] = agg_add_path(result, specs[spec].path)) == AGG_NONE)
+            goto create_failed;
+    }
+
+    if (!agg_init_state(result))
+        goto create_failed;
+
+    return result;
+
+create_failed:
+    Aggregator_Destroy(result);
+    json_free(allocator, result);
+    return NULL;
+}
+
+void Aggregator_Destroy(Aggregator *self)
+{
+    if (self->owns_job)
+    {
+        for (size_t node = 0; node < self->node_count; node++)
+            json_free(self->allocator, self->nodes[node].key);
+
+        json_free(self->allocator, self->nodes);
+        json_free(self->allocator, self->spec_fields);
+        json_free(self->allocator, self->spec_funcs);
+    }
+
+    for (size_t group = 0; group < self->group_count; group++)
+        json_free(self->allocator, self->groups[group].key);
+
+    if (self->tokens.data != NULL)
+        TokenVec_Destroy(&self->tokens);
+
+    json_free(self->allocator, self->values);
+    json_free(self->allocator, self->key_buf);
+    json_free(self->allocator, self->groups);
+    json_free(self->allocator, self->accums);
+    json_free(self->allocator, self->slots);
+    self->nodes = NULL;
+    self->node_count = 0;
+    self->spec_fields = NULL;
+    self->spec_funcs = NULL;
+    self->groups = NULL;
+    self->accums = NULL;
+    self->slots = NULL;
+    self->group_count = 0;
+}
+
+int Aggregator_Feed(Aggregator *self, char *src, size_t len)
+{
+    size_t line_start = 0;
+
+    while (line_start < len)
+    {
+        const char *newline = memchr(src + line_start, '\n', len - line_start);
+        size_t line_end = (newline != NULL) ? (size_t)(newline - src) : len;
+
+        if (agg_record(self, src + line_start, line_end - line_start) != NO_ERR)
+            return OUT_OF_MEMORY_ERR;
+
+        line_start = line_end + 1;
+    }
+
+    return NO_ERR;
+}
+
+int Aggregator_Run(Aggregator *self, char *src, size_t len, size_t thread_count)
+{
+    if (thread_count <= 1 || len < thread_count)
+        return Aggregator_Feed(self, src, len);
+
+    AggTask *tasks = json_alloc(self->allocator, sizeof(AggTask) * thread_count);
+    size_t start = 0;
+    size_t ready = 0;
+    int err = NO_ERR;
+
+    if (!tasks)
+        return OUT_OF_MEMORY_ERR;
+
+    for (; ready < thread_count; ready++)
+    {
+        AggTask *task = tasks + ready;
+        size_t end = (ready + 1 < thread_count) ? len / thread_count * (ready + 1) : len;
+
+        // each part ends just after a newline, so no record is split
+        if (end < start)
+            end = start;
+
+        if (end < len)
+        {
+            const char *newline = memchr(src + end, '\n', len - end);
+            end = (newline != NULL) ? (size_t)(newline - src) + 1 : len;
+        }
+
+        task->worker = *self;
+        task->worker.owns_job = 0;
+        task->src = src + start;
+        task->len = end - start;
+        task->err = NO_ERR;
+        task->started = 0;
+        start = end;
+
+        if (!agg_init_state(&task->worker))
+        {
+            Aggregator_Destroy(&task->worker);
+            err = OUT_OF_MEMORY_ERR;
+            break;
+        }
+
+        task->started = (pthread_create(&task->thread, NULL, agg_run_task, task) == 0);
+
+        if (!task->started)
+            agg_run_task(task); // no thread to spare, so this part runs here
+    }
+
+    // merging in part order keeps groups in the order the input first shows them
+    for (size_t i = 0; i < ready; i++)
+    {
+        if (tasks[i].started)
+            pthread_join(tasks[i].thread, NULL);
+
+        if (err == NO_ERR)
+            err = (tasks[i].err != NO_ERR) ? tasks[i].err : Aggregator_Merge(self, &tasks[i].worker);
+
+        Aggregator_Destroy(&tasks[i].worker);
+    }
+
+    json_free(self->allocator, tasks);
+
+    return err;
+}
+
+int Aggregator_RunFile(Aggregator *self, const char *path, size_t thread_count)
+{
+    JsonInput *input = JsonInput_Open(path, self->allocator);
+    size_t capacity = (size_t)AGG_BLOCK_SIZE * ((thread_count > 1) ? thread_count : 1);
+    char *buf = (input != NULL) ? json_alloc(self->allocator, capacity) : NULL;
+    size_t filled = 0;
+    int err = NO_ERR;
+
+    if (!input)
+        return INPUT_ERR;
+    else if (!buf)
+        err = OUT_OF_MEMORY_ERR;
+
+    while (err == NO_ERR)
+    {
+        size_t got = JsonInput_Read(input, buf + filled, capacity - filled);
+
+        filled += got;
+
+        if (got == 0)
+        {
+            if (JsonInput_Get_ErrCode(input) != NO_ERR)
+                err = INPUT_ERR;
+            else if (filled > 0)
+                err = Aggregator_Run(self, buf, filled, thread_count);
+
+            break;
+        }
+        else if (filled < capacity)
+            continue;
+
+        // run the complete lines of a full buffer and carry the partial last one over
+        size_t cut = filled;
+
+        while (cut > 0 && buf[cut - 1] != '\n')
+            cut--;
+
+        if (cut == 0)
+        {
+            // one line fills the whole buffer
+            char *temp = json_realloc(self->allocator, buf, capacity << 1);
+
+            if (!temp)
+                err = OUT_OF_MEMORY_ERR;
+            else
+            {
+                buf = temp;
+                capacity <<= 1;
+            }
+
+            continue;
+        }
+
+        err = Aggregator_Run(self, buf, cut, thread_count);
+        memmove(buf, buf + cut, filled - cut);
+        filled -= cut;
+    }
+
+    JsonInput_Destroy(input);
+    json_free(self->allocator, input);
+    json_free(self->allocator, buf);
+
+    return err;
+}
+
+int Aggregator_Merge(Aggregator *self, const Aggregator *other)
+{
+    for (size_t other_group = 0; other_group < other->group_count; other_group++)
+    {
+        const AggGroup *from = other->groups + other_group;
+        size_t group = agg_find_group(self, from->key, from->key_len, from->key_type);
+
+        if (group == AGG_NONE)
+            return OUT_OF_MEMORY_ERR;
+
+        self->groups[group].records += from->records;
+
+        for (size_t field = 0; field < self->field_count; field++)
+        {
+            AggAccum *into = self->accums + group * self->field_count + field;
+            const AggAccum *part = other->accums + other_group * other->field_count + field;
+
+            into->present += part->present;
+
+            if (part->count == 0)
+                continue;
+
+            if (into->count == 0 || part->min < into->min)
+                into->min = part->min;
+
+            if (into->count == 0 || part->max > into->max)
+                into->max = part->max;
+
+            into->sum += part->sum;
+            into->count += part->count;
+        }
+    }
+
+    self->records += other->records;
+    self->bad_records += other->bad_records;
+
+    return NO_ERR;
+}
+
+size_t Aggregator_GroupCount(const Aggregator *self) { return self->group_count; }
+
+const AggGroup *Aggregator_Group(const Aggregator *self, size_t group) { return (group < self->group_count) ? self->groups + group : NULL; }
+
+double Aggregator_Result(const Aggregator *self, size_t group, size_t spec)
+{
+    size_t field = self->spec_fields[spec];
+
+    if (field == AGG_NONE)
+        return (double)self->groups[group].records;
+
+    const AggAccum *accum = self->accums + group * self->field_count + field;
+
+    switch (self->spec_funcs[spec])
+    {
+    case AGG_COUNT:
+        return (double)accum->present;
+    case AGG_SUM:
+        return accum->sum;
+    case AGG_MIN:
+        return (accum->count > 0) ? accum->min : NAN;
+    case AGG_MAX:
+        return (accum->count > 0) ? accum->max : NAN;
+    case AGG_MEAN:
+        return (accum->count > 0) ? accum->sum / (double)accum->count : NAN;
+    default:
+        return NAN;
+    }
+}
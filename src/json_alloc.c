@@ -0,0 +1,55 @@
+/**
+ * @file json_alloc.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Implements the default allocator and the allocation helpers every constructor goes through.
+ * @date 2026-10-19
+ */
+
+#include <stdlib.h>
+#include "json_alloc.h"
+#include "json_stats.h"
+
+static void *libc_alloc(void *ctx, size_t size) { return malloc(size); }
+static void *libc_realloc(void *ctx, void *ptr, size_t size) { return realloc(ptr, size); }
+static void libc_free(void *ctx, void *ptr) { free(ptr); }
+
+static const JsonAllocator libc_allocator = {libc_alloc, libc_realloc, libc_free, NULL};
+
+const JsonAllocator *JsonAllocator_Default() { return &libc_allocator; }
+
+void *json_alloc(const JsonAllocator *allocator, size_t size)
+{
+    if (!allocator)
+        allocator = &libc_allocator;
+
+    void *result = allocator->alloc(allocator->ctx, size);
+
+    if (result != NULL)
+        JSON_STATS_ALLOC(size);
+
+    return result;
+}
+
+void *json_realloc(const JsonAllocator *allocator, void *ptr, size_t size)
+{
+    if (!allocator)
+        allocator = &libc_allocator;
+
+    void *result = allocator->realloc(allocator->ctx, ptr, size);
+
+    if (result != NULL)
+        JSON_STATS_ALLOC(size);
+
+    return result;
+}
+
+void json_free(const JsonAllocator *allocator, void *ptr)
+{
+    if (!ptr)
+        return;
+
+    if (!allocator)
+        allocator = &libc_allocator;
+
+    allocator->free(allocator->ctx, ptr);
+}
@@ -0,0 +1,147 @@
+/**
+ * @file json_arena.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Implements the bump allocating arena.
+ * @date 2026-10-19
+ */
+
+#include <string.h>
+#include "json_arena.h"
+
+#define ARENA_ALIGN (_Alignof(max_align_t))
+
+static size_t arena_align_up(size_t n) { return (n + (ARENA_ALIGN - 1)) & ~(ARENA_ALIGN - 1); }
+
+static ArenaBlock *arena_new_block(JsonArena *self, size_t min_size)
+{
+    size_t capacity = (min_size > self->block_size) ? min_size : self->block_size;
+    ArenaBlock *block = json_alloc(self->base, sizeof(ArenaBlock) + capacity);
+
+    if (!block)
+        return block;
+
+    block->next = NULL;
+    block->capacity = capacity;
+    block->used = 0;
+
+    return block;
+}
+
+static void *arena_alloc(void *ctx, size_t size)
+{
+    JsonArena *self = ctx;
+    size_t real_size = arena_align_up(size);
+    ArenaBlock *block = self->current;
+
+    // move through kept blocks first, and only ask the base allocator once they run out
+    while (block != NULL && block->capacity - block->used < real_size)
+    {
+        block = block->next;
+
+        if (block != NULL)
+            block->used = 0; // blocks past the current one hold nothing since the last reset
+    }
+
+    if (!block)
+    {
+        block = arena_new_block(self, real_size);
+
+        if (!block)
+            return NULL;
+
+        if (!self->head)
+            self->head = block;
+        else
+        {
+            // splice the fresh block in after the current one so kept blocks stay reachable
+            block->next = self->current->next;
+            self->current->next = block;
+        }
+    }
+
+    self->current = block;
+
+    void *result = block->data + block->used;
+    block->used += real_size;
+    self->last_ptr = result;
+
+    return result;
+}
+
+static void *arena_realloc(void *ctx, void *ptr, size_t size)
+{
+    JsonArena *self = ctx;
+
+    if (!ptr)
+        return arena_alloc(ctx, size);
+
+    ArenaBlock *block = self->current;
+    size_t offset = (unsigned char*)ptr - block->data;
+
+    // grow the newest allocation in place when its block has room
+    if (ptr == self->last_ptr && offset + size <= block->capacity)
+    {
+        block->used = offset + arena_align_up(size);
+        return ptr;
+    }
+
+    // otherwise find the owning block to bound the copy, since old sizes are not stored
+    ArenaBlock *owner = self->head;
+
+    while (owner != NULL && !((unsigned char*)ptr >= owner->data && (unsigned char*)ptr < owner->data + owner->capacity))
+        owner = owner->next;
+
+    if (!owner)
+        return NULL;
+
+    size_t old_limit = owner->capacity - (size_t)((unsigned char*)ptr - owner->data);
+    void *result = arena_alloc(ctx, size);
+
+    if (result != NULL)
+        memcpy(result, ptr, (size < old_limit) ? size : old_limit);
+
+    return result;
+}
+
+static void arena_free(void *ctx, void *ptr) {}
+
+void JsonArena_Init(JsonArena *self, size_t block_size, const JsonAllocator *base)
+{
+    self->allocator.alloc = arena_alloc;
+    self->allocator.realloc = arena_realloc;
+    self->allocator.free = arena_free;
+    self->allocator.ctx = self;
+    self->base = base;
+    self->head = NULL;
+    self->current = NULL;
+    self->block_size = (block_size > 0) ? block_size : ARENA_BLOCK_SIZE;
+    self->last_ptr = NULL;
+}
+
+void JsonArena_Reset(JsonArena *self)
+{
+    self->current = self->head;
+    self->last_ptr = NULL;
+
+    if (self->head != NULL)
+        self->head->used = 0;
+}
+
+void JsonArena_Destroy(JsonArena *self)
+{
+    ArenaBlock *target = self->head;
+    ArenaBlock *next = NULL;
+
+    while (target != NULL)
+    {
+        next = target->next;
+        json_free(self->base, target);
+        target = next;
+    }
+
+    self->head = NULL;
+    self->current = NULL;
+    self->last_ptr = NULL;
+}
+
+const JsonAllocator *JsonArena_Allocator(JsonArena *self) { return &self->allocator; }
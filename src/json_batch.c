@@ -0,0 +1,467 @@
+/**
+ * @file json_batch.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Implements the batch loader over io_uring, with a blocking fallback.
+ * @date 2026-10-19
+ */
+
+#define _GNU_SOURCE // for syscall() and MAP_POPULATE under -std=c11
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "json_batch.h"
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define BATCH_URING 1
+#endif
+
+/// Kind of operation in the low bits of an entry's user_data, above them is the slot index.
+enum batch_op {
+    BATCH_OPEN,
+    BATCH_READ,
+    BATCH_CLOSE
+};
+
+#define BATCH_OP_BITS 2
+#define BATCH_OP_MASK 3
+
+/// Helpers:
+
+static int batch_is_compressed(const char *buf, size_t len)
+{
+    const unsigned char *bytes = (const unsigned char*)buf;
+
+    return (len >= 2 && bytes[0] == 0x1f && bytes[1] == 0x8b) || (len >= 4 && bytes[0] == 0x28 && bytes[1] == 0xb5 && bytes[2] == 0x2f && bytes[3] == 0xfd);
+}
+
+/**
+ * @brief Parses a slot's file once its read completed and hands the result to the callback.
+ *
+ * @param got Bytes read, or a negative errno.
+ * @return int 1 if the file parsed without error.
+ */
+static int batch_finish(JsonBatch *self, BatchSlot *slot, const char *path, long got, BatchCallback on_doc, void *user)
+{
+    JsonThing *doc = NULL;
+    int err_code = INPUT_ERR;
+
+    // a full buffer means the file may go on past it
+    if (got >= 0 && (size_t)got < self->buffer_size && !batch_is_compressed(slot->buf, (size_t)got))
+    {
+        slot->buf[got] = '\0';
+        doc = ParseContext_Parse(self->context, slot->buf, (size_t)got);
+        err_code = ParseContext_Get_ErrCode(self->context);
+    }
+
+    on_doc(user, slot->index, path, doc, err_code);
+    slot->index = BATCH_NO_FILE;
+
+    return err_code == NO_ERR;
+}
+
+static size_t batch_run_blocking(JsonBatch *self, const char *const *paths, size_t count, BatchCallback on_doc, void *user)
+{
+    BatchSlot *slot = self->slots;
+    size_t parsed = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        long got = -1;
+        int fd = open(paths[i], O_RDONLY | O_CLOEXEC);
+
+        slot->index = i;
+
+        if (fd >= 0)
+        {
+            ssize_t step = 0;
+
+            got = 0;
+
+            while ((size_t)got < self->buffer_size && (step = read(fd, slot->buf + got, self->buffer_size - got)) > 0)
+                got += step;
+
+            if (step < 0)
+                got = -1;
+
+            close(fd);
+        }
+
+        parsed += batch_finish(self, slot, paths[i], got, on_doc, user);
+    }
+
+    return parsed;
+}
+
+#ifdef BATCH_URING
+
+static int batch_ring_supports(int ring_fd)
+{
+    static const unsigned char needed_ops[] = {IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_READ_FIXED, IORING_OP_CLOSE};
+    size_t probe_len = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = calloc(1, probe_len);
+    int supported = 0;
+
+    if (!probe)
+        return 0;
+
+    // kernels before the probe call also lack some of the ops
+    if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, 256) == 0)
+    {
+        supported = 1;
+
+        for (size_t i = 0; i < sizeof(needed_ops); i++)
+        {
+            if (needed_ops[i] > probe->last_op || !(probe->ops[needed_ops[i]].flags & IO_URING_OP_SUPPORTED))
+                supported = 0;
+        }
+    }
+
+    free(probe);
+
+    return supported;
+}
+
+static void batch_ring_close(JsonBatch *self)
+{
+    if (self->sqes != NULL)
+        munmap(self->sqes, self->sqes_len);
+
+    if (self->cq_map != NULL && self->cq_map != self->sq_map)
+        munmap(self->cq_map, self->cq_map_len);
+
+    if (self->sq_map != NULL)
+        munmap(self->sq_map, self->sq_map_len);
+
+    if (self->ring_fd >= 0)
+        close(self->ring_fd);
+
+    self->sqes = NULL;
+    self->cq_map = NULL;
+    self->sq_map = NULL;
+    self->ring_fd = -1;
+    self->fixed_buffers = 0;
+}
+
+/**
+ * @brief Sets up the ring and registers the slot buffers. Leaves ring_fd at -1 if io_uring cannot be used.
+ */
+static void batch_ring_open(JsonBatch *self)
+{
+    struct io_uring_params params;
+
+    memset(&params, 0, sizeof(params));
+    self->ring_fd = (int)syscall(__NR_io_uring_setup, (unsigned)(self->depth * 2), &params);
+
+    if (self->ring_fd < 0)
+    {
+        self->ring_fd = -1;
+        return;
+    }
+
+    if (!batch_ring_supports(self->ring_fd))
+    {
+        batch_ring_close(self);
+        return;
+    }
+
+    self->sq_entries = params.sq_entries;
+    self->sq_map_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    self->cq_map_len = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+    // newer kernels map both rings at once
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (self->cq_map_len > self->sq_map_len)
+            self->sq_map_len = self->cq_map_len;
+
+        self->cq_map_len = self->sq_map_len;
+    }
+
+    self->sq_map = mmap(NULL, self->sq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, self->ring_fd, IORING_OFF_SQ_RING);
+
+    if (self->sq_map == MAP_FAILED)
+    {
+        self->sq_map = NULL;
+        batch_ring_close(self);
+        return;
+    }
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        self->cq_map = self->sq_map;
+    else
+    {
+        self->cq_map = mmap(NULL, self->cq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, self->ring_fd, IORING_OFF_CQ_RING);
+
+        if (self->cq_map == MAP_FAILED)
+        {
+            self->cq_map = NULL;
+            batch_ring_close(self);
+            return;
+        }
+    }
+
+    self->sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+    self->sqes = mmap(NULL, self->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, self->ring_fd, IORING_OFF_SQES);
+
+    if (self->sqes == MAP_FAILED)
+    {
+        self->sqes = NULL;
+        batch_ring_close(self);
+        return;
+    }
+
+    char *sq_ring = self->sq_map;
+    char *cq_ring = self->cq_map;
+
+    self->sq_head = (unsigned*)(sq_ring + params.sq_off.head);
+    self->sq_tail = (unsigned*)(sq_ring + params.sq_off.tail);
+    self->sq_mask = (unsigned*)(sq_ring + params.sq_off.ring_mask);
+    self->sq_array = (unsigned*)(sq_ring + params.sq_off.array);
+    self->cq_head = (unsigned*)(cq_ring + params.cq_off.head);
+    self->cq_tail = (unsigned*)(cq_ring + params.cq_off.tail);
+    self->cq_mask = (unsigned*)(cq_ring + params.cq_off.ring_mask);
+    self->cqes = cq_ring + params.cq_off.cqes;
+
+    // registered buffers stay pinned, so reads into them skip the per-read page lookup; past RLIMIT_MEMLOCK plain reads are used
+    struct iovec *iovs = json_alloc(self->allocator, sizeof(struct iovec) * self->depth);
+
+    if (iovs != NULL)
+    {
+        for (size_t i = 0; i < self->depth; i++)
+        {
+            iovs[i].iov_base = self->slots[i].buf;
+            iovs[i].iov_len = self->buffer_size;
+        }
+
+        self->fixed_buffers = syscall(__NR_io_uring_register, self->ring_fd, IORING_REGISTER_BUFFERS, iovs, (unsigned)self->depth) == 0;
+        json_free(self->allocator, iovs);
+    }
+}
+
+/**
+ * @brief Fills the next submission entry. At most one open or read per slot and depth closes are in flight, which the ring always has room for.
+ *
+ * @param path The file to open, only for BATCH_OPEN.
+ */
+static void batch_queue(JsonBatch *self, size_t slot_idx, enum batch_op op, const char *path)
+{
+    unsigned tail = *self->sq_tail + self->sq_pending;
+    unsigned entry = tail & *self->sq_mask;
+    struct io_uring_sqe *sqe = (struct io_uring_sqe*)self->sqes + entry;
+    BatchSlot *slot = self->slots + slot_idx;
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->user_data = ((uint64_t)slot_idx << BATCH_OP_BITS) | op;
+
+    switch (op)
+    {
+    case BATCH_OPEN:
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (uint64_t)(uintptr_t)path;
+        sqe->open_flags = O_RDONLY | O_CLOEXEC;
+        break;
+    case BATCH_READ:
+        sqe->opcode = self->fixed_buffers ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe->fd = slot->fd;
+        sqe->addr = (uint64_t)(uintptr_t)slot->buf;
+        sqe->len = (unsigned)self->buffer_size;
+        sqe->off = 0;
+        sqe->buf_index = (unsigned short)slot_idx;
+        break;
+    case BATCH_CLOSE:
+        sqe->opcode = IORING_OP_CLOSE;
+        sqe->fd = slot->fd;
+        sqe->user_data = BATCH_CLOSE; // the slot moves on to another file before the close completes
+        slot->fd = -1;
+        self->closing++;
+        break;
+    }
+
+    self->sq_array[entry] = entry;
+    self->sq_pending++;
+}
+
+static size_t batch_run_uring(JsonBatch *self, const char *const *paths, size_t count, BatchCallback on_doc, void *user)
+{
+    size_t next = 0;
+    size_t finished = 0;
+    size_t parsed = 0;
+
+    while (finished < count || self->closing > 0)
+    {
+        // keep every slot busy while files are left
+        for (size_t i = 0; i < self->depth && next < count; i++)
+        {
+            BatchSlot *slot = self->slots + i;
+
+            if (slot->index != BATCH_NO_FILE)
+                continue;
+
+            slot->index = next++;
+            batch_queue(self, i, BATCH_OPEN, paths[slot->index]);
+        }
+
+        __atomic_store_n(self->sq_tail, *self->sq_tail + self->sq_pending, __ATOMIC_RELEASE);
+        self->sq_pending = 0;
+
+        unsigned to_submit = *self->sq_tail - __atomic_load_n(self->sq_head, __ATOMIC_ACQUIRE);
+
+        if (syscall(__NR_io_uring_enter, self->ring_fd, to_submit, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            break;
+
+        unsigned head = *self->cq_head;
+        unsigned tail = __atomic_load_n(self->cq_tail, __ATOMIC_ACQUIRE);
+
+        for (; head != tail; head++)
+        {
+            const struct io_uring_cqe *cqe = (const struct io_uring_cqe*)self->cqes + (head & *self->cq_mask);
+            enum batch_op op = (enum batch_op)(cqe->user_data & BATCH_OP_MASK);
+            BatchSlot *slot = self->slots + (cqe->user_data >> BATCH_OP_BITS);
+
+            if (op == BATCH_CLOSE)
+            {
+                self->closing--;
+                continue;
+            }
+
+            if (op == BATCH_OPEN && cqe->res >= 0)
+            {
+                slot->fd = cqe->res;
+                batch_queue(self, (size_t)(slot - self->slots), BATCH_READ, NULL);
+                continue;
+            }
+
+            if (op == BATCH_READ)
+            {
+                // regular files only read short at their end, so one read takes the whole file
+                parsed += batch_finish(self, slot, paths[slot->index], cqe->res, on_doc, user);
+
+                if (self->closing < self->depth)
+                    batch_queue(self, (size_t)(slot - self->slots), BATCH_CLOSE, NULL);
+                else
+                {
+                    close(slot->fd);
+                    slot->fd = -1;
+                }
+            }
+            else
+                parsed += batch_finish(self, slot, paths[slot->index], -1, on_doc, user);
+
+            finished++;
+        }
+
+        __atomic_store_n(self->cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    // the ring failed: operations still in flight are dropped with it, so their files are reported as unreadable
+    if (finished < count || self->closing > 0)
+    {
+        for (size_t i = 0; i < self->depth; i++)
+        {
+            BatchSlot *slot = self->slots + i;
+
+            if (slot->fd >= 0)
+            {
+                close(slot->fd);
+                slot->fd = -1;
+            }
+
+            if (slot->index != BATCH_NO_FILE)
+                batch_finish(self, slot, paths[slot->index], -1, on_doc, user);
+        }
+
+        for (; next < count; next++)
+        {
+            self->slots[0].index = next;
+            batch_finish(self, self->slots, paths[next], -1, on_doc, user);
+        }
+
+        batch_ring_close(self);
+    }
+
+    return parsed;
+}
+
+#endif
+
+/// JsonBatch:
+
+JsonBatch *JsonBatch_Create(size_t depth, size_t buffer_size, const JsonAllocator *allocator)
+{
+    JsonBatch *result = json_alloc(allocator, sizeof(JsonBatch));
+
+    if (!result)
+        return result;
+
+    memset(result, 0, sizeof(JsonBatch));
+    result->depth = (depth > 0) ? depth : BATCH_QUEUE_DEPTH;
+    result->buffer_size = (buffer_size > 0) ? buffer_size : BATCH_BUFFER_SIZE;
+    result->ring_fd = -1;
+    result->allocator = allocator;
+    result->slots = json_alloc(allocator, sizeof(BatchSlot) * result->depth);
+    result->buffers = json_alloc(allocator, (result->buffer_size + 1) * result->depth); // +1 for each nul terminator
+    result->context = ParseContext_Create(0, allocator);
+
+    if (!result->slots || !result->buffers || !result->context)
+    {
+        if (result->context != NULL)
+        {
+            ParseContext_Destroy(result->context);
+            json_free(allocator, result->context);
+        }
+
+        json_free(allocator, result->buffers);
+        json_free(allocator, result->slots);
+        json_free(allocator, result);
+
+        return NULL;
+    }
+
+    for (size_t i = 0; i < result->depth; i++)
+    {
+        result->slots[i].buf = result->buffers + i * (result->buffer_size + 1);
+        result->slots[i].index = BATCH_NO_FILE;
+        result->slots[i].fd = -1;
+    }
+
+#ifdef BATCH_URING
+    batch_ring_open(result);
+#endif
+
+    return result;
+}
+
+void JsonBatch_Destroy(JsonBatch *self)
+{
+#ifdef BATCH_URING
+    batch_ring_close(self);
+#endif
+
+    ParseContext_Destroy(self->context);
+    json_free(self->allocator, self->context);
+    json_free(self->allocator, self->buffers);
+    json_free(self->allocator, self->slots);
+    self->context = NULL;
+    self->buffers = NULL;
+    self->slots = NULL;
+}
+
+size_t JsonBatch_Run(JsonBatch *self, const char *const *paths, size_t count, BatchCallback on_doc, void *user)
+{
+#ifdef BATCH_URING
+    if (self->ring_fd >= 0)
+        return batch_run_uring(self, paths, count, on_doc, user);
+#endif
+
+    return batch_run_blocking(self, paths, count, on_doc, user);
+}
+
+int JsonBatch_Uses_Uring(const JsonBatch *self) { return self->ring_fd >= 0; }
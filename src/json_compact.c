@@ -0,0 +1,521 @@
+/**
+ * @file json_compact.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Implements the compact document: a builder over the token tape and the node readers.
+ * @date 2026-10-19
+ */
+
+#include <string.h>
+#include "json_compact.h"
+
+_Static_assert(sizeof(CompactNode) == 16, "CompactNode must stay 16 bytes");
+
+/// Growth state for the pools while building, dropped once they are trimmed.
+typedef struct compact_builder
+{
+    CompactDoc *doc;
+    const char *src;
+    size_t node_cap;
+    size_t strs_cap;
+    size_t keys_cap;
+} CompactBuilder;
+
+/// Helpers:
+
+/**
+ * @brief Makes room for need more elements after len, doubling the capacity.
+ *
+ * @return int 0 if memory ran out or the pool would pass the 32-bit limit.
+ */
+static int compact_reserve(const JsonAllocator *allocator, void **buf, size_t *cap, size_t len, size_t need, size_t elem_size)
+{
+    if (*cap - len >= need)
+        return 1;
+
+    if (len + need >= COMPACT_NONE)
+        return 0;
+
+    size_t new_cap = (*cap > 0) ? *cap << 1 : 64;
+
+    while (new_cap - len < need)
+        new_cap <<= 1;
+
+    if (new_cap > COMPACT_NONE)
+        new_cap = COMPACT_NONE;
+
+    void *temp = json_realloc(allocator, *buf, new_cap * elem_size);
+
+    if (!temp)
+        return 0;
+
+    *buf = temp;
+    *cap = new_cap;
+
+    return 1;
+}
+
+/// FNV-1a over the whole key, as many keys share a long prefix.
+static uint32_t compact_hash(const char *key, size_t len)
+{
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < len; i++)
+        hash = (hash ^ (unsigned char)key[i]) * 16777619u;
+
+    return hash;
+}
+
+/**
+ * @brief Finds the key table slot holding a key, or the empty slot where it would go.
+ */
+static uint32_t compact_probe(const CompactDoc *self, const char *key, size_t len)
+{
+    uint32_t mask = self->key_slot_count - 1;
+    uint32_t slot = compact_hash(key, len) & mask;
+
+    while (self->key_slots[slot] != COMPACT_NONE)
+    {
+        const char *name = self->keys + self->key_slots[slot];
+
+        if (strncmp(name, key, len) == 0 && name[len] == '\0')
+            break;
+
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+static int compact_grow_keys(CompactDoc *self)
+{
+    uint32_t old_count = self->key_slot_count;
+    uint32_t *old_slots = self->key_slots;
+    uint32_t new_count = (old_count > 0) ? old_count << 1 : 64;
+    uint32_t *new_slots = json_alloc(self->allocator, sizeof(uint32_t) * new_count);
+
+    if (!new_slots)
+        return 0;
+
+    memset(new_slots, 0xff, sizeof(uint32_t) * new_count);
+    self->key_slots = new_slots;
+    self->key_slot_count = new_count;
+
+    for (uint32_t i = 0; i < old_count; i++)
+    {
+        if (old_slots[i] != COMPACT_NONE)
+        {
+            const char *name = self->keys + old_slots[i];
+            new_slots[compact_probe(self, name, strlen(name))] = old_slots[i];
+        }
+    }
+
+    json_free(self->allocator, old_slots);
+
+    return 1;
+}
+
+/**
+ * @brief Decodes a key into the spare end of the key pool, then keeps it only if it was not interned yet.
+ *
+ * @return uint32_t The key's pool offset, or COMPACT_NONE if memory ran out.
+ */
+static uint32_t compact_intern(CompactBuilder *builder, const Token *key)
+{
+    CompactDoc *doc = builder->doc;
+
+    if ((doc->key_count + 1) * 2 > doc->key_slot_count && !compact_grow_keys(doc))
+        return COMPACT_NONE;
+
+    if (!compact_reserve(doc->allocator, (void**)&doc->keys, &builder->keys_cap, doc->keys_len, key->span + 1, sizeof(char)))
+        return COMPACT_NONE;
+
+    char *scratch = doc->keys + doc->keys_len;
+    size_t len = Token_DecodeTxt(key, builder->src, scratch);
+    uint32_t slot = 0;
+
+    scratch[len] = '\0';
+    slot = compact_probe(doc, scratch, len);
+
+    if (doc->key_slots[slot] == COMPACT_NONE)
+    {
+        doc->key_slots[slot] = doc->keys_len;
+        doc->keys_len += (uint32_t)len + 1;
+        doc->key_count++;
+    }
+
+    return doc->key_slots[slot];
+}
+
+/**
+ * @brief Stores a string value in its node when it fits in 8 chars, or in the string pool.
+ *
+ * @return int 0 if memory ran out or the string is too long.
+ */
+static int compact_set_str(CompactBuilder *builder, CompactNode *node, const Token *value)
+{
+    CompactDoc *doc = builder->doc;
+    size_t len = value->span;
+
+    // plain short text needs no decoding
+    if (!(value->flags & TOKEN_ESCAPED) && len <= COMPACT_INLINE_LEN)
+    {
+        memcpy(node->data.inline_str, builder->src + value->begin, len);
+        node->meta = STR | COMPACT_INLINE_STR | (uint32_t)(len << COMPACT_TAG_BITS);
+        return 1;
+    }
+
+    if (len > COMPACT_MAX_LEN || !compact_reserve(doc->allocator, (void**)&doc->strs, &builder->strs_cap, doc->strs_len, len + 1, sizeof(char)))
+        return 0;
+
+    char *text = doc->strs + doc->strs_len;
+    len = Token_DecodeTxt(value, builder->src, text);
+
+    if (len <= COMPACT_INLINE_LEN)
+    {
+        memcpy(node->data.inline_str, text, len);
+        node->meta = STR | COMPACT_INLINE_STR | (uint32_t)(len << COMPACT_TAG_BITS);
+        return 1;
+    }
+
+    text[len] = '\0';
+    node->data.str = doc->strs_len;
+    node->meta = STR | (uint32_t)(len << COMPACT_TAG_BITS);
+    doc->strs_len += (uint32_t)len + 1;
+
+    return 1;
+}
+
+/**
+ * @brief Appends the node for one value token.
+ *
+ * @return int A ParserErr.
+ */
+static int compact_add_value(CompactBuilder *builder, const Token *value, uint32_t key)
+{
+    CompactDoc *doc = builder->doc;
+    int int_val = 0;
+    double flt_val = 0.0;
+
+    if (!compact_reserve(doc->allocator, (void**)&doc->nodes, &builder->node_cap, doc->node_count, 1, sizeof(CompactNode)))
+        return OUT_OF_MEMORY_ERR;
+
+    CompactNode *node = doc->nodes + doc->node_count;
+
+    node->key = key;
+    node->data.end = 0;
+
+    switch (value->type)
+    {
+    case LBRACKET:
+        node->meta = ARR;
+        break;
+    case LCURLY:
+        node->meta = OBJ;
+        break;
+    case STRBODY:
+        if (!compact_set_str(builder, node, value))
+            return OUT_OF_MEMORY_ERR;
+        break;
+    case INT_LTRL:
+        if (!Token_ToNum(value, builder->src, doc->allocator, &int_val, NULL))
+            return OUT_OF_MEMORY_ERR;
+        node->meta = INT;
+        node->data.i = int_val;
+        break;
+    case FLT_LTRL:
+        if (!Token_ToNum(value, builder->src, doc->allocator, NULL, &flt_val))
+            return OUT_OF_MEMORY_ERR;
+        node->meta = FLT;
+        node->data.f = flt_val;
+        break;
+    case TRUE_LTRL:
+    case FALSE_LTRL:
+        node->meta = BOOL;
+        node->data.i = (value->type == TRUE_LTRL);
+        break;
+    default:
+        node->meta = NUL;
+        break;
+    }
+
+    doc->node_count++;
+
+    return NO_ERR;
+}
+
+/**
+ * @brief Builds the nodes from the token tape with the same state machine as Parser_Validate, so errors match a DOM parse.
+ *
+ * @param open Stack of open container indices, DEFAULT_MAX_DEPTH long.
+ * @return int A ParserErr.
+ */
+static int compact_build(CompactBuilder *builder, const TokenVec *tokens, uint32_t *open)
+{
+    CompactDoc *doc = builder->doc;
+    size_t depth = 0;
+    int in_obj = 0;
+    ParseState state = NEXT_ITEM; // the root takes exactly one value, like an Array after ','
+    uint32_t key = COMPACT_NONE;
+
+    for (size_t idx = 0; ; idx++)
+    {
+        if (idx >= tokens->count)
+        {
+            if (depth == 0 && state == SEPARATOR)
+                return NO_ERR;
+
+            return (depth == 0) ? EMPTY_TOKENS_ERR : UNBALANCED_NEST;
+        }
+
+        const Token *tok = tokens->data + idx;
+        TokenType tok_type = tok->type;
+
+        switch (state)
+        {
+        case FIRST_ITEM:
+        case NEXT_ITEM:
+        case PROP_VALUE:
+            if (tok_type == RBRACKET && state == FIRST_ITEM)
+                goto close_chunk;
+            else if (tok_type == UNKNOWN)
+                return UNKNOWN_TOKEN_ERR;
+            else if (tok_type != STRBODY && !(tok_type >= INT_LTRL && tok_type <= FALSE_LTRL) && tok_type != LBRACKET && tok_type != LCURLY)
+                return UNEXPECTED_TOKEN_ERR;
+
+            if (depth > 0)
+            {
+                CompactNode *parent = doc->nodes + open[depth - 1];
+
+                if ((parent->meta >> COMPACT_TAG_BITS) >= COMPACT_MAX_LEN)
+                    return OUT_OF_MEMORY_ERR;
+
+                parent->meta += 1u << COMPACT_TAG_BITS;
+            }
+
+            int err = compact_add_value(builder, tok, (state == PROP_VALUE) ? key : COMPACT_NONE);
+
+            if (err != NO_ERR)
+                return err;
+
+            if (tok_type == LBRACKET || tok_type == LCURLY)
+            {
+                if (depth >= DEFAULT_MAX_DEPTH)
+                    return DEPTH_LIMIT_ERR;
+
+                in_obj = (tok_type == LCURLY);
+                open[depth++] = doc->node_count - 1;
+                state = in_obj ? FIRST_KEY : FIRST_ITEM;
+            }
+            else
+                state = SEPARATOR;
+            break;
+        case FIRST_KEY:
+        case NEXT_KEY:
+            if (tok_type == RCURLY && state == FIRST_KEY)
+                goto close_chunk;
+            else if (tok_type != STRBODY)
+                return (tok_type == UNKNOWN) ? UNKNOWN_TOKEN_ERR : UNEXPECTED_TOKEN_ERR;
+
+            key = compact_intern(builder, tok);
+
+            if (key == COMPACT_NONE)
+                return OUT_OF_MEMORY_ERR;
+
+            state = PROP_COLON;
+            break;
+        case PROP_COLON:
+            if (tok_type != COLON)
+                return UNEXPECTED_TOKEN_ERR;
+
+            state = PROP_VALUE;
+            break;
+        case SEPARATOR:
+            if (depth == 0)
+                return UNEXPECTED_TOKEN_ERR; // trailing tokens after the root value
+            else if (tok_type == COMMA)
+                state = in_obj ? NEXT_KEY : NEXT_ITEM;
+            else if ((tok_type == RBRACKET && !in_obj) || (tok_type == RCURLY && in_obj))
+                goto close_chunk;
+            else if (tok_type == RBRACKET || tok_type == RCURLY)
+                return UNBALANCED_NEST;
+            else
+                return (tok_type == UNKNOWN) ? UNKNOWN_TOKEN_ERR : UNEXPECTED_TOKEN_ERR;
+            break;
+        default:
+            break;
+        }
+
+        continue;
+
+    close_chunk:
+        depth--;
+        doc->nodes[open[depth]].data.end = doc->node_count;
+        in_obj = (depth > 0) && (doc->nodes[open[depth - 1]].meta & COMPACT_TAG_MASK) == OBJ;
+        state = SEPARATOR;
+    }
+}
+
+/**
+ * @brief Shrinks a pool to its length, keeping the old block if the shrink fails.
+ */
+static void compact_trim(const JsonAllocator *allocator, void **buf, size_t len)
+{
+    if (len == 0)
+    {
+        json_free(allocator, *buf);
+        *buf = NULL;
+        return;
+    }
+
+    void *temp = json_realloc(allocator, *buf, len);
+
+    if (temp != NULL)
+        *buf = temp;
+}
+
+/// CompactDoc:
+
+CompactDoc *CompactDoc_Parse(char *src, size_t len, const JsonAllocator *allocator, int *err_code)
+{
+    CompactDoc *result = json_alloc(allocator, sizeof(CompactDoc));
+    uint32_t *open = json_alloc(allocator, sizeof(uint32_t) * DEFAULT_MAX_DEPTH);
+    TokenVec tokens;
+    Lexer lexer;
+
+    *err_code = OUT_OF_MEMORY_ERR;
+
+    if (!result || !open || !TokenVec_Init(&tokens, 64, allocator))
+    {
+        json_free(allocator, open);
+        json_free(allocator, result);
+        return NULL;
+    }
+
+    memset(result, 0, sizeof(CompactDoc));
+    result->allocator = allocator;
+
+    CompactBuilder builder = {result, src, 0, 0, 0};
+
+    Lexer_Init(&lexer, src, len, allocator);
+    Lexer_Lex_Into(&lexer, &tokens);
+
+    *err_code = lexer.out_of_memory ? OUT_OF_MEMORY_ERR : compact_build(&builder, &tokens, open);
+
+    TokenVec_Destroy(&tokens);
+    json_free(allocator, open);
+
+    if (*err_code != NO_ERR)
+    {
+        CompactDoc_Destroy(result);
+        json_free(allocator, result);
+        return NULL;
+    }
+
+    // growth slack is the largest part of a pool's footprint, so hand it back
+    compact_trim(allocator, (void**)&result->nodes, sizeof(CompactNode) * result->node_count);
+    compact_trim(allocator, (void**)&result->strs, result->strs_len);
+    compact_trim(allocator, (void**)&result->keys, result->keys_len);
+
+    return result;
+}
+
+void CompactDoc_Destroy(CompactDoc *self)
+{
+    json_free(self->allocator, self->nodes);
+    json_free(self->allocator, self->strs);
+    json_free(self->allocator, self->keys);
+    json_free(self->allocator, self->key_slots);
+    self->nodes = NULL;
+    self->strs = NULL;
+    self->keys = NULL;
+    self->key_slots = NULL;
+    self->node_count = 0;
+    self->strs_len = 0;
+    self->keys_len = 0;
+    self->key_slot_count = 0;
+    self->key_count = 0;
+}
+
+size_t CompactDoc_Bytes(const CompactDoc *self)
+{
+    return sizeof(CompactNode) * self->node_count + self->strs_len + self->keys_len + sizeof(uint32_t) * self->key_slot_count;
+}
+
+/// Node Readers:
+
+DataType CompactDoc_Type(const CompactDoc *self, uint32_t node) { return (DataType)(self->nodes[node].meta & COMPACT_TAG_MASK); }
+
+int CompactDoc_Int(const CompactDoc *self, uint32_t node) { return self->nodes[node].data.i; }
+
+float CompactDoc_Float(const CompactDoc *self, uint32_t node) { return self->nodes[node].data.f; }
+
+int CompactDoc_Bool(const CompactDoc *self, uint32_t node) { return self->nodes[node].data.i; }
+
+const char *CompactDoc_Str(const CompactDoc *self, uint32_t node, size_t *len)
+{
+    const CompactNode *target = self->nodes + node;
+
+    *len = target->meta >> COMPACT_TAG_BITS;
+
+    return (target->meta & COMPACT_INLINE_STR) ? target->data.inline_str : self->strs + target->data.str;
+}
+
+const char *CompactDoc_Key(const CompactDoc *self, uint32_t node)
+{
+    uint32_t key = self->nodes[node].key;
+
+    return (key != COMPACT_NONE) ? self->keys + key : NULL;
+}
+
+uint32_t CompactDoc_Count(const CompactDoc *self, uint32_t node)
+{
+    DataType type = CompactDoc_Type(self, node);
+
+    return (type == ARR || type == OBJ) ? self->nodes[node].meta >> COMPACT_TAG_BITS : 0;
+}
+
+uint32_t CompactDoc_Get(const CompactDoc *self, uint32_t object, const char *key)
+{
+    if (CompactDoc_Type(self, object) != OBJ || self->key_count == 0)
+        return COMPACT_NONE;
+
+    // members are matched by interned offset, so each compare is one integer
+    uint32_t key_off = self->key_slots[compact_probe(self, key, strlen(key))];
+    uint32_t result = COMPACT_NONE;
+    uint32_t member = object + 1;
+
+    if (key_off == COMPACT_NONE)
+        return COMPACT_NONE;
+
+    for (uint32_t i = CompactDoc_Count(self, object); i > 0; i--)
+    {
+        if (self->nodes[member].key == key_off)
+            result = member;
+
+        member = CompactDoc_Next(self, member);
+    }
+
+    return result;
+}
+
+uint32_t CompactDoc_At(const CompactDoc *self, uint32_t array, size_t index)
+{
+    if (CompactDoc_Type(self, array) != ARR || index >= CompactDoc_Count(self, array))
+        return COMPACT_NONE;
+
+    uint32_t item = array + 1;
+
+    for (; index > 0; index--)
+        item = CompactDoc_Next(self, item);
+
+    return item;
+}
+
+uint32_t CompactDoc_First(const CompactDoc *self, uint32_t container) { return (CompactDoc_Count(self, container) > 0) ? container + 1 : COMPACT_NONE; }
+
+uint32_t CompactDoc_Next(const CompactDoc *self, uint32_t node)
+{
+    DataType type = CompactDoc_Type(self, node);
+
+    return (type == ARR || type == OBJ) ? self->nodes[node].data.end : node + 1;
+}
@@ -0,0 +1,66 @@
+/**
+ * @file json_context.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Implements the reusable parse context.
+ * @date 2026-10-19
+ */
+
+#include "json_context.h"
+
+ParseContext *ParseContext_Create(size_t arena_block_size, const JsonAllocator *base)
+{
+    ParseContext *result = json_alloc(base, sizeof(ParseContext));
+
+    if (!result)
+        return result;
+
+    result->base = base;
+    JsonArena_Init(&result->arena, arena_block_size, base);
+
+    if (!TokenVec_Init(&result->tokens, 64, base))
+    {
+        json_free(base, result);
+        return NULL;
+    }
+
+    Lexer_Init(&result->lexer, NULL, 0, base);
+    Parser_Init(&result->parser, NULL, &result->tokens, JsonArena_Allocator(&result->arena));
+    result->parser.stack_allocator = base; // the parse stack outlives each document's arena
+
+    return result;
+}
+
+void ParseContext_Destroy(ParseContext *self)
+{
+    TokenVec_Destroy(&self->tokens);
+    Parser_Destroy(&self->parser);
+    JsonArena_Destroy(&self->arena);
+}
+
+void ParseContext_Reset(ParseContext *self)
+{
+    TokenVec_Clear(&self->tokens);
+    JsonArena_Reset(&self->arena);
+    Parser_Reset(&self->parser);
+}
+
+JsonThing *ParseContext_Parse(ParseContext *self, char *src, size_t len)
+{
+    ParseContext_Reset(self);
+
+    Lexer_Init(&self->lexer, src, len, self->base);
+    Lexer_Lex_Into(&self->lexer, &self->tokens);
+
+    Parser_Rebind(&self->parser, src, &self->tokens);
+
+    // a cut short tape could still parse as a shorter document
+    if (self->lexer.out_of_memory)
+    {
+        self->parser.err_code = OUT_OF_MEMORY_ERR;
+        return NULL;
+    }
+
+    return Parser_Start_Parse(&self->parser);
+}
+
+int ParseContext_Get_ErrCode(const ParseContext *self) { return Parser_Get_ErrCode(&self->parser); }
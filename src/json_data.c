@@ -7,15 +7,44 @@
 
 #include "json_data.h"
 
+/// Helpers:
+
+/**
+ * @brief Duplicates a value's string for a copied node, so each owner frees its own.
+ *
+ * @return int 0 if memory ran out.
+ */
+static int data_copy_str(const char *str, char **out, const JsonAllocator *allocator)
+{
+    if (!str)
+    {
+        *out = NULL;
+        return 1;
+    }
+
+    size_t len = strlen(str);
+
+    *out = json_alloc(allocator, len + 1);
+
+    if (!*out)
+        return 0;
+
+    memcpy(*out, str, len + 1);
+
+    return 1;
+}
+
 /// ArrayItem:
 
-ArrayItem *ArrayItem_Int(int value)
+ArrayItem *ArrayItem_Int(int value, const JsonAllocator *allocator)
 {
-    ArrayItem *result = malloc(sizeof(ArrayItem));
+    ArrayItem *result = json_alloc(allocator, sizeof(ArrayItem));
 
     if (!result)
         return result;
 
+    JSON_STATS_ADD(node_count, 1);
+
     result->type = INT;
     result->data.i = value;
     result->next = NULL;
@@ -23,12 +52,14 @@ ArrayItem *ArrayItem_Int(int value)
     return result;
 }
 
-ArrayItem *ArrayItem_Float(float value)
+ArrayItem *ArrayItem_Float(float value, const JsonAllocator *allocator)
 {
-    ArrayItem *result = malloc(sizeof(ArrayItem));
+    ArrayItem *result = json_alloc(allocator, sizeof(ArrayItem));
 
     if (!result)
         return result;
+
+    JSON_STATS_ADD(node_count, 1);
     
     result->type = FLT;
     result->data.f = value;
@@ -37,12 +68,30 @@ ArrayItem *ArrayItem_Float(float value)
     return result;
 }
 
-ArrayItem *ArrayItem_String(char *str)
+ArrayItem *ArrayItem_Bool(int value, const JsonAllocator *allocator)
 {
-    ArrayItem *result = malloc(sizeof(ArrayItem));
+    ArrayItem *result = json_alloc(allocator, sizeof(ArrayItem));
 
     if (!result)
         return result;
+
+    JSON_STATS_ADD(node_count, 1);
+
+    result->type = BOOL;
+    result->data.i = (value != 0);
+    result->next = NULL;
+
+    return result;
+}
+
+ArrayItem *ArrayItem_String(char *str, const JsonAllocator *allocator)
+{
+    ArrayItem *result = json_alloc(allocator, sizeof(ArrayItem));
+
+    if (!result)
+        return result;
+
+    JSON_STATS_ADD(node_count, 1);
     
     result->type = STR;
     result->data.str = str;
@@ -51,13 +100,15 @@ ArrayItem *ArrayItem_String(char *str)
     return result;
 }
 
-ArrayItem *ArrayItem_Chunk(void *chunk, DataType type)
+ArrayItem *ArrayItem_Chunk(void *chunk, DataType type, const JsonAllocator *allocator)
 {
-    ArrayItem *result = malloc(sizeof(ArrayItem));
+    ArrayItem *result = json_alloc(allocator, sizeof(ArrayItem));
 
     if (!result)
         return result;
 
+    JSON_STATS_ADD(node_count, 1);
+
     if (type == ARR || type == OBJ)
     {
         result->data.chunk = chunk;
@@ -74,36 +125,35 @@ ArrayItem *ArrayItem_Chunk(void *chunk, DataType type)
     return result;
 }
 
-void ArrayItem_Destroy(ArrayItem *self)
+void ArrayItem_Destroy(ArrayItem *self, const JsonAllocator *allocator)
 {
     if (self->type == STR && self->data.str != NULL)
     {
-        free(self->data.str);
+        json_free(allocator, self->data.str);
         self->data.str = NULL;
     }
-    else if (self->type == ARR && self->data.chunk != NULL)
-    {
-        Array_Destroy((Array*)self->data.chunk);
-        self->data.chunk = NULL;
-    }
-    else if (self->type == OBJ && self->data.chunk != NULL)
+    else if ((self->type == ARR || self->type == OBJ) && self->data.chunk != NULL)
     {
-        Object_Destroy((Object*)self->data.chunk);
+        Chunk_Release(self->data.chunk, self->type, allocator);
         self->data.chunk = NULL;
     }
 }
 
 /// Array:
 
-Array *Array_Create()
+Array *Array_Create(const JsonAllocator *allocator)
 {
-    Array *result = malloc(sizeof(Array));
+    Array *result = json_alloc(allocator, sizeof(Array));
 
     if (!result)
         return result;
 
+    result->allocator = allocator;
     result->head = NULL;
+    result->tail = NULL;
     result->length = 0;
+    result->refs = 1;
+    result->hash = 0;
     
     return result;
 }
@@ -121,16 +171,53 @@ void Array_Destroy(Array *self)
     {
         next = target->next;
 
-        ArrayItem_Destroy(target);
-        free(target);
+        ArrayItem_Destroy(target, self->allocator);
+        json_free(self->allocator, target);
 
         target = next;
     } while (target != NULL);
     
     self->head = NULL;
+    self->tail = NULL;
     self->length = 0;
 }
 
+Array *Array_Copy(const Array *self)
+{
+    Array *result = Array_Create(self->allocator);
+
+    if (!result)
+        return NULL;
+
+    for (const ArrayItem *item = self->head; item != NULL; item = item->next)
+    {
+        ArrayItem *copy = json_alloc(self->allocator, sizeof(ArrayItem));
+
+        if (!copy)
+            goto copy_failed;
+
+        *copy = *item;
+        copy->next = NULL;
+
+        if (item->type == STR && !data_copy_str(item->data.str, &copy->data.str, self->allocator))
+        {
+            json_free(self->allocator, copy);
+            goto copy_failed;
+        }
+        else if (item->type == ARR || item->type == OBJ)
+            Chunk_Retain(item->data.chunk, item->type);
+
+        Array_Push(result, copy);
+    }
+
+    return result;
+
+copy_failed:
+    Array_Destroy(result);
+    json_free(self->allocator, result);
+    return NULL;
+}
+
 size_t Array_Length(const Array *self) { return self->length; }
 
 const ArrayItem *Array_Get(const Array *self, size_t pos)
@@ -159,40 +246,106 @@ const ArrayItem *Array_Get(const Array *self, size_t pos)
 
 void Array_Push(Array *self, ArrayItem *item)
 {
+    self->hash = 0;
+
     if (self->length < 1)
     {
         // move assign by pointer to avoid extra copies... the item must be allocated prior!
         self->head = item;
+        self->tail = item;
         self->length = 1;
         return;
     }
 
-    ArrayItem *trackPtr = self->head;
+    if (self->tail == item) // do duplicate check... no repeats since the base case cannot have node N and node N+1 equal and so on
+        return;
+    
+    self->tail->next = item;
+    self->tail = item;
+    self->length++;
+}
+
+void Array_Insert(Array *self, size_t pos, ArrayItem *item)
+{
+    item->next = NULL;
 
-    while (trackPtr->next != NULL)
+    if (pos >= self->length)
     {
-        trackPtr = trackPtr->next;
+        Array_Push(self, item);
+        return;
+    }
+
+    if (pos == 0)
+    {
+        item->next = self->head;
+        self->head = item;
+    }
+    else
+    {
+        ArrayItem *prev = (ArrayItem*)Array_Get(self, pos - 1);
+
+        item->next = prev->next;
+        prev->next = item;
     }
 
-    if (trackPtr == item) // do duplicate check... no repeats since the base case cannot have node N and node N+1 equal and so on
-        return;
-    
-    trackPtr->next = item;
     self->length++;
+    self->hash = 0;
+}
+
+ArrayItem *Array_Take(Array *self, size_t pos)
+{
+    ArrayItem *target = NULL;
+
+    if (pos >= self->length)
+        return NULL;
+
+    self->hash = 0;
+
+    if (pos == 0)
+    {
+        target = self->head;
+        self->head = target->next;
+
+        if (self->tail == target)
+            self->tail = NULL;
+    }
+    else
+    {
+        ArrayItem *prev = (ArrayItem*)Array_Get(self, pos - 1);
+
+        target = prev->next;
+        prev->next = target->next;
+
+        if (self->tail == target)
+            self->tail = prev;
+    }
+
+    target->next = NULL;
+    self->length--;
+
+    return target;
 }
 
 /// Object:
 
-Object *Object_Create(size_t slots)
+Object *Object_Create(size_t slots, const JsonAllocator *allocator)
 {
-    Object *result = malloc(sizeof(Object));
+    Object *result = json_alloc(allocator, sizeof(Object));
 
     if (!result)
         return result;
 
-    // allocate bucket array with max load 0.40 (no collisions I guess... YOLO!)
+    result->allocator = allocator;
+    result->count = 0;
+    result->refs = 1;
+    result->hash = 0;
+
+    if (slots < 1)
+        slots = 1;
+
+    // allocate bucket array with load 1/3, which Object_SetItem keeps at or under 1/2 by growing
     size_t bucket_slots = (slots << 1) + slots;
-    result->buckets = malloc(sizeof(Property*) * bucket_slots);
+    result->buckets = json_alloc(allocator, sizeof(Property*) * bucket_slots);
     
     if (result->buckets != NULL)
     {
@@ -219,37 +372,215 @@ void Object_Destroy(Object *self)
         if (!self->buckets[curr])
             continue;
         
-        Property_Destroy((Property*)self->buckets[curr]);
-        free(self->buckets[curr]);
+        Property_Destroy((Property*)self->buckets[curr], self->allocator);
+        json_free(self->allocator, self->buckets[curr]);
         self->buckets[curr] = NULL;
     }
     
-    free(self->buckets);
+    json_free(self->allocator, self->buckets);
     self->buckets = NULL;
+    self->count = 0;
 }
 
-void Object_SetItem(Object *self, const char *key, Property *prop_val)
+Object *Object_Copy(const Object *self)
 {
-    size_t bucket = hash_object_key(key) % self->bucket_count;
+    Object *result = json_alloc(self->allocator, sizeof(Object));
+    void **buckets = json_alloc(self->allocator, sizeof(Property*) * self->bucket_count);
+
+    if (!result || !buckets)
+    {
+        json_free(self->allocator, buckets);
+        json_free(self->allocator, result);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < self->bucket_count; i++)
+        buckets[i] = NULL;
+
+    result->allocator = self->allocator;
+    result->bucket_count = self->bucket_count;
+    result->count = self->count;
+    result->buckets = buckets;
+    result->refs = 1;
+    result->hash = 0;
+
+    // same table size, so every property keeps its bucket and nothing is rehashed
+    for (size_t curr = 0; curr < self->bucket_count; curr++)
+    {
+        const Property *prop = self->buckets[curr];
+
+        if (!prop)
+            continue;
+
+        Property *copy = json_alloc(self->allocator, sizeof(Property));
+
+        if (!copy)
+            goto copy_failed;
+
+        *copy = *prop;
+        copy->name = NULL;
+
+        if (prop->type == STR)
+            copy->data.str = NULL;
+        else if (prop->type == ARR || prop->type == OBJ)
+            Chunk_Retain(prop->data.chunk, prop->type);
+
+        // the table owns the copy from here, so a failed string copy is cleaned up with the rest
+        buckets[curr] = copy;
+
+        if (!data_copy_str(prop->name, &copy->name, self->allocator) || (prop->type == STR && !data_copy_str(prop->data.str, &copy->data.str, self->allocator)))
+            goto copy_failed;
+    }
+
+    return result;
 
-    if (!self->buckets[bucket])
-        self->buckets[bucket] = prop_val;
+copy_failed:
+    Object_Destroy(result);
+    json_free(self->allocator, result);
+    return NULL;
 }
 
-const Property *Object_GetItem(Object *self, const char *key)
+static size_t object_find_bucket(const Object *self, const char *key, size_t key_len)
 {
-    size_t bucket = hash_object_key(key) % self->bucket_count;
+    size_t bucket_count = self->bucket_count;
+    size_t bucket = hash_object_keyn(key, key_len) % bucket_count;
+    size_t probe_len = 1;
+
+    // linear probe past colliding keys to the key's bucket or the first empty one
+    while (self->buckets[bucket] != NULL && probe_len < bucket_count)
+    {
+        const char *name = ((Property*)self->buckets[bucket])->name;
+
+        if (strncmp(name, key, key_len) == 0 && name[key_len] == '\0')
+            break;
+
+        bucket = (bucket + 1) % bucket_count;
+        probe_len++;
+    }
+
+    JSON_STATS_PROBE(probe_len);
+
+    return bucket;
+}
+
+static int object_grow(Object *self)
+{
+    size_t old_count = self->bucket_count;
+    void **old_buckets = self->buckets;
+    size_t new_count = (old_count > 0) ? old_count << 1 : 3;
+    void **new_buckets = json_alloc(self->allocator, sizeof(Property*) * new_count);
+
+    if (!new_buckets)
+        return 0;
+
+    for (size_t i = 0; i < new_count; i++)
+        new_buckets[i] = NULL;
+
+    self->buckets = new_buckets;
+    self->bucket_count = new_count;
+
+    // rehash every property into the wider table
+    for (size_t curr = 0; curr < old_count; curr++)
+    {
+        if (old_buckets[curr] != NULL)
+        {
+            const char *name = ((Property*)old_buckets[curr])->name;
+            self->buckets[object_find_bucket(self, name, strlen(name))] = old_buckets[curr];
+        }
+    }
+
+    json_free(self->allocator, old_buckets);
+
+    return 1;
+}
+
+int Object_SetItem(Object *self, const char *key, Property *prop_val)
+{
+    if (((self->count + 1) << 1) > self->bucket_count && !object_grow(self))
+        return 0;
+
+    size_t bucket = object_find_bucket(self, key, strlen(key));
+    Property *old_prop = (Property*)self->buckets[bucket];
+
+    // a later duplicate key replaces the earlier binding
+    if (old_prop != NULL)
+    {
+        if (old_prop == prop_val)
+            return 1;
+
+        Property_Destroy(old_prop, self->allocator);
+        json_free(self->allocator, old_prop);
+    }
+    else
+        self->count++;
+
+    self->buckets[bucket] = prop_val;
+    self->hash = 0;
+
+    return 1;
+}
+
+const Property *Object_GetItem(const Object *self, const char *key)
+{
+    if (self->bucket_count == 0)
+        return NULL;
+
+    return (Property*)self->buckets[object_find_bucket(self, key, strlen(key))];
+}
+
+const Property *Object_GetItemN(const Object *self, const char *key, size_t key_len)
+{
+    if (self->bucket_count == 0)
+        return NULL;
+
+    return (Property*)self->buckets[object_find_bucket(self, key, key_len)];
+}
+
+Property *Object_TakeItem(Object *self, const char *key)
+{
+    if (self->bucket_count == 0)
+        return NULL;
+
+    size_t bucket_count = self->bucket_count;
+    size_t hole = object_find_bucket(self, key, strlen(key));
+    Property *result = (Property*)self->buckets[hole];
+
+    if (!result)
+        return NULL;
+
+    self->buckets[hole] = NULL;
+    self->count--;
+    self->hash = 0;
 
-    return (Property*)self->buckets[bucket];
+    // pull later properties of the probe run back into the hole when it lies between their home bucket and where they sit
+    for (size_t curr = (hole + 1) % bucket_count; self->buckets[curr] != NULL; curr = (curr + 1) % bucket_count)
+    {
+        const char *name = ((Property*)self->buckets[curr])->name;
+        size_t home = hash_object_keyn(name, strlen(name)) % bucket_count;
+        int reachable = (hole <= curr) ? (home <= hole || home > curr) : (home <= hole && home > curr);
+
+        if (reachable)
+        {
+            self->buckets[hole] = self->buckets[curr];
+            self->buckets[curr] = NULL;
+            hole = curr;
+        }
+    }
+
+    return result;
 }
 
+size_t Object_Count(const Object *self) { return self->count; }
+
 /// Property:
-Property *Property_Int(char *name, int value)
+Property *Property_Int(char *name, int value, const JsonAllocator *allocator)
 {
-    Property *result = malloc(sizeof(Property));
+    Property *result = json_alloc(allocator, sizeof(Property));
 
     if (!result)
         return result;
+
+    JSON_STATS_ADD(node_count, 1);
     
     result->name = name;
     result->type = INT;
@@ -258,12 +589,14 @@ Property *Property_Int(char *name, int value)
     return result;
 }
 
-Property *Property_Float(char *name, float value)
+Property *Property_Float(char *name, float value, const JsonAllocator *allocator)
 {
-    Property *result = malloc(sizeof(Property));
+    Property *result = json_alloc(allocator, sizeof(Property));
 
     if (!result)
         return result;
+
+    JSON_STATS_ADD(node_count, 1);
     
     result->name = name;
     result->data.f = value;
@@ -272,12 +605,14 @@ Property *Property_Float(char *name, float value)
     return result;
 }
 
-Property *Property_String(char *name, char *value)
+Property *Property_String(char *name, char *value, const JsonAllocator *allocator)
 {
-    Property *result = malloc(sizeof(Property));
+    Property *result = json_alloc(allocator, sizeof(Property));
 
     if (!result)
         return result;
+
+    JSON_STATS_ADD(node_count, 1);
     
     result->name = name;
     result->data.str = value;
@@ -286,12 +621,30 @@ Property *Property_String(char *name, char *value)
     return result;
 }
 
-Property *Property_Chunk(char *name, void *value, DataType type)
+Property *Property_Bool(char *name, int value, const JsonAllocator *allocator)
 {
-    Property *result = malloc(sizeof(Property));
+    Property *result = json_alloc(allocator, sizeof(Property));
 
     if (!result)
         return result;
+
+    JSON_STATS_ADD(node_count, 1);
+    
+    result->name = name;
+    result->data.i = (value != 0);
+    result->type = BOOL;
+
+    return result;
+}
+
+Property *Property_Chunk(char *name, void *value, DataType type, const JsonAllocator *allocator)
+{
+    Property *result = json_alloc(allocator, sizeof(Property));
+
+    if (!result)
+        return result;
+
+    JSON_STATS_ADD(node_count, 1);
     
     result->name = name;
     result->data.chunk = value;
@@ -300,34 +653,27 @@ Property *Property_Chunk(char *name, void *value, DataType type)
     return result;
 }
 
-void Property_Destroy(Property *self)
+void Property_Destroy(Property *self, const JsonAllocator *allocator)
 {
     // check type for whether there is dynamic memory to free
     switch (self->type)
     {
     case INT:
     case FLT:
+    case BOOL:
         break;
     case STR:
         if (self->data.str != NULL)
         {
-            free(self->data.str);
+            json_free(allocator, self->data.str);
             self->data.str = NULL;
         }
         break;
     case ARR:
-        if (self->data.chunk != NULL)
-        {
-            Array_Destroy((Array*)self->data.chunk);
-            free(self->data.chunk);
-            self->data.chunk = NULL;
-        }
-        break;
     case OBJ:
         if (self->data.chunk != NULL)
         {
-            Object_Destroy((Object*)self->data.chunk);
-            free(self->data.chunk);
+            Chunk_Release(self->data.chunk, self->type, allocator);
             self->data.chunk = NULL;
         }
         break;
@@ -338,7 +684,7 @@ void Property_Destroy(Property *self)
     // free property name's dynamic C-String
     if (self->name != NULL)
     {
-        free(self->name);
+        json_free(allocator, self->name);
         self->name = NULL;
     }
 }
@@ -349,9 +695,61 @@ float Property_AsFloat(const Property *self) { return self->data.f; }
 
 const char *Property_AsStr(const Property *self) { return self->data.str; }
 
+int Property_AsBool(const Property *self) { return self->data.i; }
+
 const void *Property_AsChunk(const Property *self, DataType *type_flag)
 {
     *type_flag = self->type;
 
     return self->data.chunk; // non-primitive typed data!
 }
+
+/// Chunk References:
+
+void Chunk_Retain(void *chunk, DataType type)
+{
+    if (type == ARR)
+        ((Array*)chunk)->refs++;
+    else
+        ((Object*)chunk)->refs++;
+}
+
+void Chunk_Release(void *chunk, DataType type, const JsonAllocator *allocator)
+{
+    size_t *refs = (type == ARR) ? &((Array*)chunk)->refs : &((Object*)chunk)->refs;
+
+    if (--*refs > 0)
+        return;
+
+    if (type == ARR)
+        Array_Destroy((Array*)chunk);
+    else
+        Object_Destroy((Object*)chunk);
+
+    json_free(allocator, chunk);
+}
+
+int Chunk_Unshare(void **slot, DataType type, const JsonAllocator *allocator)
+{
+    size_t refs = (type == ARR) ? ((Array*)*slot)->refs : ((Object*)*slot)->refs;
+
+    if (refs == 1)
+    {
+        if (type == ARR)
+            ((Array*)*slot)->hash = 0;
+        else
+            ((Object*)*slot)->hash = 0;
+
+        return 1;
+    }
+
+    void *copy = (type == ARR) ? (void*)Array_Copy((Array*)*slot) : (void*)Object_Copy((Object*)*slot);
+
+    if (!copy)
+        return 0;
+
+    Chunk_Release(*slot, type, allocator);
+    *slot = copy;
+
+    return 1;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file json_frozen.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Implements frozen documents shared across threads by atomic reference counts.
+ * @date 2026-10-19
+ */
+
+#include "json_frozen.h"
+#include "json_merkle.h"
+
+/**
+ * @brief Unshares a container and then everything under it, so the document shares no counts with any other.
+ *
+ * @return int 0 if memory ran out.
+ */
+static int frozen_isolate(void **slot, DataType type, const JsonAllocator *allocator)
+{
+    if (!Chunk_Unshare(slot, type, allocator))
+        return 0;
+
+    if (type == ARR)
+    {
+        for (ArrayItem *item = ((Array*)*slot)->head; item != NULL; item = item->next)
+        {
+            if ((item->type == ARR || item->type == OBJ) && !frozen_isolate(&item->data.chunk, item->type, allocator))
+                return 0;
+        }
+
+        return 1;
+    }
+
+    Object *obj = (Object*)*slot;
+
+    for (size_t curr = 0; curr < obj->bucket_count; curr++)
+    {
+        Property *prop = (Property*)obj->buckets[curr];
+
+        if (prop != NULL && (prop->type == ARR || prop->type == OBJ) && !frozen_isolate(&prop->data.chunk, prop->type, allocator))
+            return 0;
+    }
+
+    return 1;
+}
+
+int JsonThing_Seal(JsonThing *doc)
+{
+    if (doc->root != NULL && (doc->root->type == ARR || doc->root->type == OBJ) && !frozen_isolate(&doc->root->data.chunk, doc->root->type, doc->allocator))
+        return 0;
+
+    // hashing now is the last write, so later JsonThing_Hash calls only read the caches
+    JsonThing_Hash(doc);
+
+    return 1;
+}
+
+FrozenThing *JsonThing_Freeze(JsonThing *doc)
+{
+    FrozenThing *result = json_alloc(doc->allocator, sizeof(FrozenThing));
+
+    if (!result)
+        return NULL;
+
+    if (!JsonThing_Seal(doc))
+    {
+        json_free(doc->allocator, result);
+        return NULL;
+    }
+
+    result->doc = doc;
+    atomic_init(&result->refs, 1);
+
+    return result;
+}
+
+FrozenThing *FrozenThing_Acquire(FrozenThing *self)
+{
+    // the caller already holds a reference, so nothing needs ordering against this one
+    atomic_fetch_add_explicit(&self->refs, 1, memory_order_relaxed);
+
+    return self;
+}
+
+int FrozenThing_Release(FrozenThing *self)
+{
+    // release publishes this reader's accesses, and acquire makes the last one see every other reader's before it frees
+    if (atomic_fetch_sub_explicit(&self->refs, 1, memory_order_acq_rel) != 1)
+        return 0;
+
+    JsonThing *doc = (JsonThing*)self->doc;
+    const JsonAllocator *allocator = doc->allocator;
+
+    JsonThing_Destroy(doc);
+    json_free(allocator, doc);
+    json_free(allocator, self);
+
+    return 1;
+}
@@ -0,0 +1,167 @@
+/**
+ * @file json_gen.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Implements the runtime helpers for generated schema parsers.
+ * @date 2026-10-19
+ */
+
+#include "json_gen.h"
+
+/// Value Readers:
+
+int JsonGen_Int(int *out, const char *src, const Token *value)
+{
+    if (value->type == NULL_LTRL)
+        return NO_ERR;
+
+    if (value->type != INT_LTRL)
+        return UNEXPECTED_TOKEN_ERR;
+
+    // the lexer already checked the digits, so accumulate them in place without copying
+    const char *digit = src + value->begin;
+    const char *end = digit + value->span;
+    int negative = (*digit == '-');
+    unsigned int result = 0;
+
+    if (negative)
+        digit++;
+
+    while (digit < end)
+    {
+        result = result * 10 + (unsigned int)(*digit - '0');
+        digit++;
+    }
+
+    *out = negative ? (int)(0u - result) : (int)result;
+
+    return NO_ERR;
+}
+
+int JsonGen_Float(float *out, const char *src, const Token *value, const JsonAllocator *allocator)
+{
+    double num = 0.0;
+
+    if (value->type == NULL_LTRL)
+        return NO_ERR;
+
+    if (value->type != INT_LTRL && value->type != FLT_LTRL)
+        return UNEXPECTED_TOKEN_ERR;
+
+    if (!Token_ToNum(value, src, allocator, NULL, &num))
+        return OUT_OF_MEMORY_ERR;
+
+    *out = num;
+
+    return NO_ERR;
+}
+
+int JsonGen_Bool(int *out, const Token *value)
+{
+    switch (value->type)
+    {
+    case NULL_LTRL:
+        return NO_ERR;
+    case TRUE_LTRL:
+        *out = 1;
+        return NO_ERR;
+    case FALSE_LTRL:
+        *out = 0;
+        return NO_ERR;
+    default:
+        return UNEXPECTED_TOKEN_ERR;
+    }
+}
+
+int JsonGen_String(char **out, const char *src, const Token *value, const JsonAllocator *allocator)
+{
+    if (value->type != STRBODY && value->type != NULL_LTRL)
+        return UNEXPECTED_TOKEN_ERR;
+
+    if (*out != NULL)
+    {
+        json_free(allocator, *out);
+        *out = NULL;
+    }
+
+    if (value->type == NULL_LTRL)
+        return NO_ERR;
+
+    *out = Token_ToTxt(value, src, allocator);
+
+    return (*out != NULL) ? NO_ERR : OUT_OF_MEMORY_ERR;
+}
+
+int JsonGen_Match_Escaped(const char *src, const Token *key, int (*match)(const char *, size_t), const JsonAllocator *allocator)
+{
+    char *txt = Token_ToTxt(key, src, allocator);
+
+    if (!txt)
+        return -1;
+
+    int field = match(txt, strlen(txt));
+    json_free(allocator, txt);
+
+    return field;
+}
+
+int JsonGen_Skip(const TokenVec *tokens, size_t *pos)
+{
+    size_t idx = *pos;
+    size_t depth = 0;
+
+    // an indexed container is jumped whole
+    if (idx < tokens->count && tokens->data[idx].skip != 0 && (tokens->data[idx].type == LBRACKET || tokens->data[idx].type == LCURLY))
+    {
+        if (tokens->data[idx].flags & TOKEN_HAS_UNKNOWN)
+            return UNKNOWN_TOKEN_ERR;
+
+        *pos = idx + tokens->data[idx].skip + 1;
+
+        return NO_ERR;
+    }
+
+    do
+    {
+        if (idx >= tokens->count)
+            return UNBALANCED_NEST;
+
+        switch (tokens->data[idx].type)
+        {
+        case LBRACKET:
+        case LCURLY:
+            depth++;
+            break;
+        case RBRACKET:
+        case RCURLY:
+            if (depth == 0)
+                return UNEXPECTED_TOKEN_ERR;
+            depth--;
+            break;
+        case UNKNOWN:
+            return UNKNOWN_TOKEN_ERR;
+        default:
+            break;
+        }
+
+        idx++;
+    } while (depth > 0);
+
+    *pos = idx;
+
+    return NO_ERR;
+}
+
+int JsonGen_Lex(TokenVec *scratch, char *src, size_t len)
+{
+    Lexer lexer;
+
+    TokenVec_Clear(scratch);
+    Lexer_Init(&lexer, src, len, scratch->allocator);
+
+    size_t count = Lexer_Lex_Into(&lexer, scratch);
+
+    if (lexer.out_of_memory)
+        return OUT_OF_MEMORY_ERR;
+
+    return (count > 0) ? NO_ERR : EMPTY_TOKENS_ERR;
+}
@@ -5,15 +5,21 @@
  * @date 2023-03-25
  */
 
+#define _POSIX_C_SOURCE 200809L // for strnlen under -std=c11
+
 #include "json_hasher.h"
 
-size_t hash_object_key(const char *key_str)
+size_t hash_object_key(const char *key_str) { return hash_object_keyn(key_str, strnlen(key_str, MAX_JSONKEY_LEN)); }
+
+size_t hash_object_keyn(const char *key_str, size_t len)
 {
-    size_t len = strnlen(key_str, MAX_JSONKEY_LEN);
     size_t place_val = 1;
     size_t hash_num = 0;
     size_t char_val = 0;
 
+    if (len > MAX_JSONKEY_LEN)
+        len = MAX_JSONKEY_LEN;
+
     for (size_t str_i = 0; str_i < len; str_i++)
     {
         char_val = (size_t)key_str[str_i];
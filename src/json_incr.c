@@ -0,0 +1,687 @@
+/**
+ * @file json_incr.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Implements incremental reparsing of edited documents.
+ * @date 2026-10-19
+ */
+
+#include "json_incr.h"
+
+#define INCR_NONE ((size_t)-1)
+
+/// Token Helpers:
+
+// a string token's extent includes its quotes, which begin and span leave out
+static size_t incr_token_start(const Token *tok) { return tok->begin - (tok->type == STRBODY); }
+
+static size_t incr_token_end(const Token *tok)
+{
+    if (tok->type == LBRACKET || tok->type == LCURLY)
+        return tok->begin + 1; // an opener's span holds its skip distance instead
+
+    return tok->begin + tok->span + (tok->type == STRBODY);
+}
+
+static int incr_is_prim(TokenType type)
+{
+    return type == INT_LTRL || type == FLT_LTRL || type == STRBODY || type == NULL_LTRL || type == TRUE_LTRL || type == FALSE_LTRL;
+}
+
+static int incr_is_punct(TokenType type)
+{
+    return type == LBRACKET || type == RBRACKET || type == LCURLY || type == RCURLY || type == COLON || type == COMMA;
+}
+
+static DataType incr_prim_type(TokenType type)
+{
+    switch (type)
+    {
+    case INT_LTRL:
+        return INT;
+    case FLT_LTRL:
+        return FLT;
+    case STRBODY:
+        return STR;
+    case NULL_LTRL:
+        return NUL;
+    case TRUE_LTRL:
+    case FALSE_LTRL:
+        return BOOL;
+    default:
+        return UNSUPPORTED;
+    }
+}
+
+/**
+ * @brief Binary searches the tape for the first token whose extent reaches pos. Tokens that only touch an edit count as edited, since their text may join with the new text.
+ */
+static size_t incr_first_touching(const TokenVec *tokens, size_t pos)
+{
+    size_t low = 0;
+    size_t high = tokens->count;
+
+    while (low < high)
+    {
+        size_t mid = low + ((high - low) >> 1);
+
+        if (incr_token_end(&tokens->data[mid]) < pos)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
+static size_t incr_first_after(const TokenVec *tokens, size_t pos)
+{
+    size_t low = 0;
+    size_t high = tokens->count;
+
+    while (low < high)
+    {
+        size_t mid = low + ((high - low) >> 1);
+
+        if (incr_token_start(&tokens->data[mid]) <= pos)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
+/// Document Helpers:
+
+static int incr_splice_text(IncrDoc *self, size_t begin, size_t end, const char *text, size_t text_len)
+{
+    size_t new_len = self->len - (end - begin) + text_len;
+
+    if (new_len + 1 > self->cap)
+    {
+        size_t new_cap = (self->cap << 1 > new_len + 1) ? self->cap << 1 : new_len + 1;
+        char *temp = json_realloc(self->allocator, self->src, new_cap);
+
+        if (!temp)
+            return 0;
+
+        self->src = temp;
+        self->cap = new_cap;
+    }
+
+    if (text_len != end - begin)
+        memmove(self->src + begin + text_len, self->src + end, self->len - end);
+
+    memcpy(self->src + begin, text, text_len);
+    self->len = new_len;
+    self->src[new_len] = '\0';
+
+    return 1;
+}
+
+static void incr_drop_doc(IncrDoc *self)
+{
+    if (!self->doc)
+        return;
+
+    JsonThing_Destroy(self->doc);
+    json_free(self->allocator, self->doc);
+    self->doc = NULL;
+}
+
+static int incr_full_parse(IncrDoc *self)
+{
+    Lexer lexer;
+
+    incr_drop_doc(self);
+    TokenVec_Clear(&self->tokens);
+
+    Lexer_Init(&lexer, self->src, self->len, self->allocator);
+    Lexer_Lex_Into(&lexer, &self->tokens);
+
+    Parser_Rebind(&self->parser, self->src, &self->tokens);
+
+    if (lexer.out_of_memory)
+        self->parser.err_code = OUT_OF_MEMORY_ERR; // a cut short tape could still parse as a shorter document
+    else
+        self->doc = Parser_Start_Parse(&self->parser);
+
+    self->relexed_count = self->tokens.count;
+    self->reparsed_count = self->tokens.count;
+    self->full_reparse = 1;
+
+    return Parser_Get_ErrCode(&self->parser);
+}
+
+static void incr_free_value(IncrDoc *self, ArrayItem *value)
+{
+    ArrayItem_Destroy(value, self->allocator);
+    json_free(self->allocator, value);
+}
+
+/// Path Helpers:
+
+/**
+ * @brief Walks the tape up to stop, recording every Array / Object still open there and which member of each is current.
+ *
+ * @return size_t Count of open containers, or INCR_NONE if the path could not grow.
+ */
+static size_t incr_walk_path(IncrDoc *self, size_t stop)
+{
+    const Token *tape = self->tokens.data;
+    size_t depth = 0;
+
+    for (size_t idx = 0; idx < stop; idx++)
+    {
+        switch (tape[idx].type)
+        {
+        case LBRACKET:
+        case LCURLY:
+            // a container closed before stop is not on the path, so it is jumped whole
+            if (tape[idx].skip != 0 && idx + tape[idx].skip < stop)
+            {
+                idx += tape[idx].skip;
+                break;
+            }
+
+            if (depth == self->path_cap)
+            {
+                size_t new_cap = (self->path_cap > 0) ? self->path_cap << 1 : 16;
+                IncrFrame *temp = json_realloc(self->allocator, self->path, sizeof(IncrFrame) * new_cap);
+
+                if (!temp)
+                    return INCR_NONE;
+
+                self->path = temp;
+                self->path_cap = new_cap;
+            }
+
+            self->path[depth].opener = idx;
+            self->path[depth].item_index = 0;
+            self->path[depth].key_idx = INCR_NONE;
+            self->path[depth].type = (tape[idx].type == LBRACKET) ? ARR : OBJ;
+            depth++;
+            break;
+        case RBRACKET:
+        case RCURLY:
+            if (depth > 0)
+                depth--;
+            break;
+        case COMMA:
+            if (depth > 0)
+                self->path[depth - 1].item_index++;
+            break;
+        case STRBODY:
+            if (depth > 0 && self->path[depth - 1].type == OBJ && idx + 1 < self->tokens.count && tape[idx + 1].type == COLON)
+                self->path[depth - 1].key_idx = idx;
+            break;
+        default:
+            break;
+        }
+    }
+
+    return depth;
+}
+
+/**
+ * @brief Checks whether a later duplicate key hides one of the first levels path members, in which case the DOM never held the edited value.
+ *
+ * @param from First tape index after the edited tokens.
+ * @param depth Count of containers open at from.
+ */
+static int incr_is_shadowed(const IncrDoc *self, size_t levels, size_t from, size_t depth)
+{
+    const Token *tape = self->tokens.data;
+    size_t live = levels; // path levels not closed yet
+    size_t outer = INCR_NONE;
+
+    for (size_t level = 0; level < levels; level++)
+    {
+        if (self->path[level].type == OBJ)
+        {
+            outer = level;
+            break;
+        }
+    }
+
+    for (size_t idx = from; idx < self->tokens.count && outer != INCR_NONE && live > outer; idx++)
+    {
+        switch (tape[idx].type)
+        {
+        case LBRACKET:
+        case LCURLY:
+            depth++;
+            break;
+        case RBRACKET:
+        case RCURLY:
+            depth--;
+            if (depth < live)
+                live = depth;
+            break;
+        case STRBODY:
+        {
+            const IncrFrame *frame = (depth > 0 && depth - 1 < live) ? &self->path[depth - 1] : NULL;
+
+            if (frame != NULL && frame->type == OBJ && frame->key_idx != INCR_NONE && idx + 1 < self->tokens.count
+                && tape[idx + 1].type == COLON && Token_SameTxt(&tape[idx], &tape[frame->key_idx], self->src, self->allocator))
+                return 1;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    return 0;
+}
+
+static ArrayItem *incr_array_item(Array *arr, size_t pos)
+{
+    ArrayItem *item = arr->head;
+
+    while (item != NULL && pos > 0)
+    {
+        item = item->next;
+        pos--;
+    }
+
+    return item;
+}
+
+static Property *incr_object_member(IncrDoc *self, Object *obj, size_t key_idx)
+{
+    char *key = Token_ToTxt(&self->tokens.data[key_idx], self->src, self->allocator);
+
+    if (!key)
+        return NULL;
+
+    Property *result = (Property*)Object_GetItem(obj, key);
+    json_free(self->allocator, key);
+
+    return result;
+}
+
+static void incr_clear_hash(void *chunk, DataType type)
+{
+    if (type == ARR)
+        ((Array*)chunk)->hash = 0;
+    else
+        ((Object*)chunk)->hash = 0;
+}
+
+/**
+ * @brief Follows the path from the DOM root down to the container opened by path[level], clearing the cached hash of every container on the way since the caller changes what lies below them.
+ *
+ * @return void* The Array or Object, or NULL if the DOM does not match the tape.
+ */
+static void *incr_find_chunk(IncrDoc *self, size_t level)
+{
+    DataType type = self->doc->root->type;
+    void *chunk = self->doc->root->data.chunk;
+
+    for (size_t step = 0; step < level && chunk != NULL; step++)
+    {
+        const IncrFrame *frame = &self->path[step];
+
+        if (type != frame->type)
+            return NULL;
+
+        incr_clear_hash(chunk, type);
+
+        if (type == ARR)
+        {
+            ArrayItem *item = incr_array_item((Array*)chunk, frame->item_index);
+            type = (item != NULL) ? item->type : UNSUPPORTED;
+            chunk = (item != NULL) ? item->data.chunk : NULL;
+        }
+        else
+        {
+            Property *member = (frame->key_idx != INCR_NONE) ? incr_object_member(self, (Object*)chunk, frame->key_idx) : NULL;
+            type = (member != NULL) ? member->type : UNSUPPORTED;
+            chunk = (member != NULL) ? member->data.chunk : NULL;
+        }
+    }
+
+    if (chunk == NULL || type != self->path[level].type)
+        return NULL;
+
+    incr_clear_hash(chunk, type);
+
+    return chunk;
+}
+
+/**
+ * @brief Moves a rebuilt value into the member of parent that frame currently points at, freeing the old value.
+ *
+ * @param value Detached holder of the new value, which is freed (but not its contents) on success.
+ * @return int 1 on success
+ */
+static int incr_install(IncrDoc *self, void *parent, const IncrFrame *frame, ArrayItem *value)
+{
+    if (frame->type == ARR)
+    {
+        ArrayItem *item = incr_array_item((Array*)parent, frame->item_index);
+
+        if (!item)
+            return 0;
+
+        ArrayItem_Destroy(item, self->allocator);
+        item->type = value->type;
+        item->data = value->data;
+        json_free(self->allocator, value);
+
+        return 1;
+    }
+
+    if (frame->key_idx == INCR_NONE)
+        return 0;
+
+    char *name = Token_ToTxt(&self->tokens.data[frame->key_idx], self->src, self->allocator);
+    Property *member = (name != NULL) ? Property_Chunk(name, NULL, value->type, self->allocator) : NULL;
+
+    if (!member)
+    {
+        json_free(self->allocator, name);
+        return 0;
+    }
+
+    switch (value->type)
+    {
+    case INT:
+    case BOOL:
+        member->data.i = value->data.i;
+        break;
+    case FLT:
+        member->data.f = value->data.f;
+        break;
+    case STR:
+        member->data.str = value->data.str;
+        break;
+    default:
+        member->data.chunk = value->data.chunk;
+        break;
+    }
+
+    // the set fails only if the table could not grow, which leaves the member unbound
+    if (!Object_SetItem((Object*)parent, name, member))
+    {
+        member->data.chunk = NULL;
+        member->type = NUL;
+        Property_Destroy(member, self->allocator);
+        json_free(self->allocator, member);
+
+        return 0;
+    }
+
+    json_free(self->allocator, value);
+
+    return 1;
+}
+
+/**
+ * @brief Parses the value starting at tape index idx into a detached ArrayItem.
+ *
+ * @param depth_used Containers around the value, which count toward the parser's depth limit.
+ */
+static ArrayItem *incr_parse_value(IncrDoc *self, size_t idx, size_t depth_used)
+{
+    Parser *parser = &self->parser;
+    size_t max_depth = parser->max_depth;
+    TokenType type = self->tokens.data[idx].type;
+    ArrayItem *result = NULL;
+
+    Parser_Rebind(parser, self->src, &self->tokens);
+    parser->tokvec_idx = idx;
+    parser->max_depth = (max_depth > depth_used) ? max_depth - depth_used : 0;
+
+    if (type == LBRACKET || type == LCURLY)
+    {
+        DataType chunk_type = (type == LBRACKET) ? ARR : OBJ;
+        void *chunk = (chunk_type == ARR) ? Parser_Parse_Arr(parser) : Parser_Parse_Obj(parser);
+
+        if (chunk != NULL)
+        {
+            result = ArrayItem_Chunk(chunk, chunk_type, self->allocator);
+
+            if (!result)
+            {
+                ArrayItem holder = {chunk_type, {.chunk = chunk}, NULL};
+                ArrayItem_Destroy(&holder, self->allocator);
+            }
+        }
+    }
+    else if (incr_is_prim(type))
+    {
+        result = Parser_Parse_Prim(parser, NULL, incr_prim_type(type), TO_ARR);
+        parser->tokvec_idx++;
+    }
+
+    parser->max_depth = max_depth;
+    self->reparsed_count = parser->tokvec_idx - idx;
+
+    return result;
+}
+
+/// IncrDoc:
+
+IncrDoc *IncrDoc_Create(const char *src, size_t len, const JsonAllocator *allocator)
+{
+    IncrDoc *result = json_alloc(allocator, sizeof(IncrDoc));
+
+    if (!result)
+        return result;
+
+    result->allocator = allocator;
+    result->len = len;
+    result->cap = len + 1;
+    result->src = json_alloc(allocator, result->cap);
+    result->doc = NULL;
+    result->path = NULL;
+    result->path_cap = 0;
+
+    if (!result->src || !TokenVec_Init(&result->tokens, 64, allocator) || !TokenVec_Init(&result->relexed, 16, allocator))
+    {
+        json_free(allocator, result->src);
+        TokenVec_Destroy(&result->tokens);
+        json_free(allocator, result);
+        return NULL;
+    }
+
+    memcpy(result->src, src, len);
+    result->src[len] = '\0';
+
+    Parser_Init(&result->parser, result->src, &result->tokens, allocator);
+    incr_full_parse(result);
+
+    return result;
+}
+
+void IncrDoc_Destroy(IncrDoc *self)
+{
+    incr_drop_doc(self);
+    Parser_Destroy(&self->parser);
+    TokenVec_Destroy(&self->tokens);
+    TokenVec_Destroy(&self->relexed);
+    json_free(self->allocator, self->path);
+    json_free(self->allocator, self->src);
+    self->path = NULL;
+    self->src = NULL;
+}
+
+int IncrDoc_Edit(IncrDoc *self, size_t begin, size_t end, const char *text, size_t text_len)
+{
+    if (end > self->len)
+        end = self->len;
+
+    if (begin > end)
+        begin = end;
+
+    self->relexed_count = 0;
+    self->reparsed_count = 0;
+    self->full_reparse = 0;
+
+    // nothing to patch while the old text was broken
+    if (!self->doc)
+        return incr_splice_text(self, begin, end, text, text_len) ? incr_full_parse(self) : OUT_OF_MEMORY_ERR;
+
+    TokenVec *tokens = &self->tokens;
+    size_t first = incr_first_touching(tokens, begin);
+    size_t stop = incr_first_after(tokens, end);
+
+    // punctuation never joins with its neighbors, so merely touching the edit leaves it as it was
+    if (first < stop && incr_is_punct(tokens->data[first].type) && incr_token_end(&tokens->data[first]) == begin)
+        first++;
+
+    if (first < stop && incr_is_punct(tokens->data[stop - 1].type) && incr_token_start(&tokens->data[stop - 1]) == end)
+        stop--;
+
+    size_t old_count = stop - first;
+    TokenType old_type = (old_count == 1) ? tokens->data[first].type : UNKNOWN;
+    size_t region_begin = begin;
+    size_t region_end = end;
+
+    if (old_count > 0)
+    {
+        if (incr_token_start(&tokens->data[first]) < region_begin)
+            region_begin = incr_token_start(&tokens->data[first]);
+
+        if (incr_token_end(&tokens->data[stop - 1]) > region_end)
+            region_end = incr_token_end(&tokens->data[stop - 1]);
+    }
+
+    // find the containers open at the edit, then drop the ones the edited tokens close
+    size_t depth = incr_walk_path(self, first);
+    size_t lowest = depth;
+    size_t region_depth = depth;
+
+    for (size_t idx = first; idx < stop && depth != INCR_NONE; idx++)
+    {
+        TokenType type = tokens->data[idx].type;
+
+        if (type == LBRACKET || type == LCURLY)
+            region_depth++;
+        else if (type == RBRACKET || type == RCURLY)
+        {
+            if (region_depth == 0)
+                break;
+
+            region_depth--;
+
+            if (region_depth < lowest)
+                lowest = region_depth;
+        }
+    }
+
+    if (!incr_splice_text(self, begin, end, text, text_len))
+        return OUT_OF_MEMORY_ERR;
+
+    // the root itself changed
+    if (depth == INCR_NONE || lowest == 0)
+        return incr_full_parse(self);
+
+    // relex just the edited span of the new text
+    size_t new_region_end = region_end - end + begin + text_len;
+    Lexer lexer;
+
+    TokenVec_Clear(&self->relexed);
+    Lexer_Init(&lexer, self->src, new_region_end, self->allocator);
+    lexer.doc_pos = region_begin;
+    Lexer_Lex_Into(&lexer, &self->relexed);
+
+    if (lexer.out_of_memory)
+        return incr_full_parse(self); // reports the failure, unless memory was freed meanwhile
+
+    size_t new_count = self->relexed.count;
+    size_t new_depth = depth;
+    self->relexed_count = new_count;
+
+    // the new tokens may close containers too
+    for (size_t idx = 0; idx < new_count && lowest > 0; idx++)
+    {
+        TokenType type = self->relexed.data[idx].type;
+
+        if (type == UNKNOWN)
+            return incr_full_parse(self); // reports the bad token
+        else if (type == LBRACKET || type == LCURLY)
+            new_depth++;
+        else if (type == RBRACKET || type == RCURLY)
+        {
+            new_depth--;
+
+            if (new_depth < lowest)
+                lowest = new_depth;
+        }
+    }
+
+    // a changed bracket balance moves closers outside the edit, so no container around it is safe to rebuild alone
+    if (lowest == 0 || new_depth != region_depth)
+        return incr_full_parse(self);
+
+    if (!TokenVec_Splice(tokens, first, old_count, self->relexed.data, new_count))
+        return incr_full_parse(self);
+
+    if (text_len != end - begin)
+    {
+        for (size_t idx = first + new_count; idx < tokens->count; idx++)
+            tokens->data[idx].begin = tokens->data[idx].begin + text_len - (end - begin);
+    }
+
+    // containers around the edit keep their elements, but their closers moved with the splice
+    for (size_t level = 0; level + 1 < lowest; level++)
+    {
+        Token *opener = &tokens->data[self->path[level].opener];
+
+        if (opener->skip != 0)
+            opener->skip = opener->skip + new_count - old_count;
+    }
+
+    // only whitespace changed
+    if (old_count == 0 && new_count == 0)
+        return NO_ERR;
+
+    // a lone primitive value edited into another is rebuilt alone, anything else rebuilds the innermost container around the edit
+    const IncrFrame *holder = &self->path[depth - 1];
+    int value_edit = lowest == depth && old_count == 1 && new_count == 1 && incr_is_prim(old_type) && incr_is_prim(tokens->data[first].type)
+        && (holder->type == ARR || (first > 0 && tokens->data[first - 1].type == COLON));
+    size_t levels = value_edit ? depth : lowest - 1;
+
+    // a rebuilt container is indexed again from scratch, since the edit may have changed its elements
+    if (!value_edit)
+        TokenVec_Link(tokens, self->path[lowest - 1].opener);
+
+    ArrayItem *value = incr_parse_value(self, value_edit ? first : self->path[lowest - 1].opener, levels);
+
+    if (!value)
+        return incr_full_parse(self); // reports the error
+
+    // an edit inside a binding hidden by a later duplicate key leaves the DOM as it was
+    if (incr_is_shadowed(self, levels, first + new_count, new_depth))
+    {
+        incr_free_value(self, value);
+        return NO_ERR;
+    }
+
+    if (levels == 0)
+    {
+        Property_Destroy(self->doc->root, self->allocator);
+        self->doc->root->type = value->type;
+        self->doc->root->data.chunk = value->data.chunk;
+        json_free(self->allocator, value);
+
+        return NO_ERR;
+    }
+
+    void *parent = incr_find_chunk(self, levels - 1);
+
+    if (!parent || !incr_install(self, parent, &self->path[levels - 1], value))
+    {
+        incr_free_value(self, value);
+        return incr_full_parse(self);
+    }
+
+    return NO_ERR;
+}
+
+const JsonThing *IncrDoc_Get(const IncrDoc *self) { return self->doc; }
+
+int IncrDoc_Get_ErrCode(const IncrDoc *self) { return Parser_Get_ErrCode(&self->parser); }
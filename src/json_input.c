@@ -0,0 +1,340 @@
+/**
+ * @file json_input.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Implements the plain, gzip and zstd file input layer.
+ * @date 2026-10-19
+ */
+
+#include <limits.h>
+#include <string.h>
+#include "json_input.h"
+
+#ifdef JSON_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef JSON_ZSTD
+#include <zstd.h>
+#endif
+
+static const unsigned char GZIP_MAGIC[2] = {0x1f, 0x8b};
+static const unsigned char ZSTD_MAGIC[4] = {0x28, 0xb5, 0x2f, 0xfd};
+
+/// Helpers:
+
+static size_t input_fail(JsonInput *self, ParserErr err)
+{
+    if (self->err_code == NO_ERR)
+        self->err_code = err;
+
+    self->at_end = 1;
+
+    return 0;
+}
+
+/**
+ * @brief Reads the next block of compressed bytes, noting when the file runs out.
+ */
+static void input_refill(JsonInput *self)
+{
+    self->raw_len = fread(self->raw, 1, INPUT_CHUNK_SIZE, self->file);
+    self->raw_pos = 0;
+
+    if (self->raw_len == 0)
+        self->file_done = 1;
+}
+
+/**
+ * @brief Serves the sniffed prefix first, then reads the rest straight into the caller's buffer.
+ */
+static size_t input_read_plain(JsonInput *self, char *buf, size_t len)
+{
+    size_t got = self->raw_len - self->raw_pos;
+
+    if (got > len)
+        got = len;
+
+    memcpy(buf, self->raw + self->raw_pos, got);
+    self->raw_pos += got;
+
+    if (got < len)
+        got += fread(buf + got, 1, len - got, self->file);
+
+    if (got == 0 && ferror(self->file))
+        return input_fail(self, INPUT_ERR);
+
+    self->at_end = (got == 0);
+
+    return got;
+}
+
+#ifdef JSON_ZLIB
+
+static voidpf input_zalloc(voidpf opaque, uInt items, uInt size)
+{
+    return json_alloc((const JsonAllocator*)opaque, (size_t)items * size);
+}
+
+static void input_zfree(voidpf opaque, voidpf address)
+{
+    json_free((const JsonAllocator*)opaque, address);
+}
+
+static int input_start_gzip(JsonInput *self)
+{
+    z_stream *stream = json_alloc(self->allocator, sizeof(z_stream));
+
+    if (!stream)
+        return 0;
+
+    memset(stream, 0, sizeof(z_stream));
+    stream->zalloc = input_zalloc;
+    stream->zfree = input_zfree;
+    stream->opaque = (voidpf)self->allocator;
+
+    // 16 + 15: expect a gzip wrapper around a full 32K window
+    if (inflateInit2(stream, 16 + MAX_WBITS) != Z_OK)
+    {
+        json_free(self->allocator, stream);
+        return 0;
+    }
+
+    self->decoder = stream;
+
+    return 1;
+}
+
+/**
+ * @brief Inflates until buf is full or the file ends. Concatenated gzip members are read as one stream, like gzip -d does.
+ */
+static size_t input_read_gzip(JsonInput *self, char *buf, size_t len)
+{
+    z_stream *stream = self->decoder;
+
+    stream->next_out = (Bytef*)buf;
+    stream->avail_out = (len > UINT_MAX) ? UINT_MAX : (uInt)len;
+
+    while (stream->avail_out > 0)
+    {
+        if (self->raw_pos == self->raw_len && !self->file_done)
+            input_refill(self);
+
+        if (self->file_done && self->frame_done)
+        {
+            self->at_end = 1;
+            break;
+        }
+
+        if (self->frame_done)
+        {
+            inflateReset(stream); // another member follows
+            self->frame_done = 0;
+        }
+
+        uInt out_before = stream->avail_out;
+
+        stream->next_in = self->raw + self->raw_pos;
+        stream->avail_in = (uInt)(self->raw_len - self->raw_pos);
+
+        int status = inflate(stream, Z_NO_FLUSH);
+
+        self->raw_pos = self->raw_len - stream->avail_in;
+
+        if (status == Z_STREAM_END)
+            self->frame_done = 1;
+        else if ((status != Z_OK && status != Z_BUF_ERROR) || (self->file_done && stream->avail_out == out_before))
+        {
+            input_fail(self, INPUT_ERR); // corrupt or truncated
+            break;
+        }
+    }
+
+    return (char*)stream->next_out - buf;
+}
+
+#endif
+
+#ifdef JSON_ZSTD
+
+static int input_start_zstd(JsonInput *self)
+{
+    ZSTD_DStream *stream = ZSTD_createDStream();
+
+    if (!stream)
+        return 0;
+
+    if (ZSTD_isError(ZSTD_initDStream(stream)))
+    {
+        ZSTD_freeDStream(stream);
+        return 0;
+    }
+
+    self->decoder = stream;
+
+    return 1;
+}
+
+/**
+ * @brief Decompresses until buf is full or the file ends. Frames written back to back are read as one stream.
+ */
+static size_t input_read_zstd(JsonInput *self, char *buf, size_t len)
+{
+    ZSTD_outBuffer out = {buf, len, 0};
+
+    while (out.pos < out.size)
+    {
+        if (self->raw_pos == self->raw_len && !self->file_done)
+            input_refill(self);
+
+        if (self->file_done && self->frame_done)
+        {
+            self->at_end = 1;
+            break;
+        }
+
+        size_t out_before = out.pos;
+        ZSTD_inBuffer in = {self->raw, self->raw_len, self->raw_pos};
+        size_t status = ZSTD_decompressStream(self->decoder, &out, &in);
+
+        self->raw_pos = in.pos;
+
+        if (ZSTD_isError(status) || (self->file_done && status != 0 && out.pos == out_before))
+        {
+            input_fail(self, INPUT_ERR); // corrupt or truncated
+            break;
+        }
+
+        self->frame_done = (status == 0);
+    }
+
+    return out.pos;
+}
+
+#endif
+
+/// JsonInput:
+
+JsonInput *JsonInput_Open(const char *path, const JsonAllocator *allocator)
+{
+    FILE *file = fopen(path, "rb");
+
+    if (!file)
+        return NULL;
+
+    JsonInput *result = json_alloc(allocator, sizeof(JsonInput));
+
+    if (!result || !JsonInput_Init(result, file, allocator))
+    {
+        json_free(allocator, result);
+        fclose(file);
+        return NULL;
+    }
+
+    result->owns_file = 1;
+
+    return result;
+}
+
+int JsonInput_Init(JsonInput *self, FILE *file, const JsonAllocator *allocator)
+{
+    self->file = file;
+    self->owns_file = 0;
+    self->codec = INPUT_PLAIN;
+    self->raw_len = 0;
+    self->raw_pos = 0;
+    self->decoder = NULL;
+    self->frame_done = 0;
+    self->file_done = 0;
+    self->at_end = 0;
+    self->err_code = NO_ERR;
+    self->allocator = allocator;
+    self->raw = json_alloc(allocator, INPUT_CHUNK_SIZE);
+
+    if (!self->raw)
+        return 0;
+
+    // the first block doubles as the magic number sniff
+    input_refill(self);
+
+    if (self->raw_len >= sizeof(GZIP_MAGIC) && memcmp(self->raw, GZIP_MAGIC, sizeof(GZIP_MAGIC)) == 0)
+        self->codec = INPUT_GZIP;
+    else if (self->raw_len >= sizeof(ZSTD_MAGIC) && memcmp(self->raw, ZSTD_MAGIC, sizeof(ZSTD_MAGIC)) == 0)
+        self->codec = INPUT_ZSTD;
+
+    int started = 1;
+
+    switch (self->codec)
+    {
+    case INPUT_GZIP:
+#ifdef JSON_ZLIB
+        started = input_start_gzip(self);
+#else
+        input_fail(self, INPUT_ERR); // recognized, but not built in
+#endif
+        break;
+    case INPUT_ZSTD:
+#ifdef JSON_ZSTD
+        started = input_start_zstd(self);
+#else
+        input_fail(self, INPUT_ERR);
+#endif
+        break;
+    default:
+        break;
+    }
+
+    if (!started)
+    {
+        json_free(allocator, self->raw);
+        self->raw = NULL;
+    }
+
+    return started;
+}
+
+void JsonInput_Destroy(JsonInput *self)
+{
+#ifdef JSON_ZLIB
+    if (self->codec == INPUT_GZIP && self->decoder != NULL)
+    {
+        inflateEnd(self->decoder);
+        json_free(self->allocator, self->decoder);
+    }
+#endif
+
+#ifdef JSON_ZSTD
+    if (self->codec == INPUT_ZSTD && self->decoder != NULL)
+        ZSTD_freeDStream(self->decoder);
+#endif
+
+    json_free(self->allocator, self->raw);
+    self->raw = NULL;
+    self->decoder = NULL;
+
+    if (self->owns_file && self->file != NULL)
+        fclose(self->file);
+
+    self->file = NULL;
+}
+
+size_t JsonInput_Read(JsonInput *self, char *buf, size_t len)
+{
+    if (self->at_end || len == 0)
+        return 0;
+
+    switch (self->codec)
+    {
+#ifdef JSON_ZLIB
+    case INPUT_GZIP:
+        return input_read_gzip(self, buf, len);
+#endif
+#ifdef JSON_ZSTD
+    case INPUT_ZSTD:
+        return input_read_zstd(self, buf, len);
+#endif
+    default:
+        return input_read_plain(self, buf, len);
+    }
+}
+
+int JsonInput_Get_ErrCode(const JsonInput *self) { return self->err_code; }
@@ -5,62 +5,162 @@
  * @date 2023-03-26
  */
 
+#include <stdint.h>
 #include "json_lex.h"
-
-int is_wspace(char c) { return c == ' ' || c == '\t' || c == '\n' || c =='\r'; }
+#include "json_input.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// SSSE3 is not in the x86-64 baseline, so its UTF-8 validator is compiled per function and picked at run time
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <tmmintrin.h>
+#define LEXER_SSSE3 1
+#endif
+
+const unsigned char JSON_CHAR_CLASS[256] = {
+    [' '] = CC_WSPACE, ['\t'] = CC_WSPACE, ['\n'] = CC_WSPACE, ['\r'] = CC_WSPACE,
+    ['['] = CC_LBRACKET, [']'] = CC_RBRACKET, ['{'] = CC_LCURLY, ['}'] = CC_RCURLY,
+    [':'] = CC_COLON, [','] = CC_COMMA, ['\"'] = CC_QUOTE,
+    ['-'] = CC_NUMBER, ['0'] = CC_NUMBER, ['1'] = CC_NUMBER, ['2'] = CC_NUMBER, ['3'] = CC_NUMBER, ['4'] = CC_NUMBER,
+    ['5'] = CC_NUMBER, ['6'] = CC_NUMBER, ['7'] = CC_NUMBER, ['8'] = CC_NUMBER, ['9'] = CC_NUMBER,
+    ['n'] = CC_LITERAL, ['t'] = CC_LITERAL, ['f'] = CC_LITERAL
+};
+
+/// Token type of each single-char punctuator class.
+#define LEXER_NO_OPENER ((size_t)-1)
+
+static const TokenType PUNCT_TOKENS[CC_LITERAL + 1] = {
+    [CC_LBRACKET] = LBRACKET, [CC_RBRACKET] = RBRACKET, [CC_LCURLY] = LCURLY, [CC_RCURLY] = RCURLY,
+    [CC_COLON] = COLON, [CC_COMMA] = COMMA
+};
+
+int is_wspace(char c) { return JSON_CHAR_CLASS[(unsigned char)c] == CC_WSPACE; }
 int is_digit(char c) { return c >= '0' && c <= '9'; }
 
-char *read_file(const char *file_path, size_t *external_len)
+/// Loads 8 chars as one word for SWAR scans.
+static uint64_t lexer_load_word64(const char *text)
+{
+    uint64_t word = 0;
+    memcpy(&word, text, sizeof(word));
+
+    return word;
+}
+
+/// Checks 8 chars at once for a byte equal to c (the classic "has zero byte" bit trick).
+static int lexer_word_has(uint64_t word, unsigned char c)
+{
+    uint64_t x = word ^ (0x0101010101010101ull * c);
+
+    return ((x - 0x0101010101010101ull) & ~x & 0x8080808080808080ull) != 0;
+}
+
+/// Checks 8 chars at once for a byte below 0x20 or at or above 0x80, i.e. a control char or part of a UTF-8 sequence.
+static int lexer_word_has_special(uint64_t word)
 {
-    FILE *fs = fopen(file_path, "r");
+    return (((word - 0x2020202020202020ull) | word) & 0x8080808080808080ull) != 0;
+}
+
+/// Loads 4 chars as one word. The memcpy compiles to a single unaligned load, and on constant literals it folds away.
+static uint32_t lexer_load_word(const char *text)
+{
+    uint32_t word = 0;
+    memcpy(&word, text, sizeof(word));
+
+    return word;
+}
+
+char *read_file(const char *file_path, size_t *external_len, const JsonAllocator *allocator)
+{
+    FILE *fs = fopen(file_path, "rb");
+    JsonInput input;
     char *buf = NULL;
-    size_t buf_size = 0;
+    size_t buf_len = 0;
+    size_t buf_cap = 0;
 
     if (!fs)
-        goto err_bail; // error case 1: no file
+        return NULL; // error case 1: no file
 
-    fseek(fs, 0, SEEK_END);
-    buf_size = ftell(fs) + 1; // +1 for nul terminator
-    fseek(fs, 0, SEEK_SET);
+    if (!JsonInput_Init(&input, fs, allocator))
+    {
+        fclose(fs);
+        return NULL;
+    }
 
-    if (buf_size == 0 || buf_size > MAX_JSON_LEN)
-        goto err_bail; // error case 2: file too big or small
+    input.owns_file = 1;
+
+    // compressed input has no size up front, so the buffer grows to the limit while decompressing
+    while (1)
+    {
+        if (buf_cap - buf_len <= 1)
+        {
+            if (buf_cap > MAX_JSON_LEN)
+                goto err_bail; // error case 2: file too big
 
-    buf = malloc(sizeof(char) * buf_size);
+            size_t new_cap = (buf_cap > 0) ? buf_cap << 1 : 4096;
 
-    if (!buf)
-        goto err_bail; // error case 3: no buffer
+            if (new_cap > MAX_JSON_LEN + 1)
+                new_cap = MAX_JSON_LEN + 1; // one spare byte tells a file at the limit from a larger one
 
-    fread(buf, sizeof(char), buf_size - 1, fs);
+            char *temp = json_realloc(allocator, buf, new_cap);
 
-    buf[buf_size - 1] = '\0';
-    *external_len = buf_size - 1;
+            if (!temp)
+                goto err_bail; // error case 3: no buffer
+
+            buf = temp;
+            buf_cap = new_cap;
+        }
+
+        size_t got = JsonInput_Read(&input, buf + buf_len, buf_cap - buf_len - 1); // -1 for nul terminator
+
+        if (got == 0)
+            break;
+
+        buf_len += got;
+    }
+
+    if (JsonInput_Get_ErrCode(&input) != NO_ERR)
+        goto err_bail; // error case 4: unreadable, corrupt or unsupported compressed data
+
+    buf[buf_len] = '\0';
+    *external_len = buf_len;
+    JsonInput_Destroy(&input);
 
-err_bail: // cleanup on any exit
-    if (fs != NULL)
-        fclose(fs);
-    
     return buf;
+
+err_bail: // cleanup on failure
+    JsonInput_Destroy(&input);
+    json_free(allocator, buf);
+
+    return NULL;
 }
 
-Lexer *Lexer_Create(const char *file_name)
+Lexer *Lexer_Create(const char *file_name, const JsonAllocator *allocator)
 {
-    Lexer *result = malloc(sizeof(Lexer));
+    Lexer *result = json_alloc(allocator, sizeof(Lexer));
 
     if (!result)
         return result;
     
     size_t temp_doc_len = 0;
-    result->doc_buf = read_file(file_name, &temp_doc_len);
-    result->doc_end = temp_doc_len;
-    result->doc_pos = 0;
+    char *temp_doc_buf = read_file(file_name, &temp_doc_len, allocator);
 
-    strcpy(result->special_null, "null");
-    result->special_null[4] = '\0'; // put null terminator to avoid over-reading
+    Lexer_Init(result, temp_doc_buf, temp_doc_len, allocator);
 
     return result;
 }
 
+void Lexer_Init(Lexer *self, char *src, size_t len, const JsonAllocator *allocator)
+{
+    self->allocator = allocator;
+    self->doc_buf = src;
+    self->doc_end = (src != NULL) ? len : 0;
+    self->doc_pos = 0;
+    self->out_of_memory = 0;
+    JsonStats_Clear(&self->stats);
+}
+
 char *Lexer_CleanUp(Lexer *self)
 {
     char *temp = self->doc_buf; // Get referencing addr. to avoid losing the buffer meant for stringifying tokens in the parser.
@@ -80,189 +180,674 @@ int Lexer_CanUse(const Lexer *self)
     return self->doc_buf != NULL;
 }
 
-void Lexer_Skip_WSpc(Lexer *self)
+/// Scanners: (shared by the public Lexer_Lex_* calls and the inlined Lexer_Lex_Into loop)
+
+/// Same as Token_Create, but visible to the compiler here so the hot loop does not call across files per token.
+static inline Token lexer_token(TokenType type, size_t begin, size_t span)
 {
-    char c = '\0';
+    Token result = {type, 0, begin, {span}};
+
+    return result;
+}
+
+static inline size_t lexer_scan_wspace(const char *buf, size_t pos, size_t end)
+{
+    // skip indentation runs 8 spaces at a time
+    while (end - pos >= 8 && lexer_load_word(buf + pos) == lexer_load_word("    ") && lexer_load_word(buf + pos + 4) == lexer_load_word("    "))
+        pos += 8;
+
+    while (pos < end && JSON_CHAR_CLASS[(unsigned char)buf[pos]] == CC_WSPACE)
+        pos++;
+
+    return pos;
+}
+
+/**
+ * @brief Finds the next char in string text that needs a closer look: a quote, a backslash, a control char or a non-ASCII byte. Plain ASCII text is skipped 16 chars at a time with SSE2, or 8 at a time with SWAR elsewhere.
+ */
+static inline size_t lexer_find_str_special(const char *buf, size_t pos, size_t end)
+{
+#ifdef __SSE2__
+    const __m128i quotes = _mm_set1_epi8('\"');
+    const __m128i slashes = _mm_set1_epi8('\\');
+    const __m128i ctrl_max = _mm_set1_epi8(0x1f);
+
+    while (end - pos >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(buf + pos));
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, quotes), _mm_cmpeq_epi8(chunk, slashes));
+
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(_mm_min_epu8(chunk, ctrl_max), chunk)); // chunk <= 0x1f
+
+        // the byte sign bits flag non-ASCII chars for free
+        unsigned int mask = (unsigned int)(_mm_movemask_epi8(hits) | _mm_movemask_epi8(chunk));
+
+        if (mask != 0)
+            return pos + __builtin_ctz(mask);
+
+        pos += 16;
+    }
+#endif
+
+    while (end - pos >= 8)
+    {
+        uint64_t word = lexer_load_word64(buf + pos);
+
+        if (lexer_word_has(word, '\"') || lexer_word_has(word, '\\') || lexer_word_has_special(word))
+            break;
+
+        pos += 8;
+    }
 
-    do
+    while (pos < end)
     {
-        c = self->doc_buf[self->doc_pos];
+        unsigned char c = (unsigned char)buf[pos];
 
-        if (!is_wspace(c))
+        if (c == '\"' || c == '\\' || c < 0x20 || c >= 0x80)
             break;
-        
-        self->doc_pos++;
-    } while (self->doc_pos < self->doc_end);
+
+        pos++;
+    }
+
+    return pos;
 }
 
-Token *Lexer_Lex_Punct(Lexer *self, TokenType punct_kind)
+static inline int lexer_is_hex(char c)
 {
-    size_t temp_start = self->doc_pos;
-    self->doc_pos++;
+    return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'f');
+}
+
+static inline unsigned int lexer_hex4(const char *text)
+{
+    unsigned int value = 0;
 
-    return Token_Create(punct_kind, temp_start, 1);
+    for (int i = 0; i < 4; i++)
+        value = (value << 4) | (unsigned int)((text[i] <= '9') ? text[i] - '0' : (text[i] | 0x20) - 'a' + 10);
+
+    return value;
 }
 
-Token *Lexer_Lex_Str(Lexer *self)
+/// Checks for a \uXXXX escape at pos, giving its code unit or -1.
+static inline long lexer_scan_u_escape(const char *buf, size_t pos, size_t end)
 {
-    self->doc_pos++;
+    if (end - pos < 6 || buf[pos] != '\\' || buf[pos + 1] != 'u'
+        || !lexer_is_hex(buf[pos + 2]) || !lexer_is_hex(buf[pos + 3]) || !lexer_is_hex(buf[pos + 4]) || !lexer_is_hex(buf[pos + 5]))
+        return -1;
 
-    size_t curr_start = self->doc_pos;
-    size_t curr_span = 0;
-    char c = '\0';
-    
-    do
+    return (long)lexer_hex4(buf + pos + 2);
+}
+
+/**
+ * @brief Checks the escape at pos, where a high surrogate must be followed by an escaped low one.
+ *
+ * @return size_t Length of the escape, or 0 if it is invalid or cut off.
+ */
+static size_t lexer_scan_escape(const char *buf, size_t pos, size_t end)
+{
+    if (end - pos < 2)
+        return 0;
+
+    switch (buf[pos + 1])
     {
-        c = self->doc_buf[self->doc_pos];
+    case '\"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+        return 2;
+    case 'u':
+    {
+        long code = lexer_scan_u_escape(buf, pos, end);
 
-        if (c == '\"')
-        {
-            self->doc_pos++; // skip past end quote to avoid stalling lexer loop!
-            break;
-        }
+        if (code < 0xd800 || code > 0xdfff)
+            return (code < 0) ? 0 : 6;
 
-        curr_span++;
-        self->doc_pos++;
-    } while (self->doc_pos < self->doc_end);
+        long low = (code <= 0xdbff) ? lexer_scan_u_escape(buf, pos + 6, end) : -1;
 
-    return Token_Create(STRBODY, curr_start, curr_span);
+        return (low >= 0xdc00 && low <= 0xdfff) ? 12 : 0;
+    }
+    default:
+        return 0;
+    }
 }
 
-Token *Lexer_Lex_Num(Lexer *self)
+/**
+ * @brief Checks one UTF-8 sequence at pos, rejecting overlong forms, surrogates and code points past U+10FFFF.
+ *
+ * @return size_t Length of the sequence, or 0 if it is invalid or cut off.
+ */
+static inline size_t lexer_scan_utf8(const char *buf, size_t pos, size_t end)
 {
-    int digit_count = 0; // to check against lone points!
-    int point_count = 0; // if > 1, then the literal is NaN!
-    size_t curr_start = self->doc_pos;
-    size_t curr_span = 0;
-    char c = '\0';
+    const unsigned char *text = (const unsigned char*)buf + pos;
+    size_t left = end - pos;
+    unsigned char lead = text[0];
+    unsigned char low = 0x80;
+    unsigned char high = 0xbf;
+    size_t len = 0;
+
+    if (lead >= 0xc2 && lead <= 0xdf)
+        len = 2;
+    else if (lead >= 0xe0 && lead <= 0xef)
+    {
+        len = 3;
+        low = (lead == 0xe0) ? 0xa0 : 0x80; // no overlong forms
+        high = (lead == 0xed) ? 0x9f : 0xbf; // no surrogates
+    }
+    else if (lead >= 0xf0 && lead <= 0xf4)
+    {
+        len = 4;
+        low = (lead == 0xf0) ? 0x90 : 0x80;
+        high = (lead == 0xf4) ? 0x8f : 0xbf; // nothing past U+10FFFF
+    }
 
-    do
+    if (len == 0 || left < len || text[1] < low || text[1] > high)
+        return 0;
+
+    for (size_t i = 2; i < len; i++)
     {
-        c = self->doc_buf[self->doc_pos];
+        if (text[i] < 0x80 || text[i] > 0xbf)
+            return 0;
+    }
 
-        if (!is_digit(c) && c != '.')
-            break;
-        else if (c == '.')
-            point_count++;
-        else if (is_digit(c))
-            digit_count++;
+    return len;
+}
 
-        // reject invalid decimals
-        if (point_count > 1)
-            break;
+#ifdef LEXER_SSSE3
 
-        curr_span++;
-        self->doc_pos++;
-    } while (self->doc_pos < self->doc_end);
+/// UTF-8 error classes of the lookup validator (Keiser & Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte").
+#define U8_TOO_SHORT (1 << 0)  // lead byte not followed by a continuation
+#define U8_TOO_LONG (1 << 1)   // continuation after ASCII
+#define U8_OVERLONG_3 (1 << 2)
+#define U8_TOO_LARGE (1 << 3)
+#define U8_SURROGATE (1 << 4)
+#define U8_OVERLONG_2 (1 << 5)
+#define U8_TOO_LARGE_1000 (1 << 6)
+#define U8_OVERLONG_4 (1 << 6)
+#define U8_TWO_CONTS (1 << 7)  // continuation after continuation, unless a 3 or 4 byte lead allows it
+#define U8_CARRY (U8_TOO_SHORT | U8_TOO_LONG | U8_TWO_CONTS)
 
-    if (point_count == 0)
-        return Token_Create(INT_LTRL, curr_start, curr_span);
-    else if (point_count == 1)
-        return Token_Create(FLT_LTRL, curr_start, curr_span);
-    
-    return Token_Create(UNKNOWN, curr_start, curr_span);
+static int lexer_ssse3_ok = -1;
+
+/**
+ * @brief Flags the bytes of input that break UTF-8, given the 16 bytes before it. Each byte pair is classified by three table lookups on its nibbles, so there is no branch per char.
+ */
+__attribute__((target("ssse3"))) static inline __m128i lexer_utf8_errors(__m128i input, __m128i prev_input)
+{
+    const __m128i low_nibbles = _mm_set1_epi8(0x0f);
+    const __m128i byte_1_high_table = _mm_setr_epi8(
+        U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG,
+        U8_TWO_CONTS, U8_TWO_CONTS, U8_TWO_CONTS, U8_TWO_CONTS,
+        U8_TOO_SHORT | U8_OVERLONG_2, U8_TOO_SHORT, U8_TOO_SHORT | U8_OVERLONG_3 | U8_SURROGATE,
+        U8_TOO_SHORT | U8_TOO_LARGE | U8_TOO_LARGE_1000 | U8_OVERLONG_4);
+    const __m128i byte_1_low_table = _mm_setr_epi8(
+        U8_CARRY | U8_OVERLONG_3 | U8_OVERLONG_2 | U8_OVERLONG_4, U8_CARRY | U8_OVERLONG_2, U8_CARRY, U8_CARRY,
+        U8_CARRY | U8_TOO_LARGE, U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000, U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+        U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000, U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+        U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000, U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+        U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000, U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+        U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000 | U8_SURROGATE, U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000,
+        U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000);
+    const __m128i byte_2_high_table = _mm_setr_epi8(
+        U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT,
+        U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_OVERLONG_3 | U8_TOO_LARGE_1000 | U8_OVERLONG_4,
+        U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_OVERLONG_3 | U8_TOO_LARGE,
+        U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_SURROGATE | U8_TOO_LARGE,
+        U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_SURROGATE | U8_TOO_LARGE,
+        U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT);
+
+    __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+    __m128i byte_1_high = _mm_shuffle_epi8(byte_1_high_table, _mm_and_si128(_mm_srli_epi16(prev1, 4), low_nibbles));
+    __m128i byte_1_low = _mm_shuffle_epi8(byte_1_low_table, _mm_and_si128(prev1, low_nibbles));
+    __m128i byte_2_high = _mm_shuffle_epi8(byte_2_high_table, _mm_and_si128(_mm_srli_epi16(input, 4), low_nibbles));
+    __m128i special_cases = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+    // third and fourth bytes of 3 and 4 byte sequences are the only continuations allowed after a continuation
+    __m128i is_third = _mm_subs_epu8(_mm_alignr_epi8(input, prev_input, 14), _mm_set1_epi8((char)(0xe0 - 0x80)));
+    __m128i is_fourth = _mm_subs_epu8(_mm_alignr_epi8(input, prev_input, 13), _mm_set1_epi8((char)(0xf0 - 0x80)));
+    __m128i must_continue = _mm_and_si128(_mm_or_si128(is_third, is_fourth), _mm_set1_epi8((char)0x80));
+
+    return _mm_xor_si128(must_continue, special_cases);
 }
 
-Token *Lexer_Lex_Null(Lexer *self)
+/**
+ * @brief Validates string text 16 chars at a time from a non-ASCII byte at pos, until a block holds a quote, backslash or control char, a block is plain ASCII again, or fewer than 16 chars remain. Errors past the first special char belong to later text and are ignored.
+ *
+ * @return size_t Where the caller should continue: a special char, the start of a sequence cut by the last block, or past an ASCII block.
+ */
+__attribute__((target("ssse3"))) static size_t lexer_scan_utf8_ssse3(const char *buf, size_t pos, size_t end, int *invalid)
 {
-    int valid_null = 1;
-    size_t curr_start = self->doc_pos;
-    size_t curr_span = 1;
-    int check_idx = 0; // index of lexer's "null" string
-    char c = '\0';
+    const __m128i quotes = _mm_set1_epi8('\"');
+    const __m128i slashes = _mm_set1_epi8('\\');
+    const __m128i ctrl_max = _mm_set1_epi8(0x1f);
+    __m128i prev_input = _mm_setzero_si128(); // the text before pos is ASCII
 
-    do
+    while (end - pos >= 16)
     {
-        c = self->doc_buf[self->doc_pos];
+        __m128i input = _mm_loadu_si128((const __m128i*)(buf + pos));
+        __m128i specials = _mm_or_si128(_mm_cmpeq_epi8(input, quotes), _mm_cmpeq_epi8(input, slashes));
 
-        // track current token text against "null"
-        if (self->special_null[check_idx] == c)
-            check_idx++;
-        else
+        specials = _mm_or_si128(specials, _mm_cmpeq_epi8(_mm_min_epu8(input, ctrl_max), input));
+
+        unsigned int special_mask = (unsigned int)_mm_movemask_epi8(specials);
+        unsigned int stop = (special_mask != 0) ? (unsigned int)__builtin_ctz(special_mask) : 16;
+        __m128i errors = _mm_cmpeq_epi8(lexer_utf8_errors(input, prev_input), _mm_setzero_si128());
+
+        // a sequence cut short by the special char is flagged at the special char itself
+        unsigned int error_mask = ~(unsigned int)_mm_movemask_epi8(errors) & ((stop < 16) ? (2u << stop) - 1 : 0xffffu);
+
+        if (error_mask != 0)
+            *invalid = 1;
+
+        if (error_mask != 0 || special_mask != 0 || _mm_movemask_epi8(input) == 0)
+            return pos + stop;
+
+        prev_input = input;
+        pos += 16;
+    }
+
+    // step back to the lead of a sequence the last block cut, so the scalar check sees it whole
+    for (size_t back = 1; back <= 3 && back <= pos; back++)
+    {
+        unsigned char c = (unsigned char)buf[pos - back];
+
+        if ((c & 0xc0) != 0x80)
         {
-            valid_null = 0;
-            break;
+            size_t need = (c >= 0xf0) ? 4 : (c >= 0xe0) ? 3 : (c >= 0xc0) ? 2 : 1;
+            return (need > back) ? pos - back : pos;
         }
+    }
 
-        curr_span++;
+    return pos;
+}
 
-        // handle case of full "null" text
-        if (check_idx == 3)
-            break;
+#endif
+
+/**
+ * @brief Validates mixed text starting at a non-ASCII byte. Text in most non-English languages interleaves short ASCII and multi-byte runs, so this stays in one scalar loop until it meets a quote, backslash or control char, or until a long ASCII run makes the vector skip worth re-entering.
+ *
+ * @return size_t Position of the first char left for the caller, or of an invalid sequence when *invalid is set.
+ */
+static inline size_t lexer_scan_utf8_run(const char *buf, size_t pos, size_t end, int *invalid)
+{
+#ifdef LEXER_SSSE3
+    if (lexer_ssse3_ok < 0)
+        lexer_ssse3_ok = __builtin_cpu_supports("ssse3"); // racing threads all store the same answer
+
+    if (lexer_ssse3_ok && end - pos >= 16)
+    {
+        size_t next = lexer_scan_utf8_ssse3(buf, pos, end, invalid);
 
-        self->doc_pos++;
+        if (next != pos)
+            return next;
     }
-    while (self->doc_pos < self->doc_end);
+#endif
 
-    self->doc_pos++;
+    size_t ascii_run = 0;
 
-    if (!valid_null)
-        return Token_Create(UNKNOWN, curr_start, curr_span);
-    
-    return Token_Create(NULL_LTRL, curr_start, curr_span);
+    while (pos < end && ascii_run < 16)
+    {
+        unsigned char c = (unsigned char)buf[pos];
+
+        if (c < 0x80)
+        {
+            if (c == '\"' || c == '\\' || c < 0x20)
+                break;
+
+            ascii_run++;
+            pos++;
+            continue;
+        }
+
+        size_t len = lexer_scan_utf8(buf, pos, end);
+
+        if (len == 0)
+        {
+            *invalid = 1;
+            return pos + 1;
+        }
+
+        ascii_run = 0;
+        pos += len;
+    }
+
+    return pos;
 }
 
-TokenVec *Lexer_Lex_All(Lexer *self)
+/**
+ * @brief Scans string text up to its closing quote, validating escapes and UTF-8 on the way. Escapes are only checked here and flagged on the token, so strings without them are later copied instead of decoded.
+ */
+static inline Token lexer_scan_str(const char *buf, size_t *pos, size_t end)
 {
-    size_t result_idx = 0; // token vector insert position
-    Token *temp = NULL;
-    TokenVec *result = TokenVec_Create(8); // collection of lexed tokens
-    char peeked_char = '\0';
+    size_t curr_start = *pos + 1;
+    size_t scan = curr_start;
+    unsigned int flags = 0;
+    int invalid = 0;
 
     while (1)
     {
-        // check for EOF before consuming any other token!
-        if (self->doc_pos >= self->doc_end)
+        scan = lexer_find_str_special(buf, scan, end);
+
+        // reject an unterminated string after consuming the rest of the text
+        if (scan >= end)
         {
-            temp = Token_Create(FILE_END, self->doc_pos, 1);
-            break;
+            *pos = end;
+            return lexer_token(UNKNOWN, curr_start - 1, end - curr_start + 1);
         }
 
-        peeked_char = self->doc_buf[self->doc_pos];
+        unsigned char c = (unsigned char)buf[scan];
+        size_t len = 1;
 
-        if (is_wspace(peeked_char))
+        if (c == '\"')
+            break;
+
+        if (c == '\\')
+        {
+            flags |= TOKEN_ESCAPED;
+            len = lexer_scan_escape(buf, scan, end);
+
+            if (len == 0)
+            {
+                // an escaped quote still must not end the string, even when the escape around it is bad
+                len = (end - scan >= 2 && (buf[scan + 1] == '\"' || buf[scan + 1] == '\\')) ? 2 : 1;
+                invalid = 1;
+            }
+        }
+        else if (c < 0x80)
+            invalid = 1; // raw control char
+        else
         {
-            Lexer_Skip_WSpc(self);
+            scan = lexer_scan_utf8_run(buf, scan, end, &invalid);
             continue;
         }
 
-        switch (peeked_char)
+        scan += len;
+    }
+
+    *pos = scan + 1; // skip past end quote to avoid stalling lexer loop!
+
+    // a bad string is still consumed whole, so lexing resumes after it
+    Token result = lexer_token(invalid ? UNKNOWN : STRBODY, curr_start, scan - curr_start);
+    result.flags = flags;
+
+    return result;
+}
+
+static inline Token lexer_scan_num(const char *buf, size_t *pos_ref, size_t end)
+{
+    size_t curr_start = *pos_ref;
+    size_t pos = curr_start;
+    size_t digit_count = 0;
+    int is_float = 0;
+
+    if (buf[pos] == '-')
+        pos++;
+
+    size_t int_start = pos;
+
+    while (pos < end && is_digit(buf[pos]))
+        pos++;
+
+    digit_count = pos - curr_start;
+    int leading_zero = (pos - int_start > 1 && buf[int_start] == '0'); // RFC 8259 has no 01 or -00
+
+    // fraction part
+    if (pos < end && buf[pos] == '.')
+    {
+        size_t frac_start = ++pos;
+
+        while (pos < end && is_digit(buf[pos]))
+            pos++;
+
+        digit_count = (pos > frac_start) ? digit_count : 0; // reject lone points!
+        is_float = 1;
+    }
+
+    // exponent part
+    if (pos < end && (buf[pos] == 'e' || buf[pos] == 'E'))
+    {
+        pos++;
+
+        if (pos < end && (buf[pos] == '+' || buf[pos] == '-'))
+            pos++;
+
+        size_t exp_start = pos;
+
+        while (pos < end && is_digit(buf[pos]))
+            pos++;
+
+        digit_count = (pos > exp_start) ? digit_count : 0;
+        is_float = 1;
+    }
+
+    *pos_ref = pos;
+
+    if (digit_count == 0 || (buf[curr_start] == '-' && digit_count == 1) || leading_zero)
+        return lexer_token(UNKNOWN, curr_start, pos - curr_start);
+
+    return lexer_token(is_float ? FLT_LTRL : INT_LTRL, curr_start, pos - curr_start);
+}
+
+static inline Token lexer_scan_literal(const char *buf, size_t *pos, size_t end)
+{
+    size_t curr_start = *pos;
+    size_t remaining = end - curr_start;
+    const char *text = buf + curr_start;
+
+    if (remaining >= 4)
+    {
+        uint32_t word = lexer_load_word(text);
+
+        if (word == lexer_load_word("null"))
+        {
+            *pos += 4;
+            return lexer_token(NULL_LTRL, curr_start, 4);
+        }
+        else if (word == lexer_load_word("true"))
         {
-        case '[':
-            temp = Lexer_Lex_Punct(self, LBRACKET);
+            *pos += 4;
+            return lexer_token(TRUE_LTRL, curr_start, 4);
+        }
+        else if (remaining >= 5 && word == lexer_load_word("fals") && text[4] == 'e')
+        {
+            *pos += 5;
+            return lexer_token(FALSE_LTRL, curr_start, 5);
+        }
+    }
+
+    *pos += 1;
+
+    return lexer_token(UNKNOWN, curr_start, 1);
+}
+
+/// Lexer Steps:
+
+void Lexer_Skip_WSpc(Lexer *self)
+{
+    self->doc_pos = lexer_scan_wspace(self->doc_buf, self->doc_pos, self->doc_end);
+}
+
+Token Lexer_Lex_Punct(Lexer *self, TokenType punct_kind)
+{
+    size_t temp_start = self->doc_pos;
+    self->doc_pos++;
+
+    return lexer_token(punct_kind, temp_start, (punct_kind == LBRACKET || punct_kind == LCURLY) ? 0 : 1);
+}
+
+Token Lexer_Lex_Str(Lexer *self) { return lexer_scan_str(self->doc_buf, &self->doc_pos, self->doc_end); }
+
+Token Lexer_Lex_Num(Lexer *self) { return lexer_scan_num(self->doc_buf, &self->doc_pos, self->doc_end); }
+
+Token Lexer_Lex_Literal(Lexer *self) { return lexer_scan_literal(self->doc_buf, &self->doc_pos, self->doc_end); }
+
+Token Lexer_Lex_Next(Lexer *self)
+{
+    const char *buf = self->doc_buf;
+    size_t pos = lexer_scan_wspace(buf, self->doc_pos, self->doc_end);
+    Token result;
+
+    if (pos >= self->doc_end)
+    {
+        self->doc_pos = pos;
+        return lexer_token(FILE_END, pos, 0);
+    }
+
+    unsigned char char_class = JSON_CHAR_CLASS[(unsigned char)buf[pos]];
+
+    switch (char_class)
+    {
+    case CC_QUOTE:
+        result = lexer_scan_str(buf, &pos, self->doc_end);
+        break;
+    case CC_NUMBER:
+        result = lexer_scan_num(buf, &pos, self->doc_end);
+        break;
+    case CC_LITERAL:
+        result = lexer_scan_literal(buf, &pos, self->doc_end);
+        break;
+    case CC_OTHER:
+        result = lexer_token(UNKNOWN, pos, 1);
+        pos++;
+        break;
+    default:
+        // without a tape there is no closer index to give an opener
+        result = lexer_token(PUNCT_TOKENS[char_class], pos, (char_class == CC_LBRACKET || char_class == CC_LCURLY) ? 0 : 1);
+        pos++;
+        break;
+    }
+
+    self->doc_pos = pos;
+
+    return result;
+}
+
+size_t Lexer_Lex_Into(Lexer *self, TokenVec *out)
+{
+    JSON_STATS_BIND(&self->stats);
+    JSON_TIMER_START(lex_start);
+
+    // keep the cursor in locals so token stores into the tape cannot force reloads
+    const char *buf = self->doc_buf;
+    size_t pos = self->doc_pos;
+    size_t end = self->doc_end;
+    size_t old_count = out->count;
+    size_t open = LEXER_NO_OPENER; // innermost open opener, whose skip links to the one around it until it closes
+    size_t last_unknown = 0;       // a container holds an UNKNOWN token iff the latest one comes after its opener
+    Token temp;
+    unsigned char char_class = CC_OTHER;
+
+    while (1)
+    {
+        // check for EOF before consuming any other token!
+        if (pos >= end)
             break;
-        case ']':
-            temp = Lexer_Lex_Punct(self, RBRACKET);
+
+        char_class = JSON_CHAR_CLASS[(unsigned char)buf[pos]];
+
+        // dense class values let this compile to one jump table
+        switch (char_class)
+        {
+        case CC_WSPACE:
+            pos = lexer_scan_wspace(buf, pos + 1, end);
+            continue;
+        case CC_LBRACKET:
+        case CC_LCURLY:
+            temp = lexer_token(PUNCT_TOKENS[char_class], pos, 0);
+            temp.skip = open;
+            open = out->count;
+            pos++;
             break;
-        case '{':
-            temp = Lexer_Lex_Punct(self, LCURLY);
+        case CC_RBRACKET:
+        case CC_RCURLY:
+            temp = lexer_token(PUNCT_TOKENS[char_class], pos, 1);
+            pos++;
+
+            if (open != LEXER_NO_OPENER)
+            {
+                Token *opener = out->data + open;
+                size_t outer = opener->skip;
+
+                opener->skip = out->count - open;
+                opener->flags += (opener->skip > 1); // the last element has no comma after it
+                opener->flags |= (last_unknown > open) ? TOKEN_HAS_UNKNOWN : 0;
+                open = outer;
+            }
             break;
-        case '}':
-            temp = Lexer_Lex_Punct(self, RCURLY);
+        case CC_COMMA:
+            if (open != LEXER_NO_OPENER)
+                out->data[open].flags++;
+            // fall through
+        case CC_COLON:
+            temp = lexer_token(PUNCT_TOKENS[char_class], pos, 1);
+            pos++;
             break;
-        case '\"':
-            temp = Lexer_Lex_Str(self);
+        case CC_QUOTE:
+            temp = lexer_scan_str(buf, &pos, end);
+            last_unknown = (temp.type == UNKNOWN) ? out->count : last_unknown;
             break;
-        case ':':
-            temp = Lexer_Lex_Punct(self, COLON);
+        case CC_NUMBER:
+            temp = lexer_scan_num(buf, &pos, end);
+            last_unknown = (temp.type == UNKNOWN) ? out->count : last_unknown;
             break;
-        case 'n':
-            temp = Lexer_Lex_Null(self);
-        case ',':
-            temp = Lexer_Lex_Punct(self, COMMA);
+        case CC_LITERAL:
+            temp = lexer_scan_literal(buf, &pos, end);
+            last_unknown = (temp.type == UNKNOWN) ? out->count : last_unknown;
             break;
         default:
-            if (is_digit(peeked_char))
-                temp = Lexer_Lex_Num(self);
-            else
-                temp = Token_Create(UNKNOWN, self->doc_pos, 1);
+            temp = lexer_token(UNKNOWN, pos, 1); // consume the stray char so lexing always advances
+            last_unknown = out->count;
+            pos++;
             break;
         }
 
-        TokenVec_Set(result, result_idx, temp); // append a new token to a dynamic vector
+        // append a new token to the tape
+        if (out->count == out->capacity && !TokenVec_Grow(out))
+        {
+            if (open == out->count)
+                open = temp.skip; // the opener never made it onto the tape
 
-        result_idx++;
+            self->out_of_memory = 1;
+            break;
+        }
+
+        out->data[out->count++] = temp;
     }
-    
+
+    // containers left open have no closer to point at
+    while (open != LEXER_NO_OPENER)
+    {
+        size_t outer = out->data[open].skip;
+
+        out->data[open].skip = 0;
+        out->data[open].flags = 0;
+        open = outer;
+    }
+
+    self->doc_pos = pos;
+    size_t lexed_count = out->count - old_count;
+
+    JSON_TIMER_STOP(lex_start, &self->stats, lex_cycles);
+    JSON_STATS_ADD(token_count, lexed_count);
+    JSON_STATS_UNBIND();
+    JSON_PROBE1(lex_done, lexed_count);
+
+    return lexed_count;
+}
+
+TokenVec *Lexer_Lex_All(Lexer *self)
+{
+    TokenVec *result = TokenVec_Create(8, self->allocator); // collection of lexed tokens
+
+    if (!result)
+    {
+        self->out_of_memory = 1;
+        return result;
+    }
+
+    Lexer_Lex_Into(self, result);
+
+    if (self->out_of_memory)
+    {
+        TokenVec_Destroy(result);
+        json_free(self->allocator, result);
+        result = NULL;
+    }
+
     return result;
 }
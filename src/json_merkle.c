@@ -0,0 +1,613 @@
+/**
+ * @file json_merkle.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Implements subtree hashing, hash-guided diffs and the shared subtree store.
+ * @date 2026-10-19
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "json_merkle.h"
+
+#define MERKLE_NO_MEMORY ((size_t)-1)
+#define MERKLE_GOLDEN 0x9e3779b97f4a7c15ULL
+
+/// Property and ArrayItem values share this layout, so hashing and comparing read either through it.
+typedef union merkle_data
+{
+    int i;
+    float f;
+    char *str;
+    void *chunk;
+} MerkleData;
+
+_Static_assert(sizeof(MerkleData) == sizeof(((Property*)0)->data) && sizeof(MerkleData) == sizeof(((ArrayItem*)0)->data), "value unions must share a layout");
+
+/// JSON Pointer being built while a diff descends.
+typedef struct merkle_path
+{
+    char *buf;
+    size_t len;
+    size_t capacity;
+    const JsonAllocator *allocator;
+} MerklePath;
+
+/// Hashing:
+
+/// The 64-bit finalizer from MurmurHash3, so nearby inputs land far apart.
+static uint64_t merkle_mix(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+
+    return x;
+}
+
+static uint64_t merkle_hash_str(const char *str)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (; *str != '\0'; str++)
+        hash = (hash ^ (unsigned char)*str) * 1099511628211ULL;
+
+    return merkle_mix(hash);
+}
+
+static uint64_t merkle_hash_data(DataType type, const void *data_ptr);
+
+/**
+ * @brief Stores a computed hash in its container. The hash is a cache kept beside the content rather than part of it, so this is the one place where hashing writes, const document or not (see note 4 in json_merkle.h).
+ */
+static uint64_t merkle_cache(const uint64_t *slot, uint64_t hash)
+{
+    hash = (hash != 0) ? hash : 1; // 0 means not hashed yet
+    *(uint64_t*)slot = hash;
+
+    return hash;
+}
+
+static uint64_t merkle_hash_array(const Array *self)
+{
+    if (self->hash != 0)
+        return self->hash;
+
+    uint64_t hash = merkle_mix(ARR * MERKLE_GOLDEN + self->length);
+
+    // chained, so the hash depends on item order
+    for (const ArrayItem *item = self->head; item != NULL; item = item->next)
+        hash = merkle_mix(hash ^ merkle_hash_data(item->type, &item->data)) + MERKLE_GOLDEN;
+
+    return merkle_cache(&self->hash, hash);
+}
+
+static uint64_t merkle_hash_object(const Object *self)
+{
+    if (self->hash != 0)
+        return self->hash;
+
+    uint64_t sum = 0;
+
+    // each member hashes its name with its value, and the sum makes member order irrelevant
+    for (size_t curr = 0; curr < self->bucket_count; curr++)
+    {
+        const Property *prop = (const Property*)self->buckets[curr];
+
+        if (prop != NULL)
+            sum += merkle_mix(merkle_hash_str(prop->name) * MERKLE_GOLDEN ^ merkle_hash_data(prop->type, &prop->data));
+    }
+
+    return merkle_cache(&self->hash, merkle_mix(sum ^ (OBJ * MERKLE_GOLDEN + self->count)));
+}
+
+static uint64_t merkle_hash_data(DataType type, const void *data_ptr)
+{
+    MerkleData data;
+    uint64_t payload = 0;
+
+    memcpy(&data, data_ptr, sizeof(data));
+
+    switch (type)
+    {
+    case INT:
+    case BOOL:
+        payload = (uint32_t)data.i;
+        break;
+    case FLT:
+    {
+        uint32_t bits = 0;
+        memcpy(&bits, &data.f, sizeof(bits));
+        payload = bits;
+        break;
+    }
+    case STR:
+        payload = merkle_hash_str(data.str);
+        break;
+    case ARR:
+        return merkle_hash_array((const Array*)data.chunk);
+    case OBJ:
+        return merkle_hash_object((const Object*)data.chunk);
+    default:
+        break;
+    }
+
+    // the type is mixed in, so 1, 1.0, true and "1" all differ
+    return merkle_mix(payload + (uint64_t)(type + 1) * MERKLE_GOLDEN);
+}
+
+/**
+ * @brief Compares values exactly, rejecting by cached hash first and accepting shared chunks without a walk.
+ */
+static int merkle_equal(DataType a_type, const void *a_ptr, DataType b_type, const void *b_ptr)
+{
+    MerkleData a;
+    MerkleData b;
+
+    memcpy(&a, a_ptr, sizeof(a));
+    memcpy(&b, b_ptr, sizeof(b));
+
+    if (a_type != b_type)
+        return 0;
+    else if ((a_type == ARR || a_type == OBJ) && a.chunk == b.chunk)
+        return 1;
+    else if (merkle_hash_data(a_type, &a) != merkle_hash_data(b_type, &b))
+        return 0;
+
+    switch (a_type)
+    {
+    case INT:
+    case BOOL:
+        return a.i == b.i;
+    case FLT:
+        return memcmp(&a.f, &b.f, sizeof(float)) == 0;
+    case STR:
+        return strcmp(a.str, b.str) == 0;
+    case ARR:
+    {
+        const ArrayItem *a_item = ((const Array*)a.chunk)->head;
+        const ArrayItem *b_item = ((const Array*)b.chunk)->head;
+
+        if (Array_Length(a.chunk) != Array_Length(b.chunk))
+            return 0;
+
+        for (; a_item != NULL; a_item = a_item->next, b_item = b_item->next)
+        {
+            if (!merkle_equal(a_item->type, &a_item->data, b_item->type, &b_item->data))
+                return 0;
+        }
+
+        return 1;
+    }
+    case OBJ:
+    {
+        const Object *a_obj = (const Object*)a.chunk;
+        const Object *b_obj = (const Object*)b.chunk;
+
+        if (a_obj->count != b_obj->count)
+            return 0;
+
+        for (size_t curr = 0; curr < a_obj->bucket_count; curr++)
+        {
+            const Property *a_prop = (const Property*)a_obj->buckets[curr];
+            const Property *b_prop = (a_prop != NULL) ? Object_GetItem(b_obj, a_prop->name) : NULL;
+
+            if (!a_prop)
+                continue;
+            else if (!b_prop || !merkle_equal(a_prop->type, &a_prop->data, b_prop->type, &b_prop->data))
+                return 0;
+        }
+
+        return 1;
+    }
+    default:
+        return 1;
+    }
+}
+
+uint64_t JsonThing_Hash(const JsonThing *self)
+{
+    if (!self->root)
+        return 0;
+
+    return merkle_hash_data(self->root->type, &self->root->data);
+}
+
+int JsonThing_Same(const JsonThing *a, const JsonThing *b) { return JsonThing_Hash(a) == JsonThing_Hash(b); }
+
+/// Diff:
+
+/**
+ * @brief Appends "/" and a key or index to the path, escaping '~' and '/' in keys.
+ *
+ * @param key NULL to append index instead.
+ * @return int 0 if memory ran out.
+ */
+static int merkle_path_push(MerklePath *self, const char *key, size_t index)
+{
+    char index_txt[24];
+
+    if (!key)
+    {
+        snprintf(index_txt, sizeof(index_txt), "%zu", index);
+        key = index_txt;
+    }
+
+    size_t need = self->len + 2 * strlen(key) + 2;
+
+    if (need > self->capacity)
+    {
+        size_t new_capacity = (self->capacity > 0) ? self->capacity : 64;
+
+        while (new_capacity < need)
+            new_capacity <<= 1;
+
+        char *temp = json_realloc(self->allocator, (self->capacity > 0) ? self->buf : NULL, new_capacity);
+
+        if (!temp)
+            return 0;
+
+        self->buf = temp;
+        self->capacity = new_capacity;
+    }
+
+    self->buf[self->len++] = '/';
+
+    for (; *key != '\0'; key++)
+    {
+        if (*key == '~' || *key == '/')
+        {
+            self->buf[self->len++] = '~';
+            self->buf[self->len++] = (*key == '~') ? '0' : '1';
+        }
+        else
+            self->buf[self->len++] = *key;
+    }
+
+    self->buf[self->len] = '\0';
+
+    return 1;
+}
+
+/**
+ * @brief Tells whether a diff can skip a pair of values: shared chunks without reading them, and other containers by their cached hashes.
+ */
+static int merkle_unchanged(DataType a_type, const MerkleData *a, DataType b_type, const MerkleData *b)
+{
+    if (a_type != b_type)
+        return 0;
+    else if ((a_type == ARR || a_type == OBJ) && a->chunk == b->chunk)
+        return 1;
+
+    return merkle_hash_data(a_type, a) == merkle_hash_data(b_type, b);
+}
+
+static size_t merkle_diff(MerklePath *path, DataType a_type, const void *a_ptr, DataType b_type, const void *b_ptr, DiffCallback on_diff, void *user);
+
+/**
+ * @brief Diffs one child under its key or index, then restores the path.
+ */
+static size_t merkle_diff_child(MerklePath *path, const char *key, size_t index, DataType a_type, const void *a_ptr, DataType b_type, const void *b_ptr, DiffCallback on_diff, void *user)
+{
+    MerkleData a;
+    MerkleData b;
+    size_t old_len = path->len;
+
+    memcpy(&a, a_ptr, sizeof(a));
+    memcpy(&b, b_ptr, sizeof(b));
+
+    // equal subtrees are skipped before their path is even built, which keeps a diff proportional to the changes
+    if (merkle_unchanged(a_type, &a, b_type, &b))
+        return 0;
+    else if (!merkle_path_push(path, key, index))
+        return MERKLE_NO_MEMORY;
+
+    size_t found = merkle_diff(path, a_type, a_ptr, b_type, b_ptr, on_diff, user);
+
+    path->len = old_len;
+    path->buf[old_len] = '\0';
+
+    return found;
+}
+
+/**
+ * @brief Reports a value present on one side only.
+ */
+static size_t merkle_report(MerklePath *path, const char *key, size_t index, DiffKind kind, DiffCallback on_diff, void *user)
+{
+    size_t old_len = path->len;
+
+    if (!merkle_path_push(path, key, index))
+        return MERKLE_NO_MEMORY;
+
+    on_diff(user, path->buf, kind);
+    path->len = old_len;
+    path->buf[old_len] = '\0';
+
+    return 1;
+}
+
+static size_t merkle_diff(MerklePath *path, DataType a_type, const void *a_ptr, DataType b_type, const void *b_ptr, DiffCallback on_diff, void *user)
+{
+    MerkleData a;
+    MerkleData b;
+    size_t total = 0;
+    size_t found = 0;
+
+    memcpy(&a, a_ptr, sizeof(a));
+    memcpy(&b, b_ptr, sizeof(b));
+
+    if (merkle_unchanged(a_type, &a, b_type, &b))
+        return 0;
+    else if (a_type != b_type || (a_type != ARR && a_type != OBJ))
+    {
+        on_diff(user, path->buf, DIFF_CHANGED);
+        return 1;
+    }
+
+    if (a_type == ARR)
+    {
+        const ArrayItem *a_item = ((const Array*)a.chunk)->head;
+        const ArrayItem *b_item = ((const Array*)b.chunk)->head;
+        size_t index = 0;
+
+        for (; a_item != NULL || b_item != NULL; index++)
+        {
+            if (a_item != NULL && b_item != NULL)
+                found = merkle_diff_child(path, NULL, index, a_item->type, &a_item->data, b_item->type, &b_item->data, on_diff, user);
+            else
+                found = merkle_report(path, NULL, index, (a_item != NULL) ? DIFF_REMOVED : DIFF_ADDED, on_diff, user);
+
+            if (found == MERKLE_NO_MEMORY)
+                return found;
+
+            total += found;
+            a_item = (a_item != NULL) ? a_item->next : NULL;
+            b_item = (b_item != NULL) ? b_item->next : NULL;
+        }
+
+        return total;
+    }
+
+    const Object *a_obj = (const Object*)a.chunk;
+    const Object *b_obj = (const Object*)b.chunk;
+
+    for (size_t curr = 0; curr < a_obj->bucket_count; curr++)
+    {
+        const Property *a_prop = (const Property*)a_obj->buckets[curr];
+
+        if (!a_prop)
+            continue;
+
+        const Property *b_prop = Object_GetItem(b_obj, a_prop->name);
+
+        if (b_prop != NULL)
+            found = merkle_diff_child(path, a_prop->name, 0, a_prop->type, &a_prop->data, b_prop->type, &b_prop->data, on_diff, user);
+        else
+            found = merkle_report(path, a_prop->name, 0, DIFF_REMOVED, on_diff, user);
+
+        if (found == MERKLE_NO_MEMORY)
+            return found;
+
+        total += found;
+    }
+
+    for (size_t curr = 0; curr < b_obj->bucket_count; curr++)
+    {
+        const Property *b_prop = (const Property*)b_obj->buckets[curr];
+
+        if (!b_prop || Object_GetItem(a_obj, b_prop->name) != NULL)
+            continue;
+
+        found = merkle_report(path, b_prop->name, 0, DIFF_ADDED, on_diff, user);
+
+        if (found == MERKLE_NO_MEMORY)
+            return found;
+
+        total += found;
+    }
+
+    return total;
+}
+
+size_t JsonThing_Diff(const JsonThing *a, const JsonThing *b, DiffCallback on_diff, void *user)
+{
+    char empty[1] = "";
+    MerklePath path = {empty, 0, 0, a->allocator}; // grows onto the heap on the first push
+
+    if (!a->root || !b->root)
+    {
+        if (a->root != NULL || b->root != NULL)
+            on_diff(user, "", (a->root != NULL) ? DIFF_REMOVED : DIFF_ADDED);
+
+        return (a->root != NULL || b->root != NULL);
+    }
+
+    size_t found = merkle_diff(&path, a->root->type, &a->root->data, b->root->type, &b->root->data, on_diff, user);
+
+    if (path.capacity > 0)
+        json_free(path.allocator, path.buf);
+
+    return found;
+}
+
+/// MerkleStore:
+
+static const JsonAllocator *merkle_resolve_allocator(const JsonAllocator *allocator) { return (allocator != NULL) ? allocator : JsonAllocator_Default(); }
+
+/**
+ * @brief Finds a stored chunk equal to the given one.
+ */
+static MerkleEntry *merkle_store_find(MerkleStore *self, uint64_t hash, DataType type, void *chunk)
+{
+    size_t mask = self->capacity - 1;
+
+    for (size_t slot = hash & mask; self->entries[slot].type != UNSUPPORTED; slot = (slot + 1) & mask)
+    {
+        MerkleEntry *entry = self->entries + slot;
+
+        if (entry->hash == hash && merkle_equal(entry->type, &entry->chunk, type, &chunk))
+            return entry;
+    }
+
+    return NULL;
+}
+
+static int merkle_store_grow(MerkleStore *self)
+{
+    size_t old_capacity = self->capacity;
+    MerkleEntry *old_entries = self->entries;
+    size_t new_capacity = old_capacity << 1;
+    MerkleEntry *new_entries = json_alloc(self->allocator, sizeof(MerkleEntry) * new_capacity);
+
+    if (!new_entries)
+        return 0;
+
+    for (size_t i = 0; i < new_capacity; i++)
+        new_entries[i].type = UNSUPPORTED;
+
+    for (size_t i = 0; i < old_capacity; i++)
+    {
+        if (old_entries[i].type == UNSUPPORTED)
+            continue;
+
+        size_t slot = old_entries[i].hash & (new_capacity - 1);
+
+        while (new_entries[slot].type != UNSUPPORTED)
+            slot = (slot + 1) & (new_capacity - 1);
+
+        new_entries[slot] = old_entries[i];
+    }
+
+    json_free(self->allocator, old_entries);
+    self->entries = new_entries;
+    self->capacity = new_capacity;
+
+    return 1;
+}
+
+/**
+ * @brief Interns the chunk in a slot: swaps it for an equal stored one, or interns its children and then stores it.
+ *
+ * @return size_t Subtrees swapped, or MERKLE_NO_MEMORY.
+ */
+static size_t merkle_intern(MerkleStore *self, void **slot, DataType type)
+{
+    uint64_t hash = merkle_hash_data(type, slot);
+    MerkleEntry *found = merkle_store_find(self, hash, type, *slot);
+    size_t swapped = 0;
+    size_t child_swapped = 0;
+
+    if (found != NULL)
+    {
+        if (found->chunk == *slot)
+            return 0;
+
+        Chunk_Retain(found->chunk, type);
+        Chunk_Release(*slot, type, self->allocator);
+        *slot = found->chunk;
+
+        return 1;
+    }
+
+    // swapping a child for an equal one leaves this chunk's content and hash as they were
+    if (type == ARR)
+    {
+        for (ArrayItem *item = ((Array*)*slot)->head; item != NULL; item = item->next)
+        {
+            if (item->type == ARR || item->type == OBJ)
+            {
+                if ((child_swapped = merkle_intern(self, &item->data.chunk, item->type)) == MERKLE_NO_MEMORY)
+                    return child_swapped;
+
+                swapped += child_swapped;
+            }
+        }
+    }
+    else
+    {
+        Object *obj = (Object*)*slot;
+
+        for (size_t curr = 0; curr < obj->bucket_count; curr++)
+        {
+            Property *prop = (Property*)obj->buckets[curr];
+
+            if (prop != NULL && (prop->type == ARR || prop->type == OBJ))
+            {
+                if ((child_swapped = merkle_intern(self, &prop->data.chunk, prop->type)) == MERKLE_NO_MEMORY)
+                    return child_swapped;
+
+                swapped += child_swapped;
+            }
+        }
+    }
+
+    if (((self->count + 1) << 1) > self->capacity && !merkle_store_grow(self))
+        return MERKLE_NO_MEMORY;
+
+    size_t entry = hash & (self->capacity - 1);
+
+    while (self->entries[entry].type != UNSUPPORTED)
+        entry = (entry + 1) & (self->capacity - 1);
+
+    self->entries[entry].hash = hash;
+    self->entries[entry].type = type;
+    self->entries[entry].chunk = *slot;
+    self->count++;
+    Chunk_Retain(*slot, type);
+
+    return swapped;
+}
+
+MerkleStore *MerkleStore_Create(const JsonAllocator *allocator)
+{
+    MerkleStore *result = json_alloc(allocator, sizeof(MerkleStore));
+    size_t capacity = 64;
+
+    if (!result)
+        return NULL;
+
+    result->entries = json_alloc(allocator, sizeof(MerkleEntry) * capacity);
+
+    if (!result->entries)
+    {
+        json_free(allocator, result);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < capacity; i++)
+        result->entries[i].type = UNSUPPORTED;
+
+    result->capacity = capacity;
+    result->count = 0;
+    result->allocator = allocator;
+
+    return result;
+}
+
+void MerkleStore_Destroy(MerkleStore *self)
+{
+    for (size_t i = 0; i < self->capacity; i++)
+    {
+        if (self->entries[i].type != UNSUPPORTED)
+            Chunk_Release(self->entries[i].chunk, self->entries[i].type, self->allocator);
+    }
+
+    json_free(self->allocator, self->entries);
+    self->entries = NULL;
+    self->capacity = 0;
+    self->count = 0;
+}
+
+size_t MerkleStore_Intern(MerkleStore *self, JsonThing *doc)
+{
+    if (merkle_resolve_allocator(doc->allocator) != merkle_resolve_allocator(self->allocator))
+        return MERKLE_NO_MEMORY;
+    else if (!doc->root || (doc->root->type != ARR && doc->root->type != OBJ))
+        return 0;
+
+    JsonThing_Hash(doc);
+
+    return merkle_intern(self, &doc->root->data.chunk, doc->root->type);
+}
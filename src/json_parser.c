@@ -1,29 +1,61 @@
 /**
  * @file json_parser.c
  * @author Derek Tan (DrkWithT at GitHub)
- * @brief Implements the recursive Parser.
+ * @brief Implements the iterative Parser, which keeps open containers on an explicit stack instead of recursing.
  * @date 2023-03-27
  */
 
+#include <stdint.h>
 #include "json_parser.h"
 
-Parser *Parser_Create(char *src, TokenVec *tokens)
+Parser *Parser_Create(char *src, TokenVec *tokens, const JsonAllocator *allocator)
 {
-    Parser *result = malloc(sizeof(Parser));
+    Parser *result = json_alloc(allocator, sizeof(Parser));
 
     if (!result || !tokens)
         return result;
-    
-    result->srcbuf_ref = src;
-    result->tokvec_ref = tokens;
-    result->tokvec_idx = 0;
-    result->tokvec_end = result->tokvec_ref->count; // remember to stop at a NULL terminator token!
 
-    result->temp_root = NULL; // set this when parsing outermost JSON layer: primitive, array, or object!
+    Parser_Init(result, src, tokens, allocator);
 
     return result;
 }
 
+void Parser_Init(Parser *self, char *src, TokenVec *tokens, const JsonAllocator *allocator)
+{
+    self->allocator = allocator;
+    self->stack = NULL;
+    self->stack_cap = 0;
+    self->stack_allocator = allocator;
+    self->max_depth = DEFAULT_MAX_DEPTH;
+    self->projection = NULL;
+
+    Parser_Rebind(self, src, tokens);
+}
+
+void Parser_Rebind(Parser *self, char *src, TokenVec *tokens)
+{
+    self->err_code = NO_ERR;
+    self->srcbuf_ref = src;
+    self->tokvec_ref = tokens;
+    self->tokvec_idx = 0;
+    self->tokvec_end = (tokens != NULL) ? tokens->count : 0;
+    self->depth = 0;
+    JsonStats_Clear(&self->stats);
+
+    self->temp_root = NULL; // set this when parsing outermost JSON layer: primitive, array, or object!
+}
+
+void Parser_Destroy(Parser *self)
+{
+    json_free(self->stack_allocator, self->stack);
+    self->stack = NULL;
+    self->stack_cap = 0;
+}
+
+void Parser_SetMaxDepth(Parser *self, size_t max_depth) { self->max_depth = max_depth; }
+
+void Parser_SetProjection(Parser *self, const Projection *projection) { self->projection = projection; }
+
 void Parser_Reset(Parser *self)
 {
     // NOTE: unbind reference pointers, but make sure to get them before calling this function.
@@ -33,6 +65,7 @@ void Parser_Reset(Parser *self)
     self->temp_root = NULL;
     self->tokvec_idx = 0;
     self->tokvec_end = 0;
+    self->depth = 0;
 }
 
 int Parser_IsReady(const Parser *self)
@@ -51,32 +84,47 @@ void *Parser_Parse_Prim(Parser *self, char *optional_name, DataType prim_type, J
     void *temp = NULL;
     Token *curr_token_ref = NULL;
     char *curr_token_txt = NULL;
+    int int_val = 0;
+    double flt_val = 0.0;
     curr_token_ref = TokenVec_At(self->tokvec_ref, self->tokvec_idx);
     
     if (!curr_token_ref)
         return temp;
-    
-    curr_token_txt = Token_ToTxt(curr_token_ref, self->srcbuf_ref);
 
-    if (!curr_token_txt)
-        return temp;
-    
     TokenType tok_type = curr_token_ref->type;
 
+    // only strings allocate their text, numbers go through scratch text unless they are overlong
+    if (tok_type == STRBODY)
+    {
+        curr_token_txt = Token_ToTxt(curr_token_ref, self->srcbuf_ref, self->allocator);
+
+        if (!curr_token_txt)
+            return temp;
+    }
+    else if ((tok_type == INT_LTRL || tok_type == FLT_LTRL)
+        && !Token_ToNum(curr_token_ref, self->srcbuf_ref, self->allocator, (tok_type == INT_LTRL) ? &int_val : NULL, (tok_type == FLT_LTRL) ? &flt_val : NULL))
+        return temp;
+
     if (relation == TO_NONE)  // handle root constants
     {
         switch (tok_type)
         {
         case INT_LTRL:
-            temp = Property_Int(NULL, atoi(curr_token_txt));
+            temp = Property_Int(NULL, int_val, self->allocator);
             break;
         case FLT_LTRL:
-            temp = Property_Float(NULL, atof(curr_token_txt));
+            temp = Property_Float(NULL, flt_val, self->allocator);
             break;
         case STRBODY:
-            temp = Property_String(NULL, curr_token_txt);
+            temp = Property_String(NULL, curr_token_txt, self->allocator);
             break;
         case NULL_LTRL:
+            temp = Property_Chunk(NULL, NULL, NUL, self->allocator);
+            break;
+        case TRUE_LTRL:
+        case FALSE_LTRL:
+            temp = Property_Bool(NULL, tok_type == TRUE_LTRL, self->allocator);
+            break;
         default:
             break;
         }
@@ -86,15 +134,21 @@ void *Parser_Parse_Prim(Parser *self, char *optional_name, DataType prim_type, J
         switch (tok_type)
         {
         case INT_LTRL:
-            temp = ArrayItem_Int(atoi(curr_token_txt));
+            temp = ArrayItem_Int(int_val, self->allocator);
             break;
         case FLT_LTRL:
-            temp = ArrayItem_Float(atof(curr_token_txt));
+            temp = ArrayItem_Float(flt_val, self->allocator);
             break;
         case STRBODY:
-            temp = ArrayItem_String(curr_token_txt);
+            temp = ArrayItem_String(curr_token_txt, self->allocator);
             break;
         case NULL_LTRL:
+            temp = ArrayItem_Chunk(NULL, NUL, self->allocator);
+            break;
+        case TRUE_LTRL:
+        case FALSE_LTRL:
+            temp = ArrayItem_Bool(tok_type == TRUE_LTRL, self->allocator);
+            break;
         default:
             break;
         }
@@ -104,411 +158,642 @@ void *Parser_Parse_Prim(Parser *self, char *optional_name, DataType prim_type, J
         switch (tok_type)
         {
         case INT_LTRL:
-            temp = Property_Int(optional_name, atoi(curr_token_txt));
+            temp = Property_Int(optional_name, int_val, self->allocator);
             break;
         case FLT_LTRL:
-            temp = Property_Float(optional_name, atof(curr_token_txt));
+            temp = Property_Float(optional_name, flt_val, self->allocator);
             break;
         case STRBODY:
-            temp = Property_String(optional_name, curr_token_txt);
+            temp = Property_String(optional_name, curr_token_txt, self->allocator);
             break;
         case NULL_LTRL:
+            temp = Property_Chunk(optional_name, NULL, NUL, self->allocator);
+            break;
+        case TRUE_LTRL:
+        case FALSE_LTRL:
+            temp = Property_Bool(optional_name, tok_type == TRUE_LTRL, self->allocator);
+            break;
         default:
             break;
         }
     }
 
+    // don't leak the copied string if its node could not be made
+    if (!temp && tok_type == STRBODY)
+        json_free(self->allocator, curr_token_txt);
+
     return temp;
 }
 
-void *Parser_Parse_Arr(Parser *self)
+/// Parse Stack:
+
+/**
+ * @brief Gets the projection node of a container opened now. Array elements share their Array's node, and an Object value takes the one its key matched.
+ */
+static size_t parser_next_proj(const Parser *self)
 {
-    puts("Parse [...]"); // DEBUG
-    self->tokvec_idx++;  // skip past 1st bracket...
+    if (self->depth == 0)
+        return (self->projection != NULL) ? PROJ_ROOT : PROJ_ALL;
 
-    int skip = 0;        // do not push a remaining value to array on commas
-    int needs_comma = 0;
-    int completed = 0;
-    Token *temp_tok_ref = NULL;
-    Array *result = Array_Create();
+    const ParseFrame *parent = self->stack + (self->depth - 1);
 
-    if (!result)
-        return result;
+    return (parent->type == ARR) ? parent->proj : parent->pending_proj;
+}
 
-    void *parsed_val_ref = NULL;
+/**
+ * @brief Creates the Array or Object opened by the current token. An indexed Object is sized for all its members up front, unless a projection will drop most of them.
+ */
+static void *parser_create_chunk(Parser *self, DataType type)
+{
+    if (type == ARR)
+        return Array_Create(self->allocator);
 
-    while (!completed && self->err_code == NO_ERR)
+    const Token *opener = TokenVec_At(self->tokvec_ref, self->tokvec_idx);
+    size_t slots = (opener->skip != 0 && parser_next_proj(self) == PROJ_ALL) ? (opener->flags & TOKEN_COUNT_MASK) : 1;
+
+    return Object_Create(slots, self->allocator);
+}
+
+static int parser_push_frame(Parser *self, void *chunk, DataType type)
+{
+    if (self->depth >= self->max_depth)
+    {
+        self->err_code = DEPTH_LIMIT_ERR;
+        return 0;
+    }
+
+    if (self->depth == self->stack_cap)
     {
-        // stop parser on token vector end
-        if (Parser_AtEnd(self))
+        size_t new_cap = (self->stack_cap > 0) ? self->stack_cap << 1 : 16;
+        ParseFrame *temp = json_realloc(self->stack_allocator, self->stack, sizeof(ParseFrame) * new_cap);
+
+        if (!temp)
         {
-            completed = 1;
-            break;
+            self->err_code = OUT_OF_MEMORY_ERR;
+            return 0;
         }
 
-        // peek at current token
-        temp_tok_ref = TokenVec_At(self->tokvec_ref, self->tokvec_idx);
+        self->stack = temp;
+        self->stack_cap = new_cap;
+    }
+
+    ParseFrame *frame = self->stack + self->depth;
+    size_t proj = parser_next_proj(self);
+
+    frame->chunk = chunk;
+    frame->pending_name = NULL;
+    frame->type = type;
+    frame->state = (type == ARR) ? FIRST_ITEM : FIRST_KEY;
+    frame->proj = proj;
+    frame->pending_proj = PROJ_ALL;
+
+    self->depth++;
+    JSON_STATS_DEPTH(self->depth);
+
+    return 1;
+}
+
+void Parser_Unwind(Parser *self, size_t stop_depth)
+{
+    while (self->depth > stop_depth)
+    {
+        self->depth--;
+        json_free(self->allocator, self->stack[self->depth].pending_name);
+        self->stack[self->depth].pending_name = NULL;
+    }
+}
+
+static void parser_free_chunk(Parser *self, void *chunk, DataType type)
+{
+    if (!chunk)
+        return;
+
+    if (type == ARR)
+        Array_Destroy((Array*)chunk);
+    else
+        Object_Destroy((Object*)chunk);
+
+    json_free(self->allocator, chunk);
+}
+
+/**
+ * @brief Binds a parsed value to the innermost container. An Array takes an ArrayItem and an Object takes a Property named by the frame's pending key.
+ * @note If the Object's table cannot grow, the Property is destroyed with everything under it.
+ */
+static int parser_bind_value(Parser *self, ParseFrame *frame, void *value)
+{
+    if (!value)
+    {
+        self->err_code = OUT_OF_MEMORY_ERR;
+        return 0;
+    }
+
+    if (frame->type == ARR)
+        Array_Push((Array*)frame->chunk, (ArrayItem*)value);
+    else
+    {
+        int bound = Object_SetItem((Object*)frame->chunk, frame->pending_name, (Property*)value);
+
+        frame->pending_name = NULL; // moved into the property
 
-        switch (temp_tok_ref->type)
+        if (!bound)
         {
-        case LBRACKET:
-            parsed_val_ref = ArrayItem_Chunk(Parser_Parse_Arr(self), ARR);
-            needs_comma = 1;
-            break;
-        case LCURLY:
-            parsed_val_ref = ArrayItem_Chunk(Parser_Parse_Obj(self), OBJ);
-            needs_comma = 1;
-            break;
-        case INT_LTRL:
-            parsed_val_ref = Parser_Parse_Prim(self, NULL, INT, TO_ARR);
-            needs_comma = 1;
-            break;
-        case FLT_LTRL:
-            parsed_val_ref = Parser_Parse_Prim(self, NULL, FLT, TO_ARR);
-            needs_comma = 1;
-            break;
-        case NULL_LTRL:
-            parsed_val_ref = Parser_Parse_Prim(self, NULL,  NUL, TO_ARR);
-            needs_comma = 1;
-            break;
-        case STRBODY:
-            parsed_val_ref = Parser_Parse_Prim(self, NULL, STR, TO_ARR);
-            needs_comma = 1;
-            break;
-        case COMMA:
-            if (!needs_comma)
-            {
-                self->err_code = UNEXPECTED_TOKEN_ERR;
-                completed = 1;
-            }
-            else
-                needs_comma = 0;
-            break;
-        default:
-            break;  // ignore UNKNOWN tokens for now!
+            Property_Destroy((Property*)value, self->allocator);
+            json_free(self->allocator, value);
+            self->err_code = OUT_OF_MEMORY_ERR;
+            return 0;
         }
-        
-        skip = !needs_comma && (temp_tok_ref->type == COMMA || temp_tok_ref->type == UNKNOWN);
-        
-        if (!skip && parsed_val_ref != NULL)
-            Array_Push((Array*)result, (ArrayItem*)parsed_val_ref);
+    }
 
-        self->tokvec_idx++;
+    frame->state = SEPARATOR;
+
+    return 1;
+}
+
+/**
+ * @brief Opens a nested Array or Object at the current token. The new container is bound to its parent right away, so it is owned even if parsing fails later.
+ */
+static int parser_open_chunk(Parser *self, ParseFrame *frame, DataType type)
+{
+    void *chunk = parser_create_chunk(self, type);
+    void *wrapper = NULL;
 
-        completed = temp_tok_ref->type == RBRACKET;
+    if (!chunk)
+    {
+        self->err_code = OUT_OF_MEMORY_ERR;
+        return 0;
     }
 
-    return result;
+    if (frame->type == ARR)
+        wrapper = ArrayItem_Chunk(chunk, type, self->allocator);
+    else
+        wrapper = Property_Chunk(frame->pending_name, chunk, type, self->allocator);
+
+    if (!wrapper)
+    {
+        parser_free_chunk(self, chunk, type);
+        self->err_code = OUT_OF_MEMORY_ERR;
+        return 0;
+    }
+
+    // a container that could not be bound was freed with its wrapper
+    if (!parser_bind_value(self, frame, wrapper))
+        return 0;
+
+    JSON_PROBE1(parse_chunk, self->depth + 1);
+
+    return parser_push_frame(self, chunk, type); // NOTE: frame may move after this!
 }
 
-void *Parser_Parse_Obj(Parser *self)
+static int parser_parse_value(Parser *self, ParseFrame *frame, TokenType tok_type)
 {
-    puts("Parse {...}");  // DEBUG
-    self->tokvec_idx++;   // skip past 1st left curly brace
+    JsonProx relation = (frame->type == ARR) ? TO_ARR : TO_PROP;
 
-    int completed = 0;    // if current object is fully parsed
-    int needs_attr = 1;   // expect attr. name
-    int needs_colon = 0;  // expect colon
-    int needs_value = 0;  // expect attr. value
-    int needs_comma = 0;  // expect comma
-    int skip_put = 0;     // whether to skip binding value to attr. (on commas)
+    switch (tok_type)
+    {
+    case LBRACKET:
+        return parser_open_chunk(self, frame, ARR);
+    case LCURLY:
+        return parser_open_chunk(self, frame, OBJ);
+    case INT_LTRL:
+        return parser_bind_value(self, frame, Parser_Parse_Prim(self, frame->pending_name, INT, relation));
+    case FLT_LTRL:
+        return parser_bind_value(self, frame, Parser_Parse_Prim(self, frame->pending_name, FLT, relation));
+    case STRBODY:
+        return parser_bind_value(self, frame, Parser_Parse_Prim(self, frame->pending_name, STR, relation));
+    case NULL_LTRL:
+        return parser_bind_value(self, frame, Parser_Parse_Prim(self, frame->pending_name, NUL, relation));
+    case TRUE_LTRL:
+    case FALSE_LTRL:
+        return parser_bind_value(self, frame, Parser_Parse_Prim(self, frame->pending_name, BOOL, relation));
+    case UNKNOWN:
+        self->err_code = UNKNOWN_TOKEN_ERR;
+        return 0;
+    default:
+        self->err_code = UNEXPECTED_TOKEN_ERR;
+        return 0;
+    }
+}
 
-    Token *curr_tok_ref = NULL;
-    char *temp_attr_name = NULL;
-    Property *todo_property = NULL;
-    Object *result = NULL;
+/**
+ * @brief Steps over the unprojected value starting at the current token, leaving tokvec_idx on its last token. An indexed container is jumped in O(1), others are walked by counting brackets. Nested tokens are never parsed, so nothing is allocated.
+ */
+static int parser_skip_value(Parser *self, TokenType tok_type)
+{
+    if (tok_type != LBRACKET && tok_type != LCURLY)
+    {
+        if (tok_type == UNKNOWN)
+            self->err_code = UNKNOWN_TOKEN_ERR;
+        else if (tok_type == RBRACKET || tok_type == RCURLY || tok_type == COLON || tok_type == COMMA)
+            self->err_code = UNEXPECTED_TOKEN_ERR;
 
-    size_t obj_buckets = 0;
-    size_t relative_nest_lvl = 0;
-    size_t last_tok_pos = self->tokvec_idx;
+        return self->err_code == NO_ERR;
+    }
 
-    while (!Parser_AtEnd(self)) {
-        curr_tok_ref = TokenVec_At(self->tokvec_ref, self->tokvec_idx);  // prescan property count on this level to find out buckets
+    const Token *tokens = self->tokvec_ref->data;
+    const Token *opener = tokens + self->tokvec_idx;
 
-        switch(curr_tok_ref->type)
+    if (opener->skip != 0 && self->tokvec_idx + opener->skip < self->tokvec_end)
+    {
+        if (opener->flags & TOKEN_HAS_UNKNOWN)
         {
+            self->err_code = UNKNOWN_TOKEN_ERR;
+            return 0;
+        }
+
+        self->tokvec_idx += opener->skip;
+        return 1;
+    }
+
+    size_t idx = self->tokvec_idx + 1;
+    size_t depth = 1;
+
+    for (; idx < self->tokvec_end; idx++)
+    {
+        switch (tokens[idx].type)
+        {
+        case LBRACKET:
         case LCURLY:
-            relative_nest_lvl++;
+            depth++;
             break;
+        case RBRACKET:
         case RCURLY:
-            relative_nest_lvl--;
-        case COLON:
-            if (relative_nest_lvl == 0)
-                obj_buckets++;
+            depth--;
             break;
+        case UNKNOWN:
+            self->err_code = UNKNOWN_TOKEN_ERR;
+            return 0;
         default:
             break;
         }
 
-        self->tokvec_idx++;
+        if (depth == 0)
+        {
+            self->tokvec_idx = idx;
+            return 1;
+        }
     }
 
-    // backtrack to first token of object
-    self->tokvec_idx = last_tok_pos;
+    self->err_code = UNBALANCED_NEST;
 
-    result = Object_Create(obj_buckets);
-    
-    if (!result)
-        return result;
+    return 0;
+}
 
-    while (!completed && self->err_code == NO_ERR)
+int Parser_Run(Parser *self, size_t stop_depth)
+{
+    while (self->err_code == NO_ERR && !Parser_AtEnd(self))
     {
-        DataType parsed_value_type = UNSUPPORTED; // whether a token value is currently valid to bind to some attr.
-
-        // stop parser on end of token vector
-        if (Parser_AtEnd(self))
-        {
-            completed = 1;
-            break;
-        }
-
-        // get current token
-        curr_tok_ref = TokenVec_At(self->tokvec_ref, self->tokvec_idx);
+        ParseFrame *frame = self->stack + (self->depth - 1);
+        Token *curr_tok_ref = TokenVec_At(self->tokvec_ref, self->tokvec_idx);
+        TokenType tok_type = curr_tok_ref->type;
+        int closes = 0;
 
-        // check token to see what to parse
-        switch (curr_tok_ref->type)
+        switch (frame->state)
         {
-        case STRBODY:
-            if (needs_attr)
-            {
-                // puts("read attr"); // DEBUG
-                temp_attr_name = Token_ToTxt(curr_tok_ref, self->srcbuf_ref);
-                needs_attr = 0;
-                needs_colon = 1;
-            }
-            else if (needs_value)
-            {
-                // puts("bind string");
-                parsed_value_type = STR;
-                todo_property = Property_String(temp_attr_name, Token_ToTxt(curr_tok_ref, self->srcbuf_ref));
-                needs_value = 0;
-                needs_comma = 1;
-            }
-            else
-            {
-                self->err_code = UNEXPECTED_TOKEN_ERR;
-                completed = 1;
-            }
-            break;
-        case COLON:
-            if (!needs_colon)
-            {
-                self->err_code = UNEXPECTED_TOKEN_ERR;
-                completed = 1;
-            }
+        case FIRST_ITEM:
+            if (tok_type == RBRACKET)
+                closes = 1;
             else
+                parser_parse_value(self, frame, tok_type);
+            break;
+        case NEXT_ITEM:
+            parser_parse_value(self, frame, tok_type);
+            break;
+        case PROP_VALUE:
+            if (frame->pending_proj != PROJ_SKIP)
+                parser_parse_value(self, frame, tok_type);
+            else if (parser_skip_value(self, tok_type))
+                frame->state = SEPARATOR;
+            break;
+        case FIRST_KEY:
+        case NEXT_KEY:
+            if (tok_type == RCURLY && frame->state == FIRST_KEY)
+                closes = 1;
+            else if (tok_type == STRBODY)
             {
-                needs_colon = 0;
-                needs_value = 1;
-            }
-            break;
-        case INT_LTRL:
-            if (needs_value)
-            {
-                // puts("bind int"); // DEBUG
-                parsed_value_type = INT;
-                char *temp = Token_ToTxt(curr_tok_ref, self->srcbuf_ref);
-                int value = 0;
+                frame->state = PROP_COLON;
 
-                if (temp != NULL)
+                if (frame->proj != PROJ_ALL)
                 {
-                    value = atoi(temp);
-                    todo_property = Property_Int(temp_attr_name, value);
-                    free(temp);
+                    frame->pending_proj = Projection_Step(self->projection, frame->proj, curr_tok_ref, self->srcbuf_ref);
+
+                    if (frame->pending_proj == PROJ_SKIP)
+                        break; // the key text is never needed
                 }
 
-                needs_value = 0;
-                needs_comma = 1;
-            }
-            else
-            {
-                self->err_code = UNEXPECTED_TOKEN_ERR;
-                completed = 1;
-            }
-            break;
-        case FLT_LTRL:
-            if (needs_value)
-            {
-                // puts("bind float"); // DEBUG
-                parsed_value_type = FLT;
-                char *temp = Token_ToTxt(curr_tok_ref, self->srcbuf_ref);
-                float value = 0.0f;
+                frame->pending_name = Token_ToTxt(curr_tok_ref, self->srcbuf_ref, self->allocator);
 
-                if (temp != NULL)
-                {
-                    value = atof(temp);
-                    parsed_value_type = INT;
-                    todo_property = Property_Float(temp_attr_name, value);
-                    free(temp);
-                }
-                
-                needs_value = 0;
-                needs_comma = 1;
+                if (!frame->pending_name)
+                    self->err_code = OUT_OF_MEMORY_ERR;
             }
             else
-            {
-                self->err_code = UNEXPECTED_TOKEN_ERR;
-                completed = 1;
-            }
+                self->err_code = (tok_type == UNKNOWN) ? UNKNOWN_TOKEN_ERR : UNEXPECTED_TOKEN_ERR;
             break;
-        case LCURLY:
-            if (needs_value)
-            {
-                // puts("put {}"); // DEBUG
-                parsed_value_type = OBJ;
-                todo_property = Property_Chunk(temp_attr_name, Parser_Parse_Obj(self), parsed_value_type);
-                needs_value = 0;
-                needs_comma = 1;
-            }
+        case PROP_COLON:
+            if (tok_type == COLON)
+                frame->state = PROP_VALUE;
             else
-            {
                 self->err_code = UNEXPECTED_TOKEN_ERR;
-                completed = 1;
-            }
             break;
-        case LBRACKET:
-            if (needs_value)
-            {
-                //puts("put []"); // DEBUG
-                parsed_value_type = ARR;
-                todo_property = Property_Chunk(temp_attr_name, Parser_Parse_Arr(self), parsed_value_type);
-                needs_value = 0;
-                needs_comma = 1;
-            }
+        case SEPARATOR:
+            if (tok_type == COMMA)
+                frame->state = (frame->type == ARR) ? NEXT_ITEM : NEXT_KEY;
+            else if ((tok_type == RBRACKET && frame->type == ARR) || (tok_type == RCURLY && frame->type == OBJ))
+                closes = 1;
+            else if (tok_type == RBRACKET || tok_type == RCURLY)
+                self->err_code = UNBALANCED_NEST;
             else
-            {
-                self->err_code = UNEXPECTED_TOKEN_ERR;
-                completed = 1;
-            }
-            break;
-        case COMMA:
-            if (!needs_comma)
-            {
-                self->err_code = UNEXPECTED_TOKEN_ERR;
-                completed = 1;
-            }
-            else
-            {
-                needs_attr = 1;
-                needs_colon = 0;
-                needs_value = 0;
-                needs_comma = 0;
-            }
+                self->err_code = (tok_type == UNKNOWN) ? UNKNOWN_TOKEN_ERR : UNEXPECTED_TOKEN_ERR;
             break;
         default:
             break;
         }
 
-        skip_put = curr_tok_ref->type == COMMA || curr_tok_ref->type == COLON || curr_tok_ref->type == UNKNOWN || parsed_value_type == UNSUPPORTED || (curr_tok_ref->type == STRBODY && needs_attr);
+        if (self->err_code != NO_ERR)
+            break;
 
-        // bind property to parsing object when it's appropriate!
-        if (!skip_put && todo_property != NULL)
-            Object_SetItem(result, temp_attr_name, todo_property);
-        
         self->tokvec_idx++;
 
-        completed = curr_tok_ref->type == RCURLY;
+        if (closes)
+        {
+            self->depth--;
+
+            if (self->depth == stop_depth)
+                return 1;
+        }
     }
 
-    return result;
+    return 0;
 }
 
-int Parser_Get_ErrCode(const Parser *self) { return self->err_code; }
-
-JsonThing *Parser_Start_Parse(Parser *self)
+void *Parser_Begin_Chunk(Parser *self, DataType type)
 {
-    if (!Parser_IsReady(self))
-        return NULL;
+    void *result = parser_create_chunk(self, type);
 
-    Token *temp_token_ref = NULL;
-    DataType temp_root_type = UNSUPPORTED;
-    JsonThing *result = NULL;
+    if (!result)
+    {
+        self->err_code = OUT_OF_MEMORY_ERR;
+        return result;
+    }
 
-    // count colons on 1st nesting level (just the 1st layer of properties)...
-    int prescan_nest_level = 0;
-    size_t colon_count = 0;
+    self->tokvec_idx++; // skip past the opening bracket or brace
 
-    while (!Parser_AtEnd(self))
+    if (!parser_push_frame(self, result, type))
     {
-        temp_token_ref = TokenVec_At(self->tokvec_ref, self->tokvec_idx);
-        
-        switch (temp_token_ref->type)
-        {
-        case LCURLY:
-        case LBRACKET:
-            prescan_nest_level++;
-            break;
-        case RCURLY:
-        case RBRACKET:
-            prescan_nest_level--;
-            break;
-        default:
-            if (temp_token_ref->type == COLON && prescan_nest_level == 1)
-                colon_count++;  // when I find an outermost property colon, count it!
-            break;
-        }
+        parser_free_chunk(self, result, type);
+        result = NULL;
+    }
 
-        self->tokvec_idx++;
+    return result;
+}
+
+static void *parser_parse_chunk(Parser *self, DataType type)
+{
+    size_t base_depth = self->depth;
+    void *result = Parser_Begin_Chunk(self, type);
+
+    if (result != NULL && !Parser_Run(self, base_depth))
+    {
+        if (self->err_code == NO_ERR)
+            self->err_code = UNBALANCED_NEST; // ran out of tokens before the closer
+
+        Parser_Unwind(self, base_depth);
+        parser_free_chunk(self, result, type);
+        result = NULL;
     }
 
-    self->tokvec_idx = 0;
+    return result;
+}
+
+void *Parser_Parse_Arr(Parser *self) { return parser_parse_chunk(self, ARR); }
+
+void *Parser_Parse_Obj(Parser *self) { return parser_parse_chunk(self, OBJ); }
 
-    // reject unbalanced json!
-    if (prescan_nest_level != 0)
+int Parser_Get_ErrCode(const Parser *self) { return self->err_code; }
+
+JsonThing *Parser_Start_Parse(Parser *self)
+{
+    if (!Parser_IsReady(self))
     {
-        self->err_code = UNBALANCED_NEST;
-        return result;
+        if (self->tokvec_ref != NULL && self->tokvec_end == 0)
+            self->err_code = EMPTY_TOKENS_ERR;
+
+        return NULL;
     }
 
-    temp_token_ref = TokenVec_At(self->tokvec_ref, self->tokvec_idx);
+    JSON_STATS_BIND(&self->stats);
+    JSON_TIMER_START(parse_start);
+
+    Token *temp_token_ref = TokenVec_At(self->tokvec_ref, self->tokvec_idx);
+    DataType temp_root_type = UNSUPPORTED;
+    JsonThing *result = NULL;
+
+    void *root_chunk = NULL;
 
     switch (temp_token_ref->type)
     {
     case LCURLY:
-        if (!self->temp_root)
-        {
-            self->temp_root = Property_Chunk(NULL, Parser_Parse_Obj(self), OBJ);
-            temp_root_type = OBJ;
-        }
+        temp_root_type = OBJ;
+        root_chunk = Parser_Parse_Obj(self);
         break;
     case LBRACKET:
-        if (!self->temp_root)
-        {
-            self->temp_root = Property_Chunk(NULL, Parser_Parse_Arr(self), ARR);
-            temp_root_type = ARR;
-        }
+        temp_root_type = ARR;
+        root_chunk = Parser_Parse_Arr(self);
         break;
     case INT_LTRL:
-        if (!self->temp_root)
-        {
-            self->temp_root = Parser_Parse_Prim(self, NULL, INT, TO_NONE);
-            temp_root_type = INT;
-        }
+        temp_root_type = INT;
         break;
     case FLT_LTRL:
-        if (!self->temp_root)
-        {
-            self->temp_root = Parser_Parse_Prim(self, NULL, FLT, TO_NONE);
-            temp_root_type = FLT;
-        }
+        temp_root_type = FLT;
         break;
     case STRBODY:
-        if (!self->temp_root)
-        {
-            self->temp_root = Parser_Parse_Prim(self, NULL, STR, TO_NONE);
-            temp_root_type = STR;
-        }
+        temp_root_type = STR;
+        break;
+    case NULL_LTRL:
+        temp_root_type = NUL;
+        break;
+    case TRUE_LTRL:
+    case FALSE_LTRL:
+        temp_root_type = BOOL;
+        break;
+    case UNKNOWN:
+        self->err_code = UNKNOWN_TOKEN_ERR;
         break;
     default:
+        self->err_code = UNEXPECTED_TOKEN_ERR;
         break;
     }
 
-    // reject invalid root json values!
-    if (temp_root_type == UNSUPPORTED)
-        return result;
+    if (self->err_code != NO_ERR || temp_root_type == UNSUPPORTED)
+        goto parse_done;
+
+    if (root_chunk != NULL)
+    {
+        self->temp_root = Property_Chunk(NULL, root_chunk, temp_root_type, self->allocator);
+
+        if (!self->temp_root)
+            parser_free_chunk(self, root_chunk, temp_root_type);
+    }
+    else
+    {
+        // a primitive root is the lone value of the document
+        self->temp_root = Parser_Parse_Prim(self, NULL, temp_root_type, TO_NONE);
+        self->tokvec_idx++;
+    }
+
+    if (!self->temp_root)
+        self->err_code = OUT_OF_MEMORY_ERR;
+    else if (!Parser_AtEnd(self))
+        self->err_code = UNEXPECTED_TOKEN_ERR; // trailing tokens after the root value
+
+    if (self->err_code == NO_ERR)
+        result = JsonThing_Create(temp_root_type, (Property*)self->temp_root, self->allocator);
+
+    // reject failed json by freeing any partial root
+    if (!result && self->temp_root != NULL)
+    {
+        Property_Destroy(self->temp_root, self->allocator);
+        json_free(self->allocator, self->temp_root);
+
+        if (self->err_code == NO_ERR)
+            self->err_code = OUT_OF_MEMORY_ERR;
+    }
 
-    result = JsonThing_Create(temp_root_type, (Property*)self->temp_root);
     self->temp_root = NULL; // NOTE: now I can unbind old ref. ptr. to JSON root value!
 
+parse_done: // stop the phase timer on any exit
+    JSON_TIMER_STOP(parse_start, &self->stats, parse_cycles);
+    JSON_STATS_UNBIND();
+    JSON_PROBE2(parse_done, self->stats.node_count, self->err_code);
+
+    if (result != NULL)
+        result->stats = self->stats;
+
     return result;
 }
+
+/// Validation:
+
+#define VALIDATE_BITS_PER_WORD 64
+
+/**
+ * @brief Records a failure at the first byte of the offending token, found again from the end of the token before it. String tokens begin after their quote, so their own begin would be off by one.
+ */
+static int parser_validate_fail(Lexer *lexer, ParserErr err, size_t prev_pos, size_t *err_offset)
+{
+    if (err_offset != NULL)
+    {
+        lexer->doc_pos = prev_pos;
+        Lexer_Skip_WSpc(lexer);
+        *err_offset = lexer->doc_pos;
+    }
+
+    return err;
+}
+
+int Parser_Validate(const char *src, size_t len, size_t *err_offset)
+{
+    // one bit per open container (1 for an Object) is all the state nesting needs, so nothing is allocated
+    uint64_t nest_bits[DEFAULT_MAX_DEPTH / VALIDATE_BITS_PER_WORD];
+    size_t depth = 0;
+    int in_obj = 0;
+    ParseState state = NEXT_ITEM; // the root takes exactly one value, like an Array after ','
+    Lexer lexer;
+
+    Lexer_Init(&lexer, (char*)src, len, NULL);
+
+    while (1)
+    {
+        size_t prev_pos = lexer.doc_pos;
+        TokenType tok_type = Lexer_Lex_Next(&lexer).type;
+
+        if (tok_type == FILE_END)
+        {
+            if (depth == 0 && state == SEPARATOR)
+                return parser_validate_fail(&lexer, NO_ERR, len, err_offset);
+
+            return parser_validate_fail(&lexer, (depth == 0) ? EMPTY_TOKENS_ERR : UNBALANCED_NEST, len, err_offset);
+        }
+
+        switch (state)
+        {
+        case FIRST_ITEM:
+        case NEXT_ITEM:
+        case PROP_VALUE:
+            if (tok_type == LBRACKET || tok_type == LCURLY)
+            {
+                if (depth >= DEFAULT_MAX_DEPTH)
+                    return parser_validate_fail(&lexer, DEPTH_LIMIT_ERR, prev_pos, err_offset);
+
+                uint64_t bit = (uint64_t)1 << (depth % VALIDATE_BITS_PER_WORD);
+                uint64_t *word = nest_bits + depth / VALIDATE_BITS_PER_WORD;
+
+                in_obj = (tok_type == LCURLY);
+                *word = in_obj ? (*word | bit) : (*word & ~bit);
+                depth++;
+                state = in_obj ? FIRST_KEY : FIRST_ITEM;
+            }
+            else if (tok_type == RBRACKET && state == FIRST_ITEM)
+                goto close_chunk;
+            else if (tok_type == STRBODY || (tok_type >= INT_LTRL && tok_type <= FALSE_LTRL))
+                state = SEPARATOR;
+            else
+                return parser_validate_fail(&lexer, (tok_type == UNKNOWN) ? UNKNOWN_TOKEN_ERR : UNEXPECTED_TOKEN_ERR, prev_pos, err_offset);
+            break;
+        case FIRST_KEY:
+        case NEXT_KEY:
+            if (tok_type == RCURLY && state == FIRST_KEY)
+                goto close_chunk;
+            else if (tok_type == STRBODY)
+                state = PROP_COLON;
+            else
+                return parser_validate_fail(&lexer, (tok_type == UNKNOWN) ? UNKNOWN_TOKEN_ERR : UNEXPECTED_TOKEN_ERR, prev_pos, err_offset);
+            break;
+        case PROP_COLON:
+            if (tok_type != COLON)
+                return parser_validate_fail(&lexer, UNEXPECTED_TOKEN_ERR, prev_pos, err_offset);
+
+            state = PROP_VALUE;
+            break;
+        case SEPARATOR:
+            if (depth == 0)
+                return parser_validate_fail(&lexer, UNEXPECTED_TOKEN_ERR, prev_pos, err_offset); // trailing tokens after the root value
+            else if (tok_type == COMMA)
+                state = in_obj ? NEXT_KEY : NEXT_ITEM;
+            else if ((tok_type == RBRACKET && !in_obj) || (tok_type == RCURLY && in_obj))
+                goto close_chunk;
+            else if (tok_type == RBRACKET || tok_type == RCURLY)
+                return parser_validate_fail(&lexer, UNBALANCED_NEST, prev_pos, err_offset);
+            else
+                return parser_validate_fail(&lexer, (tok_type == UNKNOWN) ? UNKNOWN_TOKEN_ERR : UNEXPECTED_TOKEN_ERR, prev_pos, err_offset);
+            break;
+        default:
+            break;
+        }
+
+        continue;
+
+    close_chunk:
+        depth--;
+        in_obj = (depth > 0) && ((nest_bits[(depth - 1) / VALIDATE_BITS_PER_WORD] >> ((depth - 1) % VALIDATE_BITS_PER_WORD)) & 1);
+        state = SEPARATOR;
+    }
+}
+
+void Parser_Locate(const char *src, size_t offset, size_t *line, size_t *column)
+{
+    const char *cursor = src;
+    const char *stop = src + offset;
+    const char *newline = NULL;
+    size_t line_count = 1;
+
+    // only paid for when an error is reported, never while validating
+    while (cursor < stop && (newline = memchr(cursor, '\n', stop - cursor)) != NULL)
+    {
+        line_count++;
+        cursor = newline + 1;
+    }
+
+    *line = line_count;
+    *column = (size_t)(stop - cursor) + 1;
+}
@@ -0,0 +1,780 @@
+/**
+ * @file json_patch.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Implements JSON Patch and JSON Merge Patch over the DOM.
+ * @date 2026-10-19
+ */
+
+#include <string.h>
+#include "json_patch.h"
+
+#define PATCH_BAD_POINTER ((size_t)-1)
+
+// values move between Properties and ArrayItems by copying the union, so both must match
+_Static_assert(sizeof(((Property*)0)->data) == sizeof(((ArrayItem*)0)->data), "Property and ArrayItem values must share a layout");
+
+/// Where an operation lands: a member of an Object, a position in an Array, or the document root.
+typedef struct patch_loc
+{
+    DataType parent_type;   // ARR or OBJ, UNSUPPORTED for the root
+    void *parent;
+    const char *key;        // decoded last segment
+    size_t index;           // ARR: the position, or the length for "-"
+} PatchLoc;
+
+/// Values:
+
+// A loose value is held in a bare ArrayItem, which ArrayItem_Destroy can free whatever its type.
+
+static void patch_from_prop(const Property *prop, ArrayItem *out)
+{
+    out->type = prop->type;
+    memcpy(&out->data, &prop->data, sizeof(out->data));
+    out->next = NULL;
+}
+
+/**
+ * @brief Frees a Property's value but keeps its name, then moves a loose value in.
+ */
+static void patch_set_prop(Property *prop, const ArrayItem *value, const JsonAllocator *allocator)
+{
+    ArrayItem old;
+
+    patch_from_prop(prop, &old);
+    ArrayItem_Destroy(&old, allocator);
+    prop->type = value->type;
+    memcpy(&prop->data, &value->data, sizeof(prop->data));
+}
+
+static int patch_copy_str(const char *str, char **out, const JsonAllocator *allocator)
+{
+    size_t len = strlen(str);
+
+    *out = json_alloc(allocator, len + 1);
+
+    if (!*out)
+        return 0;
+
+    memcpy(*out, str, len + 1);
+
+    return 1;
+}
+
+/**
+ * @brief Creates a null member with a copy of name, for a value to be moved into.
+ */
+static Property *patch_new_member(const char *name, const JsonAllocator *allocator)
+{
+    char *name_copy = NULL;
+
+    if (!patch_copy_str(name, &name_copy, allocator))
+        return NULL;
+
+    Property *result = Property_Chunk(name_copy, NULL, NUL, allocator);
+
+    if (!result)
+        json_free(allocator, name_copy);
+
+    return result;
+}
+
+/**
+ * @brief Binds a member, destroying it if the table could not grow.
+ *
+ * @return int 0 if memory ran out.
+ */
+static int patch_bind(Object *self, Property *member)
+{
+    if (Object_SetItem(self, member->name, member))
+        return 1;
+
+    Property_Destroy(member, self->allocator);
+    json_free(self->allocator, member);
+
+    return 0;
+}
+
+/**
+ * @brief Deep copies a value from the patch document with the target's allocator.
+ *
+ * @return int 0 if memory ran out. out then holds a partial copy, which the caller still destroys.
+ */
+static int patch_copy(const ArrayItem *src, ArrayItem *out, const JsonAllocator *allocator)
+{
+    *out = *src;
+    out->next = NULL;
+
+    switch (src->type)
+    {
+    case STR:
+        return patch_copy_str(src->data.str, &out->data.str, allocator);
+    case ARR:
+    {
+        Array *copy = Array_Create(allocator);
+
+        out->data.chunk = copy;
+
+        if (!copy)
+            return 0;
+
+        for (const ArrayItem *item = ((const Array*)src->data.chunk)->head; item != NULL; item = item->next)
+        {
+            ArrayItem *item_copy = json_alloc(allocator, sizeof(ArrayItem));
+
+            if (!item_copy)
+                return 0;
+
+            int copied = patch_copy(item, item_copy, allocator);
+
+            Array_Push(copy, item_copy);
+
+            if (!copied)
+                return 0;
+        }
+
+        return 1;
+    }
+    case OBJ:
+    {
+        const Object *src_obj = (const Object*)src->data.chunk;
+        Object *copy = Object_Create(src_obj->count, allocator);
+        ArrayItem src_value;
+        ArrayItem member_value;
+
+        out->data.chunk = copy;
+
+        if (!copy || copy->bucket_count == 0)
+            return 0;
+
+        for (size_t curr = 0; curr < src_obj->bucket_count; curr++)
+        {
+            const Property *prop = (const Property*)src_obj->buckets[curr];
+
+            if (!prop)
+                continue;
+
+            Property *member = patch_new_member(prop->name, allocator);
+
+            if (!member || !patch_bind(copy, member))
+                return 0;
+
+            patch_from_prop(prop, &src_value);
+
+            int copied = patch_copy(&src_value, &member_value, allocator);
+
+            patch_set_prop(member, &member_value, allocator);
+
+            if (!copied)
+                return 0;
+        }
+
+        return 1;
+    }
+    default:
+        return 1;
+    }
+}
+
+/**
+ * @brief Copies a value from elsewhere in the same document. Containers are shared rather than copied, and are unshared if either place is edited later.
+ *
+ * @return int 0 if memory ran out.
+ */
+static int patch_share(const ArrayItem *src, ArrayItem *out, const JsonAllocator *allocator)
+{
+    *out = *src;
+    out->next = NULL;
+
+    if (src->type == STR)
+        return patch_copy_str(src->data.str, &out->data.str, allocator);
+    else if (src->type == ARR || src->type == OBJ)
+        Chunk_Retain(src->data.chunk, src->type);
+
+    return 1;
+}
+
+/**
+ * @brief Compares values the way the "test" operation does: numbers by value whether written as int or float, Objects regardless of member order.
+ */
+static int patch_equal(const ArrayItem *a, const ArrayItem *b)
+{
+    if ((a->type == INT || a->type == FLT) && (b->type == INT || b->type == FLT))
+    {
+        double a_num = (a->type == INT) ? a->data.i : a->data.f;
+        double b_num = (b->type == INT) ? b->data.i : b->data.f;
+
+        return a_num == b_num;
+    }
+
+    if (a->type != b->type)
+        return 0;
+
+    switch (a->type)
+    {
+    case STR:
+        return strcmp(a->data.str, b->data.str) == 0;
+    case BOOL:
+        return a->data.i == b->data.i;
+    case ARR:
+    {
+        const ArrayItem *a_item = ((const Array*)a->data.chunk)->head;
+        const ArrayItem *b_item = ((const Array*)b->data.chunk)->head;
+
+        if (Array_Length(a->data.chunk) != Array_Length(b->data.chunk))
+            return 0;
+
+        for (; a_item != NULL; a_item = a_item->next, b_item = b_item->next)
+        {
+            if (!patch_equal(a_item, b_item))
+                return 0;
+        }
+
+        return 1;
+    }
+    case OBJ:
+    {
+        Object *a_obj = (Object*)a->data.chunk;
+        Object *b_obj = (Object*)b->data.chunk;
+        ArrayItem a_value;
+        ArrayItem b_value;
+
+        if (a_obj->count != b_obj->count)
+            return 0;
+
+        for (size_t curr = 0; curr < a_obj->bucket_count; curr++)
+        {
+            const Property *a_prop = (const Property*)a_obj->buckets[curr];
+            const Property *b_prop = (a_prop != NULL) ? Object_GetItem(b_obj, a_prop->name) : NULL;
+
+            if (!a_prop)
+                continue;
+            else if (!b_prop)
+                return 0;
+
+            patch_from_prop(a_prop, &a_value);
+            patch_from_prop(b_prop, &b_value);
+
+            if (!patch_equal(&a_value, &b_value))
+                return 0;
+        }
+
+        return 1;
+    }
+    default:
+        return 1;
+    }
+}
+
+/// JSON Pointers:
+
+/**
+ * @brief Decodes a JSON Pointer into null separated segments, turning "~0" into '~' and "~1" into '/'.
+ *
+ * @param pointer
+ * @param scratch Needs room for the pointer's length plus one.
+ * @return size_t Segment count, 0 for the root, or PATCH_BAD_POINTER.
+ */
+static size_t patch_split(const char *pointer, char *scratch)
+{
+    size_t count = 0;
+
+    if (*pointer == '\0')
+        return 0;
+    else if (*pointer != '/')
+        return PATCH_BAD_POINTER;
+
+    for (const char *c = pointer; *c != '\0'; c++)
+    {
+        if (*c == '/')
+        {
+            if (count++ > 0)
+                *scratch++ = '\0';
+        }
+        else if (*c == '~')
+        {
+            c++;
+
+            if (*c != '0' && *c != '1')
+                return PATCH_BAD_POINTER;
+
+            *scratch++ = (*c == '0') ? '~' : '/';
+        }
+        else
+            *scratch++ = *c;
+    }
+
+    *scratch = '\0';
+
+    return count;
+}
+
+/**
+ * @brief Reads an Array index segment: decimal digits without a leading zero, or "-" for the end.
+ *
+ * @return int 0 if the segment is not an index.
+ */
+static int patch_index(const char *segment, const Array *array, size_t *index)
+{
+    if (strcmp(segment, "-") == 0)
+    {
+        *index = array->length;
+        return 1;
+    }
+
+    if (*segment == '\0' || (segment[0] == '0' && segment[1] != '\0'))
+        return 0;
+
+    *index = 0;
+
+    for (; *segment != '\0'; segment++)
+    {
+        if (*segment < '0' || *segment > '9' || *index > (((size_t)-1) - 9) / 10)
+            return 0;
+
+        *index = *index * 10 + (size_t)(*segment - '0');
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Walks a pointer to the container holding its target. For writes, every container on the way is unshared first, so clones never see the change.
+ *
+ * @param scratch Receives the decoded segments, and must outlive loc.
+ * @return int A PatchErr.
+ */
+static int patch_resolve(JsonThing *doc, const char *pointer, int for_write, PatchLoc *loc, char *scratch)
+{
+    size_t count = patch_split(pointer, scratch);
+    const char *segment = scratch;
+
+    loc->parent_type = UNSUPPORTED;
+    loc->parent = NULL;
+    loc->key = NULL;
+    loc->index = 0;
+
+    if (count == PATCH_BAD_POINTER)
+        return PATCH_BAD_OP;
+    else if (!doc->root)
+        return PATCH_NO_PATH;
+    else if (count == 0)
+        return PATCH_OK;
+
+    DataType type = doc->root->type;
+    void **slot = &doc->root->data.chunk;
+
+    for (size_t i = 1; ; i++)
+    {
+        if (type != ARR && type != OBJ)
+            return PATCH_NO_PATH;
+        else if (for_write && !Chunk_Unshare(slot, type, doc->allocator))
+            return PATCH_NO_MEMORY;
+
+        if (i == count)
+            break;
+
+        if (type == OBJ)
+        {
+            Property *member = (Property*)Object_GetItem((Object*)*slot, segment);
+
+            if (!member)
+                return PATCH_NO_PATH;
+
+            type = member->type;
+            slot = &member->data.chunk;
+        }
+        else
+        {
+            size_t index = 0;
+            ArrayItem *item = patch_index(segment, (Array*)*slot, &index) ? (ArrayItem*)Array_Get((Array*)*slot, index) : NULL;
+
+            if (!item)
+                return PATCH_NO_PATH;
+
+            type = item->type;
+            slot = &item->data.chunk;
+        }
+
+        segment += strlen(segment) + 1;
+    }
+
+    loc->parent_type = type;
+    loc->parent = *slot;
+    loc->key = segment;
+
+    if (type == ARR && !patch_index(segment, (Array*)*slot, &loc->index))
+        return PATCH_NO_PATH;
+
+    return PATCH_OK;
+}
+
+/// Node Edits:
+
+/**
+ * @brief Views the value at a location without taking it.
+ *
+ * @return int 0 if there is no value there.
+ */
+static int patch_get(const JsonThing *doc, const PatchLoc *loc, ArrayItem *out)
+{
+    if (loc->parent_type == OBJ)
+    {
+        const Property *prop = Object_GetItem((Object*)loc->parent, loc->key);
+
+        if (!prop)
+            return 0;
+
+        patch_from_prop(prop, out);
+    }
+    else if (loc->parent_type == ARR)
+    {
+        const ArrayItem *item = Array_Get((Array*)loc->parent, loc->index);
+
+        if (!item)
+            return 0;
+
+        *out = *item;
+        out->next = NULL;
+    }
+    else
+        patch_from_prop(doc->root, out);
+
+    return 1;
+}
+
+/**
+ * @brief Unlinks the value at a location and hands it to the caller.
+ *
+ * @return int A PatchErr. The root cannot be taken.
+ */
+static int patch_take(const JsonThing *doc, const PatchLoc *loc, ArrayItem *out)
+{
+    if (loc->parent_type == OBJ)
+    {
+        Property *prop = Object_TakeItem((Object*)loc->parent, loc->key);
+
+        if (!prop)
+            return PATCH_NO_PATH;
+
+        patch_from_prop(prop, out);
+        json_free(doc->allocator, prop->name);
+        json_free(doc->allocator, prop);
+    }
+    else if (loc->parent_type == ARR)
+    {
+        ArrayItem *item = Array_Take((Array*)loc->parent, loc->index);
+
+        if (!item)
+            return PATCH_NO_PATH;
+
+        *out = *item;
+        json_free(doc->allocator, item);
+    }
+    else
+        return PATCH_BAD_OP;
+
+    return PATCH_OK;
+}
+
+/**
+ * @brief Moves a loose value into a location. "add" binds a new member or inserts an item, and "replace" needs a value to be there already.
+ *
+ * @return int A PatchErr. On failure the caller still owns value.
+ */
+static int patch_put(JsonThing *doc, const PatchLoc *loc, ArrayItem *value, int replace)
+{
+    if (loc->parent_type == OBJ)
+    {
+        Property *prop = (Property*)Object_GetItem((Object*)loc->parent, loc->key);
+
+        if (!prop && replace)
+            return PATCH_NO_PATH;
+        else if (!prop)
+        {
+            prop = patch_new_member(loc->key, doc->allocator);
+
+            if (!prop || !patch_bind((Object*)loc->parent, prop))
+                return PATCH_NO_MEMORY;
+        }
+
+        patch_set_prop(prop, value, doc->allocator);
+    }
+    else if (loc->parent_type == ARR)
+    {
+        Array *array = (Array*)loc->parent;
+
+        if (replace)
+        {
+            ArrayItem *item = (ArrayItem*)Array_Get(array, loc->index);
+
+            if (!item)
+                return PATCH_NO_PATH;
+
+            ArrayItem_Destroy(item, doc->allocator);
+            item->type = value->type;
+            item->data = value->data;
+        }
+        else
+        {
+            if (loc->index > array->length)
+                return PATCH_NO_PATH;
+
+            ArrayItem *item = json_alloc(doc->allocator, sizeof(ArrayItem));
+
+            if (!item)
+                return PATCH_NO_MEMORY;
+
+            *item = *value;
+            Array_Insert(array, loc->index, item);
+        }
+    }
+    else
+        patch_set_prop(doc->root, value, doc->allocator);
+
+    return PATCH_OK;
+}
+
+/// JSON Patch:
+
+/**
+ * @brief Moves a value, putting it back where it was if the destination does not exist.
+ */
+static int patch_move(JsonThing *doc, const char *from, const char *path, char *from_scratch, char *path_scratch)
+{
+    PatchLoc from_loc;
+    PatchLoc path_loc;
+    ArrayItem value;
+    size_t from_len = strlen(from);
+
+    // a value cannot move into itself
+    if (strncmp(path, from, from_len) == 0 && path[from_len] == '/')
+        return PATCH_BAD_OP;
+
+    int err = patch_resolve(doc, from, 1, &from_loc, from_scratch);
+
+    if (err == PATCH_OK && strcmp(from, path) == 0)
+        return patch_get(doc, &from_loc, &value) ? PATCH_OK : PATCH_NO_PATH;
+    else if (err == PATCH_OK)
+        err = patch_take(doc, &from_loc, &value);
+
+    if (err != PATCH_OK)
+        return err;
+
+    err = patch_resolve(doc, path, 1, &path_loc, path_scratch);
+
+    if (err == PATCH_OK)
+        err = patch_put(doc, &path_loc, &value, 0);
+
+    // from's containers are private after its walk, so its location still holds
+    if (err != PATCH_OK && patch_put(doc, &from_loc, &value, 0) != PATCH_OK)
+        ArrayItem_Destroy(&value, doc->allocator);
+
+    return err;
+}
+
+static int patch_apply_op(JsonThing *doc, Object *op)
+{
+    const Property *op_name = Object_GetItem(op, "op");
+    const Property *path = Object_GetItem(op, "path");
+    const Property *from = Object_GetItem(op, "from");
+    const Property *op_value = Object_GetItem(op, "value");
+
+    if (!op_name || op_name->type != STR || !path || path->type != STR || (from != NULL && from->type != STR))
+        return PATCH_BAD_OP;
+
+    const char *name = op_name->data.str;
+    int needs_from = (strcmp(name, "move") == 0 || strcmp(name, "copy") == 0);
+    int needs_value = (strcmp(name, "add") == 0 || strcmp(name, "replace") == 0 || strcmp(name, "test") == 0);
+
+    if ((needs_from && !from) || (needs_value && !op_value))
+        return PATCH_BAD_OP;
+    else if (!needs_from && !needs_value && strcmp(name, "remove") != 0)
+        return PATCH_BAD_OP;
+
+    size_t path_len = strlen(path->data.str);
+    size_t from_len = (from != NULL) ? strlen(from->data.str) : 0;
+    char *path_scratch = json_alloc(doc->allocator, path_len + from_len + 2);
+    char *from_scratch = path_scratch + path_len + 1;
+    PatchLoc loc;
+    ArrayItem value;
+    ArrayItem found;
+    int err = PATCH_OK;
+
+    if (!path_scratch)
+        return PATCH_NO_MEMORY;
+
+    if (strcmp(name, "add") == 0 || strcmp(name, "replace") == 0)
+    {
+        err = patch_resolve(doc, path->data.str, 1, &loc, path_scratch);
+        patch_from_prop(op_value, &found);
+
+        if (err == PATCH_OK && !patch_copy(&found, &value, doc->allocator))
+        {
+            ArrayItem_Destroy(&value, doc->allocator);
+            err = PATCH_NO_MEMORY;
+        }
+        else if (err == PATCH_OK)
+        {
+            err = patch_put(doc, &loc, &value, name[0] == 'r');
+
+            if (err != PATCH_OK)
+                ArrayItem_Destroy(&value, doc->allocator);
+        }
+    }
+    else if (strcmp(name, "remove") == 0)
+    {
+        err = patch_resolve(doc, path->data.str, 1, &loc, path_scratch);
+
+        if (err == PATCH_OK)
+            err = patch_take(doc, &loc, &value);
+
+        if (err == PATCH_OK)
+            ArrayItem_Destroy(&value, doc->allocator);
+    }
+    else if (strcmp(name, "move") == 0)
+        err = patch_move(doc, from->data.str, path->data.str, from_scratch, path_scratch);
+    else if (strcmp(name, "copy") == 0)
+    {
+        err = patch_resolve(doc, from->data.str, 0, &loc, from_scratch);
+
+        if (err == PATCH_OK && !patch_get(doc, &loc, &found))
+            err = PATCH_NO_PATH;
+        else if (err == PATCH_OK && !patch_share(&found, &value, doc->allocator))
+            err = PATCH_NO_MEMORY;
+        else if (err == PATCH_OK)
+        {
+            err = patch_resolve(doc, path->data.str, 1, &loc, path_scratch);
+
+            if (err == PATCH_OK)
+                err = patch_put(doc, &loc, &value, 0);
+
+            if (err != PATCH_OK)
+                ArrayItem_Destroy(&value, doc->allocator);
+        }
+    }
+    else
+    {
+        err = patch_resolve(doc, path->data.str, 0, &loc, path_scratch);
+        patch_from_prop(op_value, &value);
+
+        if (err == PATCH_OK && !patch_get(doc, &loc, &found))
+            err = PATCH_NO_PATH;
+        else if (err == PATCH_OK && !patch_equal(&found, &value))
+            err = PATCH_TEST_FAILED;
+    }
+
+    json_free(doc->allocator, path_scratch);
+
+    return err;
+}
+
+int JsonPatch_Apply(JsonThing *doc, const JsonThing *patch, size_t *failed_op)
+{
+    size_t op_index = 0;
+    int err = PATCH_OK;
+
+    if (!patch->root || patch->root->type != ARR)
+        err = PATCH_BAD_OP;
+    else
+    {
+        for (const ArrayItem *op = ((const Array*)patch->root->data.chunk)->head; op != NULL; op = op->next, op_index++)
+        {
+            err = (op->type == OBJ) ? patch_apply_op(doc, (Object*)op->data.chunk) : PATCH_BAD_OP;
+
+            if (err != PATCH_OK)
+                break;
+        }
+    }
+
+    if (failed_op != NULL)
+        *failed_op = (err != PATCH_OK) ? op_index : 0;
+
+    return err;
+}
+
+/// JSON Merge Patch:
+
+static int patch_merge(Property *target, const Property *changes, const JsonAllocator *allocator)
+{
+    ArrayItem value;
+
+    if (changes->type != OBJ)
+    {
+        ArrayItem src;
+
+        patch_from_prop(changes, &src);
+
+        if (!patch_copy(&src, &value, allocator))
+        {
+            ArrayItem_Destroy(&value, allocator);
+            return PATCH_NO_MEMORY;
+        }
+
+        patch_set_prop(target, &value, allocator);
+
+        return PATCH_OK;
+    }
+
+    const Object *members = (const Object*)changes->data.chunk;
+
+    if (target->type != OBJ)
+    {
+        value.type = OBJ;
+        value.data.chunk = Object_Create(members->count, allocator);
+
+        if (!value.data.chunk)
+            return PATCH_NO_MEMORY;
+
+        patch_set_prop(target, &value, allocator);
+    }
+    else if (!Chunk_Unshare(&target->data.chunk, OBJ, allocator))
+        return PATCH_NO_MEMORY;
+
+    Object *merged = (Object*)target->data.chunk;
+
+    for (size_t curr = 0; curr < members->bucket_count; curr++)
+    {
+        const Property *member = (const Property*)members->buckets[curr];
+
+        if (!member)
+            continue;
+
+        if (member->type == NUL)
+        {
+            Property *old = Object_TakeItem(merged, member->name);
+
+            if (old != NULL)
+            {
+                Property_Destroy(old, allocator);
+                json_free(allocator, old);
+            }
+
+            continue;
+        }
+
+        Property *current = (Property*)Object_GetItem(merged, member->name);
+
+        if (!current)
+        {
+            current = patch_new_member(member->name, allocator);
+
+            if (!current || !patch_bind(merged, current))
+                return PATCH_NO_MEMORY;
+        }
+
+        int err = patch_merge(current, member, allocator);
+
+        if (err != PATCH_OK)
+            return err;
+    }
+
+    return PATCH_OK;
+}
+
+int JsonPatch_Merge(JsonThing *doc, const JsonThing *merge_patch)
+{
+    if (!doc->root || !merge_patch->root)
+        return PATCH_OK;
+
+    return patch_merge(doc->root, merge_patch->root, doc->allocator);
+}
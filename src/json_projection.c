@@ -0,0 +1,166 @@
+/**
+ * @file json_projection.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Implements the field projection trie.
+ * @date 2026-10-19
+ */
+
+#include <string.h>
+#include "json_projection.h"
+
+/// Helpers:
+
+/**
+ * @brief Appends a node, growing the flat node array when full.
+ *
+ * @return size_t The new node's index, or PROJ_ALL if memory ran out.
+ */
+static size_t proj_add_node(Projection *self, const char *key, size_t key_len)
+{
+    if (self->count == self->capacity)
+    {
+        size_t new_cap = (self->capacity > 0) ? self->capacity << 1 : 8;
+        ProjNode *temp = json_realloc(self->allocator, self->nodes, sizeof(ProjNode) * new_cap);
+
+        if (!temp)
+            return PROJ_ALL;
+
+        self->nodes = temp;
+        self->capacity = new_cap;
+    }
+
+    ProjNode *node = self->nodes + self->count;
+
+    node->key = NULL;
+    node->key_len = key_len;
+    node->first_child = PROJ_ALL;
+    node->next_sibling = PROJ_ALL;
+    node->is_leaf = 0;
+
+    if (key != NULL)
+    {
+        node->key = json_alloc(self->allocator, key_len + 1);
+
+        if (!node->key)
+            return PROJ_ALL;
+
+        memcpy(node->key, key, key_len);
+        node->key[key_len] = '\0';
+    }
+
+    return self->count++;
+}
+
+static size_t proj_find_child(const Projection *self, size_t node, const char *key, size_t key_len)
+{
+    size_t child = self->nodes[node].first_child;
+
+    while (child != PROJ_ALL)
+    {
+        const ProjNode *curr = self->nodes + child;
+
+        if (curr->key_len == key_len && memcmp(curr->key, key, key_len) == 0)
+            break;
+
+        child = curr->next_sibling;
+    }
+
+    return child;
+}
+
+/// Projection:
+
+Projection *Projection_Create(const JsonAllocator *allocator)
+{
+    Projection *result = json_alloc(allocator, sizeof(Projection));
+
+    if (!result)
+        return result;
+
+    result->nodes = NULL;
+    result->count = 0;
+    result->capacity = 0;
+    result->allocator = allocator;
+
+    if (proj_add_node(result, NULL, 0) != PROJ_ROOT)
+    {
+        json_free(allocator, result->nodes);
+        json_free(allocator, result);
+        return NULL;
+    }
+
+    return result;
+}
+
+void Projection_Destroy(Projection *self)
+{
+    for (size_t i = 0; i < self->count; i++)
+        json_free(self->allocator, self->nodes[i].key);
+
+    json_free(self->allocator, self->nodes);
+    self->nodes = NULL;
+    self->count = 0;
+    self->capacity = 0;
+}
+
+int Projection_Add(Projection *self, const char *path)
+{
+    size_t node = PROJ_ROOT;
+    const char *segment = path;
+
+    while (1)
+    {
+        const char *dot = strchr(segment, '.');
+        size_t seg_len = (dot != NULL) ? (size_t)(dot - segment) : strlen(segment);
+
+        if (seg_len == 0)
+            return 0;
+
+        size_t child = proj_find_child(self, node, segment, seg_len);
+
+        if (child == PROJ_ALL)
+        {
+            child = proj_add_node(self, segment, seg_len);
+
+            if (child == PROJ_ALL)
+                return 0;
+
+            // link the new node first among its siblings (nodes may have moved while growing)
+            self->nodes[child].next_sibling = self->nodes[node].first_child;
+            self->nodes[node].first_child = child;
+        }
+
+        node = child;
+
+        if (self->nodes[node].is_leaf)
+            return 1; // a shorter path already keeps this whole value
+
+        if (!dot)
+            break;
+
+        segment = dot + 1;
+    }
+
+    self->nodes[node].is_leaf = 1;
+
+    return 1;
+}
+
+size_t Projection_Step(const Projection *self, size_t node, const Token *key, const char *src)
+{
+    size_t child = self->nodes[node].first_child;
+
+    // escaped keys are compared while decoding, so skipped keys still allocate nothing
+    if (key->flags & TOKEN_ESCAPED)
+    {
+        while (child != PROJ_ALL && !Token_MatchTxt(key, src, self->nodes[child].key, self->nodes[child].key_len))
+            child = self->nodes[child].next_sibling;
+    }
+    else
+        child = proj_find_child(self, node, src + key->begin, key->span);
+
+    if (child == PROJ_ALL)
+        return PROJ_SKIP;
+
+    return self->nodes[child].is_leaf ? PROJ_ALL : child;
+}
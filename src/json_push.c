@@ -0,0 +1,413 @@
+/**
+ * @file json_push.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Implements the resumable push parser.
+ * @date 2026-10-19
+ */
+
+#include <string.h>
+#include "json_push.h"
+
+/// Helpers:
+
+static PushStatus push_fail(PushParser *self, ParserErr err)
+{
+    if (self->err_code == NO_ERR)
+        self->err_code = err;
+
+    // frames only reference containers owned by the root, so unwinding first leaves just the root to free
+    Parser_Unwind(&self->parser, 0);
+
+    if (self->root != NULL)
+    {
+        Property_Destroy(self->root, self->allocator);
+        json_free(self->allocator, self->root);
+        self->root = NULL;
+    }
+
+    if (self->doc != NULL)
+    {
+        JsonThing_Destroy(self->doc); // trailing garbage after a finished document
+        json_free(self->allocator, self->doc);
+        self->doc = NULL;
+    }
+
+    self->status = PUSH_ERROR;
+
+    return self->status;
+}
+
+static int push_only_wspace(const char *bytes, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        if (!is_wspace(bytes[i]))
+            return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Makes room for len more bytes after the pending input.
+ */
+static int push_reserve(PushParser *self, size_t len)
+{
+    if (self->buf_cap - self->buf_len < len)
+    {
+        size_t new_cap = (self->buf_cap > 0) ? self->buf_cap : PUSH_BUFFER_SIZE;
+
+        while (new_cap - self->buf_len < len)
+            new_cap <<= 1;
+
+        char *temp = json_realloc(self->allocator, self->buf, new_cap);
+
+        if (!temp)
+            return 0;
+
+        self->buf = temp;
+        self->buf_cap = new_cap;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Lexes every complete token after lex_pos. Unless the input is final, a token that may still continue past the end of the buffer is left unlexed: a string without its closing quote (or a UTF-8 char or escape cut in half), a number touching the end, or a literal shorter than its keyword.
+ *
+ * @return int 0 if memory ran out.
+ */
+static int push_lex(PushParser *self, int final)
+{
+    Lexer *lexer = &self->lexer;
+    const char *buf = self->buf;
+
+    Lexer_Init(lexer, self->buf, self->buf_len, self->allocator);
+    lexer->doc_pos = self->lex_pos;
+
+    while (1)
+    {
+        Lexer_Skip_WSpc(lexer);
+
+        size_t begin = lexer->doc_pos;
+
+        if (begin >= self->buf_len)
+            break;
+
+        unsigned char char_class = JSON_CHAR_CLASS[(unsigned char)buf[begin]];
+
+        if (!final && char_class == CC_QUOTE)
+        {
+            // resume the quote search where the last feed gave up instead of rescanning a long string
+            size_t from = (self->str_resume > begin + 1) ? self->str_resume : begin + 1;
+
+            if (!memchr(buf + from, '\"', self->buf_len - from))
+            {
+                self->str_resume = self->buf_len;
+                break;
+            }
+        }
+        else if (!final && char_class == CC_LITERAL && self->buf_len - begin < ((buf[begin] == 'f') ? 5u : 4u))
+            break;
+
+        Token temp = Lexer_Lex_Next(lexer);
+
+        // a number touching the end may have more digits coming, and a string that ran to the end only found escaped quotes
+        if (!final && lexer->doc_pos >= self->buf_len && (char_class == CC_NUMBER || (char_class == CC_QUOTE && temp.type == UNKNOWN)))
+        {
+            if (char_class == CC_QUOTE)
+                self->str_resume = self->buf_len;
+
+            lexer->doc_pos = begin;
+            break;
+        }
+
+        if (!TokenVec_Push(&self->tokens, temp))
+            return 0;
+
+        self->str_resume = 0;
+    }
+
+    self->lex_pos = lexer->doc_pos;
+
+    return 1;
+}
+
+/**
+ * @brief Opens the root value on the first token, then runs the suspended parse stack over the new tokens.
+ */
+static PushStatus push_parse(PushParser *self)
+{
+    Parser *parser = &self->parser;
+
+    parser->srcbuf_ref = self->buf;
+    parser->tokvec_end = self->tokens.count;
+
+    if (parser->tokvec_idx >= parser->tokvec_end)
+        return self->status;
+
+    if (self->root_type == UNSUPPORTED)
+    {
+        Token *first = TokenVec_At(&self->tokens, parser->tokvec_idx);
+
+        switch (first->type)
+        {
+        case LCURLY:
+            self->root_type = OBJ;
+            break;
+        case LBRACKET:
+            self->root_type = ARR;
+            break;
+        case INT_LTRL:
+            self->root_type = INT;
+            break;
+        case FLT_LTRL:
+            self->root_type = FLT;
+            break;
+        case STRBODY:
+            self->root_type = STR;
+            break;
+        case NULL_LTRL:
+            self->root_type = NUL;
+            break;
+        case TRUE_LTRL:
+        case FALSE_LTRL:
+            self->root_type = BOOL;
+            break;
+        case UNKNOWN:
+            return push_fail(self, UNKNOWN_TOKEN_ERR);
+        default:
+            return push_fail(self, UNEXPECTED_TOKEN_ERR);
+        }
+
+        if (self->root_type == ARR || self->root_type == OBJ)
+        {
+            void *chunk = Parser_Begin_Chunk(parser, self->root_type);
+
+            if (!chunk)
+                return push_fail(self, parser->err_code);
+
+            self->root = Property_Chunk(NULL, chunk, self->root_type, self->allocator);
+
+            if (!self->root)
+            {
+                Parser_Unwind(parser, 0);
+
+                if (self->root_type == ARR)
+                    Array_Destroy((Array*)chunk);
+                else
+                    Object_Destroy((Object*)chunk);
+
+                json_free(self->allocator, chunk);
+
+                return push_fail(self, OUT_OF_MEMORY_ERR);
+            }
+        }
+        else
+        {
+            // a primitive root is the lone value of the document
+            self->root = Parser_Parse_Prim(parser, NULL, self->root_type, TO_NONE);
+            parser->tokvec_idx++;
+
+            if (!self->root)
+                return push_fail(self, OUT_OF_MEMORY_ERR);
+        }
+    }
+
+    if (parser->depth > 0 && !Parser_Run(parser, 0))
+        return (parser->err_code == NO_ERR) ? self->status : push_fail(self, parser->err_code);
+
+    // the root value is closed: only whitespace may follow it
+    if (parser->tokvec_idx < parser->tokvec_end || !push_only_wspace(self->buf + self->lex_pos, self->buf_len - self->lex_pos))
+        return push_fail(self, UNEXPECTED_TOKEN_ERR);
+
+    self->doc = JsonThing_Create(self->root_type, self->root, self->allocator);
+
+    if (!self->doc)
+        return push_fail(self, OUT_OF_MEMORY_ERR);
+
+    self->root = NULL;
+    self->status = PUSH_DONE;
+
+    return self->status;
+}
+
+/**
+ * @brief Drops consumed tokens and the bytes before the first unfinished token, so the buffer only grows as large as the longest token.
+ */
+static void push_compact(PushParser *self)
+{
+    Parser *parser = &self->parser;
+    size_t drop = self->lex_pos;
+
+    if (parser->tokvec_idx < self->tokens.count && self->tokens.data[parser->tokvec_idx].begin < drop)
+        drop = self->tokens.data[parser->tokvec_idx].begin;
+
+    TokenVec_Splice(&self->tokens, 0, parser->tokvec_idx, NULL, 0);
+    parser->tokvec_idx = 0;
+    parser->tokvec_end = self->tokens.count;
+
+    if (drop == 0)
+        return;
+
+    for (size_t i = 0; i < self->tokens.count; i++)
+        self->tokens.data[i].begin -= drop;
+
+    memmove(self->buf, self->buf + drop, self->buf_len - drop);
+    self->buf_len -= drop;
+    self->lex_pos -= drop;
+    self->str_resume = (self->str_resume > drop) ? self->str_resume - drop : 0;
+}
+
+/**
+ * @brief Lexes and parses newly appended input, then compacts the buffer if the document is still open.
+ */
+static PushStatus push_advance(PushParser *self)
+{
+    if (!push_lex(self, 0))
+        return push_fail(self, OUT_OF_MEMORY_ERR);
+
+    if (push_parse(self) == PUSH_NEED_MORE)
+        push_compact(self);
+
+    return self->status;
+}
+
+/// PushParser:
+
+PushParser *PushParser_Create(const JsonAllocator *allocator)
+{
+    PushParser *result = json_alloc(allocator, sizeof(PushParser));
+
+    if (!result)
+        return result;
+
+    if (!TokenVec_Init(&result->tokens, 16, allocator))
+    {
+        json_free(allocator, result);
+        return NULL;
+    }
+
+    result->buf = NULL;
+    result->buf_len = 0;
+    result->buf_cap = 0;
+    result->allocator = allocator;
+    Lexer_Init(&result->lexer, NULL, 0, allocator);
+    Parser_Init(&result->parser, NULL, &result->tokens, allocator);
+    result->doc = NULL;
+    result->root = NULL;
+    PushParser_Reset(result);
+
+    return result;
+}
+
+void PushParser_Destroy(PushParser *self)
+{
+    PushParser_Reset(self);
+    Parser_Destroy(&self->parser);
+    TokenVec_Destroy(&self->tokens);
+    json_free(self->allocator, self->buf);
+    self->buf = NULL;
+    self->buf_cap = 0;
+}
+
+void PushParser_Reset(PushParser *self)
+{
+    Parser_Unwind(&self->parser, 0);
+
+    if (self->root != NULL)
+    {
+        Property_Destroy(self->root, self->allocator);
+        json_free(self->allocator, self->root);
+    }
+
+    if (self->doc != NULL)
+    {
+        JsonThing_Destroy(self->doc);
+        json_free(self->allocator, self->doc);
+    }
+
+    TokenVec_Clear(&self->tokens);
+    Parser_Rebind(&self->parser, self->buf, &self->tokens);
+    self->buf_len = 0;
+    self->lex_pos = 0;
+    self->str_resume = 0;
+    self->root = NULL;
+    self->root_type = UNSUPPORTED;
+    self->doc = NULL;
+    self->status = PUSH_NEED_MORE;
+    self->err_code = NO_ERR;
+}
+
+PushStatus PushParser_Feed(PushParser *self, const char *bytes, size_t len)
+{
+    if (self->status == PUSH_ERROR)
+        return self->status;
+
+    if (self->status == PUSH_DONE)
+        return push_only_wspace(bytes, len) ? self->status : push_fail(self, UNEXPECTED_TOKEN_ERR);
+
+    if (!push_reserve(self, len))
+        return push_fail(self, OUT_OF_MEMORY_ERR);
+
+    memcpy(self->buf + self->buf_len, bytes, len);
+    self->buf_len += len;
+
+    return push_advance(self);
+}
+
+PushStatus PushParser_Parse_Input(PushParser *self, JsonInput *input)
+{
+    while (self->status != PUSH_ERROR)
+    {
+        if (!push_reserve(self, INPUT_CHUNK_SIZE))
+            return push_fail(self, OUT_OF_MEMORY_ERR);
+
+        // decompressed bytes land right after the pending ones, so they are never copied again
+        char *block = self->buf + self->buf_len;
+        size_t got = JsonInput_Read(input, block, INPUT_CHUNK_SIZE);
+
+        if (got == 0)
+            break;
+
+        if (self->status == PUSH_DONE)
+        {
+            if (!push_only_wspace(block, got))
+                return push_fail(self, UNEXPECTED_TOKEN_ERR);
+
+            continue;
+        }
+
+        self->buf_len += got;
+        push_advance(self);
+    }
+
+    if (JsonInput_Get_ErrCode(input) != NO_ERR)
+        return push_fail(self, INPUT_ERR);
+
+    return PushParser_Finish(self);
+}
+
+PushStatus PushParser_Finish(PushParser *self)
+{
+    if (self->status != PUSH_NEED_MORE)
+        return self->status;
+
+    if (!push_lex(self, 1))
+        return push_fail(self, OUT_OF_MEMORY_ERR);
+
+    if (push_parse(self) == PUSH_NEED_MORE)
+        return push_fail(self, (self->root_type == UNSUPPORTED) ? EMPTY_TOKENS_ERR : UNBALANCED_NEST);
+
+    return self->status;
+}
+
+JsonThing *PushParser_Take(PushParser *self)
+{
+    JsonThing *result = self->doc;
+    self->doc = NULL;
+
+    return result;
+}
+
+int PushParser_Get_ErrCode(const PushParser *self) { return self->err_code; }
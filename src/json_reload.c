@@ -0,0 +1,267 @@
+/**
+ * @file json_reload.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Implements RCU-style hot reloading with quiescent-state-based reclamation.
+ * @date 2026-10-19
+ */
+
+#include "json_reload.h"
+#include "json_frozen.h"
+
+/// Helpers:
+
+static void reload_free_doc(JsonThing *doc, const JsonAllocator *allocator)
+{
+    JsonThing_Destroy(doc);
+    json_free(allocator, doc);
+}
+
+/**
+ * @brief Frees the retired documents every online reader has passed. The lock must be held.
+ *
+ * @return size_t How many are still waiting.
+ */
+static size_t reload_reclaim_locked(JsonReload *self)
+{
+    uint64_t oldest = UINT64_MAX;
+    size_t pending = 0;
+
+    // seq_cst pairs with the readers' stores, so a reader coming online either shows up here or sees the new document
+    for (const ReloadReader *reader = self->readers; reader != NULL; reader = reader->next)
+    {
+        uint64_t seen = atomic_load(&reader->epoch);
+
+        if (seen != 0 && seen < oldest)
+            oldest = seen;
+    }
+
+    ReloadRetired **link = &self->retired;
+
+    while (*link != NULL)
+    {
+        ReloadRetired *entry = *link;
+
+        if (entry->epoch <= oldest)
+        {
+            *link = entry->next;
+            reload_free_doc(entry->doc, self->allocator);
+            json_free(self->allocator, entry);
+        }
+        else
+        {
+            link = &entry->next;
+            pending++;
+        }
+    }
+
+    return pending;
+}
+
+static void *reload_run_load(void *arg)
+{
+    JsonReload *self = (JsonReload*)arg;
+    size_t src_len = 0;
+    char *src = read_file(self->load_path, &src_len, self->allocator);
+    Lexer lexer;
+    Parser parser;
+
+    if (!src)
+    {
+        self->load_err = INPUT_ERR;
+        return NULL;
+    }
+
+    Lexer_Init(&lexer, src, src_len, self->allocator);
+    TokenVec *tokens = Lexer_Lex_All(&lexer);
+
+    if (!tokens)
+    {
+        json_free(self->allocator, src);
+        self->load_err = OUT_OF_MEMORY_ERR;
+        return NULL;
+    }
+
+    Parser_Init(&parser, src, tokens, self->allocator);
+    JsonThing *doc = Parser_Start_Parse(&parser);
+    int err = Parser_Get_ErrCode(&parser);
+
+    Parser_Destroy(&parser);
+    TokenVec_Destroy(tokens);
+    json_free(self->allocator, tokens);
+    json_free(self->allocator, src);
+
+    if (doc != NULL && err == NO_ERR && !JsonReload_Publish(self, doc))
+        err = OUT_OF_MEMORY_ERR;
+
+    if (doc != NULL && err != NO_ERR)
+        reload_free_doc(doc, self->allocator);
+
+    self->load_err = (doc != NULL || err != NO_ERR) ? err : OUT_OF_MEMORY_ERR;
+
+    return NULL;
+}
+
+/// JsonReload:
+
+JsonReload *JsonReload_Create(JsonThing *initial, const JsonAllocator *allocator)
+{
+    if (initial != NULL && !JsonThing_Seal(initial))
+        return NULL;
+
+    JsonReload *result = json_alloc(allocator, sizeof(JsonReload));
+
+    if (!result)
+        return NULL;
+
+    if (pthread_mutex_init(&result->lock, NULL) != 0)
+    {
+        json_free(allocator, result);
+        return NULL;
+    }
+
+    atomic_init(&result->current, initial);
+    atomic_init(&result->epoch, 1);
+    result->readers = NULL;
+    result->retired = NULL;
+    result->loading = 0;
+    result->load_err = NO_ERR;
+    result->load_path = NULL;
+    result->allocator = allocator;
+
+    return result;
+}
+
+void JsonReload_Destroy(JsonReload *self)
+{
+    JsonReload_Wait(self);
+
+    while (self->retired != NULL)
+    {
+        ReloadRetired *entry = self->retired;
+
+        self->retired = entry->next;
+        reload_free_doc(entry->doc, self->allocator);
+        json_free(self->allocator, entry);
+    }
+
+    JsonThing *current = atomic_exchange(&self->current, NULL);
+
+    if (current != NULL)
+        reload_free_doc(current, self->allocator);
+
+    pthread_mutex_destroy(&self->lock);
+    self->readers = NULL;
+}
+
+void JsonReload_AddReader(JsonReload *self, ReloadReader *reader)
+{
+    pthread_mutex_lock(&self->lock);
+    atomic_store(&reader->epoch, atomic_load(&self->epoch));
+    reader->next = self->readers;
+    self->readers = reader;
+    pthread_mutex_unlock(&self->lock);
+}
+
+void JsonReload_RemoveReader(JsonReload *self, ReloadReader *reader)
+{
+    pthread_mutex_lock(&self->lock);
+
+    for (ReloadReader **link = &self->readers; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == reader)
+        {
+            *link = reader->next;
+            break;
+        }
+    }
+
+    reader->next = NULL;
+    pthread_mutex_unlock(&self->lock);
+}
+
+void JsonReload_Quiesce(JsonReload *self, ReloadReader *reader)
+{
+    // seq_cst, not release: a reader coming back online must be seen by any reclaim that could miss its next JsonReload_Get
+    atomic_store(&reader->epoch, atomic_load(&self->epoch));
+}
+
+void JsonReload_Offline(ReloadReader *reader) { atomic_store_explicit(&reader->epoch, 0, memory_order_release); }
+
+int JsonReload_Publish(JsonReload *self, JsonThing *doc)
+{
+    // sealed and allocated up front, so a failure leaves the old version published, and no reader ever sees a hash being cached
+    if (doc != NULL && !JsonThing_Seal(doc))
+        return 0;
+
+    ReloadRetired *entry = json_alloc(self->allocator, sizeof(ReloadRetired));
+
+    if (!entry)
+        return 0;
+
+    pthread_mutex_lock(&self->lock);
+
+    entry->doc = atomic_exchange(&self->current, doc);
+    entry->epoch = atomic_fetch_add(&self->epoch, 1) + 1; // readers that quiesce from now on cannot hold the old document
+
+    if (entry->doc != NULL)
+    {
+        entry->next = self->retired;
+        self->retired = entry;
+    }
+    else
+        json_free(self->allocator, entry);
+
+    reload_reclaim_locked(self);
+    pthread_mutex_unlock(&self->lock);
+
+    return 1;
+}
+
+size_t JsonReload_Reclaim(JsonReload *self)
+{
+    pthread_mutex_lock(&self->lock);
+    size_t pending = reload_reclaim_locked(self);
+    pthread_mutex_unlock(&self->lock);
+
+    return pending;
+}
+
+int JsonReload_Load(JsonReload *self, const char *path)
+{
+    size_t path_len = strlen(path);
+
+    if (self->loading)
+        return 0;
+
+    self->load_path = json_alloc(self->allocator, path_len + 1);
+
+    if (!self->load_path)
+        return 0;
+
+    memcpy(self->load_path, path, path_len + 1);
+    self->load_err = NO_ERR;
+
+    if (pthread_create(&self->loader, NULL, reload_run_load, self) != 0)
+    {
+        json_free(self->allocator, self->load_path);
+        self->load_path = NULL;
+        return 0;
+    }
+
+    self->loading = 1;
+
+    return 1;
+}
+
+int JsonReload_Wait(JsonReload *self)
+{
+    if (!self->loading)
+        return self->load_err;
+
+    pthread_join(self->loader, NULL);
+    json_free(self->allocator, self->load_path);
+    self->load_path = NULL;
+    self->loading = 0;
+
+    return self->load_err;
+}
@@ -0,0 +1,1006 @@
+/**
+ * @file json_schema.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Implements the schema compiler and the one pass validator over lexer tokens.
+ * @date 2026-10-19
+ */
+
+#include "json_schema.h"
+#include "json_gen.h"
+
+#define SCHEMA_BITS_PER_WORD 64
+#define SCHEMA_DECODE_CAP (SCHEMA_MAX_TEXT * 6) // raw text of the longest name worth decoding, as a \uXXXX escape may give 1 byte
+#define SCHEMA_EXACT_DOUBLE 9007199254740992.0  // 2^53: every double this large is a whole number
+
+/// Schema compile state, only alive during JsonSchema_Compile.
+typedef struct json_schema_compiler
+{
+    JsonSchema *schema;
+    const TokenVec *tokens; // tape of the schema text, checked well-formed already
+    const char *src;
+    size_t err_offset;
+} SchemaCompiler;
+
+/// Validation state of one open container that a schema node describes.
+typedef struct json_schema_frame
+{
+    size_t node;
+    size_t count;   // items so far
+    uint64_t seen;  // required_bit of each required member so far
+} SchemaFrame;
+
+/// Helpers:
+
+static uint64_t schema_hash(const char *text, size_t len)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (size_t i = 0; i < len; i++)
+        hash = (hash ^ (unsigned char)text[i]) * 1099511628211ULL;
+
+    return hash;
+}
+
+static size_t schema_token_offset(const Token *token)
+{
+    return (token->type == STRBODY) ? token->begin - 1 : token->begin; // a string starts at its quote
+}
+
+/**
+ * @brief Gives a string token's text, decoded into buf only when it has escapes.
+ *
+ * @return const char* NULL when the text is longer than SCHEMA_MAX_TEXT, so it cannot be a name or enum string of a schema.
+ */
+static const char *schema_text(const Token *token, const char *src, char *buf, size_t *len)
+{
+    if (!(token->flags & TOKEN_ESCAPED))
+    {
+        *len = token->span;
+
+        return (token->span <= SCHEMA_MAX_TEXT) ? src + token->begin : NULL;
+    }
+
+    if (token->span > SCHEMA_DECODE_CAP)
+        return NULL;
+
+    *len = Token_DecodeTxt(token, src, buf);
+
+    return (*len <= SCHEMA_MAX_TEXT) ? buf : NULL;
+}
+
+/**
+ * @brief Reads a number token. Short integers are accumulated digit by digit, and the rest go through Token_ToNum, which copies only overlong literals.
+ *
+ * @return int 0 if memory ran out.
+ */
+static int schema_number(const Token *token, const char *src, const JsonAllocator *allocator, double *out)
+{
+    if (token->type == INT_LTRL && token->span <= 18)
+    {
+        const char *digit = src + token->begin;
+        const char *end = digit + token->span;
+        int negative = (*digit == '-');
+        int64_t result = 0;
+
+        for (digit += negative; digit < end; digit++)
+            result = result * 10 + (*digit - '0');
+
+        *out = (double)(negative ? -result : result);
+
+        return 1;
+    }
+
+    return Token_ToNum(token, src, allocator, NULL, out);
+}
+
+/**
+ * @brief Counts the code points of a string token without decoding it. Escapes count as one, except that a surrogate pair counts once in all.
+ */
+static size_t schema_length(const Token *token, const char *src)
+{
+    const unsigned char *curr = (const unsigned char*)src + token->begin;
+    const unsigned char *end = curr + token->span;
+    size_t count = 0;
+
+    if (!(token->flags & TOKEN_ESCAPED))
+    {
+        for (; curr < end; curr++)
+            count += ((*curr & 0xc0) != 0x80);
+
+        return count;
+    }
+
+    while (curr < end)
+    {
+        if (*curr != '\\')
+        {
+            count += ((*curr & 0xc0) != 0x80);
+            curr++;
+        }
+        else if (curr[1] == 'u')
+        {
+            // the lexer only lets a high surrogate through when a low one follows, which is counted instead
+            int high = (curr[2] == 'd' || curr[2] == 'D') && (curr[3] == '8' || curr[3] == '9' || (curr[3] | 0x20) == 'a' || (curr[3] | 0x20) == 'b');
+
+            count += !high;
+            curr += 6;
+        }
+        else
+        {
+            count++;
+            curr += 2;
+        }
+    }
+
+    return count;
+}
+
+static int schema_reserve(const JsonAllocator *allocator, void **data, size_t *capacity, size_t needed, size_t item_size)
+{
+    if (needed <= *capacity)
+        return 1;
+
+    size_t new_capacity = (*capacity > 0) ? *capacity : 8;
+
+    while (new_capacity < needed)
+        new_capacity <<= 1;
+
+    void *temp = json_realloc(allocator, *data, item_size * new_capacity);
+
+    if (!temp)
+        return 0;
+
+    *data = temp;
+    *capacity = new_capacity;
+
+    return 1;
+}
+
+static char *schema_copy_text(const JsonAllocator *allocator, const char *text, size_t len)
+{
+    char *result = json_alloc(allocator, len + 1);
+
+    if (result != NULL)
+    {
+        memcpy(result, text, len);
+        result[len] = '\0';
+    }
+
+    return result;
+}
+
+/// Compiler:
+
+static size_t schema_compile_node(SchemaCompiler *comp, size_t *pos, size_t depth);
+
+static size_t schema_fail(SchemaCompiler *comp, const Token *token)
+{
+    comp->err_offset = schema_token_offset(token);
+
+    return SCHEMA_NONE;
+}
+
+static size_t schema_add_node(JsonSchema *self, unsigned int types)
+{
+    if (!schema_reserve(self->allocator, (void**)&self->nodes, &self->node_capacity, self->node_count + 1, sizeof(SchemaNode)))
+        return SCHEMA_NONE;
+
+    SchemaNode *node = self->nodes + self->node_count;
+
+    memset(node, 0, sizeof(SchemaNode));
+    node->types = types;
+    node->items = SCHEMA_NONE;
+
+    return self->node_count++;
+}
+
+/**
+ * @brief Finds or adds the member of a node being compiled, whose members are gathered in a list first as required may come before or after properties.
+ *
+ * @return SchemaProp* NULL if memory ran out.
+ */
+static SchemaProp *schema_pending_prop(SchemaCompiler *comp, SchemaProp **pending, size_t *count, size_t *capacity, const char *key, size_t key_len)
+{
+    for (size_t i = 0; i < *count; i++)
+    {
+        if ((*pending)[i].key_len == key_len && memcmp((*pending)[i].key, key, key_len) == 0)
+            return *pending + i;
+    }
+
+    if (!schema_reserve(comp->schema->allocator, (void**)pending, capacity, *count + 1, sizeof(SchemaProp)))
+        return NULL;
+
+    SchemaProp *prop = *pending + *count;
+
+    prop->key = schema_copy_text(comp->schema->allocator, key, key_len);
+    prop->key_len = key_len;
+    prop->hash = schema_hash(key, key_len);
+    prop->node = SCHEMA_NONE;
+    prop->required_bit = 0;
+
+    if (!prop->key)
+        return NULL;
+
+    (*count)++;
+
+    return prop;
+}
+
+/**
+ * @brief Lays the gathered members out as the node's open addressing table, at most half full. Their names move into the table.
+ *
+ * @return int 0 if memory ran out.
+ */
+static int schema_build_props(JsonSchema *self, size_t node, SchemaProp *pending, size_t count)
+{
+    size_t slots = 2;
+
+    while (slots < count * 2)
+        slots <<= 1;
+
+    if (!schema_reserve(self->allocator, (void**)&self->props, &self->prop_capacity, self->prop_count + slots, sizeof(SchemaProp)))
+        return 0;
+
+    SchemaProp *table = self->props + self->prop_count;
+
+    for (size_t i = 0; i < slots; i++)
+        table[i].key = NULL;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t slot = pending[i].hash & (slots - 1);
+
+        while (table[slot].key != NULL)
+            slot = (slot + 1) & (slots - 1);
+
+        table[slot] = pending[i];
+        pending[i].key = NULL;
+    }
+
+    self->nodes[node].first_prop = self->prop_count;
+    self->nodes[node].prop_slots = slots;
+    self->prop_count += slots;
+
+    return 1;
+}
+
+static int schema_type_bit(const char *name, size_t len, unsigned int *bits)
+{
+    static const char type_names[7][8] = {"null", "boolean", "integer", "number", "string", "array", "object"};
+
+    for (int i = 0; i < 7; i++)
+    {
+        if (strlen(type_names[i]) == len && memcmp(type_names[i], name, len) == 0)
+        {
+            *bits |= 1u << i;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static int schema_compile_type(SchemaCompiler *comp, const Token *value, SchemaNode *node)
+{
+    char buf[SCHEMA_DECODE_CAP];
+    size_t len = 0;
+    const char *name = NULL;
+    unsigned int bits = 0;
+
+    if (value->type == STRBODY)
+    {
+        name = schema_text(value, comp->src, buf, &len);
+
+        if (!name || !schema_type_bit(name, len, &bits))
+            return 0;
+    }
+    else if (value->type == LBRACKET)
+    {
+        for (const Token *item = value + 1; item->type != RBRACKET; item++)
+        {
+            if (item->type == COMMA)
+                continue;
+
+            name = (item->type == STRBODY) ? schema_text(item, comp->src, buf, &len) : NULL;
+
+            if (!name || !schema_type_bit(name, len, &bits))
+            {
+                comp->err_offset = schema_token_offset(item);
+                return 0;
+            }
+        }
+    }
+    else
+        return 0;
+
+    node->types = bits;
+
+    return 1;
+}
+
+static int schema_compile_enum(SchemaCompiler *comp, const Token *value, size_t node)
+{
+    JsonSchema *self = comp->schema;
+    char buf[SCHEMA_DECODE_CAP];
+    size_t first = self->const_count;
+
+    if (value->type != LBRACKET)
+        return 0;
+
+    for (const Token *item = value + 1; item->type != RBRACKET; item++)
+    {
+        if (item->type == COMMA)
+            continue;
+
+        if (!schema_reserve(self->allocator, (void**)&self->consts, &self->const_capacity, self->const_count + 1, sizeof(SchemaConst)))
+            return 0;
+
+        SchemaConst *entry = self->consts + self->const_count;
+        size_t len = 0;
+        const char *text = NULL;
+
+        memset(entry, 0, sizeof(SchemaConst));
+
+        switch (item->type)
+        {
+        case NULL_LTRL:
+            entry->type = SCHEMA_NULL;
+            break;
+        case TRUE_LTRL:
+        case FALSE_LTRL:
+            entry->type = SCHEMA_BOOLEAN;
+            entry->number = (item->type == TRUE_LTRL);
+            break;
+        case INT_LTRL:
+        case FLT_LTRL:
+            if (schema_number(item, comp->src, self->allocator, &entry->number))
+                entry->type = SCHEMA_NUMBER;
+            break;
+        case STRBODY:
+            text = schema_text(item, comp->src, buf, &len);
+
+            if (!text || !(entry->text = schema_copy_text(self->allocator, text, len)))
+                break;
+
+            entry->type = SCHEMA_STRING;
+            entry->text_len = len;
+            entry->hash = schema_hash(text, len);
+            break;
+        default:
+            break; // Arrays and Objects are not supported
+        }
+
+        if (entry->type == 0)
+        {
+            comp->err_offset = schema_token_offset(item);
+            return 0;
+        }
+
+        self->const_count++;
+    }
+
+    self->nodes[node].first_enum = first;
+    self->nodes[node].enum_count = self->const_count - first;
+    self->nodes[node].checks |= SCHEMA_HAS_ENUM;
+
+    return 1;
+}
+
+static int schema_compile_count(const SchemaCompiler *comp, const Token *value, size_t *out)
+{
+    if (value->type != INT_LTRL || comp->src[value->begin] == '-')
+        return 0;
+
+    *out = (size_t)strtoull(comp->src + value->begin, NULL, 10);
+
+    return 1;
+}
+
+static size_t schema_compile_object(SchemaCompiler *comp, size_t *pos, size_t depth)
+{
+    static const char *annotations[] = {"$schema", "$id", "$comment", "title", "description", "default", "examples", "deprecated", "readOnly", "writeOnly"};
+    JsonSchema *self = comp->schema;
+    const Token *tokens = comp->tokens->data;
+    size_t node = schema_add_node(self, SCHEMA_ANY);
+    SchemaProp *pending = NULL;
+    size_t pending_count = 0;
+    size_t pending_capacity = 0;
+    size_t idx = *pos + 1;
+    int ok = (node != SCHEMA_NONE);
+    char buf[SCHEMA_DECODE_CAP];
+
+    if (!ok)
+        comp->err_offset = schema_token_offset(tokens + *pos);
+
+    while (ok && tokens[idx].type != RCURLY)
+    {
+        const Token *key = tokens + idx;
+        const Token *value = tokens + idx + 2;
+        size_t len = 0;
+        const char *keyword = schema_text(key, comp->src, buf, &len);
+        size_t next = idx + 2;
+        int known = 1;
+
+        comp->err_offset = schema_token_offset(value);
+        JsonGen_Skip(comp->tokens, &next); // an indexed container is jumped in O(1)
+
+        if (!keyword)
+            known = 0;
+        else if (len == 4 && memcmp(keyword, "type", 4) == 0)
+            ok = schema_compile_type(comp, value, self->nodes + node);
+        else if (len == 4 && memcmp(keyword, "enum", 4) == 0)
+            ok = schema_compile_enum(comp, value, node);
+        else if ((len == 7 && memcmp(keyword, "minimum", 7) == 0) || (len == 7 && memcmp(keyword, "maximum", 7) == 0))
+        {
+            int is_min = (keyword[1] == 'i');
+
+            ok = (value->type == INT_LTRL || value->type == FLT_LTRL)
+                && schema_number(value, comp->src, self->allocator, is_min ? &self->nodes[node].minimum : &self->nodes[node].maximum);
+            self->nodes[node].checks |= is_min ? SCHEMA_HAS_MINIMUM : SCHEMA_HAS_MAXIMUM;
+        }
+        else if (len == 9 && memcmp(keyword, "minLength", 9) == 0)
+        {
+            ok = schema_compile_count(comp, value, &self->nodes[node].min_length);
+            self->nodes[node].checks |= SCHEMA_HAS_MIN_LENGTH;
+        }
+        else if (len == 9 && memcmp(keyword, "maxLength", 9) == 0)
+        {
+            ok = schema_compile_count(comp, value, &self->nodes[node].max_length);
+            self->nodes[node].checks |= SCHEMA_HAS_MAX_LENGTH;
+        }
+        else if (len == 8 && memcmp(keyword, "minItems", 8) == 0)
+        {
+            ok = schema_compile_count(comp, value, &self->nodes[node].min_items);
+            self->nodes[node].checks |= SCHEMA_HAS_MIN_ITEMS;
+        }
+        else if (len == 8 && memcmp(keyword, "maxItems", 8) == 0)
+        {
+            ok = schema_compile_count(comp, value, &self->nodes[node].max_items);
+            self->nodes[node].checks |= SCHEMA_HAS_MAX_ITEMS;
+        }
+        else if (len == 5 && memcmp(keyword, "items", 5) == 0)
+        {
+            size_t child = SCHEMA_NONE;
+
+            // a list of schemas, one per position, is not supported
+            next = idx + 2;
+            ok = ((child = schema_compile_node(comp, &next, depth + 1)) != SCHEMA_NONE);
+
+            if (ok)
+                self->nodes[node].items = child;
+        }
+        else if (len == 8 && memcmp(keyword, "required", 8) == 0)
+        {
+            ok = (value->type == LBRACKET);
+
+            for (const Token *item = value + 1; ok && item->type != RBRACKET; item++)
+            {
+                if (item->type == COMMA)
+                    continue;
+
+                const char *name = (item->type == STRBODY) ? schema_text(item, comp->src, buf, &len) : NULL;
+                SchemaProp *prop = NULL;
+
+                comp->err_offset = schema_token_offset(item);
+                ok = (name != NULL && (prop = schema_pending_prop(comp, &pending, &pending_count, &pending_capacity, name, len)) != NULL);
+
+                if (ok && prop->required_bit == 0)
+                {
+                    ok = (self->nodes[node].required_count < SCHEMA_MAX_REQUIRED);
+
+                    if (ok)
+                        prop->required_bit = (uint64_t)1 << self->nodes[node].required_count++;
+                }
+            }
+        }
+        else if (len == 10 && memcmp(keyword, "properties", 10) == 0)
+        {
+            ok = (value->type == LCURLY);
+            next = idx + 3;
+
+            while (ok && tokens[next].type != RCURLY)
+            {
+                const Token *name_token = tokens + next;
+                const char *name = schema_text(name_token, comp->src, buf, &len);
+                SchemaProp *prop = NULL;
+                size_t child = SCHEMA_NONE;
+
+                comp->err_offset = schema_token_offset(name_token);
+                ok = (name != NULL && (prop = schema_pending_prop(comp, &pending, &pending_count, &pending_capacity, name, len)) != NULL);
+                next += 2;
+
+                // the list may move while the child compiles, but not its index
+                size_t prop_idx = ok ? (size_t)(prop - pending) : 0;
+
+                ok = ok && ((child = schema_compile_node(comp, &next, depth + 1)) != SCHEMA_NONE);
+
+                if (ok)
+                    pending[prop_idx].node = child;
+
+                if (ok && tokens[next].type == COMMA)
+                    next++;
+            }
+
+            next++;
+        }
+        else
+        {
+            known = 0;
+
+            for (size_t i = 0; i < sizeof(annotations) / sizeof(annotations[0]); i++)
+            {
+                if (strlen(annotations[i]) == len && memcmp(annotations[i], keyword, len) == 0)
+                    known = 1;
+            }
+        }
+
+        if (!known)
+        {
+            comp->err_offset = schema_token_offset(key);
+            ok = 0;
+        }
+
+        if (!ok)
+            break;
+
+        idx = next;
+
+        if (tokens[idx].type == COMMA)
+            idx++;
+    }
+
+    if (ok && pending_count > 0)
+        ok = schema_build_props(self, node, pending, pending_count);
+
+    for (size_t i = 0; i < pending_count; i++)
+        json_free(self->allocator, pending[i].key);
+
+    json_free(self->allocator, pending);
+    *pos = idx + 1;
+
+    return ok ? node : SCHEMA_NONE;
+}
+
+static size_t schema_compile_node(SchemaCompiler *comp, size_t *pos, size_t depth)
+{
+    const Token *token = comp->tokens->data + *pos;
+
+    if (depth > SCHEMA_MAX_DEPTH)
+        return schema_fail(comp, token);
+
+    switch (token->type)
+    {
+    case LCURLY:
+        return schema_compile_object(comp, pos, depth);
+    case TRUE_LTRL:
+    case FALSE_LTRL:
+        (*pos)++;
+
+        // boolean schemas pass every value or none
+        if (schema_add_node(comp->schema, (token->type == TRUE_LTRL) ? SCHEMA_ANY : 0) == SCHEMA_NONE)
+            return schema_fail(comp, token);
+
+        return comp->schema->node_count - 1;
+    default:
+        return schema_fail(comp, token);
+    }
+}
+
+JsonSchema *JsonSchema_Compile(const char *src, size_t len, const JsonAllocator *allocator, size_t *err_offset)
+{
+    size_t offset = len;
+    JsonSchema *result = NULL;
+    TokenVec tokens;
+    Lexer lexer;
+
+    if (Parser_Validate(src, len, &offset) != NO_ERR)
+    {
+        if (err_offset != NULL)
+            *err_offset = offset;
+
+        return NULL;
+    }
+
+    result = json_alloc(allocator, sizeof(JsonSchema));
+
+    if (!result)
+        return NULL;
+
+    memset(result, 0, sizeof(JsonSchema));
+    result->allocator = allocator;
+
+    if (!TokenVec_Init(&tokens, 64, allocator))
+    {
+        json_free(allocator, result);
+        return NULL;
+    }
+
+    // the tape indexes every container, so annotations are stepped over whole
+    Lexer_Init(&lexer, (char*)src, len, allocator);
+    Lexer_Lex_Into(&lexer, &tokens);
+
+    SchemaCompiler comp = {result, &tokens, src, len};
+    size_t pos = 0;
+
+    // a cut short tape would be walked past its end
+    if (lexer.out_of_memory || schema_compile_node(&comp, &pos, 0) == SCHEMA_NONE)
+    {
+        offset = comp.err_offset;
+        JsonSchema_Destroy(result);
+        json_free(allocator, result);
+        result = NULL;
+    }
+
+    TokenVec_Destroy(&tokens);
+
+    if (err_offset != NULL)
+        *err_offset = offset;
+
+    return result;
+}
+
+void JsonSchema_Destroy(JsonSchema *self)
+{
+    for (size_t i = 0; i < self->prop_count; i++)
+        json_free(self->allocator, self->props[i].key);
+
+    for (size_t i = 0; i < self->const_count; i++)
+        json_free(self->allocator, self->consts[i].text);
+
+    json_free(self->allocator, self->nodes);
+    json_free(self->allocator, self->props);
+    json_free(self->allocator, self->consts);
+    self->nodes = NULL;
+    self->props = NULL;
+    self->consts = NULL;
+    self->node_count = 0;
+    self->prop_count = 0;
+    self->const_count = 0;
+}
+
+/// Validator:
+
+static int schema_in_enum(const JsonSchema *self, const SchemaNode *node, const Token *value, const char *src, double number)
+{
+    char buf[SCHEMA_DECODE_CAP];
+    const char *text = NULL;
+    size_t len = 0;
+    uint64_t hash = 0;
+    unsigned int type = SCHEMA_NULL;
+
+    switch (value->type)
+    {
+    case TRUE_LTRL:
+    case FALSE_LTRL:
+        type = SCHEMA_BOOLEAN;
+        number = (value->type == TRUE_LTRL);
+        break;
+    case INT_LTRL:
+    case FLT_LTRL:
+        type = SCHEMA_NUMBER;
+        break;
+    case STRBODY:
+        if (!(text = schema_text(value, src, buf, &len)))
+            return 0;
+
+        type = SCHEMA_STRING;
+        hash = schema_hash(text, len);
+        break;
+    case NULL_LTRL:
+        break;
+    default:
+        return 0;
+    }
+
+    const SchemaConst *entry = self->consts + node->first_enum;
+    const SchemaConst *end = entry + node->enum_count;
+
+    for (; entry < end; entry++)
+    {
+        if (entry->type != type)
+            continue;
+
+        if (type == SCHEMA_STRING)
+        {
+            if (entry->hash == hash && entry->text_len == len && memcmp(entry->text, text, len) == 0)
+                return 1;
+        }
+        else if (type == SCHEMA_NULL || entry->number == number)
+            return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Checks one value, or the opener of one container, against a node.
+ *
+ * @return int SCHEMA_OK or a SchemaErr.
+ */
+static int schema_check_value(const JsonSchema *self, const SchemaNode *node, const Token *value, const char *src)
+{
+    unsigned int type = 0;
+    double number = 0.0;
+    int is_number = (value->type == INT_LTRL || value->type == FLT_LTRL);
+
+    switch (value->type)
+    {
+    case LCURLY:
+        type = SCHEMA_OBJECT;
+        break;
+    case LBRACKET:
+        type = SCHEMA_ARRAY;
+        break;
+    case STRBODY:
+        type = SCHEMA_STRING;
+        break;
+    case INT_LTRL:
+        type = SCHEMA_NUMBER | SCHEMA_INTEGER;
+        break;
+    case FLT_LTRL:
+        type = SCHEMA_NUMBER;
+        break;
+    case TRUE_LTRL:
+    case FALSE_LTRL:
+        type = SCHEMA_BOOLEAN;
+        break;
+    default:
+        type = SCHEMA_NULL;
+        break;
+    }
+
+    // numbers are only read when a check needs their value
+    if (is_number && ((node->checks & (SCHEMA_HAS_MINIMUM | SCHEMA_HAS_MAXIMUM | SCHEMA_HAS_ENUM)) || !(node->types & type))
+        && !schema_number(value, src, self->allocator, &number))
+        return SCHEMA_NO_MEMORY_ERR;
+
+    if (value->type == FLT_LTRL && !(node->types & type))
+    {
+        int whole = (number >= SCHEMA_EXACT_DOUBLE || number <= -SCHEMA_EXACT_DOUBLE || number == (double)(int64_t)number);
+
+        type |= whole ? SCHEMA_INTEGER : 0;
+    }
+
+    if (!(node->types & type))
+        return SCHEMA_TYPE_ERR;
+
+    if ((node->checks & SCHEMA_HAS_ENUM) && !schema_in_enum(self, node, value, src, number))
+        return SCHEMA_ENUM_ERR;
+
+    if (is_number)
+    {
+        if ((node->checks & SCHEMA_HAS_MINIMUM) && number < node->minimum)
+            return SCHEMA_MINIMUM_ERR;
+
+        if ((node->checks & SCHEMA_HAS_MAXIMUM) && number > node->maximum)
+            return SCHEMA_MAXIMUM_ERR;
+    }
+    else if (value->type == STRBODY && (node->checks & (SCHEMA_HAS_MIN_LENGTH | SCHEMA_HAS_MAX_LENGTH)))
+    {
+        size_t length = schema_length(value, src);
+
+        if ((node->checks & SCHEMA_HAS_MIN_LENGTH) && length < node->min_length)
+            return SCHEMA_MIN_LENGTH_ERR;
+
+        if ((node->checks & SCHEMA_HAS_MAX_LENGTH) && length > node->max_length)
+            return SCHEMA_MAX_LENGTH_ERR;
+    }
+
+    return SCHEMA_OK;
+}
+
+static const SchemaProp *schema_find_prop(const JsonSchema *self, const SchemaNode *node, const Token *key, const char *src)
+{
+    char buf[SCHEMA_DECODE_CAP];
+    size_t len = 0;
+    const char *text = schema_text(key, src, buf, &len);
+
+    if (!text)
+        return NULL;
+
+    uint64_t hash = schema_hash(text, len);
+    const SchemaProp *table = self->props + node->first_prop;
+    size_t mask = node->prop_slots - 1;
+
+    for (size_t slot = hash & mask; table[slot].key != NULL; slot = (slot + 1) & mask)
+    {
+        if (table[slot].hash == hash && table[slot].key_len == len && memcmp(table[slot].key, text, len) == 0)
+            return table + slot;
+    }
+
+    return NULL;
+}
+
+static const char *schema_missing(const JsonSchema *self, const SchemaNode *node, uint64_t seen)
+{
+    const SchemaProp *table = self->props + node->first_prop;
+
+    for (size_t slot = 0; slot < node->prop_slots; slot++)
+    {
+        if (table[slot].key != NULL && table[slot].required_bit != 0 && !(seen & table[slot].required_bit))
+            return table[slot].key;
+    }
+
+    return NULL;
+}
+
+static int schema_validate_fail(SchemaResult *result, SchemaErr err, ParserErr syntax_err, size_t offset)
+{
+    if (result != NULL)
+    {
+        result->err = err;
+        result->syntax_err = syntax_err;
+        result->offset = offset;
+    }
+
+    return err;
+}
+
+int JsonSchema_Validate(const JsonSchema *self, const char *src, size_t len, SchemaResult *result)
+{
+    // grammar state as in Parser_Validate, plus a frame per open container the schema describes
+    uint64_t nest_bits[DEFAULT_MAX_DEPTH / SCHEMA_BITS_PER_WORD];
+    SchemaFrame frames[SCHEMA_MAX_DEPTH + 1];
+    size_t frame_count = 0;
+    size_t loose_depth = 0; // depth of the outermost open container no node describes, 0 when there is none
+    size_t expect = 0;      // node of the next value, starting with the root
+    size_t depth = 0;
+    int in_obj = 0;
+    ParseState state = NEXT_ITEM;
+    Lexer lexer;
+
+    if (result != NULL)
+        result->missing = NULL;
+
+    Lexer_Init(&lexer, (char*)src, len, NULL);
+
+    while (1)
+    {
+        Token token = Lexer_Lex_Next(&lexer);
+        TokenType tok_type = token.type;
+        size_t offset = schema_token_offset(&token);
+
+        if (tok_type == FILE_END)
+        {
+            if (depth == 0 && state == SEPARATOR)
+                return schema_validate_fail(result, SCHEMA_OK, NO_ERR, len);
+
+            return schema_validate_fail(result, SCHEMA_SYNTAX_ERR, (depth == 0) ? EMPTY_TOKENS_ERR : UNBALANCED_NEST, len);
+        }
+
+        switch (state)
+        {
+        case FIRST_ITEM:
+        case NEXT_ITEM:
+        case PROP_VALUE:
+            if (tok_type == RBRACKET && state == FIRST_ITEM)
+                goto close_chunk;
+            else if (tok_type != LBRACKET && tok_type != LCURLY && tok_type != STRBODY && (tok_type < INT_LTRL || tok_type > FALSE_LTRL))
+                return schema_validate_fail(result, SCHEMA_SYNTAX_ERR, (tok_type == UNKNOWN) ? UNKNOWN_TOKEN_ERR : UNEXPECTED_TOKEN_ERR, offset);
+
+            if (loose_depth == 0)
+            {
+                // an Array item takes the node of its Array's items
+                if (state != PROP_VALUE && depth > 0)
+                {
+                    SchemaFrame *frame = frames + frame_count - 1;
+                    const SchemaNode *parent = self->nodes + frame->node;
+
+                    frame->count++;
+
+                    if ((parent->checks & SCHEMA_HAS_MAX_ITEMS) && frame->count > parent->max_items)
+                        return schema_validate_fail(result, SCHEMA_MAX_ITEMS_ERR, NO_ERR, offset);
+
+                    expect = parent->items;
+                }
+
+                if (expect != SCHEMA_NONE)
+                {
+                    int err = schema_check_value(self, self->nodes + expect, &token, src);
+
+                    if (err != SCHEMA_OK)
+                        return schema_validate_fail(result, err, NO_ERR, offset);
+                }
+            }
+
+            if (tok_type == LBRACKET || tok_type == LCURLY)
+            {
+                if (depth >= DEFAULT_MAX_DEPTH)
+                    return schema_validate_fail(result, SCHEMA_SYNTAX_ERR, DEPTH_LIMIT_ERR, offset);
+
+                uint64_t bit = (uint64_t)1 << (depth % SCHEMA_BITS_PER_WORD);
+                uint64_t *word = nest_bits + depth / SCHEMA_BITS_PER_WORD;
+
+                in_obj = (tok_type == LCURLY);
+                *word = in_obj ? (*word | bit) : (*word & ~bit);
+                depth++;
+                state = in_obj ? FIRST_KEY : FIRST_ITEM;
+
+                if (loose_depth == 0)
+                {
+                    const SchemaNode *node = (expect != SCHEMA_NONE) ? self->nodes + expect : NULL;
+                    int described = (node != NULL) && (in_obj ? node->prop_slots > 0 : (node->items != SCHEMA_NONE || (node->checks & (SCHEMA_HAS_MIN_ITEMS | SCHEMA_HAS_MAX_ITEMS))));
+
+                    // a container without a node only needs its grammar checked
+                    if (described)
+                    {
+                        frames[frame_count].node = expect;
+                        frames[frame_count].count = 0;
+                        frames[frame_count].seen = 0;
+                        frame_count++;
+                    }
+                    else
+                        loose_depth = depth;
+                }
+            }
+            else
+                state = SEPARATOR;
+            break;
+        case FIRST_KEY:
+        case NEXT_KEY:
+            if (tok_type == RCURLY && state == FIRST_KEY)
+                goto close_chunk;
+            else if (tok_type != STRBODY)
+                return schema_validate_fail(result, SCHEMA_SYNTAX_ERR, (tok_type == UNKNOWN) ? UNKNOWN_TOKEN_ERR : UNEXPECTED_TOKEN_ERR, offset);
+
+            if (loose_depth == 0)
+            {
+                SchemaFrame *frame = frames + frame_count - 1;
+                const SchemaProp *prop = schema_find_prop(self, self->nodes + frame->node, &token, src);
+
+                expect = (prop != NULL) ? prop->node : SCHEMA_NONE;
+                frame->seen |= (prop != NULL) ? prop->required_bit : 0;
+            }
+
+            state = PROP_COLON;
+            break;
+        case PROP_COLON:
+            if (tok_type != COLON)
+                return schema_validate_fail(result, SCHEMA_SYNTAX_ERR, UNEXPECTED_TOKEN_ERR, offset);
+
+            state = PROP_VALUE;
+            break;
+        case SEPARATOR:
+            if (depth == 0)
+                return schema_validate_fail(result, SCHEMA_SYNTAX_ERR, UNEXPECTED_TOKEN_ERR, offset); // trailing tokens after the root value
+            else if (tok_type == COMMA)
+                state = in_obj ? NEXT_KEY : NEXT_ITEM;
+            else if ((tok_type == RBRACKET && !in_obj) || (tok_type == RCURLY && in_obj))
+                goto close_chunk;
+            else if (tok_type == RBRACKET || tok_type == RCURLY)
+                return schema_validate_fail(result, SCHEMA_SYNTAX_ERR, UNBALANCED_NEST, offset);
+            else
+                return schema_validate_fail(result, SCHEMA_SYNTAX_ERR, (tok_type == UNKNOWN) ? UNKNOWN_TOKEN_ERR : UNEXPECTED_TOKEN_ERR, offset);
+            break;
+        default:
+            break;
+        }
+
+        continue;
+
+    close_chunk:
+        if (loose_depth == depth)
+            loose_depth = 0;
+        else if (loose_depth == 0)
+        {
+            const SchemaFrame *frame = frames + --frame_count;
+            const SchemaNode *node = self->nodes + frame->node;
+            uint64_t all_required = (node->required_count >= SCHEMA_MAX_REQUIRED) ? ~(uint64_t)0 : ((uint64_t)1 << node->required_count) - 1;
+
+            if (!in_obj && (node->checks & SCHEMA_HAS_MIN_ITEMS) && frame->count < node->min_items)
+                return schema_validate_fail(result, SCHEMA_MIN_ITEMS_ERR, NO_ERR, offset);
+
+            if (in_obj && frame->seen != all_required)
+            {
+                if (result != NULL)
+                    result->missing = schema_missing(self, node, frame->seen);
+
+                return schema_validate_fail(result, SCHEMA_REQUIRED_ERR, NO_ERR, offset);
+            }
+        }
+
+        depth--;
+        in_obj = (depth > 0) && ((nest_bits[(depth - 1) / SCHEMA_BITS_PER_WORD] >> ((depth - 1) % SCHEMA_BITS_PER_WORD)) & 1);
+        state = SEPARATOR;
+    }
+}
@@ -0,0 +1,77 @@
+/**
+ * @file json_stats.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Implements the parse instrumentation records and cycle timer.
+ * @date 2026-10-19
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "json_stats.h"
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static _Thread_local JsonStats *active_stats = NULL;
+
+void JsonStats_Clear(JsonStats *self)
+{
+    memset(self, 0, sizeof(JsonStats));
+}
+
+void JsonStats_Merge(JsonStats *self, const JsonStats *other)
+{
+    self->lex_cycles += other->lex_cycles;
+    self->parse_cycles += other->parse_cycles;
+    self->destroy_cycles += other->destroy_cycles;
+    self->token_count += other->token_count;
+    self->node_count += other->node_count;
+    self->alloc_count += other->alloc_count;
+    self->alloc_bytes += other->alloc_bytes;
+    self->probe_count += other->probe_count;
+    self->probe_total += other->probe_total;
+
+    if (other->max_depth > self->max_depth)
+        self->max_depth = other->max_depth;
+
+    if (other->probe_max > self->probe_max)
+        self->probe_max = other->probe_max;
+}
+
+void JsonStats_Print(const JsonStats *self, FILE *out)
+{
+    fprintf(out, "stats: lex=%llu parse=%llu destroy=%llu (cycles)\n",
+        (unsigned long long)self->lex_cycles, (unsigned long long)self->parse_cycles, (unsigned long long)self->destroy_cycles);
+    fprintf(out, "stats: tokens=%zu nodes=%zu allocs=%zu bytes=%zu depth=%zu\n",
+        self->token_count, self->node_count, self->alloc_count, self->alloc_bytes, self->max_depth);
+    fprintf(out, "stats: probes=%zu avg_len=%.2f max_len=%zu\n",
+        self->probe_count, (self->probe_count > 0) ? (double)self->probe_total / self->probe_count : 0.0, self->probe_max);
+}
+
+uint64_t json_cycles_now()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks = 0;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+#endif
+}
+
+JsonStats *JsonStats_Bind(JsonStats *target)
+{
+    JsonStats *previous = active_stats;
+    active_stats = target;
+
+    return previous;
+}
+
+JsonStats *JsonStats_Active() { return active_stats; }
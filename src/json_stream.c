@@ -0,0 +1,271 @@
+/**
+ * @file json_stream.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Implements the streaming top-level Array iterator.
+ * @date 2026-10-19
+ */
+
+#include "json_stream.h"
+
+#define STREAM_EOF (-1)
+
+/// Window Helpers:
+
+/**
+ * @brief Drops the bytes before keep_pos, then reads one more chunk after the kept ones. The window only grows when a single element outgrows it.
+ *
+ * @return size_t Bytes read, 0 at end of file, on a read error or when memory ran out.
+ */
+static size_t stream_fill(ArrayStream *self)
+{
+    if (self->keep_pos > 0)
+    {
+        memmove(self->buf, self->buf + self->keep_pos, self->buf_len - self->keep_pos);
+        self->buf_len -= self->keep_pos;
+        self->scan_pos -= self->keep_pos;
+        self->keep_pos = 0;
+    }
+
+    if (self->buf_cap - self->buf_len < self->chunk_size)
+    {
+        size_t new_cap = (self->buf_cap << 1 > self->buf_len + self->chunk_size) ? self->buf_cap << 1 : self->buf_len + self->chunk_size;
+        char *temp = json_realloc(self->allocator, self->buf, new_cap);
+
+        if (!temp)
+        {
+            self->err_code = OUT_OF_MEMORY_ERR;
+            return 0;
+        }
+
+        self->buf = temp;
+        self->buf_cap = new_cap;
+    }
+
+    size_t got = JsonInput_Read(&self->input, self->buf + self->buf_len, self->chunk_size);
+    self->buf_len += got;
+
+    if (JsonInput_Get_ErrCode(&self->input) != NO_ERR && self->err_code == NO_ERR)
+        self->err_code = INPUT_ERR;
+
+    return got;
+}
+
+/**
+ * @brief Skips whitespace, dropping it from the window, and peeks at the next byte.
+ *
+ * @return int The byte, or STREAM_EOF.
+ */
+static int stream_peek(ArrayStream *self)
+{
+    while (1)
+    {
+        if (self->scan_pos == self->buf_len)
+        {
+            self->keep_pos = self->scan_pos;
+
+            if (!stream_fill(self))
+                return STREAM_EOF;
+        }
+
+        char ch = self->buf[self->scan_pos];
+
+        if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r')
+            return (unsigned char)ch;
+
+        self->scan_pos++;
+    }
+}
+
+static const JsonThing *stream_fail(ArrayStream *self, ParserErr err)
+{
+    if (self->err_code == NO_ERR)
+        self->err_code = err;
+
+    return NULL;
+}
+
+/**
+ * @brief Scans from scan_pos to the ',' or ']' ending the current element, tracking nesting and strings so separators inside them are skipped. Grammar inside the element is left to the parser.
+ *
+ * @return int 1 if the element ended before the end of the file.
+ */
+static int stream_scan_element(ArrayStream *self)
+{
+    size_t depth = 0;
+    int in_string = 0;
+    int escaped = 0;
+
+    while (1)
+    {
+        if (self->scan_pos == self->buf_len && !stream_fill(self))
+            return 0;
+
+        char ch = self->buf[self->scan_pos];
+
+        if (in_string)
+        {
+            if (escaped)
+                escaped = 0;
+            else if (ch == '\\')
+                escaped = 1;
+            else if (ch == '\"')
+                in_string = 0;
+        }
+        else if (ch == '\"')
+            in_string = 1;
+        else if (ch == '[' || ch == '{')
+            depth++;
+        else if (ch == ']' || ch == '}')
+        {
+            if (depth == 0)
+                return 1;
+
+            depth--;
+        }
+        else if (ch == ',' && depth == 0)
+            return 1;
+
+        self->scan_pos++;
+    }
+}
+
+/// ArrayStream:
+
+ArrayStream *ArrayStream_Open(const char *path, size_t chunk_size, const JsonAllocator *allocator)
+{
+    FILE *file = fopen(path, "rb");
+
+    if (!file)
+        return NULL;
+
+    ArrayStream *result = ArrayStream_Create(file, chunk_size, allocator);
+
+    if (!result)
+    {
+        fclose(file);
+        return NULL;
+    }
+
+    result->input.owns_file = 1;
+
+    return result;
+}
+
+ArrayStream *ArrayStream_Create(FILE *file, size_t chunk_size, const JsonAllocator *allocator)
+{
+    ArrayStream *result = json_alloc(allocator, sizeof(ArrayStream));
+
+    if (!result)
+        return result;
+
+    result->chunk_size = (chunk_size > 0) ? chunk_size : STREAM_CHUNK_SIZE;
+    result->buf = NULL;
+    result->buf_len = 0;
+    result->buf_cap = 0;
+    result->keep_pos = 0;
+    result->scan_pos = 0;
+    result->state = STREAM_START;
+    result->err_code = NO_ERR;
+    result->index = 0;
+    result->allocator = allocator;
+    result->context = ParseContext_Create(0, allocator);
+
+    if (!result->context)
+    {
+        json_free(allocator, result);
+        return NULL;
+    }
+
+    if (!JsonInput_Init(&result->input, file, allocator))
+    {
+        ParseContext_Destroy(result->context);
+        json_free(allocator, result->context);
+        json_free(allocator, result);
+        return NULL;
+    }
+
+    return result;
+}
+
+void ArrayStream_Destroy(ArrayStream *self)
+{
+    ParseContext_Destroy(self->context);
+    json_free(self->allocator, self->context);
+    json_free(self->allocator, self->buf);
+    self->context = NULL;
+    self->buf = NULL;
+    JsonInput_Destroy(&self->input);
+}
+
+const JsonThing *ArrayStream_Next(ArrayStream *self)
+{
+    if (self->err_code != NO_ERR || self->state == STREAM_END)
+        return NULL;
+
+    int next = stream_peek(self);
+
+    switch (self->state)
+    {
+    case STREAM_START:
+        if (next != '[')
+            return stream_fail(self, (next == STREAM_EOF) ? EMPTY_TOKENS_ERR : UNEXPECTED_TOKEN_ERR);
+
+        self->scan_pos++;
+        self->state = STREAM_FIRST;
+        next = stream_peek(self);
+        break;
+    case STREAM_AFTER:
+        if (next != ',' && next != ']')
+            return stream_fail(self, (next == STREAM_EOF) ? UNBALANCED_NEST : UNEXPECTED_TOKEN_ERR);
+
+        self->scan_pos++;
+        self->state = (next == ',') ? STREAM_NEXT : STREAM_END;
+        next = stream_peek(self);
+        break;
+    default:
+        break;
+    }
+
+    if (self->state == STREAM_FIRST && next == ']')
+    {
+        self->scan_pos++;
+        self->state = STREAM_END;
+        next = stream_peek(self);
+    }
+
+    // only whitespace may follow the Array
+    if (self->state == STREAM_END)
+        return (next == STREAM_EOF) ? NULL : stream_fail(self, UNEXPECTED_TOKEN_ERR);
+
+    if (next == STREAM_EOF)
+        return stream_fail(self, UNBALANCED_NEST);
+
+    if (next == ',' || next == ']')
+        return stream_fail(self, UNEXPECTED_TOKEN_ERR); // missing element
+
+    self->keep_pos = self->scan_pos;
+
+    if (!stream_scan_element(self))
+        return stream_fail(self, UNBALANCED_NEST);
+
+    // the element is parsed in place, and the window may move once it is done
+    size_t elem_begin = self->keep_pos;
+    size_t elem_end = self->scan_pos;
+
+    while (elem_end > elem_begin && (self->buf[elem_end - 1] == ' ' || self->buf[elem_end - 1] == '\t'
+        || self->buf[elem_end - 1] == '\n' || self->buf[elem_end - 1] == '\r'))
+        elem_end--;
+
+    const JsonThing *result = ParseContext_Parse(self->context, self->buf + elem_begin, elem_end - elem_begin);
+
+    if (!result)
+        return stream_fail(self, ParseContext_Get_ErrCode(self->context));
+
+    self->keep_pos = self->scan_pos;
+    self->state = STREAM_AFTER;
+    self->index++;
+
+    return result;
+}
+
+int ArrayStream_Get_ErrCode(const ArrayStream *self) { return self->err_code; }
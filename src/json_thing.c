@@ -7,14 +7,38 @@
 
 #include "json_thing.h"
 
-JsonThing *JsonThing_Create(DataType root_type, Property *new_root)
+/// Helpers:
+
+/**
+ * @brief Gets the Array item named by a path segment of decimal digits.
+ */
+static ArrayItem *thing_array_at(const Array *array, const char *segment, size_t segment_len)
+{
+    size_t index = 0;
+
+    for (size_t i = 0; i < segment_len; i++)
+    {
+        if (segment[i] < '0' || segment[i] > '9')
+            return NULL;
+
+        index = index * 10 + (size_t)(segment[i] - '0');
+    }
+
+    return (ArrayItem*)Array_Get(array, index);
+}
+
+/// JsonThing:
+
+JsonThing *JsonThing_Create(DataType root_type, Property *new_root, const JsonAllocator *allocator)
 {
-    JsonThing *result = malloc(sizeof(JsonThing));
+    JsonThing *result = json_alloc(allocator, sizeof(JsonThing));
     
     if (!result)
         return result;
     
     result->root = new_root;
+    result->allocator = allocator;
+    JsonStats_Clear(&result->stats);
 
     return result;
 }
@@ -23,30 +47,114 @@ void JsonThing_Destroy(JsonThing *self)
 {
     if (!self->root)
         return;
-    
-    DataType root_type = self->root->type;
 
-    switch (root_type)
+    JSON_STATS_BIND(&self->stats);
+    JSON_TIMER_START(destroy_start);
+
+    // NOTE: Property_Destroy frees a root Array / Object along with its contents, and numeric roots own nothing.
+    Property_Destroy(self->root, self->allocator);
+    json_free(self->allocator, self->root);
+    self->root = NULL;
+
+    JSON_TIMER_STOP(destroy_start, &self->stats, destroy_cycles);
+    JSON_STATS_UNBIND();
+    JSON_PROBE(destroy_done);
+}
+
+JsonThing *JsonThing_Clone(const JsonThing *self)
+{
+    const Property *root = self->root;
+    Property *root_copy = NULL;
+
+    if (root != NULL)
+    {
+        root_copy = json_alloc(self->allocator, sizeof(Property));
+
+        if (!root_copy)
+            return NULL;
+
+        *root_copy = *root;
+
+        if (root->type == ARR || root->type == OBJ)
+            Chunk_Retain(root->data.chunk, root->type);
+        else if (root->type == STR && root->data.str != NULL)
+        {
+            size_t len = strlen(root->data.str);
+
+            root_copy->data.str = json_alloc(self->allocator, len + 1);
+
+            if (!root_copy->data.str)
+            {
+                json_free(self->allocator, root_copy);
+                return NULL;
+            }
+
+            memcpy(root_copy->data.str, root->data.str, len + 1);
+        }
+    }
+
+    JsonThing *result = JsonThing_Create((root != NULL) ? root->type : UNSUPPORTED, root_copy, self->allocator);
+
+    if (!result && root_copy != NULL)
     {
-    case ARR:
-        Array_Destroy((Array*)self->root->data.chunk);
-        break;
-    case OBJ:
-        Object_Destroy((Object*)self->root->data.chunk);
-        break;
-    case STR:
-        Property_Destroy(self->root);
-        break;
-    default:
-        // NOTE: numeric primitives are statically allocated, so no freeing here.
-        break;
+        Property_Destroy(root_copy, self->allocator);
+        json_free(self->allocator, root_copy);
     }
 
-    if (self->root != NULL)
+    return result;
+}
+
+void *JsonThing_Edit(JsonThing *self, const char *path, DataType *type_flag)
+{
+    *type_flag = UNSUPPORTED;
+
+    if (!self->root || (self->root->type != ARR && self->root->type != OBJ))
+        return NULL;
+
+    DataType type = self->root->type;
+    void **slot = &self->root->data.chunk;
+    const char *segment = (*path != '\0') ? path : NULL;
+
+    // copy on the way down, so every container above the target is private before the target is
+    while (1)
     {
-        free(self->root);
-        self->root = NULL;
+        if (!Chunk_Unshare(slot, type, self->allocator))
+            return NULL;
+
+        if (!segment)
+            break;
+
+        const char *dot = strchr(segment, '.');
+        size_t segment_len = (dot != NULL) ? (size_t)(dot - segment) : strlen(segment);
+
+        if (type == OBJ)
+        {
+            Property *member = (segment_len > 0) ? (Property*)Object_GetItemN((Object*)*slot, segment, segment_len) : NULL;
+
+            if (!member)
+                return NULL;
+
+            type = member->type;
+            slot = &member->data.chunk;
+        }
+        else
+        {
+            ArrayItem *item = (segment_len > 0) ? thing_array_at((Array*)*slot, segment, segment_len) : NULL;
+
+            if (!item)
+                return NULL;
+
+            type = item->type;
+            slot = &item->data.chunk;
+        }
+
+        if (type != ARR && type != OBJ)
+            return NULL;
+
+        segment = (dot != NULL) ? dot + 1 : NULL;
     }
 
-    puts("JsonThing_Destroy: Freed root."); // DEBUG
+    *type_flag = type;
+
+    return *slot;
 }
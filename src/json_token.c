@@ -6,129 +6,413 @@
  */
 
 #include "json_token.h"
+#include <string.h>
 
 /// Token:
 
-Token *Token_Create(TokenType _type, size_t _begin, size_t _span)
+Token Token_Create(TokenType _type, size_t _begin, size_t _span)
 {
-    Token *result = malloc(sizeof(Token));
+    Token result;
 
-    if (!result)
-        return result;
-    
-    result->type = _type;
-    result->begin = _begin;
-    result->span = _span;
+    result.type = _type;
+    result.flags = 0;
+    result.begin = _begin;
+    result.span = _span;
 
     return result;
 }
 
-char *Token_ToTxt(const Token *self, const char *src)
+static unsigned int token_hex4(const char *text)
 {
-    size_t buf_pos = 0;
-    size_t src_pos = self->begin;
-    size_t real_sz = self->span + 1; // include space for null terminator
+    unsigned int value = 0;
 
-    char *txt = malloc(sizeof(char) * real_sz);
+    for (int i = 0; i < 4; i++)
+    {
+        char c = text[i];
+        value = (value << 4) | (unsigned int)((c <= '9') ? c - '0' : (c | 0x20) - 'a' + 10);
+    }
 
-    if (!txt)
-        return txt;
+    return value;
+}
+
+static size_t token_put_utf8(char *out, unsigned int code)
+{
+    if (code < 0x80)
+    {
+        out[0] = (char)code;
+        return 1;
+    }
+
+    if (code < 0x800)
+    {
+        out[0] = (char)(0xc0 | (code >> 6));
+        out[1] = (char)(0x80 | (code & 0x3f));
+        return 2;
+    }
+
+    if (code < 0x10000)
+    {
+        out[0] = (char)(0xe0 | (code >> 12));
+        out[1] = (char)(0x80 | ((code >> 6) & 0x3f));
+        out[2] = (char)(0x80 | (code & 0x3f));
+        return 3;
+    }
 
-    for (size_t count = 0; count < real_sz - 1; count++)
+    out[0] = (char)(0xf0 | (code >> 18));
+    out[1] = (char)(0x80 | ((code >> 12) & 0x3f));
+    out[2] = (char)(0x80 | ((code >> 6) & 0x3f));
+    out[3] = (char)(0x80 | (code & 0x3f));
+    return 4;
+}
+
+/**
+ * @brief Decodes the one escape starting at the backslash text[*in_pos] and steps *in_pos past it. The lexer already checked every escape, but a lone surrogate still decodes to U+FFFD rather than invalid UTF-8.
+ *
+ * @return size_t Decoded length, at most 4.
+ */
+static size_t token_unescape_one(const char *text, size_t len, size_t *in_pos, char *out)
+{
+    char kind = text[*in_pos + 1];
+    *in_pos += 2;
+
+    switch (kind)
+    {
+    case 'b': out[0] = '\b'; return 1;
+    case 'f': out[0] = '\f'; return 1;
+    case 'n': out[0] = '\n'; return 1;
+    case 'r': out[0] = '\r'; return 1;
+    case 't': out[0] = '\t'; return 1;
+    case 'u':
     {
-        txt[buf_pos] = src[src_pos];
-        buf_pos++;
-        src_pos++;
+        unsigned int code = (*in_pos + 4 <= len) ? token_hex4(text + *in_pos) : 0xfffd;
+        *in_pos += 4;
+
+        if (code >= 0xd800 && code <= 0xdbff && *in_pos + 6 <= len && text[*in_pos] == '\\' && text[*in_pos + 1] == 'u')
+        {
+            unsigned int low = token_hex4(text + *in_pos + 2);
+
+            if (low >= 0xdc00 && low <= 0xdfff)
+            {
+                code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                *in_pos += 6;
+            }
+        }
+
+        if (code >= 0xd800 && code <= 0xdfff)
+            code = 0xfffd;
+
+        return token_put_utf8(out, code);
     }
+    default: // \" \\ and \/ stand for themselves
+        out[0] = kind;
+        return 1;
+    }
+}
 
-    txt[buf_pos] = '\0';
+/**
+ * @brief Decodes escaped string text. Runs between backslashes are found with memchr and copied whole, so only the escapes themselves are handled per char.
+ *
+ * @return size_t Decoded length.
+ */
+static size_t token_unescape(const char *text, size_t len, char *out)
+{
+    size_t in_pos = 0;
+    size_t out_pos = 0;
+
+    while (in_pos < len)
+    {
+        const char *slash = memchr(text + in_pos, '\\', len - in_pos);
+        size_t run = (slash != NULL) ? (size_t)(slash - text) - in_pos : len - in_pos;
+
+        memcpy(out + out_pos, text + in_pos, run);
+        in_pos += run;
+        out_pos += run;
+
+        if (in_pos + 1 >= len)
+            break;
+
+        out_pos += token_unescape_one(text, len, &in_pos, out + out_pos);
+    }
+
+    return out_pos;
+}
+
+char *Token_ToTxt(const Token *self, const char *src, const JsonAllocator *allocator)
+{
+    char *txt = json_alloc(allocator, sizeof(char) * (self->span + 1)); // include space for null terminator
+
+    if (!txt)
+        return txt;
+
+    // strings without escapes skip the decoder entirely
+    size_t txt_len = self->span;
+
+    if (self->flags & TOKEN_ESCAPED)
+        txt_len = token_unescape(src + self->begin, self->span, txt);
+    else
+        memcpy(txt, src + self->begin, self->span);
+
+    txt[txt_len] = '\0';
 
     return txt;
 }
 
-/// TokenVec:
+size_t Token_DecodeTxt(const Token *self, const char *src, char *out)
+{
+    if (self->flags & TOKEN_ESCAPED)
+        return token_unescape(src + self->begin, self->span, out);
+
+    memcpy(out, src + self->begin, self->span);
+
+    return self->span;
+}
 
-TokenVec *TokenVec_Create(size_t _capacity)
+int Token_MatchTxt(const Token *self, const char *src, const char *txt, size_t txt_len)
 {
-    TokenVec *result = malloc(sizeof(TokenVec));
+    const char *text = src + self->begin;
+    size_t len = self->span;
+    size_t in_pos = 0;
+    size_t out_pos = 0;
+    char decoded[4];
 
-    if (!result)
-        return result;
-    
-    result->capacity = _capacity;
-    result->count = 0;
-    result->data = malloc(sizeof(Token*) * _capacity);
+    if (!(self->flags & TOKEN_ESCAPED))
+        return len == txt_len && memcmp(text, txt, len) == 0;
 
-    if (!result->data)
+    // decode one escape at a time and stop at the first differing byte
+    while (in_pos < len)
     {
-        result->capacity = 0;
+        if (text[in_pos] != '\\')
+        {
+            if (out_pos >= txt_len || text[in_pos] != txt[out_pos])
+                return 0;
+
+            in_pos++;
+            out_pos++;
+            continue;
+        }
+
+        if (in_pos + 1 >= len)
+            break;
+
+        size_t decoded_len = token_unescape_one(text, len, &in_pos, decoded);
+
+        if (out_pos + decoded_len > txt_len || memcmp(decoded, txt + out_pos, decoded_len) != 0)
+            return 0;
+
+        out_pos += decoded_len;
     }
-    else
+
+    return out_pos == txt_len;
+}
+
+int Token_SameTxt(const Token *a, const Token *b, const char *src, const JsonAllocator *allocator)
+{
+    if (!((a->flags | b->flags) & TOKEN_ESCAPED))
+        return a->span == b->span && memcmp(src + a->begin, src + b->begin, a->span) == 0;
+
+    char *a_txt = Token_ToTxt(a, src, allocator);
+    char *b_txt = Token_ToTxt(b, src, allocator);
+    int same = a_txt != NULL && b_txt != NULL && strcmp(a_txt, b_txt) == 0;
+
+    json_free(allocator, a_txt);
+    json_free(allocator, b_txt);
+
+    return same;
+}
+
+size_t Token_CopyTxt(const Token *self, const char *src, char *buf, size_t buf_len)
+{
+    size_t copy_len = self->span;
+
+    if (buf_len == 0)
+        return 0;
+
+    if (copy_len > buf_len - 1)
+        copy_len = buf_len - 1;
+
+    memcpy(buf, src + self->begin, copy_len);
+    buf[copy_len] = '\0';
+
+    return copy_len;
+}
+
+int Token_ToNum(const Token *self, const char *src, const JsonAllocator *allocator, int *int_out, double *flt_out)
+{
+    char num_txt[MAX_NUM_TXT_LEN];
+    char *txt = num_txt;
+
+    // a literal too long for the scratch text is copied whole rather than cut short
+    if (self->span >= MAX_NUM_TXT_LEN)
     {
-        for (size_t i = 0; i < result->capacity; i++)
-            result->data[i] = NULL; // initialize empty token slots
+        txt = json_alloc(allocator, self->span + 1);
+
+        if (!txt)
+            return 0;
     }
 
+    Token_CopyTxt(self, src, txt, self->span + 1);
+
+    if (int_out != NULL)
+        *int_out = atoi(txt);
+
+    if (flt_out != NULL)
+        *flt_out = strtod(txt, NULL);
+
+    if (txt != num_txt)
+        json_free(allocator, txt);
+
+    return 1;
+}
+
+/// TokenVec:
+
+TokenVec *TokenVec_Create(size_t _capacity, const JsonAllocator *allocator)
+{
+    TokenVec *result = json_alloc(allocator, sizeof(TokenVec));
+
+    if (!result)
+        return result;
+
+    TokenVec_Init(result, _capacity, allocator);
+
     return result;
 }
 
+int TokenVec_Init(TokenVec *self, size_t _capacity, const JsonAllocator *allocator)
+{
+    if (_capacity < 1)
+        _capacity = 1;
+
+    self->allocator = allocator;
+    self->count = 0;
+    self->data = json_alloc(allocator, sizeof(Token) * _capacity);
+    self->capacity = (self->data != NULL) ? _capacity : 0;
+
+    return self->data != NULL;
+}
+
 void TokenVec_Destroy(TokenVec *self)
 {
     if (!self->data)
         return;
-    
-    // free all referenced tokens
-    for (size_t i = 0; i < self->capacity; i++)
-    {
-        if (!self->data[i])
-            continue;
-        
-        free(self->data[i]);
-    }
-    
-    // free emptied token buffer
-    free(self->data);
+
+    json_free(self->allocator, self->data);
     self->data = NULL;
+    self->count = 0;
     self->capacity = 0;
 }
 
-void TokenVec_Grow(TokenVec *self)
+int TokenVec_Grow(TokenVec *self)
 {
     if (!self->data)
-        return;
+        return 0;
 
     size_t new_capacity = self->capacity << 1;
-    size_t old_end_pos = self->capacity;
 
-    Token **temp = realloc(self->data, (sizeof(Token*) * new_capacity));
+    Token *temp = json_realloc(self->allocator, self->data, (sizeof(Token) * new_capacity));
 
     if (!temp)
-        return;
+        return 0;
 
     self->data = temp;
     self->capacity = new_capacity;
     // slot usage count is unchanged!
 
-    // initialize new empty slots after the older ones...
-    for (size_t i = old_end_pos; i < new_capacity; i++)
-        self->data[i] = NULL;
+    return 1;
 }
 
-void TokenVec_Set(TokenVec *self, size_t idx, Token *item)
+int TokenVec_Push(TokenVec *self, Token item)
 {
-    // only set an empty slot and update length if ok
-    if (!self->data[idx])
+    if (self->count == self->capacity && !TokenVec_Grow(self))
+        return 0;
+
+    self->data[self->count] = item;
+    self->count++;
+
+    return 1;
+}
+
+void TokenVec_Clear(TokenVec *self) { self->count = 0; }
+
+int TokenVec_Splice(TokenVec *self, size_t pos, size_t old_count, const Token *items, size_t new_count)
+{
+    size_t new_total = self->count - old_count + new_count;
+
+    while (new_total > self->capacity)
     {
-        self->data[idx] = item;
-        self->count++;
+        if (!TokenVec_Grow(self))
+            return 0;
+    }
+
+    if (new_count != old_count)
+        memmove(self->data + pos + new_count, self->data + pos + old_count, sizeof(Token) * (self->count - pos - old_count));
+
+    if (new_count > 0)
+        memcpy(self->data + pos, items, sizeof(Token) * new_count);
+
+    self->count = new_total;
+
+    return 1;
+}
+
+int TokenVec_Link(TokenVec *self, size_t opener)
+{
+    Token *tape = self->data;
+    size_t open = opener;
+
+    // the same intrusive stack as the lexer's: an open opener's skip links to the opener around it
+    tape[opener].skip = self->count;
+    tape[opener].flags = 0;
+
+    for (size_t idx = opener + 1; idx < self->count; idx++)
+    {
+        switch (tape[idx].type)
+        {
+        case LBRACKET:
+        case LCURLY:
+            tape[idx].skip = open;
+            tape[idx].flags = 0;
+            open = idx;
+            break;
+        case RBRACKET:
+        case RCURLY:
+        {
+            size_t outer = tape[open].skip;
+
+            tape[open].skip = idx - open;
+            tape[open].flags += (tape[open].skip > 1);
+
+            if (open == opener)
+                return 1;
+
+            tape[outer].flags |= tape[open].flags & TOKEN_HAS_UNKNOWN;
+            open = outer;
+            break;
+        }
+        case COMMA:
+            tape[open].flags++;
+            break;
+        case UNKNOWN:
+            tape[open].flags |= TOKEN_HAS_UNKNOWN;
+            break;
+        default:
+            break;
+        }
+    }
+
+    while (open != self->count)
+    {
+        size_t outer = tape[open].skip;
+
+        tape[open].skip = 0;
+        tape[open].flags = 0;
+        open = outer;
     }
 
-    // also reallocate this vector when old slots are full
-    if (self->count == self->capacity)
-        TokenVec_Grow(self);
+    return 0;
 }
 
 Token *TokenVec_At(TokenVec *self, size_t idx)
 {
-    return self->data[idx];
+    return self->data + idx;
 }
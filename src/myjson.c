@@ -5,9 +5,23 @@
  * @date 2023-03-25
  */
 
-#include "json_parser.h"
+#include "json_context.h"
+#include "gen_request.h"
+#include "json_incr.h"
+#include "json_stream.h"
+#include "json_push.h"
+#include "json_projection.h"
+#include "json_batch.h"
+#include "json_compact.h"
+#include "json_patch.h"
+#include "json_merkle.h"
+#include "json_frozen.h"
+#include "json_reload.h"
+#include "json_aggregate.h"
+#include "json_schema.h"
+#include <sched.h>
 
-#define TEST_COUNT 3
+#define TEST_COUNT 26
 
 // static const char TOKEN_TYPENAMES[13][8] = {
 //     "WTSPACE",
@@ -25,10 +39,33 @@
 //     "UNKNOWN"
 // };
 
-static const char TEST_FILES[TEST_COUNT][17] = {
+static const char TEST_FILES[TEST_COUNT][18] = {
     "tests/test1.json",
     "tests/test2.json",
-    "tests/test3.json"
+    "tests/test3.json",
+    "tests/test4.json",
+    "tests/test5.json",
+    "tests/test6.json",
+    "tests/test7.json",
+    "tests/test8.json",
+    "tests/test9.json",
+    "tests/test10.json",
+    "tests/test11.json",
+    "tests/test12.json",
+    "tests/test13.json",
+    "tests/test14.json",
+    "tests/test15.json",
+    "tests/test16.json",
+    "tests/test17.json",
+    "tests/test18.json",
+    "tests/test19.json",
+    "tests/test20.json",
+    "tests/test21.json",
+    "tests/test22.json",
+    "tests/test23.json",
+    "tests/test24.json",
+    "tests/test25.json",
+    "tests/test26.json"
 };
 
 // void Print_Token(size_t t_num, const Token *t)
@@ -66,6 +103,1447 @@ void Do_Test3(const JsonThing *json_ds)
     printf("json_ds[1][\"x\"] = %i\n", coord_x->data.i);
 }
 
+static size_t heap_alloc_count = 0;
+static size_t heap_alloc_bytes = 0;
+
+static void *counting_alloc(void *ctx, size_t size) { heap_alloc_count++; heap_alloc_bytes += size; return malloc(size); }
+static void *counting_realloc(void *ctx, void *ptr, size_t size) { heap_alloc_count++; heap_alloc_bytes += size; return realloc(ptr, size); }
+static void counting_free(void *ctx, void *ptr) { free(ptr); }
+static void *no_grow_realloc(void *ctx, void *ptr, size_t size) { return NULL; }
+
+static size_t fail_countdown = 0; // allocations until the one that fails, 0 to never fail
+static long live_allocs = 0;
+
+static void *failing_alloc(void *ctx, size_t size)
+{
+    if (fail_countdown > 0 && --fail_countdown == 0)
+        return NULL;
+
+    void *result = malloc(size);
+    live_allocs += (result != NULL);
+
+    return result;
+}
+
+static void *failing_realloc(void *ctx, void *ptr, size_t size)
+{
+    if (fail_countdown > 0 && --fail_countdown == 0)
+        return NULL;
+
+    void *result = realloc(ptr, size);
+    live_allocs += (result != NULL && ptr == NULL);
+
+    return result;
+}
+
+static void failing_free(void *ctx, void *ptr) { live_allocs -= (ptr != NULL); free(ptr); }
+
+void Do_Test4(const JsonThing *json_ds)
+{
+    const JsonAllocator counting = {counting_alloc, counting_realloc, counting_free, NULL};
+    size_t src_len = 0;
+    char *src = read_file(TEST_FILES[3], &src_len, NULL);
+    ParseContext *ctx = ParseContext_Create(0, &counting);
+
+    if (!src || !ctx)
+        return;
+
+    // warm up the tape and arena, then parse the same-sized document again
+    ParseContext_Parse(ctx, src, src_len);
+    size_t warm_count = heap_alloc_count;
+    const JsonThing *reparsed = NULL;
+
+    for (int round = 0; round < 1000; round++)
+        reparsed = ParseContext_Parse(ctx, src, src_len);
+
+    Array *arr = (Array*)reparsed->root->data.chunk;
+    Object *obj2 = (Object*)Array_Get(arr, 1)->data.chunk;
+
+    printf("json_ds[1][\"path\"] = \"%s\"\n", Property_AsStr(Object_GetItem(obj2, "path")));
+    printf("steady-state heap allocations (should be 0): %zu\n", heap_alloc_count - warm_count);
+
+    ParseContext_Destroy(ctx);
+    json_free(&counting, ctx);
+
+    // a tape that cannot grow is cut short, which must not pass for a shorter document
+    const JsonAllocator no_grow = {counting_alloc, no_grow_realloc, counting_free, NULL};
+    ParseContext *small_ctx = ParseContext_Create(0, &no_grow);
+
+    if (small_ctx != NULL)
+    {
+        const JsonThing *cut = ParseContext_Parse(small_ctx, src, src_len);
+
+        printf("tape could not grow: document %s, error code (should be %i): %i\n", (cut != NULL) ? "kept" : "dropped", OUT_OF_MEMORY_ERR, ParseContext_Get_ErrCode(small_ctx));
+        ParseContext_Destroy(small_ctx);
+        json_free(&no_grow, small_ctx);
+    }
+
+    // fail each allocation of a parse in turn, with the tape unindexed so every Object starts small and its table has to grow
+    const JsonAllocator failing = {failing_alloc, failing_realloc, failing_free, NULL};
+    Lexer lexer;
+    Parser parser;
+    size_t failures = 0;
+    size_t wrong = 0;
+    size_t leaked = 0;
+
+    Lexer_Init(&lexer, src, src_len, NULL);
+    TokenVec *tokens = Lexer_Lex_All(&lexer);
+
+    for (size_t idx = 0; tokens != NULL && idx < tokens->count; idx++)
+    {
+        if (tokens->data[idx].type == LBRACKET || tokens->data[idx].type == LCURLY)
+            tokens->data[idx].skip = 0;
+    }
+
+    Parser_Init(&parser, src, tokens, NULL);
+    JsonThing *whole = (tokens != NULL) ? Parser_Start_Parse(&parser) : NULL;
+    Parser_Destroy(&parser);
+
+    for (size_t nth = 1; whole != NULL; nth++)
+    {
+        fail_countdown = nth;
+        live_allocs = 0;
+        Parser_Init(&parser, src, tokens, &failing);
+
+        JsonThing *doc = Parser_Start_Parse(&parser);
+        int err = Parser_Get_ErrCode(&parser);
+        int failed = (fail_countdown == 0);
+
+        // a failure may be recovered from, but then nothing may be missing
+        wrong += (doc != NULL) ? !JsonThing_Same(doc, whole) : (err != OUT_OF_MEMORY_ERR);
+
+        if (doc != NULL)
+        {
+            JsonThing_Destroy(doc);
+            json_free(&failing, doc);
+        }
+
+        Parser_Destroy(&parser);
+
+        if (!failed)
+            break; // the whole parse took fewer allocations
+
+        failures++;
+        leaked += (live_allocs != 0);
+    }
+
+    fail_countdown = 0;
+    printf("failed allocations tried: %zu, wrong documents (should be 0): %zu, parses leaking (should be 0): %zu\n", failures, wrong, leaked);
+
+    if (whole != NULL)
+    {
+        JsonThing_Destroy(whole);
+        free(whole);
+    }
+
+    if (tokens != NULL)
+    {
+        TokenVec_Destroy(tokens);
+        free(tokens);
+    }
+
+    free(src);
+}
+
+void Do_Test5(const JsonThing *json_ds)
+{
+    size_t depth = 1;
+    const ArrayItem *item = Array_Get((Array*)json_ds->root->data.chunk, 0);
+
+    while (item != NULL && item->type == ARR)
+    {
+        item = Array_Get((Array*)item->data.chunk, 0);
+        depth++;
+    }
+
+    printf("nesting depth = %zu, innermost = %i\n", depth, (item != NULL) ? item->data.i : -1);
+
+    // the same document must fail cleanly under a tighter limit
+    size_t src_len = 0;
+    char *src = read_file(TEST_FILES[4], &src_len, NULL);
+    ParseContext *ctx = ParseContext_Create(0, NULL);
+
+    if (!src || !ctx)
+        return;
+
+    Parser_SetMaxDepth(&ctx->parser, 100);
+    const JsonThing *limited = ParseContext_Parse(ctx, src, src_len);
+
+    printf("max depth 100: result %s, error code (should be %i): %i\n", (limited != NULL) ? "non-NULL" : "NULL", DEPTH_LIMIT_ERR, ParseContext_Get_ErrCode(ctx));
+
+    ParseContext_Destroy(ctx);
+    free(ctx);
+    free(src);
+}
+
+void Do_Test6(const JsonThing *json_ds)
+{
+    DataType type = UNSUPPORTED;
+
+    Object *obj = (Object*)json_ds->root->data.chunk;
+    Array *flags = (Array*)Property_AsChunk(Object_GetItem(obj, "flags"), &type);
+
+    printf("active = %i, admin = %i, manager type (should be %i): %i\n", Property_AsBool(Object_GetItem(obj, "active")),
+        Property_AsBool(Object_GetItem(obj, "admin")), NUL, Object_GetItem(obj, "manager")->type);
+    printf("balance = %.1f, offset = %i\n", Property_AsFloat(Object_GetItem(obj, "balance")), Property_AsInt(Object_GetItem(obj, "offset")));
+    printf("precise (81 chars, should be 1.25) = %.2f\n", Property_AsFloat(Object_GetItem(obj, "precise")));
+    printf("flags = [%i, %i, type %i]\n", Array_Get(flags, 0)->data.i, Array_Get(flags, 1)->data.i, Array_Get(flags, 2)->type);
+}
+
+void Do_Test7(const JsonThing *json_ds)
+{
+    size_t src_len = 0;
+    char *src = read_file(TEST_FILES[6], &src_len, NULL);
+    TokenVec scratch;
+    Request request;
+
+    if (!src || !TokenVec_Init(&scratch, 64, NULL))
+        return;
+
+    // the generated parser must agree with the DOM, while skipping the unknown "trace" value
+    int err = Request_Parse_Text(&request, src, src_len, &scratch, NULL);
+    Object *obj = (Object*)json_ds->root->data.chunk;
+
+    printf("generated parse error code (should be 0): %i\n", err);
+    printf("request = {id: %i, user: \"%s\", path: \"%s\", ms: %.2f, cached: %i}, present = 0x%x\n",
+        request.id, request.user, request.path, request.ms, request.cached, request.present);
+    printf("matches DOM: %s\n", (request.id == Property_AsInt(Object_GetItem(obj, "id"))
+        && strcmp(request.path, Property_AsStr(Object_GetItem(obj, "path"))) == 0
+        && request.ms == Property_AsFloat(Object_GetItem(obj, "ms"))) ? "yes" : "no");
+
+    Request_Destroy(&request, NULL);
+    TokenVec_Destroy(&scratch);
+    free(src);
+}
+
+static void Print_Edit(const IncrDoc *doc, const char *label)
+{
+    printf("%s: error %i, relexed %zu, reparsed %zu, full reparse %i\n", label, IncrDoc_Get_ErrCode(doc), doc->relexed_count, doc->reparsed_count, doc->full_reparse);
+}
+
+void Do_Test8(const JsonThing *json_ds)
+{
+    size_t src_len = 0;
+    char *src = read_file(TEST_FILES[7], &src_len, NULL);
+    IncrDoc *doc = (src != NULL) ? IncrDoc_Create(src, src_len, NULL) : NULL;
+
+    if (!doc)
+    {
+        free(src);
+        return;
+    }
+
+    // a value edit rebuilds one node, an inserted item rebuilds its Array, and a broken document reparses fully
+    size_t rps_pos = strstr(doc->src, "100") - doc->src;
+    IncrDoc_Edit(doc, rps_pos, rps_pos + 3, "250", 3);
+    Print_Edit(doc, "value edit");
+
+    size_t hosts_pos = strstr(doc->src, "\"a2\"") - doc->src + 4;
+    IncrDoc_Edit(doc, hosts_pos, hosts_pos, ", \"a3\"", 6);
+    Print_Edit(doc, "array insert");
+
+    IncrDoc_Edit(doc, 0, 1, "", 0);
+    Print_Edit(doc, "broken root");
+
+    IncrDoc_Edit(doc, 0, 0, "{", 1);
+    Print_Edit(doc, "fixed root");
+
+    Object *root = (Object*)IncrDoc_Get(doc)->root->data.chunk;
+    Object *limits = (Object*)Object_GetItem(root, "limits")->data.chunk;
+    Array *hosts = (Array*)Object_GetItem(root, "hosts")->data.chunk;
+
+    printf("limits.rps (was %i) = %i, hosts[2] = \"%s\"\n", Property_AsInt(Object_GetItem((Object*)Object_GetItem((Object*)json_ds->root->data.chunk, "limits")->data.chunk, "rps")),
+        Property_AsInt(Object_GetItem(limits, "rps")), Array_Get(hosts, 2)->data.str);
+
+    IncrDoc_Destroy(doc);
+    free(doc);
+    free(src);
+}
+
+void Do_Test9(const JsonThing *json_ds)
+{
+    // a tiny chunk size forces elements to straddle refills
+    ArrayStream *stream = ArrayStream_Open(TEST_FILES[8], 8, NULL);
+    const JsonThing *element = NULL;
+    int id_sum = 0;
+
+    if (!stream)
+        return;
+
+    while ((element = ArrayStream_Next(stream)) != NULL)
+    {
+        if (element->root->type == OBJ)
+            id_sum += Property_AsInt(Object_GetItem((Object*)element->root->data.chunk, "id"));
+        else
+            id_sum += element->root->data.i;
+    }
+
+    printf("streamed %zu of %zu elements, error code (should be 0): %i\n", stream->index, Array_Length((Array*)json_ds->root->data.chunk), ArrayStream_Get_ErrCode(stream));
+    printf("id sum = %i, window capacity = %zu\n", id_sum, stream->buf_cap);
+
+    ArrayStream_Destroy(stream);
+    free(stream);
+}
+
+void Do_Test10(const JsonThing *json_ds)
+{
+    size_t src_len = 0;
+    char *src = read_file(TEST_FILES[9], &src_len, NULL);
+    PushParser *push = (src != NULL) ? PushParser_Create(NULL) : NULL;
+    PushStatus status = PUSH_NEED_MORE;
+    size_t feeds = 0;
+
+    if (!push)
+    {
+        free(src);
+        return;
+    }
+
+    // 3 byte slices split numbers, strings and literals across feeds
+    for (size_t pos = 0; pos < src_len && status == PUSH_NEED_MORE; pos += 3, feeds++)
+        status = PushParser_Feed(push, src + pos, (src_len - pos < 3) ? src_len - pos : 3);
+
+    status = PushParser_Finish(push);
+
+    JsonThing *doc = PushParser_Take(push);
+
+    printf("push status (should be %i) = %i after %zu feeds, error code (should be 0): %i, largest buffer = %zu\n", PUSH_DONE, status, feeds, PushParser_Get_ErrCode(push), push->buf_cap);
+
+    if (doc != NULL)
+    {
+        Object *obj = (Object*)doc->root->data.chunk;
+        Object *sensor = (Object*)Object_GetItem(obj, "sensor")->data.chunk;
+        Array *values = (Array*)Object_GetItem(obj, "values")->data.chunk;
+        Object *old_sensor = (Object*)Object_GetItem((Object*)json_ds->root->data.chunk, "sensor")->data.chunk;
+
+        printf("sensor = {id: %i, label: \"%s\"}, values[0] = %.3f, values[2] = %i, ok = %i\n", Property_AsInt(Object_GetItem(sensor, "id")),
+            Property_AsStr(Object_GetItem(sensor, "label")), Array_Get(values, 0)->data.f, Array_Get(values, 2)->data.i, Property_AsBool(Object_GetItem(obj, "ok")));
+        printf("matches DOM: %s\n", (Property_AsInt(Object_GetItem(sensor, "id")) == Property_AsInt(Object_GetItem(old_sensor, "id"))
+            && Array_Length(values) == 6) ? "yes" : "no");
+
+        JsonThing_Destroy(doc);
+        free(doc);
+    }
+
+    // a cut off document and trailing garbage both fail
+    PushParser_Reset(push);
+    PushParser_Feed(push, "[1, [2", 6);
+    printf("unfinished finish (should be %i) = %i\n", UNBALANCED_NEST, (PushParser_Finish(push), PushParser_Get_ErrCode(push)));
+
+    PushParser_Reset(push);
+    PushParser_Feed(push, "[1] ", 4);
+    printf("trailing feed (should be %i) = %i\n", PUSH_ERROR, PushParser_Feed(push, "2", 1));
+
+    PushParser_Destroy(push);
+    free(push);
+    free(src);
+}
+
+void Do_Test11(const JsonThing *json_ds)
+{
+#ifdef JSON_ZLIB
+    const int expected_err = NO_ERR;
+#else
+    const int expected_err = INPUT_ERR; // gzip is recognized but not built in
+#endif
+    // the same document compressed with gzip -9 must come out identical through every reader
+    JsonInput *input = JsonInput_Open("tests/test11.json.gz", NULL);
+    PushParser *push = PushParser_Create(NULL);
+
+    if (!input || !push)
+    {
+        free(input);
+        free(push);
+        return;
+    }
+
+    PushParser_Parse_Input(push, input);
+
+    JsonThing *doc = PushParser_Take(push);
+
+    printf("codec (should be %i) = %i, push error code (should be %i): %i, items = %zu of %zu\n", INPUT_GZIP, input->codec, expected_err,
+        PushParser_Get_ErrCode(push), (doc != NULL) ? Array_Length((Array*)doc->root->data.chunk) : 0, Array_Length((Array*)json_ds->root->data.chunk));
+
+    ArrayStream *stream = ArrayStream_Open("tests/test11.json.gz", 0, NULL);
+    int id_sum = 0;
+    const JsonThing *element = NULL;
+
+    while (stream != NULL && (element = ArrayStream_Next(stream)) != NULL)
+        id_sum += Property_AsInt(Object_GetItem((Object*)element->root->data.chunk, "id"));
+
+    printf("streamed id sum = %i, stream error code (should be %i): %i\n", id_sum, expected_err, (stream != NULL) ? ArrayStream_Get_ErrCode(stream) : -1);
+
+    size_t plain_len = 0, gz_len = 0;
+    char *plain = read_file(TEST_FILES[10], &plain_len, NULL);
+    char *unzipped = read_file("tests/test11.json.gz", &gz_len, NULL);
+
+    printf("read_file matches plain text: %s\n", (plain != NULL && unzipped != NULL && plain_len == gz_len && memcmp(plain, unzipped, gz_len) == 0) ? "yes" : "no");
+
+    if (doc != NULL)
+    {
+        JsonThing_Destroy(doc);
+        free(doc);
+    }
+
+    if (stream != NULL)
+    {
+        ArrayStream_Destroy(stream);
+        free(stream);
+    }
+
+    free(plain);
+    free(unzipped);
+    PushParser_Destroy(push);
+    free(push);
+    JsonInput_Destroy(input);
+    free(input);
+}
+
+void Do_Test12(const JsonThing *json_ds)
+{
+    Object *obj = (Object*)json_ds->root->data.chunk;
+    const char *raw = Property_AsStr(Object_GetItem(obj, "raw"));
+
+    printf("quote = [%s], path = [%s]\n", Property_AsStr(Object_GetItem(obj, "quote")), Property_AsStr(Object_GetItem(obj, "path")));
+    printf("greek = %s, raw = %s, emoji = %s, id = %i\n", Property_AsStr(Object_GetItem(obj, "greek")), raw,
+        Property_AsStr(Object_GetItem(obj, "emoji")), Property_AsInt(Object_GetItem(obj, "id")));
+    printf("decoded emoji matches raw UTF-8: %s\n", strcmp(Property_AsStr(Object_GetItem(obj, "emoji")), raw + strlen(raw) - 4) == 0 ? "yes" : "no");
+
+    // bad escapes, lone surrogates, broken UTF-8 and raw control chars are all rejected
+    static char bad_docs[][16] = {"[\"\\q\"]", "[\"\\ud83c\"]", "[\"\xc3\"]", "[\"\xed\xa0\x80\"]", "[\"tab\there\"]", "[\"\\u12\"]"};
+    ParseContext *context = ParseContext_Create(0, NULL);
+
+    if (!context)
+        return;
+
+    printf("bad string error codes (should be %i):", UNKNOWN_TOKEN_ERR);
+
+    for (size_t i = 0; i < sizeof(bad_docs) / sizeof(bad_docs[0]); i++)
+    {
+        ParseContext_Parse(context, bad_docs[i], strlen(bad_docs[i]));
+        printf(" %i", ParseContext_Get_ErrCode(context));
+    }
+
+    putchar('\n');
+    ParseContext_Destroy(context);
+    free(context);
+}
+
+void Do_Test13(const JsonThing *json_ds)
+{
+    size_t src_len = 0;
+    size_t err_offset = 0;
+    size_t line = 0;
+    size_t column = 0;
+    char *src = read_file(TEST_FILES[12], &src_len, NULL);
+
+    if (!src)
+        return;
+
+    printf("validate error code (should be 0): %i, keys in DOM: %zu\n", Parser_Validate(src, src_len, &err_offset), ((Object*)json_ds->root->data.chunk)->count);
+
+    // break the document in a few ways: each error is located only after validation has stopped
+    static const char *bad_docs[] = {"{\n  \"a\": [1, 2,]\n}", "{\n  \"a\": 1\n  \"b\": 2\n}", "[\n  {\"k\": \"\\x\"}\n]", "[[1, 2]", "[1, 2]]", "", "{\"port\": 08080}", "[0, -00]"};
+
+    for (size_t i = 0; i < sizeof(bad_docs) / sizeof(bad_docs[0]); i++)
+    {
+        int err = Parser_Validate(bad_docs[i], strlen(bad_docs[i]), &err_offset);
+
+        Parser_Locate(bad_docs[i], err_offset, &line, &column);
+        printf("bad doc %zu: error %i at byte %zu (line %zu, column %zu)\n", i + 1, err, err_offset, line, column);
+    }
+
+    free(src);
+}
+
+void Do_Test14(const JsonThing *json_ds)
+{
+    const JsonAllocator counting = {counting_alloc, counting_realloc, counting_free, NULL};
+    static const char *paths[] = {"id", "user.name", "tags.k", "user.name.first"};
+    size_t src_len = 0;
+    char *src = read_file(TEST_FILES[13], &src_len, NULL);
+    Projection *projection = Projection_Create(NULL);
+    Lexer lexer;
+    Parser parser;
+
+    if (!src || !projection)
+        return;
+
+    for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); i++)
+        Projection_Add(projection, paths[i]);
+
+    Lexer_Init(&lexer, src, src_len, NULL);
+    TokenVec *tokens = Lexer_Lex_All(&lexer);
+
+    // parse whole first so the parse stack is warm, then count only DOM allocations
+    Parser_Init(&parser, src, tokens, &counting);
+    JsonThing *full = Parser_Start_Parse(&parser);
+    size_t full_count = heap_alloc_count;
+
+    Parser_Rebind(&parser, src, tokens);
+    Parser_SetProjection(&parser, projection);
+    heap_alloc_count = 0;
+    JsonThing *projected = Parser_Start_Parse(&parser);
+    size_t projected_count = heap_alloc_count;
+
+    printf("projected error code (should be 0): %i\n", Parser_Get_ErrCode(&parser));
+
+    if (full != NULL && projected != NULL)
+    {
+        DataType type = UNSUPPORTED;
+        Array *records = (Array*)projected->root->data.chunk;
+        Object *last = (Object*)Array_Get(records, Array_Length(records) - 1)->data.chunk;
+        Object *user = (Object*)Property_AsChunk(Object_GetItem(last, "user"), &type);
+        Object *tag = (Object*)Array_Get((Array*)Property_AsChunk(Object_GetItem(last, "tags"), &type), 1)->data.chunk;
+
+        printf("records = %zu, keys in last (should be 3) = %zu, keys in its user (should be 1) = %zu\n", Array_Length(records), last->count, user->count);
+        printf("id = %i, user.name = %s, tags[1].k = %s, tags[1].v present: %s\n", Property_AsInt(Object_GetItem(last, "id")),
+            Property_AsStr(Object_GetItem(user, "name")), Property_AsStr(Object_GetItem(tag, "k")), Object_GetItem(tag, "v") ? "yes" : "no");
+        printf("allocations: whole document = %zu, projected = %zu\n", full_count, projected_count);
+    }
+
+    if (full != NULL)
+    {
+        JsonThing_Destroy(full);
+        json_free(&counting, full);
+    }
+
+    if (projected != NULL)
+    {
+        JsonThing_Destroy(projected);
+        json_free(&counting, projected);
+    }
+
+    // escaped keys are matched while decoding, so skipping them costs no more allocations than skipping plain ones
+    static char plain_doc[] = "{\"id\": 7, \"name\": \"x\", \"sku\": \"s\"}";
+    static char escaped_doc[] = "{\"\\u0069d\": 7, \"n\\u00e4me\": \"x\", \"sk\\u0075\": \"s\"}";
+    char *key_docs[] = {plain_doc, escaped_doc};
+    size_t key_counts[2] = {0, 0};
+    int key_ids[2] = {0, 0};
+
+    for (int i = 0; i < 2; i++)
+    {
+        Lexer key_lexer;
+
+        Lexer_Init(&key_lexer, key_docs[i], strlen(key_docs[i]), NULL);
+        TokenVec *key_tokens = Lexer_Lex_All(&key_lexer);
+
+        if (!key_tokens)
+            continue;
+
+        Parser_Rebind(&parser, key_docs[i], key_tokens);
+        heap_alloc_count = 0;
+        JsonThing *keyed = Parser_Start_Parse(&parser);
+        key_counts[i] = heap_alloc_count;
+
+        if (keyed != NULL)
+        {
+            key_ids[i] = Property_AsInt(Object_GetItem((Object*)keyed->root->data.chunk, "id"));
+            JsonThing_Destroy(keyed);
+            json_free(&counting, keyed);
+        }
+
+        TokenVec_Destroy(key_tokens);
+        free(key_tokens);
+    }
+
+    printf("escaped keys: id = %i (should be %i), allocations plain = %zu, escaped = %zu\n", key_ids[1], key_ids[0], key_counts[0], key_counts[1]);
+
+    Parser_Destroy(&parser);
+    TokenVec_Destroy(tokens);
+    free(tokens);
+    Projection_Destroy(projection);
+    free(projection);
+    free(src);
+}
+
+void Do_Test15(const JsonThing *json_ds)
+{
+    size_t src_len = 0;
+    char *src = read_file(TEST_FILES[14], &src_len, NULL);
+    Lexer lexer;
+
+    if (!src)
+        return;
+
+    Lexer_Init(&lexer, src, src_len, NULL);
+    TokenVec *tokens = Lexer_Lex_All(&lexer);
+    const Token *tape = tokens->data;
+
+    // visit the root's members by jumping over each value instead of walking it
+    printf("root: %u members, closer at token %zu of %zu\n", tape[0].flags & TOKEN_COUNT_MASK, tape[0].skip, tokens->count - 1);
+
+    for (size_t idx = 1; tape[idx].type == STRBODY; )
+    {
+        const Token *value = tape + idx + 2;
+        size_t value_end = idx + 2;
+
+        if (value->type == LBRACKET || value->type == LCURLY)
+        {
+            printf("  %.*s: %u elements, %zu tokens\n", (int)tape[idx].span, src + tape[idx].begin, value->flags & TOKEN_COUNT_MASK, value->skip + 1);
+            value_end += value->skip;
+        }
+
+        idx = value_end + 1 + (tape[value_end + 1].type == COMMA);
+    }
+
+    // Objects were sized from the index, so none had to grow while parsing
+    Object *root = (Object*)json_ds->root->data.chunk;
+    DataType type = UNSUPPORTED;
+    Array *events = (Array*)Property_AsChunk(Object_GetItem(root, "events"), &type);
+    Object *event = (Object*)Array_Get(events, 1)->data.chunk;
+
+    printf("root buckets = %zu for %zu members, event buckets = %zu for %zu members\n", root->bucket_count, root->count, event->bucket_count, event->count);
+
+    TokenVec_Destroy(tokens);
+    free(tokens);
+    free(src);
+}
+
+typedef struct batch_record
+{
+    int err_code;
+    DataType root_type;
+    size_t members;
+} BatchRecord;
+
+static void batch_record(void *user, size_t index, const char *path, const JsonThing *doc, int err_code)
+{
+    BatchRecord *record = (BatchRecord*)user + index;
+
+    // the document is only valid during the callback, so keep what is needed now
+    record->err_code = err_code;
+    record->root_type = (doc != NULL) ? doc->root->type : UNSUPPORTED;
+    record->members = 0;
+
+    if (doc != NULL && doc->root->type == OBJ)
+        record->members = Object_Count((Object*)doc->root->data.chunk);
+    else if (doc != NULL && doc->root->type == ARR)
+        record->members = Array_Length((Array*)doc->root->data.chunk);
+}
+
+void Do_Test18(const JsonThing *json_ds)
+{
+    Array *path_list = (Array*)json_ds->root->data.chunk;
+    const char *paths[16];
+    BatchRecord records[16];
+    size_t count = 0;
+
+    for (ArrayItem *item = path_list->head; item != NULL && count < 16; item = item->next)
+        paths[count++] = item->data.str;
+
+    // a queue depth of 4 keeps several reads in flight while earlier files parse
+    JsonBatch *batch = JsonBatch_Create(4, 0, NULL);
+
+    if (!batch)
+        return;
+
+    size_t parsed = JsonBatch_Run(batch, paths, count, batch_record, records);
+
+    printf("reads through io_uring: %s, parsed %zu of %zu files\n", JsonBatch_Uses_Uring(batch) ? "yes" : "no (blocking fallback)", parsed, count);
+
+    for (size_t i = 0; i < count; i++)
+        printf("  %-22s error %i, root type %i, %zu elements\n", paths[i], records[i].err_code, records[i].root_type, records[i].members);
+
+    JsonBatch_Destroy(batch);
+    free(batch);
+}
+
+/**
+ * @brief Checks a compact node against a DOM value, passed as the type and union fields of a Property or ArrayItem.
+ */
+static int compact_matches(const CompactDoc *doc, uint32_t node, DataType type, int i, float f, const char *str, void *chunk)
+{
+    size_t len = 0;
+
+    if (CompactDoc_Type(doc, node) != type)
+        return 0;
+
+    switch (type)
+    {
+    case INT:
+    case BOOL:
+        return CompactDoc_Int(doc, node) == i;
+    case FLT:
+        return CompactDoc_Float(doc, node) == f;
+    case STR:
+    {
+        const char *text = CompactDoc_Str(doc, node, &len);
+        return strlen(str) == len && memcmp(text, str, len) == 0;
+    }
+    case NUL:
+        return 1;
+    case ARR:
+    {
+        const ArrayItem *item = ((Array*)chunk)->head;
+        uint32_t elem = CompactDoc_First(doc, node);
+
+        if (CompactDoc_Count(doc, node) != Array_Length((Array*)chunk))
+            return 0;
+
+        for (; item != NULL; item = item->next, elem = CompactDoc_Next(doc, elem))
+        {
+            if (!compact_matches(doc, elem, item->type, item->data.i, item->data.f, item->data.str, item->data.chunk))
+                return 0;
+        }
+
+        return 1;
+    }
+    case OBJ:
+    {
+        uint32_t member = CompactDoc_First(doc, node);
+
+        // duplicate keys stay in the compact pool, so compare each name through the lookups, which both shadow them
+        for (uint32_t n = CompactDoc_Count(doc, node); n > 0; n--, member = CompactDoc_Next(doc, member))
+        {
+            const char *key = CompactDoc_Key(doc, member);
+            const Property *prop = Object_GetItem((Object*)chunk, key);
+
+            if (!prop || !compact_matches(doc, CompactDoc_Get(doc, node, key), prop->type, prop->data.i, prop->data.f, prop->data.str, prop->data.chunk))
+                return 0;
+        }
+
+        return 1;
+    }
+    default:
+        return 0;
+    }
+}
+
+void Do_Test19(const JsonThing *json_ds)
+{
+    const JsonAllocator counting = {counting_alloc, counting_realloc, counting_free, NULL};
+    size_t src_len = 0;
+    char *src = read_file(TEST_FILES[18], &src_len, NULL);
+    int err_code = NO_ERR;
+    Lexer lexer;
+    Parser parser;
+
+    if (!src)
+        return;
+
+    CompactDoc *doc = CompactDoc_Parse(src, src_len, &counting, &err_code);
+
+    printf("compact parse error code (should be 0): %i\n", err_code);
+
+    if (!doc)
+    {
+        free(src);
+        return;
+    }
+
+    // parse once so the parse stack is warm, then count only the DOM's bytes
+    Lexer_Init(&lexer, src, src_len, NULL);
+    TokenVec *tokens = Lexer_Lex_All(&lexer);
+    Parser_Init(&parser, src, tokens, &counting);
+    JsonThing *warm = Parser_Start_Parse(&parser);
+
+    JsonThing_Destroy(warm);
+    json_free(&counting, warm);
+    Parser_Rebind(&parser, src, tokens);
+    heap_alloc_bytes = 0;
+    JsonThing *dom = Parser_Start_Parse(&parser);
+    size_t dom_bytes = heap_alloc_bytes;
+
+    uint32_t last = CompactDoc_At(doc, COMPACT_ROOT, CompactDoc_Count(doc, COMPACT_ROOT) - 1);
+    uint32_t fourth = CompactDoc_At(doc, COMPACT_ROOT, 3);
+    size_t name_len = 0;
+    const char *name = CompactDoc_Str(doc, CompactDoc_Get(doc, fourth, "name"), &name_len);
+
+    printf("records = %u, nodes = %u, distinct keys = %u\n", CompactDoc_Count(doc, COMPACT_ROOT), doc->node_count, doc->key_count);
+    printf("records[3].name = %.*s, records[3].note.year = %i, records[5].id (later key wins) = %i\n", (int)name_len, name,
+        CompactDoc_Int(doc, CompactDoc_Get(doc, CompactDoc_Get(doc, fourth, "note"), "year")), CompactDoc_Int(doc, CompactDoc_Get(doc, last, "id")));
+    printf("missing key found: %s\n", (CompactDoc_Get(doc, last, "nope") == COMPACT_NONE) ? "no" : "yes");
+    printf("matches the DOM: %s\n", compact_matches(doc, COMPACT_ROOT, json_ds->root->type, 0, 0, NULL, json_ds->root->data.chunk) ? "yes" : "no");
+    printf("bytes: node = %zu, compact document = %zu, DOM = %zu\n", sizeof(CompactNode), CompactDoc_Bytes(doc), dom_bytes);
+
+    if (dom != NULL)
+    {
+        JsonThing_Destroy(dom);
+        json_free(&counting, dom);
+    }
+
+    CompactDoc_Destroy(doc);
+    json_free(&counting, doc);
+    Parser_Destroy(&parser);
+    TokenVec_Destroy(tokens);
+    free(tokens);
+    free(src);
+}
+
+static Property *Make_IntProp(const char *name, int value, const JsonAllocator *allocator)
+{
+    size_t name_len = strlen(name);
+    char *name_copy = json_alloc(allocator, name_len + 1);
+
+    memcpy(name_copy, name, name_len + 1);
+
+    return Property_Int(name_copy, value, allocator);
+}
+
+void Do_Test20(const JsonThing *json_ds)
+{
+    const JsonAllocator counting = {counting_alloc, counting_realloc, counting_free, NULL};
+    size_t src_len = 0;
+    char *src = read_file(TEST_FILES[19], &src_len, NULL);
+    JsonThing *variants[1000];
+    char path[16];
+    DataType type = UNSUPPORTED;
+    Lexer lexer;
+    Parser parser;
+
+    if (!src)
+        return;
+
+    Lexer_Init(&lexer, src, src_len, NULL);
+    TokenVec *tokens = Lexer_Lex_All(&lexer);
+    Parser_Init(&parser, src, tokens, &counting);
+    heap_alloc_count = 0;
+    JsonThing *base = Parser_Start_Parse(&parser);
+    size_t parse_count = heap_alloc_count;
+
+    if (!base)
+        return;
+
+    heap_alloc_count = 0;
+
+    for (int i = 0; i < 1000; i++)
+        variants[i] = JsonThing_Clone(base);
+
+    size_t clone_count = heap_alloc_count;
+
+    // each variant re-weights one route, copying the root, the route list and that route
+    heap_alloc_count = 0;
+
+    for (int i = 0; i < 1000; i++)
+    {
+        snprintf(path, sizeof(path), "routes.%i", i % 3);
+        Object_SetItem((Object*)JsonThing_Edit(variants[i], path, &type), "weight", Make_IntProp("weight", i, &counting));
+    }
+
+    size_t edit_count = heap_alloc_count;
+    Object *base_root = (Object*)base->root->data.chunk;
+    Object *variant_root = (Object*)variants[7]->root->data.chunk;
+    Array *base_routes = (Array*)Object_GetItem(base_root, "routes")->data.chunk;
+    Array *variant_routes = (Array*)Object_GetItem(variant_root, "routes")->data.chunk;
+
+    printf("allocations: parse = %zu, per clone = %zu, per path edit = %zu\n", parse_count, clone_count / 1000, edit_count / 1000);
+    printf("base routes[1].weight = %i, variant 7 routes[1].weight = %i\n", Property_AsInt(Object_GetItem((Object*)Array_Get(base_routes, 1)->data.chunk, "weight")),
+        Property_AsInt(Object_GetItem((Object*)Array_Get(variant_routes, 1)->data.chunk, "weight")));
+    printf("variant 7 shares: catalog = %s, routes[0] = %s, routes[1] = %s\n",
+        (Object_GetItem(base_root, "catalog")->data.chunk == Object_GetItem(variant_root, "catalog")->data.chunk) ? "yes" : "no",
+        (Array_Get(base_routes, 0)->data.chunk == Array_Get(variant_routes, 0)->data.chunk) ? "yes" : "no",
+        (Array_Get(base_routes, 1)->data.chunk == Array_Get(variant_routes, 1)->data.chunk) ? "yes" : "no");
+    printf("catalog references (should be 1001) = %zu\n", ((Array*)Object_GetItem(base_root, "catalog")->data.chunk)->refs);
+    printf("edit a number (should fail): %s, edit a missing key (should fail): %s\n", JsonThing_Edit(variants[0], "limits.cpu", &type) ? "ok" : "failed",
+        JsonThing_Edit(variants[0], "routes.9", &type) ? "ok" : "failed");
+
+    // the base can go first, as every variant holds its own references
+    JsonThing_Destroy(base);
+    json_free(&counting, base);
+
+    variant_root = (Object*)variants[999]->root->data.chunk;
+    printf("after destroying the base, variant 999 catalog length = %zu\n", Array_Length((Array*)Object_GetItem(variant_root, "catalog")->data.chunk));
+
+    for (int i = 0; i < 1000; i++)
+    {
+        JsonThing_Destroy(variants[i]);
+        json_free(&counting, variants[i]);
+    }
+
+    Parser_Destroy(&parser);
+    TokenVec_Destroy(tokens);
+    free(tokens);
+    free(src);
+}
+
+static const char *Item_Str(const Object *obj, const char *key)
+{
+    const Property *prop = Object_GetItem((Object*)obj, key);
+
+    return (prop != NULL && prop->type == STR) ? prop->data.str : "(none)";
+}
+
+void Do_Test21(const JsonThing *json_ds)
+{
+    char patch_text[] = "["
+        "{\"op\": \"test\", \"path\": \"/limits/cpu\", \"value\": 2.0},"
+        "{\"op\": \"replace\", \"path\": \"/limits/cpu\", \"value\": 4},"
+        "{\"op\": \"add\", \"path\": \"/tags/1\", \"value\": \"internal\"},"
+        "{\"op\": \"add\", \"path\": \"/tags/-\", \"value\": \"beta\"},"
+        "{\"op\": \"remove\", \"path\": \"/owner/m~0n\"},"
+        "{\"op\": \"move\", \"from\": \"/owner/a~1b\", \"path\": \"/limits/ab\"},"
+        "{\"op\": \"copy\", \"from\": \"/routes/0\", \"path\": \"/routes/-\"},"
+        "{\"op\": \"add\", \"path\": \"/routes/2/weight\", \"value\": {\"min\": 1, \"max\": [3, 4]}}"
+        "]";
+    char failing_text[] = "["
+        "{\"op\": \"replace\", \"path\": \"/name\", \"value\": \"renamed\"},"
+        "{\"op\": \"test\", \"path\": \"/name\", \"value\": \"gateway\"}"
+        "]";
+    char bad_move_text[] = "[{\"op\": \"move\", \"from\": \"/limits\", \"path\": \"/limits/inner\"}]";
+    char merge_text[] = "{\"limits\": {\"memory\": null, \"cpu\": 8, \"disk\": {\"size\": 10}}, \"owner\": \"nobody\", \"name\": null}";
+    ParseContext *ctx = ParseContext_Create(0, NULL);
+    size_t failed_op = 0;
+
+    if (!ctx)
+        return;
+
+    // patch a clone, so the original stays as it was and only the patched paths are copied
+    JsonThing *doc = JsonThing_Clone(json_ds);
+    const JsonThing *patch = ParseContext_Parse(ctx, patch_text, strlen(patch_text));
+    int err = JsonPatch_Apply(doc, patch, &failed_op);
+    Object *root = (Object*)doc->root->data.chunk;
+    Object *limits = (Object*)Object_GetItem(root, "limits")->data.chunk;
+    Array *tags = (Array*)Object_GetItem(root, "tags")->data.chunk;
+    Array *routes = (Array*)Object_GetItem(root, "routes")->data.chunk;
+    Object *copied = (Object*)Array_Get(routes, 2)->data.chunk;
+    Object *weight = (Object*)Object_GetItem(copied, "weight")->data.chunk;
+    Object *original_limits = (Object*)Object_GetItem((Object*)json_ds->root->data.chunk, "limits")->data.chunk;
+
+    printf("patch error code (should be 0): %i\n", err);
+    printf("tags:");
+    for (const ArrayItem *tag = tags->head; tag != NULL; tag = tag->next)
+        printf(" %s", tag->data.str);
+    printf("\n");
+    printf("limits.cpu = %i, limits.ab = %i, owner keys = %zu, original limits.cpu = %i\n", Property_AsInt(Object_GetItem(limits, "cpu")),
+        Property_AsInt(Object_GetItem(limits, "ab")), Object_Count((Object*)Object_GetItem(root, "owner")->data.chunk), Property_AsInt(Object_GetItem(original_limits, "cpu")));
+    printf("routes = %zu, routes[2].prefix = %s, routes[2].weight.max[1] = %i, routes[0].weight = %i\n", Array_Length(routes), Item_Str(copied, "prefix"),
+        Array_Get((Array*)Object_GetItem(weight, "max")->data.chunk, 1)->data.i, Property_AsInt(Object_GetItem((Object*)Array_Get(routes, 0)->data.chunk, "weight")));
+
+    // a failed test stops the patch, so apply it to a throwaway clone for all-or-nothing
+    JsonThing *trial = JsonThing_Clone(doc);
+    err = JsonPatch_Apply(trial, ParseContext_Parse(ctx, failing_text, strlen(failing_text)), &failed_op);
+    printf("failing patch: error %i at op %zu, kept name = %s\n", err, failed_op, Item_Str(root, "name"));
+    JsonThing_Destroy(trial);
+    free(trial);
+
+    err = JsonPatch_Apply(doc, ParseContext_Parse(ctx, bad_move_text, strlen(bad_move_text)), &failed_op);
+    printf("move into own child: error %i, limits still has %zu keys\n", err, Object_Count(limits));
+
+    err = JsonPatch_Merge(doc, ParseContext_Parse(ctx, merge_text, strlen(merge_text)));
+    limits = (Object*)Object_GetItem(root, "limits")->data.chunk;
+    printf("merge error code (should be 0): %i, limits.cpu = %i, limits.memory present: %s, limits.disk.size = %i, owner = %s, name present: %s\n", err,
+        Property_AsInt(Object_GetItem(limits, "cpu")), Object_GetItem(limits, "memory") ? "yes" : "no",
+        Property_AsInt(Object_GetItem((Object*)Object_GetItem(limits, "disk")->data.chunk, "size")), Item_Str(root, "owner"), Object_GetItem(root, "name") ? "yes" : "no");
+
+    JsonThing_Destroy(doc);
+    free(doc);
+    ParseContext_Destroy(ctx);
+    free(ctx);
+}
+
+static void Print_Diff(void *user, const char *pointer, DiffKind kind)
+{
+    static const char kind_names[3][8] = {"added", "removed", "changed"};
+
+    (void)user;
+    printf("  %s %s\n", kind_names[kind], pointer);
+}
+
+/**
+ * @brief Parses a libc-allocated source with the libc allocator, taking ownership of src.
+ */
+static JsonThing *Parse_Source(char *src, size_t src_len)
+{
+    Lexer lexer;
+    Parser parser;
+
+    if (!src)
+        return NULL;
+
+    Lexer_Init(&lexer, src, src_len, NULL);
+    TokenVec *tokens = Lexer_Lex_All(&lexer);
+    Parser_Init(&parser, src, tokens, NULL);
+    JsonThing *result = Parser_Start_Parse(&parser);
+
+    Parser_Destroy(&parser);
+    TokenVec_Destroy(tokens);
+    free(tokens);
+    free(src);
+
+    return result;
+}
+
+static JsonThing *Parse_Fixture(const char *path)
+{
+    size_t src_len = 0;
+    char *src = read_file(path, &src_len, NULL);
+
+    // read_file sets src_len, so it must run before src_len is passed on
+    return Parse_Source(src, src_len);
+}
+
+void Do_Test22(const JsonThing *json_ds)
+{
+    char reordered_text[] = "{\"routes\": ["
+        "{\"policy\": {\"codes\": [500, 502, 503], \"timeout\": 2.5, \"retries\": 3}, \"path\": \"/invoices\"},"
+        "{\"path\": \"/refunds\", \"policy\": {\"retries\": 3, \"codes\": [500, 502, 503], \"timeout\": 2.5}},"
+        "{\"path\": \"/health\", \"policy\": {\"timeout\": 2.5, \"codes\": [500, 502, 503], \"retries\": 1}}],"
+        "\"defaults\": {\"codes\": [500, 502, 503], \"retries\": 3, \"timeout\": 2.5}, \"service\": \"billing\"}";
+    char patch_text[] = "["
+        "{\"op\": \"replace\", \"path\": \"/routes/1/policy/retries\", \"value\": 5},"
+        "{\"op\": \"add\", \"path\": \"/routes/-\", \"value\": {\"path\": \"/audit\"}},"
+        "{\"op\": \"remove\", \"path\": \"/service\"}"
+        "]";
+    ParseContext *ctx = ParseContext_Create(0, NULL);
+    DataType type = UNSUPPORTED;
+
+    if (!ctx)
+        return;
+
+    JsonThing *doc = JsonThing_Clone(json_ds);
+    JsonThing *reordered = ParseContext_Parse(ctx, reordered_text, strlen(reordered_text));
+
+    printf("clone same as original: %s, reordered keys same: %s\n", (JsonThing_Hash(doc) == JsonThing_Hash(json_ds)) ? "yes" : "no",
+        JsonThing_Same(doc, reordered) ? "yes" : "no");
+
+    // the patch clears the cached hashes on its paths, so rehashing revisits only those
+    JsonThing *edited = JsonThing_Clone(doc);
+    int err = JsonPatch_Apply(edited, ParseContext_Parse(ctx, patch_text, strlen(patch_text)), NULL);
+
+    printf("patch error code (should be 0): %i, edited same: %s\n", err, JsonThing_Same(doc, edited) ? "yes" : "no");
+    printf("diff:\n");
+    printf("differences = %zu\n", JsonThing_Diff(doc, edited, Print_Diff, NULL));
+
+    // an incremental reparse clears the cached hashes from the rebuilt value up to the root
+    IncrDoc *incr = IncrDoc_Create(reordered_text, strlen(reordered_text), NULL);
+
+    if (incr != NULL)
+    {
+        char edited_text[sizeof(reordered_text)];
+        size_t at = strstr(reordered_text, "\"retries\": 1") - reordered_text + strlen("\"retries\": ");
+        uint64_t before = JsonThing_Hash(IncrDoc_Get(incr));
+        int incr_err = IncrDoc_Edit(incr, at, at + 1, "4", 1);
+
+        memcpy(edited_text, reordered_text, sizeof(reordered_text));
+        edited_text[at] = '4';
+
+        printf("incremental edit error code (should be 0): %i, hash changed: %s, same as a fresh parse: %s\n", incr_err,
+            (JsonThing_Hash(IncrDoc_Get(incr)) != before) ? "yes" : "no",
+            JsonThing_Same(IncrDoc_Get(incr), ParseContext_Parse(ctx, edited_text, strlen(edited_text))) ? "yes" : "no");
+
+        IncrDoc_Destroy(incr);
+        free(incr);
+    }
+
+    // two independent parses of the same file end up sharing every subtree
+    MerkleStore *store = MerkleStore_Create(NULL);
+    JsonThing *first = Parse_Fixture(TEST_FILES[21]);
+    JsonThing *second = Parse_Fixture(TEST_FILES[21]);
+
+    if (store != NULL && first != NULL && second != NULL)
+    {
+        size_t first_swaps = MerkleStore_Intern(store, first);
+        size_t second_swaps = MerkleStore_Intern(store, second);
+        Object *root = (Object*)first->root->data.chunk;
+        Array *routes = (Array*)Object_GetItem(root, "routes")->data.chunk;
+        Object *defaults = (Object*)Object_GetItem(root, "defaults")->data.chunk;
+
+        printf("swapped: first = %zu, second = %zu, stored subtrees = %zu, same root: %s\n", first_swaps, second_swaps, store->count,
+            (first->root->data.chunk == second->root->data.chunk) ? "yes" : "no");
+        printf("routes[1].policy is defaults: %s, routes[2].policy is defaults: %s\n",
+            (Object_GetItem((Object*)Array_Get(routes, 1)->data.chunk, "policy")->data.chunk == defaults) ? "yes" : "no",
+            (Object_GetItem((Object*)Array_Get(routes, 2)->data.chunk, "policy")->data.chunk == defaults) ? "yes" : "no");
+
+        // edits unshare from the store as from any other owner
+        Object_SetItem((Object*)JsonThing_Edit(second, "defaults", &type), "retries", Make_IntProp("retries", 9, NULL));
+        printf("after editing the second: first defaults.retries = %i, same: %s\n", Property_AsInt(Object_GetItem(defaults, "retries")),
+            JsonThing_Same(first, second) ? "yes" : "no");
+    }
+
+    if (second != NULL)
+    {
+        JsonThing_Destroy(second);
+        free(second);
+    }
+
+    if (first != NULL)
+    {
+        JsonThing_Destroy(first);
+        free(first);
+    }
+
+    if (store != NULL)
+    {
+        MerkleStore_Destroy(store);
+        free(store);
+    }
+
+    JsonThing_Destroy(edited);
+    free(edited);
+    JsonThing_Destroy(doc);
+    free(doc);
+    ParseContext_Destroy(ctx);
+    free(ctx);
+}
+
+typedef struct frozen_reader
+{
+    FrozenThing *frozen;
+    uint64_t hash;
+    long sum;
+    int freed;
+} FrozenReader;
+
+static void *Read_Frozen(void *arg)
+{
+    static const char keys[4][8] = {"cpu", "memory", "disk", "threads"};
+    FrozenReader *reader = (FrozenReader*)arg;
+    const Object *root = (const Object*)reader->frozen->doc->root->data.chunk;
+
+    for (int i = 0; i < 100000; i++)
+    {
+        const Object *limits = (const Object*)Object_GetItem(root, "limits")->data.chunk;
+
+        reader->sum += Property_AsInt(Object_GetItem(limits, keys[i % 4]));
+    }
+
+    reader->hash = JsonThing_Hash(reader->frozen->doc);
+    reader->freed = FrozenThing_Release(reader->frozen);
+
+    return NULL;
+}
+
+void Do_Test23(const JsonThing *json_ds)
+{
+    FrozenReader readers[4];
+    pthread_t threads[4];
+    int started = 0;
+    int freed = 0;
+
+    // the clone shares every container with json_ds, so freezing gives it private copies
+    JsonThing *doc = JsonThing_Clone(json_ds);
+    FrozenThing *frozen = (doc != NULL) ? JsonThing_Freeze(doc) : NULL;
+
+    if (!frozen)
+        return;
+
+    uint64_t hash = JsonThing_Hash(frozen->doc);
+
+    printf("frozen root shared with the original: %s, same content: %s\n", (frozen->doc->root->data.chunk == json_ds->root->data.chunk) ? "yes" : "no",
+        (hash == JsonThing_Hash(json_ds)) ? "yes" : "no");
+
+    for (; started < 4; started++)
+    {
+        readers[started].frozen = FrozenThing_Acquire(frozen);
+        readers[started].hash = 0;
+        readers[started].sum = 0;
+        readers[started].freed = 0;
+
+        if (pthread_create(&threads[started], NULL, Read_Frozen, &readers[started]) != 0)
+        {
+            FrozenThing_Release(frozen);
+            break;
+        }
+    }
+
+    // readers may outlive this reference, and whichever lets go last frees the document
+    freed += FrozenThing_Release(frozen);
+
+    for (int i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+        printf("reader %i: sum = %li, hash matches: %s\n", i, readers[i].sum, (readers[i].hash == hash) ? "yes" : "no");
+        freed += readers[i].freed;
+    }
+
+    printf("times freed (should be 1): %i\n", freed);
+}
+
+typedef struct reload_reader_args
+{
+    JsonReload *reload;
+    long reads;
+    long torn;      // documents whose fields disagree with each other
+    long unsealed;  // documents published before their hashes were filled in
+    int last_version;
+} ReloadReaderArgs;
+
+static void *Read_Reloaded(void *arg)
+{
+    ReloadReaderArgs *args = (ReloadReaderArgs*)arg;
+    ReloadReader reader;
+
+    JsonReload_AddReader(args->reload, &reader);
+
+    // each pass is one unit of work: read the current version, use it, then quiesce
+    while (args->last_version < 2)
+    {
+        const JsonThing *config = JsonReload_Get(args->reload);
+        const Object *root = (const Object*)config->root->data.chunk;
+        const Object *pool = (const Object*)Object_GetItem(root, "pool")->data.chunk;
+        int version = Property_AsInt(Object_GetItem(root, "version"));
+
+        if (version + Property_AsInt(Object_GetItem(pool, "max")) + Property_AsInt(Object_GetItem(pool, "min")) != Property_AsInt(Object_GetItem(root, "check")))
+            args->torn++;
+
+        // published documents are sealed, so hashing one only reads the caches
+        if (root->hash == 0 || JsonThing_Hash(config) != root->hash)
+            args->unsealed++;
+
+        args->last_version = version;
+        args->reads++;
+        JsonReload_Quiesce(args->reload, &reader);
+        sched_yield();
+    }
+
+    JsonReload_RemoveReader(args->reload, &reader);
+
+    return NULL;
+}
+
+void Do_Test24(const JsonThing *json_ds)
+{
+    char first_text[] = "{\"version\": 1, \"pool\": {\"min\": 2, \"max\": 8}, \"check\": 11}";
+    size_t first_len = strlen(first_text);
+    char *first_src = malloc(first_len + 1);
+    ReloadReaderArgs args[3];
+    pthread_t threads[3];
+    ReloadReader lagging;
+    int started = 0;
+
+    if (!first_src)
+        return;
+
+    memcpy(first_src, first_text, first_len + 1);
+
+    JsonThing *first = Parse_Source(first_src, first_len);
+    JsonReload *reload = (first != NULL) ? JsonReload_Create(first, NULL) : NULL;
+
+    if (!reload)
+    {
+        if (first != NULL)
+        {
+            JsonThing_Destroy(first);
+            free(first);
+        }
+
+        return;
+    }
+
+    // a reader that has not quiesced since the swap keeps the old version alive
+    JsonReload_AddReader(reload, &lagging);
+
+    for (; started < 3; started++)
+    {
+        args[started].reload = reload;
+        args[started].reads = 0;
+        args[started].torn = 0;
+        args[started].unsealed = 0;
+        args[started].last_version = 0;
+
+        if (pthread_create(&threads[started], NULL, Read_Reloaded, &args[started]) != 0)
+            break;
+    }
+
+    int load_ok = JsonReload_Load(reload, TEST_FILES[23]);
+    int err = JsonReload_Wait(reload);
+
+    printf("load started: %s, error code (should be 0): %i, version now = %i\n", load_ok ? "yes" : "no", err,
+        Property_AsInt(Object_GetItem((const Object*)JsonReload_Get(reload)->root->data.chunk, "version")));
+    printf("same as the fixture: %s\n", JsonThing_Same(JsonReload_Get(reload), json_ds) ? "yes" : "no");
+
+    for (int i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+        printf("reader %i: ended on version %i, torn reads = %li, unsealed reads = %li\n", i, args[i].last_version, args[i].torn, args[i].unsealed);
+    }
+
+    printf("waiting with a lagging reader (should be 1): %zu\n", JsonReload_Reclaim(reload));
+    JsonReload_Quiesce(reload, &lagging);
+    printf("waiting after it quiesces (should be 0): %zu\n", JsonReload_Reclaim(reload));
+    JsonReload_RemoveReader(reload, &lagging);
+
+    JsonReload_Destroy(reload);
+    free(reload);
+}
+
+static void Print_Aggregates(const Aggregator *agg, size_t spec_count)
+{
+    for (size_t group = 0; group < Aggregator_GroupCount(agg); group++)
+    {
+        const AggGroup *info = Aggregator_Group(agg, group);
+
+        printf("  %s%s:", (info->key_type == NUL) ? "(none)" : info->key, (info->key_type == INT) ? " (number)" : "");
+
+        for (size_t spec = 0; spec < spec_count; spec++)
+            printf(" %.2f", Aggregator_Result(agg, group, spec));
+
+        printf("\n");
+    }
+}
+
+static int Same_Aggregates(const Aggregator *a, const Aggregator *b, size_t spec_count)
+{
+    if (Aggregator_GroupCount(a) != Aggregator_GroupCount(b) || a->records != b->records || a->bad_records != b->bad_records)
+        return 0;
+
+    for (size_t group = 0; group < Aggregator_GroupCount(a); group++)
+    {
+        if (strcmp(Aggregator_Group(a, group)->key, Aggregator_Group(b, group)->key) != 0)
+            return 0;
+
+        for (size_t spec = 0; spec < spec_count; spec++)
+        {
+            double x = Aggregator_Result(a, group, spec);
+            double y = Aggregator_Result(b, group, spec);
+
+            if (x != y && !(x != x && y != y)) // NAN matches NAN
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+void Do_Test25(const JsonThing *json_ds)
+{
+    static const char func_names[5][8] = {"count", "sum", "min", "max", "mean"};
+    const Object *job = (const Object*)json_ds->root->data.chunk;
+    const Array *aggregates = (const Array*)Object_GetItem(job, "aggregates")->data.chunk;
+    AggSpec specs[8];
+    size_t spec_count = 0;
+
+    // the job itself is JSON: a group path and a list of path / function pairs
+    for (const ArrayItem *item = aggregates->head; item != NULL && spec_count < 8; item = item->next, spec_count++)
+    {
+        const Property *path = Object_GetItem((const Object*)item->data.chunk, "path");
+        const char *func = Object_GetItem((const Object*)item->data.chunk, "func")->data.str;
+
+        specs[spec_count].path = (path->type == STR) ? path->data.str : NULL;
+        specs[spec_count].func = AGG_COUNT;
+
+        for (int i = 0; i < 5; i++)
+        {
+            if (strcmp(func, func_names[i]) == 0)
+                specs[spec_count].func = (AggFunc)i;
+        }
+    }
+
+    const char *input = Object_GetItem(job, "input")->data.str;
+    const char *group_path = Object_GetItem(job, "group")->data.str;
+    Aggregator *single = Aggregator_Create(group_path, specs, spec_count, NULL);
+    Aggregator *parallel = Aggregator_Create(group_path, specs, spec_count, NULL);
+
+    if (single != NULL && parallel != NULL)
+    {
+        int err = Aggregator_RunFile(single, input, 1);
+        int parallel_err = Aggregator_RunFile(parallel, input, 4);
+
+        printf("error codes (should be 0): %i %i, records = %zu, bad records = %zu\n", err, parallel_err, single->records, single->bad_records);
+        printf("per group: count, sum, min, max, mean of latency.ms, errors\n");
+        Print_Aggregates(single, spec_count);
+        printf("4 threads match 1: %s\n", Same_Aggregates(single, parallel, spec_count) ? "yes" : "no");
+    }
+
+    // an 81 char literal equal to 1.25 is summed whole
+    char long_records[] = "{\"x\": 0.0000000000000000000000000000000000000000000000000000000000000000000000000125e74}\n{\"x\": 1}\n";
+    AggSpec sum_spec = {"x", AGG_SUM};
+    Aggregator *sums = Aggregator_Create(NULL, &sum_spec, 1, NULL);
+
+    if (sums != NULL)
+    {
+        int err = Aggregator_Feed(sums, long_records, strlen(long_records));
+
+        printf("long literal: error code (should be 0): %i, sum (should be 2.25) = %.2f\n", err, Aggregator_Result(sums, 0, 0));
+        Aggregator_Destroy(sums);
+        free(sums);
+    }
+
+    if (parallel != NULL)
+    {
+        Aggregator_Destroy(parallel);
+        free(parallel);
+    }
+
+    if (single != NULL)
+    {
+        Aggregator_Destroy(single);
+        free(single);
+    }
+}
+
+void Do_Test26(const JsonThing *json_ds)
+{
+    size_t src_len = 0;
+    size_t err_offset = 0;
+    size_t line = 0;
+    size_t column = 0;
+    char *src = read_file(TEST_FILES[25], &src_len, NULL);
+    JsonSchema *schema = (src != NULL) ? JsonSchema_Compile(src, src_len, NULL, &err_offset) : NULL;
+    SchemaResult result;
+
+    if (!schema)
+    {
+        printf("schema did not compile, error at byte %zu\n", err_offset);
+        free(src);
+        return;
+    }
+
+    printf("schema nodes: %zu, described members in DOM: %zu\n", schema->node_count, Object_Count((const Object*)Object_GetItem((const Object*)json_ds->root->data.chunk, "properties")->data.chunk));
+
+    // escaped names and strings, a surrogate pair counted as one code point, a whole float as an integer and undescribed members
+    static const char good_doc[] = "{\"\\u0073ervice\": \"caf\\u00e9-\\ud83d\\ude00-bar\", \"replicas\": 3e0, \"ratio\": 0.75, \"enabled\": true, \"owner\": null, \"tier\": \"back\\u0065nd\",\n"
+        " \"zones\": [\"us-east-1a\", \"eu-west-1c\"], \"limits\": {\"cpu\": \"500m\", \"ports\": [80, 443]}, \"tags\": [{\"k\": \"team\"}, [1, [2]]], \"extra\": {\"deep\": [1, {\"x\": 2}]}}";
+
+    printf("good doc: error %i\n", JsonSchema_Validate(schema, good_doc, strlen(good_doc), &result));
+
+    static const char *bad_docs[] = {
+        "{\"service\": \"inventory\",\n \"replicas\": 2.5, \"zones\": [\"us-east-1a\"]}",
+        "{\"service\": \"inventory\",\n \"replicas\": 12, \"zones\": [\"us-east-1a\"]}",
+        "{\"service\": \"inventory\",\n \"replicas\": 3, \"zones\": []}",
+        "{\"service\": \"inventory\",\n \"replicas\": 3, \"zones\": [\"a\", \"b\", \"c\", \"d\", \"e\"]}",
+        "{\"service\": \"inventory\",\n \"replicas\": 3, \"zones\": [\"us-east-1a\", \"us-east-1abc\"]}",
+        "{\"service\": \"inventory\",\n \"replicas\": 3}",
+        "{\"service\": \"inventory\",\n \"replicas\": 3, \"zones\": [\"us-east-1a\"], \"limits\": {\"ports\": [80]}}",
+        "{\"service\": \"inventory\",\n \"replicas\": 3, \"zones\": [\"us-east-1a\"], \"tier\": \"middle\"}",
+        "{\"service\": \"inventory\",\n \"replicas\": 3, \"zones\": [\"us-east-1a\"], \"limits\": {\"cpu\": \"1\", \"ports\": [80, 70000]}}",
+        "{\"service\": \"\",\n \"replicas\": 3, \"zones\": [\"us-east-1a\"]}",
+        "{\"service\": \"inventory\",\n \"replicas\": 3, \"zones\": [\"us-east-1a\",]}"
+    };
+
+    for (size_t i = 0; i < sizeof(bad_docs) / sizeof(bad_docs[0]); i++)
+    {
+        int err = JsonSchema_Validate(schema, bad_docs[i], strlen(bad_docs[i]), &result);
+
+        Parser_Locate(bad_docs[i], result.offset, &line, &column);
+        printf("bad doc %zu: error %i (syntax %i, Parser_Validate %i) at line %zu, column %zu%s%s\n", i + 1, err, result.syntax_err, Parser_Validate(bad_docs[i], strlen(bad_docs[i]), NULL), line, column, (result.missing != NULL) ? ", missing " : "", (result.missing != NULL) ? result.missing : "");
+    }
+
+    // an 81 char literal equal to 1.25 is read whole, both as a schema bound and as a value
+    static const char long_schema[] = "{\"items\": {\"minimum\": 1, \"maximum\": 0.0000000000000000000000000000000000000000000000000000000000000000000000000125e74}}";
+    static const char long_docs[2][96] = {"[0.0000000000000000000000000000000000000000000000000000000000000000000000000125e74]", "[0.0000000000000000000000000000000000000000000000000000000000000000000000000125e74, 1.5]"};
+    JsonSchema *bounds = JsonSchema_Compile(long_schema, strlen(long_schema), NULL, &err_offset);
+
+    if (bounds != NULL)
+    {
+        printf("long literals: maximum = %.2f, errors (should be 0 and 5): %i and %i\n", bounds->nodes[1].maximum,
+            JsonSchema_Validate(bounds, long_docs[0], strlen(long_docs[0]), NULL), JsonSchema_Validate(bounds, long_docs[1], strlen(long_docs[1]), NULL));
+        JsonSchema_Destroy(bounds);
+        free(bounds);
+    }
+
+    // keywords outside the subset are refused rather than ignored
+    static const char *unsupported[] = {"{\"type\": \"string\", \"pattern\": \"^a\"}", "{\"items\": [{\"type\": \"string\"}]}", "{\"enum\": [[1]]}"};
+
+    for (size_t i = 0; i < sizeof(unsupported) / sizeof(unsupported[0]); i++)
+    {
+        JsonSchema *refused = JsonSchema_Compile(unsupported[i], strlen(unsupported[i]), NULL, &err_offset);
+
+        printf("unsupported schema %zu: %s at byte %zu\n", i + 1, (refused != NULL) ? "compiled" : "refused", err_offset);
+
+        if (refused != NULL)
+        {
+            JsonSchema_Destroy(refused);
+            free(refused);
+        }
+    }
+
+    JsonSchema_Destroy(schema);
+    free(schema);
+    free(src);
+}
+
 int main(int argc, char *argv[])
 {
     if (argc != 2)
@@ -82,7 +1560,15 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    Lexer *lexer_ref = Lexer_Create(TEST_FILES[test_index]);
+    // the C++ tests have their own drivers
+    if (test_index == 15 || test_index == 16)
+    {
+        printf("Test %i runs in %s (make cpp).\n", test_index + 1, (test_index == 15) ? "./bin/myjson_cpp" : "./bin/myjson_static");
+        return 0;
+    }
+
+    const JsonAllocator *allocator = JsonAllocator_Default();
+    Lexer *lexer_ref = Lexer_Create(TEST_FILES[test_index], allocator);
 
     if (!lexer_ref)
     {
@@ -93,13 +1579,18 @@ int main(int argc, char *argv[])
     TokenVec *tokens = Lexer_Lex_All(lexer_ref);
     char *old_buf_ref = Lexer_CleanUp(lexer_ref);
 
-    Parser *parser_ref = Parser_Create(old_buf_ref, tokens);
+    Parser *parser_ref = Parser_Create(old_buf_ref, tokens, allocator);
 
     JsonThing *json_result = Parser_Start_Parse(parser_ref); 
 
     printf("parser exit code (should be 0): %i\n", Parser_Get_ErrCode(parser_ref));
     Parser_Reset(parser_ref);
 
+#ifdef JSON_STATS
+    if (json_result != NULL)
+        JsonStats_Merge(&json_result->stats, &lexer_ref->stats); // fold the lex phase into the document's record
+#endif
+
     puts("Testing object property:");
     if (json_result != NULL)
     {
@@ -114,6 +1605,69 @@ int main(int argc, char *argv[])
         case 2:
             Do_Test3(json_result);
             break;
+        case 3:
+            Do_Test4(json_result);
+            break;
+        case 4:
+            Do_Test5(json_result);
+            break;
+        case 5:
+            Do_Test6(json_result);
+            break;
+        case 6:
+            Do_Test7(json_result);
+            break;
+        case 7:
+            Do_Test8(json_result);
+            break;
+        case 8:
+            Do_Test9(json_result);
+            break;
+        case 9:
+            Do_Test10(json_result);
+            break;
+        case 10:
+            Do_Test11(json_result);
+            break;
+        case 11:
+            Do_Test12(json_result);
+            break;
+        case 12:
+            Do_Test13(json_result);
+            break;
+        case 13:
+            Do_Test14(json_result);
+            break;
+        case 14:
+            Do_Test15(json_result);
+            break;
+        case 17:
+            Do_Test18(json_result);
+            break;
+        case 18:
+            Do_Test19(json_result);
+            break;
+        case 19:
+            Do_Test20(json_result);
+            break;
+        case 20:
+            Do_Test21(json_result);
+            break;
+        case 21:
+            Do_Test22(json_result);
+            break;
+        case 22:
+            Do_Test23(json_result);
+            break;
+        case 23:
+            Do_Test24(json_result);
+            break;
+        case 24:
+            Do_Test25(json_result);
+            break;
+        case 25:
+            Do_Test26(json_result);
+            break;
         default:
             break;
         }
@@ -121,33 +1675,37 @@ int main(int argc, char *argv[])
 
     if (old_buf_ref != NULL)
     {
-        free(old_buf_ref);
+        json_free(allocator, old_buf_ref);
         old_buf_ref = NULL;
     }
 
     if (tokens != NULL)
     {
         TokenVec_Destroy(tokens);
-        free(tokens);
+        json_free(allocator, tokens);
         tokens = NULL;
     }
 
     if (lexer_ref != NULL)
     {
-        free(lexer_ref);
+        json_free(allocator, lexer_ref);
         lexer_ref = NULL;
     }
 
     if (parser_ref != NULL)
     {
-        free(parser_ref);
+        Parser_Destroy(parser_ref);
+        json_free(allocator, parser_ref);
         parser_ref = NULL;
     }
 
     if (json_result != NULL)
     {
         JsonThing_Destroy(json_result);
-        free(json_result);
+#ifdef JSON_STATS
+        JsonStats_Print(&json_result->stats, stdout);
+#endif
+        json_free(allocator, json_result);
         json_result = NULL;
     }
 
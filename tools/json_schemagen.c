@@ -0,0 +1,463 @@
+/**
+ * @file json_schemagen.c
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Generates a specialized parser for one fixed-shape JSON message. The schema is itself JSON:
+ *     {"name": "Request", "fields": [{"name": "id", "type": "int"}, ...]}
+ * with field types "int", "float", "bool" or "string". The emitted parser matches keys by a switch on key length and first char plus one memcmp, then writes values straight into the fields of a C struct without building DOM nodes.
+ * @note Usage: ./bin/json_schemagen <schema.json> <out.h> <out.c>
+ * @date 2026-10-19
+ */
+
+#include "json_parser.h"
+#include <ctype.h>
+#include <string.h>
+
+/// Limits:
+
+#define MAX_SCHEMA_FIELDS 32 // one presence bit per field
+#define MAX_IDENT_LEN 64
+
+/// Schema:
+
+typedef enum schema_field_type {
+    FIELD_INT,
+    FIELD_FLOAT,
+    FIELD_BOOL,
+    FIELD_STRING
+} FieldType;
+
+typedef struct schema_field
+{
+    char name[MAX_IDENT_LEN];
+    size_t name_len;
+    FieldType type;
+} SchemaField;
+
+typedef struct message_schema
+{
+    char name[MAX_IDENT_LEN];  // struct type and function prefix, e.g. Request
+    char lower[MAX_IDENT_LEN]; // static helper prefix, e.g. request
+    char upper[MAX_IDENT_LEN]; // macro prefix, e.g. REQUEST
+    SchemaField fields[MAX_SCHEMA_FIELDS];
+    size_t field_count;
+} MessageSchema;
+
+static const char *FIELD_C_TYPES[] = {"int", "float", "int", "char *"};
+static const char *FIELD_READERS[] = {"JsonGen_Int(&self->%s, src, value)", "JsonGen_Float(&self->%s, src, value, allocator)", "JsonGen_Bool(&self->%s, value)", "JsonGen_String(&self->%s, src, value, allocator)"};
+
+/// Helpers:
+
+static int is_identifier(const char *txt)
+{
+    size_t len = strlen(txt);
+
+    if (len == 0 || len >= MAX_IDENT_LEN || isdigit((unsigned char)txt[0]))
+        return 0;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (!isalnum((unsigned char)txt[i]) && txt[i] != '_')
+            return 0;
+    }
+
+    return 1;
+}
+
+static int read_field_type(const char *txt, FieldType *out)
+{
+    static const char *names[] = {"int", "float", "bool", "string"};
+
+    for (int i = 0; i <= FIELD_STRING; i++)
+    {
+        if (strcmp(txt, names[i]) == 0)
+        {
+            *out = (FieldType)i;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static const char *string_of(Object *obj, const char *key)
+{
+    const Property *prop = Object_GetItem(obj, key);
+
+    return (prop != NULL && prop->type == STR) ? Property_AsStr(prop) : NULL;
+}
+
+static const char *file_name_of(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+
+    return (slash != NULL) ? slash + 1 : path;
+}
+
+/**
+ * @brief Fills a schema from a parsed schema document, printing the first problem found.
+ *
+ * @param schema
+ * @param doc
+ * @return int 1 on success
+ */
+static int load_schema(MessageSchema *schema, const JsonThing *doc)
+{
+    if (doc->root == NULL || doc->root->type != OBJ)
+    {
+        fprintf(stderr, "schema: root must be an Object\n");
+        return 0;
+    }
+
+    Object *root = (Object*)doc->root->data.chunk;
+    const char *name = string_of(root, "name");
+    const Property *fields_prop = Object_GetItem(root, "fields");
+
+    if (name == NULL || !is_identifier(name))
+    {
+        fprintf(stderr, "schema: \"name\" must be a C identifier\n");
+        return 0;
+    }
+
+    if (fields_prop == NULL || fields_prop->type != ARR)
+    {
+        fprintf(stderr, "schema: \"fields\" must be an Array\n");
+        return 0;
+    }
+
+    strcpy(schema->name, name);
+
+    for (size_t i = 0; name[i] != '\0'; i++)
+    {
+        schema->lower[i] = tolower((unsigned char)name[i]);
+        schema->upper[i] = toupper((unsigned char)name[i]);
+    }
+
+    schema->lower[strlen(name)] = '\0';
+    schema->upper[strlen(name)] = '\0';
+
+    Array *fields = (Array*)fields_prop->data.chunk;
+    schema->field_count = Array_Length(fields);
+
+    if (schema->field_count == 0 || schema->field_count > MAX_SCHEMA_FIELDS)
+    {
+        fprintf(stderr, "schema: expected 1 to %i fields\n", MAX_SCHEMA_FIELDS);
+        return 0;
+    }
+
+    for (size_t i = 0; i < schema->field_count; i++)
+    {
+        const ArrayItem *item = Array_Get(fields, i);
+        Object *field = (item->type == OBJ) ? (Object*)item->data.chunk : NULL;
+        const char *field_name = (field != NULL) ? string_of(field, "name") : NULL;
+        const char *field_type = (field != NULL) ? string_of(field, "type") : NULL;
+
+        if (field_name == NULL || !is_identifier(field_name))
+        {
+            fprintf(stderr, "schema: field %zu needs a C identifier \"name\"\n", i);
+            return 0;
+        }
+
+        if (field_type == NULL || !read_field_type(field_type, &schema->fields[i].type))
+        {
+            fprintf(stderr, "schema: field \"%s\" needs a \"type\" of int, float, bool or string\n", field_name);
+            return 0;
+        }
+
+        for (size_t prev = 0; prev < i; prev++)
+        {
+            if (strcmp(schema->fields[prev].name, field_name) == 0)
+            {
+                fprintf(stderr, "schema: field \"%s\" is declared twice\n", field_name);
+                return 0;
+            }
+        }
+
+        strcpy(schema->fields[i].name, field_name);
+        schema->fields[i].name_len = strlen(field_name);
+    }
+
+    return 1;
+}
+
+/// Emitters:
+
+static void emit_header(FILE *out, const MessageSchema *schema, const char *schema_path, const char *header_name)
+{
+    fprintf(out, "#ifndef GEN_%s_H\n#define GEN_%s_H\n\n", schema->upper, schema->upper);
+    fprintf(out, "/**\n * @file %s\n * @brief Generated by tools/json_schemagen.c from %s. Do not edit.\n */\n\n", header_name, schema_path);
+    fprintf(out, "#include \"json_gen.h\"\n\n/// Presence Bits:\n\n");
+
+    for (size_t i = 0; i < schema->field_count; i++)
+    {
+        char field_upper[MAX_IDENT_LEN];
+
+        for (size_t c = 0; c <= schema->fields[i].name_len; c++)
+            field_upper[c] = toupper((unsigned char)schema->fields[i].name[c]);
+
+        fprintf(out, "#define %s_HAS_%s (1u << %zu)\n", schema->upper, field_upper, i);
+    }
+
+    fprintf(out, "\ntypedef struct gen_%s\n{\n", schema->lower);
+
+    for (size_t i = 0; i < schema->field_count; i++)
+    {
+        const char *c_type = FIELD_C_TYPES[schema->fields[i].type];
+        const char *gap = (schema->fields[i].type == FIELD_STRING) ? "" : " ";
+
+        fprintf(out, "    %s%s%s;\n", c_type, gap, schema->fields[i].name);
+    }
+
+    fprintf(out, "    unsigned int present; // %s_HAS_... bits of the fields seen with non-null values\n} %s;\n\n", schema->upper, schema->name);
+
+    fprintf(out, "/**\n * @brief Parses one %s Object starting at tokens[*pos]. Unknown keys are skipped and duplicate keys replace earlier values.\n *\n", schema->name);
+    fprintf(out, " * @param self Cleared first, then filled. On error it is left destroyed.\n * @param src\n * @param tokens\n");
+    fprintf(out, " * @param pos Index of the opening '{', advanced past the closing '}' on success.\n * @param allocator Allocates the string fields (NULL for libc).\n * @return int ParserErr\n */\n");
+    fprintf(out, "int %s_Parse(%s *self, const char *src, const TokenVec *tokens, size_t *pos, const JsonAllocator *allocator);\n\n", schema->name, schema->name);
+
+    fprintf(out, "/**\n * @brief Lexes a whole document into a scratch tape and parses it as one %s.\n *\n", schema->name);
+    fprintf(out, " * @param self\n * @param src\n * @param len\n * @param scratch Token tape reused between documents.\n * @param allocator\n * @return int ParserErr\n */\n");
+    fprintf(out, "int %s_Parse_Text(%s *self, char *src, size_t len, TokenVec *scratch, const JsonAllocator *allocator);\n", schema->name, schema->name);
+    fprintf(out, "void %s_Destroy(%s *self, const JsonAllocator *allocator);\n\n#endif\n", schema->name, schema->name);
+}
+
+static void emit_key_matcher(FILE *out, const MessageSchema *schema)
+{
+    size_t max_len = 0;
+
+    for (size_t i = 0; i < schema->field_count; i++)
+    {
+        if (schema->fields[i].name_len > max_len)
+            max_len = schema->fields[i].name_len;
+    }
+
+    fprintf(out, "static int %s_match_key(const char *key, size_t len)\n{\n    switch (len)\n    {\n", schema->lower);
+
+    // group by length, then by first char, so most keys cost two jumps and one short memcmp
+    for (size_t len = 1; len <= max_len; len++)
+    {
+        int len_used = 0;
+        int chars_done[256] = {0};
+
+        for (size_t i = 0; i < schema->field_count; i++)
+        {
+            const SchemaField *field = &schema->fields[i];
+            unsigned char first = (unsigned char)field->name[0];
+
+            if (field->name_len != len || chars_done[first])
+                continue;
+
+            if (!len_used)
+                fprintf(out, "    case %zu:\n        switch (key[0])\n        {\n", len);
+
+            len_used = 1;
+            chars_done[first] = 1;
+            fprintf(out, "        case '%c':\n", first);
+
+            for (size_t j = i; j < schema->field_count; j++)
+            {
+                const SchemaField *other = &schema->fields[j];
+
+                if (other->name_len != len || (unsigned char)other->name[0] != first)
+                    continue;
+
+                if (len == 1)
+                    fprintf(out, "            return %zu;\n", j);
+                else
+                    fprintf(out, "            if (memcmp(key + 1, \"%s\", %zu) == 0)\n                return %zu;\n", other->name + 1, len - 1, j);
+            }
+
+            if (len > 1)
+                fprintf(out, "            break;\n");
+        }
+
+        if (len_used)
+            fprintf(out, "        default:\n            break;\n        }\n        break;\n");
+    }
+
+    fprintf(out, "    default:\n        break;\n    }\n\n    return -1;\n}\n\n");
+}
+
+static void emit_source(FILE *out, const MessageSchema *schema, const char *schema_path, const char *header_name, const char *source_name)
+{
+    const char *name = schema->name;
+    const char *lower = schema->lower;
+
+    fprintf(out, "/**\n * @file %s\n * @brief Generated by tools/json_schemagen.c from %s. Do not edit.\n */\n\n", source_name, schema_path);
+    fprintf(out, "#include \"%s\"\n\n", header_name);
+
+    emit_key_matcher(out, schema);
+
+    fprintf(out, "static int %s_set_field(%s *self, int field, const char *src, const Token *value, const JsonAllocator *allocator)\n{\n", lower, name);
+    fprintf(out, "    int err = NO_ERR;\n\n    switch (field)\n    {\n");
+
+    for (size_t i = 0; i < schema->field_count; i++)
+    {
+        fprintf(out, "    case %zu:\n        err = ", i);
+        fprintf(out, FIELD_READERS[schema->fields[i].type], schema->fields[i].name);
+        fprintf(out, ";\n        break;\n");
+    }
+
+    fprintf(out, "    default:\n        break;\n    }\n\n");
+    fprintf(out, "    if (value->type == NULL_LTRL)\n        self->present &= ~(1u << field);\n    else\n        self->present |= 1u << field;\n\n    return err;\n}\n\n");
+
+    fprintf(out, "int %s_Parse(%s *self, const char *src, const TokenVec *tokens, size_t *pos, const JsonAllocator *allocator)\n{\n", name, name);
+    fprintf(out,
+        "    const Token *tape = tokens->data;\n"
+        "    size_t idx = *pos;\n"
+        "    size_t end = tokens->count;\n"
+        "    int err = NO_ERR;\n\n"
+        "    memset(self, 0, sizeof(%s));\n\n"
+        "    if (idx >= end || tape[idx].type != LCURLY)\n"
+        "        return UNEXPECTED_TOKEN_ERR;\n\n"
+        "    idx++;\n\n"
+        "    if (idx < end && tape[idx].type == RCURLY)\n"
+        "    {\n"
+        "        *pos = idx + 1;\n"
+        "        return NO_ERR;\n"
+        "    }\n\n"
+        "    while (1)\n"
+        "    {\n"
+        "        // a member needs at least key, colon and one value token\n"
+        "        if (end - idx < 3)\n"
+        "        {\n"
+        "            err = UNBALANCED_NEST;\n"
+        "            break;\n"
+        "        }\n\n"
+        "        if (tape[idx].type != STRBODY || tape[idx + 1].type != COLON)\n"
+        "        {\n"
+        "            err = UNEXPECTED_TOKEN_ERR;\n"
+        "            break;\n"
+        "        }\n\n"
+        "        // escaped keys are rare, so only they pay for decoding\n"
+        "        int field = (tape[idx].flags & TOKEN_ESCAPED) ? JsonGen_Match_Escaped(src, tape + idx, %s_match_key, allocator)\n"
+        "            : %s_match_key(src + tape[idx].begin, tape[idx].span);\n"
+        "        idx += 2;\n\n"
+        "        if (field < 0)\n"
+        "            err = JsonGen_Skip(tokens, &idx);\n"
+        "        else\n"
+        "        {\n"
+        "            err = %s_set_field(self, field, src, tape + idx, allocator);\n"
+        "            idx++;\n"
+        "        }\n\n"
+        "        if (err != NO_ERR)\n"
+        "            break;\n\n"
+        "        if (idx >= end)\n"
+        "        {\n"
+        "            err = UNBALANCED_NEST;\n"
+        "            break;\n"
+        "        }\n\n"
+        "        if (tape[idx].type == RCURLY)\n"
+        "        {\n"
+        "            idx++;\n"
+        "            break;\n"
+        "        }\n\n"
+        "        if (tape[idx].type != COMMA)\n"
+        "        {\n"
+        "            err = UNEXPECTED_TOKEN_ERR;\n"
+        "            break;\n"
+        "        }\n\n"
+        "        idx++;\n"
+        "    }\n\n"
+        "    if (err != NO_ERR)\n"
+        "    {\n"
+        "        %s_Destroy(self, allocator);\n"
+        "        return err;\n"
+        "    }\n\n"
+        "    *pos = idx;\n\n"
+        "    return NO_ERR;\n"
+        "}\n\n", name, lower, lower, lower, name);
+
+    fprintf(out, "int %s_Parse_Text(%s *self, char *src, size_t len, TokenVec *scratch, const JsonAllocator *allocator)\n{\n", name, name);
+    fprintf(out,
+        "    size_t pos = 0;\n"
+        "    int err = JsonGen_Lex(scratch, src, len);\n\n"
+        "    memset(self, 0, sizeof(%s));\n\n"
+        "    if (err == NO_ERR)\n"
+        "        err = %s_Parse(self, src, scratch, &pos, allocator);\n\n"
+        "    // trailing tokens after the message\n"
+        "    if (err == NO_ERR && pos != scratch->count)\n"
+        "    {\n"
+        "        %s_Destroy(self, allocator);\n"
+        "        err = UNEXPECTED_TOKEN_ERR;\n"
+        "    }\n\n"
+        "    return err;\n"
+        "}\n\n", name, name, name);
+
+    fprintf(out, "void %s_Destroy(%s *self, const JsonAllocator *allocator)\n{\n", name, name);
+
+    for (size_t i = 0; i < schema->field_count; i++)
+    {
+        if (schema->fields[i].type == FIELD_STRING)
+            fprintf(out, "    json_free(allocator, self->%s);\n", schema->fields[i].name);
+    }
+
+    fprintf(out, "    memset(self, 0, sizeof(%s));\n}\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 4)
+    {
+        printf("usage: ./json_schemagen <schema.json> <out.h> <out.c>\n");
+        return 1;
+    }
+
+    size_t src_len = 0;
+    char *src = read_file(argv[1], &src_len, NULL);
+
+    if (!src)
+    {
+        fprintf(stderr, "schema: cannot read %s\n", argv[1]);
+        return 1;
+    }
+
+    TokenVec tokens;
+    Lexer lexer;
+    Parser parser;
+    MessageSchema schema;
+    int status = 1;
+
+    TokenVec_Init(&tokens, 64, NULL);
+    Lexer_Init(&lexer, src, src_len, NULL);
+    Lexer_Lex_Into(&lexer, &tokens);
+    Parser_Init(&parser, src, &tokens, NULL);
+
+    JsonThing *doc = lexer.out_of_memory ? NULL : Parser_Start_Parse(&parser);
+
+    if (lexer.out_of_memory)
+        fprintf(stderr, "schema: out of memory while lexing %s\n", argv[1]);
+    else if (!doc)
+        fprintf(stderr, "schema: %s is not valid JSON (parser error %i)\n", argv[1], Parser_Get_ErrCode(&parser));
+    else if (load_schema(&schema, doc))
+    {
+        FILE *header_out = fopen(argv[2], "w");
+        FILE *source_out = fopen(argv[3], "w");
+
+        if (header_out != NULL && source_out != NULL)
+        {
+            emit_header(header_out, &schema, argv[1], file_name_of(argv[2]));
+            emit_source(source_out, &schema, argv[1], file_name_of(argv[2]), file_name_of(argv[3]));
+            status = 0;
+        }
+        else
+            fprintf(stderr, "schema: cannot open the output files\n");
+
+        if (header_out != NULL)
+            fclose(header_out);
+
+        if (source_out != NULL)
+            fclose(source_out);
+    }
+
+    if (doc != NULL)
+    {
+        JsonThing_Destroy(doc);
+        json_free(NULL, doc);
+    }
+
+    Parser_Destroy(&parser);
+    TokenVec_Destroy(&tokens);
+    json_free(NULL, src);
+
+    return status;
+}
@@ -0,0 +1,71 @@
+/**
+ * @file myjson_cpp.cpp
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Test driver for the C++ wrapper in json.hpp (Test 16).
+ * @date 2026-10-19
+ */
+
+#include <cstdio>
+#include <string_view>
+#include <utility>
+#include "json.hpp"
+
+static const char *TEST_FILE = "tests/test16.json";
+
+int main()
+{
+    myjson::Document doc = myjson::Document::parse_file(TEST_FILE);
+
+    std::printf("parser exit code (should be 0): %i\n", doc.error());
+
+    if (!doc)
+        return 1;
+
+    // typed reads check the type, unchecked ones are direct loads
+    std::string_view service = doc["service"].get<std::string_view>().value_or("?");
+    int replicas = doc["replicas"].as<int>();
+    double ratio = doc["ratio"].get<double>().value_or(0.0);
+
+    std::printf("service = %.*s, replicas = %i, ratio = %.2f, enabled = %i, owner is null: %s\n",
+        static_cast<int>(service.size()), service.data(), replicas, ratio,
+        doc["enabled"].as<bool>(), doc["owner"].is<std::nullptr_t>() ? "yes" : "no");
+
+    // a type mismatch or missing key is an empty result, never a bad cast
+    std::printf("replicas as string: %s, missing key: %s, lookup through a missing key: %s\n",
+        doc["replicas"].get<std::string_view>() ? "yes" : "no",
+        doc["nope"] ? "found" : "missing",
+        doc["nope"]["deeper"][0] ? "found" : "missing");
+
+    int limit_sum = 0;
+
+    for (auto [key, value] : doc["limits"].as<myjson::ObjectView>())
+    {
+        if (value.is<int>() && (key == "cpu" || key == "mem"))
+            limit_sum += value.as<int>();
+    }
+
+    std::printf("limits.cpu + limits.mem = %i\n", limit_sum);
+
+    std::printf("hosts:");
+    for (myjson::Value host : doc["hosts"].as<myjson::ArrayView>())
+        std::printf(" %s", host.as<const char*>());
+    std::printf("\n");
+
+    std::printf("ports[0][1] = %i, ports has %zu groups\n", doc["ports"][0][1].as<int>(), doc["ports"].as<myjson::ArrayView>().size());
+
+    // moving hands over ownership: only the last owner frees the document
+    myjson::Document moved = std::move(doc);
+    std::printf("after move: old owner empty: %s, new owner has %zu members\n", doc ? "no" : "yes", moved.root().as<myjson::ObjectView>().size());
+
+    // a clone shares the tree, and outlives the document it came from
+    myjson::Document copy = moved.clone();
+    moved.reset();
+    std::printf("clone after the original is freed: %zu members, ports[1][0] = %i\n", copy.root().as<myjson::ObjectView>().size(), copy["ports"][1][0].as<int>());
+
+    myjson::Document broken = myjson::Document::parse("{\"a\": [1, 2}");
+    std::printf("broken document empty: %s, error code (should be 4): %i\n", broken ? "no" : "yes", broken.error());
+
+    puts("Cleanup OK");
+
+    return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file myjson_static.cpp
+ * @author Derek Tan (DrkWithT at GitHub)
+ * @brief Test driver for the compile-time parser in json_static.hpp (Test 17).
+ * @date 2026-10-19
+ */
+
+#include <cstdio>
+#include <cstring>
+#include "json_static.hpp"
+
+static constexpr char ROUTES_JSON[] = R"({
+    "version": 3,
+    "default": {"upstream": "web", "timeout": 2.5, "retry": true},
+    "routes": [
+        {"prefix": "/api", "upstream": "api", "weight": 10, "tags": ["v1", "v2"]},
+        {"prefix": "/static", "upstream": "cdn", "weight": -1, "cache": null},
+        {"prefix": "/café", "upstream": "🚀 edge", "weight": 1e2}
+    ],
+    "features": {"beta": false, "limits": [[1, 2], [], [3.25e-2]]},
+    "banner": "tab\t \"quoted\" caf\u00e9 \ud83d\ude80",
+    "weight": 1, "weight": 2
+})";
+
+static constexpr auto routes = myjson::parse_static<ROUTES_JSON>();
+
+// constant keys fold: these are checked by the compiler, and no parse runs at startup
+static_assert(routes["version"].as<int>() == 3);
+static_assert(routes["default"]["upstream"].as<std::string_view>() == "web");
+static_assert(routes["routes"][1]["weight"].as<int>() == -1);
+static_assert(routes["routes"][2]["prefix"].as<std::string_view>() == "/caf\xc3\xa9");
+static_assert(routes["features"]["limits"][1].size() == 0);
+static_assert(!routes["routes"][3] && !routes["nope"]["deeper"]);
+static_assert(routes["weight"].as<int>() == 2); // a later duplicate key shadows the earlier one
+static_assert(!routes["version"].get<std::string_view>().has_value());
+static_assert(routes["banner"].as<std::string_view>() == "tab\t \"quoted\" caf\xc3\xa9 \xf0\x9f\x9a\x80");
+
+// numbers follow RFC 8259 like json_lex.c, so a leading zero is refused while a lone zero is kept
+static_assert(myjson::detail::StaticParser {"[01]", nullptr, nullptr}.run().err == UNKNOWN_TOKEN_ERR);
+static_assert(myjson::detail::StaticParser {"[-00.5]", nullptr, nullptr}.run().err == UNKNOWN_TOKEN_ERR);
+static_assert(myjson::detail::StaticParser {"[0, -0, 0.5, 0e1]", nullptr, nullptr}.run().err == NO_ERR);
+
+static constexpr int ROUTE_WEIGHT = routes["routes"][0]["weight"].as<int>();
+
+/**
+ * @brief Checks a static value against the same value parsed at run time by the C parser.
+ */
+static bool same_value(myjson::StaticValue expected, myjson::Value actual)
+{
+    if (!actual || expected.type() != actual.type())
+        return false;
+
+    switch (expected.type())
+    {
+    case INT:
+    case BOOL:
+        return expected.as<int>() == actual.as<int>();
+    case FLT:
+        return expected.as<float>() == actual.as<float>();
+    case STR:
+        return expected.as<std::string_view>() == actual.as<std::string_view>();
+    case NUL:
+        return true;
+    case ARR:
+    {
+        myjson::ArrayView items = actual.as<myjson::ArrayView>();
+        auto item = items.begin();
+
+        if (expected.size() != items.size())
+            return false;
+
+        for (myjson::StaticValue expected_item : expected)
+        {
+            if (!same_value(expected_item, *item++))
+                return false;
+        }
+
+        return true;
+    }
+    case OBJ:
+    {
+        myjson::ObjectView members = actual.as<myjson::ObjectView>();
+
+        // the static document keeps shadowed duplicates, which the lookups below skip
+        for (myjson::StaticValue member : expected)
+        {
+            if (!same_value(expected[member.key()], members[member.key()]))
+                return false;
+        }
+
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+int main()
+{
+    myjson::Document runtime = myjson::Document::parse(ROUTES_JSON);
+
+    std::printf("parser exit code (should be 0): %i\n", runtime.error());
+
+    if (!runtime)
+        return 1;
+
+    std::printf("static document: %zu nodes, %zu pool chars, %zu bytes of read-only data\n", routes.nodes.size(), routes.chars.size(), sizeof(routes));
+    std::printf("routes[0].weight (folded) = %i, default.timeout = %.2f\n", ROUTE_WEIGHT, routes["default"]["timeout"].as<double>());
+
+    std::printf("upstreams:");
+    for (myjson::StaticValue route : routes["routes"])
+        std::printf(" %s", route["upstream"].as<const char*>());
+    std::printf("\n");
+
+    std::printf("matches the run time parse: %s\n", same_value(routes.root(), runtime.root()) ? "yes" : "no");
+
+    puts("Cleanup OK");
+
+    return 0;
+}